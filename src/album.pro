@@ -56,6 +56,7 @@ SOURCES += \
         dialogs/albumcreatedialog.cpp \
         dialogs/dialog.cpp \
         searchview/searchview.cpp \
+        searchview/searchcontroller.cpp \
         widgets/albumlefttabitem.cpp \
         importview/importview.cpp \
         importtimelineview/importtimelineview.cpp \
@@ -78,6 +79,7 @@ HEADERS += \
         dialogs/albumcreatedialog.h \
         dialogs/dialog.h \
         searchview/searchview.h \
+        searchview/searchcontroller.h \
         widgets/albumlefttabitem.h \
         importview/importview.h \
         importtimelineview/importtimelineview.h \
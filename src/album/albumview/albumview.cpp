@@ -5,6 +5,7 @@
 #include "dtkcore_global.h"
 #include "dialogs/albumdeletedialog.h"
 #include "dbmanager/dbmanager.h"
+#include "dbmanager/dbasyncmanager.h"
 #include <DNotifySender>
 #include <QMimeData>
 #include <DTableView>
@@ -137,7 +138,6 @@ AlbumView::AlbumView()
     , m_updateMountViewThread(nullptr), isMountThreadRunning(false), m_currentViewPictureCount(0)
 
 {
-    m_iAlubmPicsNum = DBManager::instance()->getImgsCount();
     m_vfsManager = new DGioVolumeManager;
     m_diskManager = new DDiskManager(this);
     m_diskManager->setWatchChanges(true);
@@ -713,6 +713,7 @@ void AlbumView::initRightView()
 
 //Search View
     m_pSearchView = new SearchView;
+    connect(m_pSearchView, &SearchView::sigSearchFinished, this, &AlbumView::restorePicNum);
 
 // Phone View
     pPhoneWidget = new DWidget();
@@ -834,14 +835,19 @@ void AlbumView::initRightView()
     pVBoxLayout->addWidget(m_pRightStackWidget);
     m_pRightWidget->setLayout(pVBoxLayout);
 
-    if (0 < DBManager::instance()->getImgsCount()) {
-        m_pRightThumbnailList->setFrameShape(DTableView::NoFrame);
-        m_pRightStackWidget->setCurrentIndex(RIGHT_VIEW_TIMELINE_IMPORT);
-        m_pStatusBar->show();
-    } else {
-        m_pRightStackWidget->setCurrentIndex(RIGHT_VIEW_IMPORT);
-        m_pStatusBar->setVisible(false);
-    }
+    m_pRightStackWidget->setCurrentIndex(RIGHT_VIEW_IMPORT);
+    m_pStatusBar->setVisible(false);
+    std::function<int()> count = []() {
+        return DBManager::instance()->getImgsCount();
+    };
+    std::function<void(const int &)> callback = [this](const int &count) {
+        if (0 < count && COMMON_STR_RECENT_IMPORTED == m_currentAlbum) {
+            m_pRightThumbnailList->setFrameShape(DTableView::NoFrame);
+            m_pRightStackWidget->setCurrentIndex(RIGHT_VIEW_TIMELINE_IMPORT);
+            m_pStatusBar->show();
+        }
+    };
+    DBAsyncManager::instance()->query(this, count, callback, "AlbumView::updateRightView");
 }
 
 void AlbumView::updateRightView()
@@ -906,39 +912,54 @@ void AlbumView::setCurrentItemType(int type)
 // 更新已导入列表
 void AlbumView::updateRightImportView()
 {
-    m_iAlubmPicsNum = DBManager::instance()->getImgsCount();
-
-    if (0 < m_iAlubmPicsNum) {
-        m_pImpTimeLineView->clearAndStartLayout();
-        m_pRightStackWidget->setCurrentIndex(RIGHT_VIEW_TIMELINE_IMPORT);
-        m_pStatusBar->setVisible(true);
-    } else {
-        m_pImpTimeLineView->clearAndStartLayout();
-        m_pImportView->setAlbumname(QString());
-        m_pRightStackWidget->setCurrentIndex(RIGHT_VIEW_IMPORT);
-        m_pStatusBar->setVisible(false);
-    }
+    m_pImpTimeLineView->clearAndStartLayout();
     emit sigSearchEditIsDisplay(true);
     setAcceptDrops(true);
+    std::function<int()> count = []() {
+        return DBManager::instance()->getImgsCount();
+    };
+    std::function<void(const int &)> callback = [this](const int &count) {
+        if (COMMON_STR_RECENT_IMPORTED != m_currentAlbum) {
+            return;
+        }
+        m_iAlubmPicsNum = count;
+        if (0 < m_iAlubmPicsNum) {
+            m_pRightStackWidget->setCurrentIndex(RIGHT_VIEW_TIMELINE_IMPORT);
+            m_pStatusBar->setVisible(true);
+        } else {
+            m_pImportView->setAlbumname(QString());
+            m_pRightStackWidget->setCurrentIndex(RIGHT_VIEW_IMPORT);
+            m_pStatusBar->setVisible(false);
+        }
+    };
+    DBAsyncManager::instance()->query(this, count, callback, "AlbumView::updateRightView");
 }
 
 // 更新个人收藏列表
 void AlbumView::updateRightMyFavoriteView()
 {
-    using namespace utils::image;
-    DBImgInfoList infos;
-    infos = DBManager::instance()->getInfosByAlbum(m_currentAlbum, AlbumDBType::Favourite);
-    m_curThumbnaiItemList_info << infos;
-    m_pRightFavoriteThumbnailList->stopLoadAndClear();
-    m_pRightFavoriteThumbnailList->loadFilesFromLocal(infos);
     m_iAlubmPicsNum = DBManager::instance()->getImgsCountByAlbum(m_currentAlbum, AlbumDBType::Favourite);
     QString favoriteStr = tr("%1 photo(s)");
     m_pFavoritePicTotal->setText(favoriteStr.arg(QString::number(m_iAlubmPicsNum)));
     m_pRightStackWidget->setCurrentIndex(RIGHT_VIEW_FAVORITE_LIST);
     m_pStatusBar->setVisible(true);
-    m_pRightFavoriteThumbnailList->resizeHand();
     emit sigSearchEditIsDisplay(true);
     setAcceptDrops(false);
+    //相册图片在数据库线程查询，切换到其他相册后旧结果作废
+    const QString album = m_currentAlbum;
+    std::function<DBImgInfoList()> query = [album]() {
+        return DBManager::instance()->getInfosByAlbum(album, AlbumDBType::Favourite);
+    };
+    std::function<void(const DBImgInfoList &)> callback = [this, album](const DBImgInfoList & infos) {
+        if (album != m_currentAlbum) {
+            return;
+        }
+        m_curThumbnaiItemList_info << infos;
+        m_pRightFavoriteThumbnailList->stopLoadAndClear();
+        m_pRightFavoriteThumbnailList->loadFilesFromLocal(infos);
+        m_pRightFavoriteThumbnailList->resizeHand();
+    };
+    DBAsyncManager::instance()->query(this, query, callback, "AlbumView::updateRightView");
 }
 
 // 更新外接设备右侧视图
@@ -1039,11 +1060,22 @@ void AlbumView::updateRightMountView()
 // 更新新建相册列表
 void AlbumView::updateRightNoTrashView()
 {
-    using namespace utils::image;
-    DBImgInfoList infos;
-    infos = DBManager::instance()->getInfosByAlbum(m_currentAlbum);
-    m_curThumbnaiItemList_info << infos;
     m_iAlubmPicsNum = DBManager::instance()->getImgsCountByAlbum(m_currentAlbum);
+    const QString album = m_currentAlbum;
+    std::function<DBImgInfoList()> query = [album]() {
+        return DBManager::instance()->getInfosByAlbum(album);
+    };
+    std::function<void(const DBImgInfoList &)> callback = [this, album](const DBImgInfoList & infos) {
+        if (album != m_currentAlbum) {
+            return;
+        }
+        m_curThumbnaiItemList_info << infos;
+        m_pRightThumbnailList->stopLoadAndClear();
+        m_pRightThumbnailList->loadFilesFromLocal(infos);
+        int value = static_cast<int>(m_noTrashListWidget->verticalScrollBar()->maximum() * m_pRightThumbnailList->m_Row);
+        m_noTrashListWidget->verticalScrollBar()->setValue(value + 100);
+    };
+    DBAsyncManager::instance()->query(this, query, callback, "AlbumView::updateRightView");
     if (0 < m_iAlubmPicsNum) {
         m_pRightTitle->setText(m_currentAlbum);
         QFontMetrics elideFont(m_pRightTitle->font());
@@ -1051,13 +1083,9 @@ void AlbumView::updateRightNoTrashView()
         QString str = tr("%1 photo(s)");
         m_pRightPicTotal->setText(str.arg(QString::number(m_iAlubmPicsNum)));
         m_pRightThumbnailList->m_imageType = m_currentAlbum;
-        m_pRightThumbnailList->stopLoadAndClear();
-        m_pRightThumbnailList->loadFilesFromLocal(infos);
         m_pRightStackWidget->setCurrentIndex(RIGHT_VIEW_THUMBNAIL_LIST);
         m_pStatusBar->show();
     } else {
-        m_pRightThumbnailList->stopLoadAndClear();
-        m_pRightThumbnailList->loadFilesFromLocal(infos);
         m_pImportView->setAlbumname(m_currentAlbum);
         m_pRightStackWidget->setCurrentIndex(RIGHT_VIEW_IMPORT);
         m_pStatusBar->setVisible(false);
@@ -1065,8 +1093,6 @@ void AlbumView::updateRightNoTrashView()
 
     emit sigSearchEditIsDisplay(true);
     setAcceptDrops(true);
-    int value = static_cast<int>(m_noTrashListWidget->verticalScrollBar()->maximum() * m_pRightThumbnailList->m_Row);
-    m_noTrashListWidget->verticalScrollBar()->setValue(value + 100);
 }
 
 void AlbumView::updateRightTrashView()
@@ -1312,7 +1338,7 @@ void AlbumView::onKeyDelete()
         paths = m_pRightFavoriteThumbnailList->selectedPaths();
         if (0 < paths.length()) {
             m_pRightFavoriteThumbnailList->setCurrentSelectPath();
-            DBManager::instance()->removeFromAlbum(COMMON_STR_FAVORITES, paths, AlbumDBType::Favourite);
+            DBManager::instance()->removeFromAlbumAsync(COMMON_STR_FAVORITES, paths, AlbumDBType::Favourite);
         }
     } else if (COMMON_STR_CUSTOM == m_currentType) {
         paths = m_pRightThumbnailList->selectedPaths();
@@ -1571,7 +1597,7 @@ void AlbumView::importComboBoxChange(QString strText)
         qDebug() << "xxxxxxxxxx" << window()->x();
         dialog->move(window()->x() + (window()->width() - dialog->width()) / 2, window()->y() + (window()->height() - dialog->height()) / 2);
         connect(dialog, &AlbumCreateDialog::albumAdded, this, [ = ] {
-            DBManager::instance()->insertIntoAlbum(dialog->getCreateAlbumName(), QStringList(" "));
+            DBManager::instance()->insertIntoAlbumAsync(dialog->getCreateAlbumName(), QStringList(" "));
             onCreateNewAlbumFrom(dialog->getCreateAlbumName());
             updateImportComboBox();
             m_importByPhoneComboBox->setCurrentIndex(m_importByPhoneComboBox->count() - 1);
@@ -1752,11 +1778,16 @@ void AlbumView::updateImportComboBox()
     m_importByPhoneComboBox->clear();
     m_importByPhoneComboBox->addItem(tr("Gallery"));
     m_importByPhoneComboBox->addItem(tr("New album"));
-    QStringList allAlbumNames = DBManager::instance()->getAllAlbumNames();
-    for (auto albumName : allAlbumNames) {
-        m_importByPhoneComboBox->addItem(albumName);
-    }
     m_importByPhoneComboBox->setCurrentText(tr("Gallery"));     //默认选中
+    std::function<QStringList()> query = []() {
+        return DBManager::instance()->getAllAlbumNames();
+    };
+    std::function<void(const QStringList &)> callback = [this](const QStringList & allAlbumNames) {
+        for (auto albumName : allAlbumNames) {
+            m_importByPhoneComboBox->addItem(albumName);
+        }
+    };
+    DBAsyncManager::instance()->query(this, query, callback, "AlbumView::updateImportComboBox");
 }
 
 //手机照片全部导入
@@ -1929,7 +1960,7 @@ void AlbumView::onLeftListDropEvent(QModelIndex dropIndex)
     }
     qDebug() << "dropItemPaths: " << dropItemPaths;
     //向其他相册拖拽，动作添加
-    DBManager::instance()->insertIntoAlbum(item->m_albumNameStr, dropItemPaths);
+    DBManager::instance()->insertIntoAlbumAsync(item->m_albumNameStr, dropItemPaths);
     //LMH0509,为了解决24887 【相册】【5.6.9.13】拖动已导入相册中的图片到新建相册，相册崩溃
     QModelIndex index;
     emit m_pLeftListView->m_pCustomizeListView->pressed(index);
@@ -1972,14 +2003,28 @@ void AlbumView::restorePicNum()
 {
     QString str = tr("%1 photo(s)");
     int selPicNum = 0;
+    if (4 != m_pRightStackWidget->currentIndex()
+            && (COMMON_STR_RECENT_IMPORTED == m_currentAlbum || COMMON_STR_TRASH == m_currentAlbum)) {
+        //已导入和最近删除的总数在数据库线程统计
+        const QString album = m_currentAlbum;
+        std::function<int()> count = [album]() {
+            return COMMON_STR_TRASH == album ? DBManager::instance()->getTrashImgsCount()
+                   : DBManager::instance()->getImgsCount();
+        };
+        std::function<void(const int &)> callback = [this, album, str](const int &count) {
+            if (album != m_currentAlbum || 4 == m_pRightStackWidget->currentIndex()) {
+                return;
+            }
+            m_pStatusBar->setVisible(count > 0);
+            m_pStatusBar->m_pAllPicNumLabel->setText(str.arg(QString::number(count)));
+        };
+        DBAsyncManager::instance()->query(this, count, callback, "AlbumView::restorePicNum");
+        return;
+    }
     if (4 == m_pRightStackWidget->currentIndex()) {
         selPicNum = m_pSearchView->m_searchPicNum;
     } else {
-        if (COMMON_STR_RECENT_IMPORTED == m_currentAlbum) {
-            selPicNum = DBManager::instance()->getImgsCount();
-        } else if (COMMON_STR_TRASH == m_currentAlbum) {
-            selPicNum = DBManager::instance()->getTrashImgsCount();
-        } else if (COMMON_STR_FAVORITES == m_currentAlbum) {
+        if (COMMON_STR_FAVORITES == m_currentAlbum) {
             selPicNum = DBManager::instance()->getImgsCountByAlbum(m_currentAlbum, AlbumDBType::Favourite);
         } else {
             if (5 == m_pRightStackWidget->currentIndex()) {
@@ -2104,7 +2149,7 @@ void AlbumView::onInsertedIntoAlbum(QString albumname, QStringList pathlist)
 
 void AlbumView::onFinishLoad()
 {
-    m_pImpTimeLineView->m_mainListWidget->update();
+    m_pImpTimeLineView->m_timelineView->update();
     m_pRightThumbnailList->update();
     m_pRightFavoriteThumbnailList->update();
     m_pRightTrashThumbnailList->update();
@@ -1,6 +1,7 @@
 #include "leftlistview.h"
 #include "widgets/albumlefttabitem.h"
 #include "dbmanager/dbmanager.h"
+#include "dbmanager/dbasyncmanager.h"
 #include "application.h"
 #include "controller/configsetter.h"
 #include "utils/baseutils.h"
@@ -169,16 +170,23 @@ void LeftListView::initUI()
     m_pCustomizeListView->setFrameShape(DListWidget::NoFrame);
     m_pCustomizeListView->setContextMenuPolicy(Qt::CustomContextMenu);
 
-    QStringList allAlbumNames = DBManager::instance()->getAllAlbumNames();
-    for (auto albumName : allAlbumNames) {
-        QListWidgetItem *pListWidgetItem = new QListWidgetItem(m_pCustomizeListView, 1);
-        pListWidgetItem->setSizeHint(QSize(LEFT_VIEW_LISTITEM_WIDTH_160 /*+ 8*/, LEFT_VIEW_LISTITEM_HEIGHT_40));
-
-        AlbumLeftTabItem *pAlbumLeftTabItem = new AlbumLeftTabItem(albumName, COMMON_STR_CREATEALBUM);
-        pAlbumLeftTabItem->setFixedWidth(LEFT_VIEW_LISTITEM_WIDTH_160 /*+ 8*/);
-        pAlbumLeftTabItem->setFixedHeight(LEFT_VIEW_LISTITEM_HEIGHT_40);
-        m_pCustomizeListView->setItemWidget(pListWidgetItem, pAlbumLeftTabItem);
-    }
+    //相册名在数据库线程查询，返回后填充列表
+    std::function<QStringList()> query = []() {
+        return DBManager::instance()->getAllAlbumNames();
+    };
+    std::function<void(const QStringList &)> callback = [this](const QStringList & allAlbumNames) {
+        for (auto albumName : allAlbumNames) {
+            QListWidgetItem *pListWidgetItem = new QListWidgetItem(m_pCustomizeListView, 1);
+            pListWidgetItem->setSizeHint(QSize(LEFT_VIEW_LISTITEM_WIDTH_160 /*+ 8*/, LEFT_VIEW_LISTITEM_HEIGHT_40));
+
+            AlbumLeftTabItem *pAlbumLeftTabItem = new AlbumLeftTabItem(albumName, COMMON_STR_CREATEALBUM);
+            pAlbumLeftTabItem->setFixedWidth(LEFT_VIEW_LISTITEM_WIDTH_160 /*+ 8*/);
+            pAlbumLeftTabItem->setFixedHeight(LEFT_VIEW_LISTITEM_HEIGHT_40);
+            m_pCustomizeListView->setItemWidget(pListWidgetItem, pAlbumLeftTabItem);
+        }
+        onUpdateLeftListview();
+    };
+    DBAsyncManager::instance()->query(this, query, callback, "LeftListView::customizeList");
     // 设备Widget
     QVBoxLayout *pMountVLayout = new QVBoxLayout(this);
     pMountVLayout->setContentsMargins(0, 0, 0, 0);
@@ -258,16 +266,23 @@ void LeftListView::updatePhotoListView()
 void LeftListView::updateCustomizeListView()
 {
     m_pCustomizeListView->clear();
-    QStringList allAlbumNames = DBManager::instance()->getAllAlbumNames();
-    for (auto albumName : allAlbumNames) {
-        QListWidgetItem *pListWidgetItem = new QListWidgetItem(m_pCustomizeListView);
-        pListWidgetItem->setSizeHint(QSize(LEFT_VIEW_LISTITEM_WIDTH_160, LEFT_VIEW_LISTITEM_HEIGHT_40));
-
-        AlbumLeftTabItem *pAlbumLeftTabItem = new AlbumLeftTabItem(albumName);
-        pAlbumLeftTabItem->setFixedWidth(LEFT_VIEW_LISTITEM_WIDTH_160);
-        pAlbumLeftTabItem->setFixedHeight(LEFT_VIEW_LISTITEM_HEIGHT_40);
-        m_pCustomizeListView->setItemWidget(pListWidgetItem, pAlbumLeftTabItem);
-    }
+    std::function<QStringList()> query = []() {
+        return DBManager::instance()->getAllAlbumNames();
+    };
+    std::function<void(const QStringList &)> callback = [this](const QStringList & allAlbumNames) {
+        m_pCustomizeListView->clear();
+        for (auto albumName : allAlbumNames) {
+            QListWidgetItem *pListWidgetItem = new QListWidgetItem(m_pCustomizeListView);
+            pListWidgetItem->setSizeHint(QSize(LEFT_VIEW_LISTITEM_WIDTH_160, LEFT_VIEW_LISTITEM_HEIGHT_40));
+
+            AlbumLeftTabItem *pAlbumLeftTabItem = new AlbumLeftTabItem(albumName);
+            pAlbumLeftTabItem->setFixedWidth(LEFT_VIEW_LISTITEM_WIDTH_160);
+            pAlbumLeftTabItem->setFixedHeight(LEFT_VIEW_LISTITEM_HEIGHT_40);
+            m_pCustomizeListView->setItemWidget(pListWidgetItem, pAlbumLeftTabItem);
+        }
+        onUpdateLeftListview();
+    };
+    DBAsyncManager::instance()->query(this, query, callback, "LeftListView::customizeList");
 }
 
 void LeftListView::initMenu()
@@ -316,15 +331,21 @@ void LeftListView::onMenuClicked(QAction *action)
     const int id = action->property("MenuID").toInt();
     switch (MenuItemId(id)) {
     case IdStartSlideShow: {
-        auto imagelist = DBManager::instance()->getInfosByAlbum(m_ItemCurrentName);
-        QStringList paths;
-        for (auto image : imagelist) {
-            paths << image.filePath;
-        }
-        if (paths.length() > 0) {
-            const QString path = paths.first();
-            emit menuOpenImage(path, paths, true, true);
-        }
+        const QString album = m_ItemCurrentName;
+        std::function<QStringList()> query = [album]() {
+            QStringList paths;
+            for (auto image : DBManager::instance()->getInfosByAlbum(album)) {
+                paths << image.filePath;
+            }
+            return paths;
+        };
+        std::function<void(const QStringList &)> callback = [this](const QStringList & paths) {
+            if (paths.length() > 0) {
+                const QString path = paths.first();
+                emit menuOpenImage(path, paths, true, true);
+            }
+        };
+        DBAsyncManager::instance()->query(this, query, callback);
         break;
     }
     case IdCreateAlbum: {
@@ -1,6 +1,7 @@
 #include "allpicview.h"
 #include <QMimeData>
 #include "imageengine/imageengineapi.h"
+#include "dbmanager/dbasyncmanager.h"
 #include "mainwindow.h"
 #include <dgiovolumemanager.h>
 #include <dgiofile.h>
@@ -54,6 +55,7 @@ AllPicView::AllPicView()
     m_mainLayout->addWidget(m_pThumbnailListView);
     pThumbnailListView->setLayout(m_mainLayout);
     m_pSearchView = new SearchView();
+    connect(m_pSearchView, &SearchView::sigSearchFinished, this, &AllPicView::restorePicNum);
     m_pStackedWidget->addWidget(m_pImportView);
     m_pStackedWidget->setCurrentIndex(VIEW_IMPORT);
     m_pStackedWidget->addWidget(pThumbnailListView);
@@ -118,14 +120,21 @@ void AllPicView::initConnections()
 
 void AllPicView::updateStackedWidget()
 {
-    if (0 < DBManager::instance()->getImgsCount()) {
-        m_pStackedWidget->setCurrentIndex(VIEW_ALLPICS);
-        m_pStatusBar->setVisible(true);
-    } else {
-        m_pStackedWidget->setCurrentIndex(VIEW_IMPORT);
-        m_pStatusBar->setVisible(false);
-    }
-    updatePicNum();
+    //图片总数在数据库线程统计，回调中切换页面
+    std::function<int()> count = []() {
+        return DBManager::instance()->getImgsCount();
+    };
+    std::function<void(const int &)> callback = [this](const int &count) {
+        if (0 < count) {
+            m_pStackedWidget->setCurrentIndex(VIEW_ALLPICS);
+            m_pStatusBar->setVisible(true);
+        } else {
+            m_pStackedWidget->setCurrentIndex(VIEW_IMPORT);
+            m_pStatusBar->setVisible(false);
+        }
+        updatePicNum();
+    };
+    DBAsyncManager::instance()->query(this, count, callback, "AllPicView::updateStackedWidget");
 }
 
 void AllPicView::monitorHaveNewFile(QStringList list)
@@ -326,10 +335,20 @@ const ThumbnailListView *AllPicView::getAllPicThumbnailListViewModel()
 void AllPicView::restorePicNum()
 {
     QString str = tr("%1 photo(s)");
-    int selPicNum = 0;
     if (VIEW_ALLPICS == m_pStackedWidget->currentIndex()) {
-        selPicNum = DBManager::instance()->getImgsCount();
-    } else if (VIEW_SEARCH == m_pStackedWidget->currentIndex()) {
+        std::function<int()> count = []() {
+            return DBManager::instance()->getImgsCount();
+        };
+        std::function<void(const int &)> callback = [this, str](const int &count) {
+            if (VIEW_ALLPICS == m_pStackedWidget->currentIndex()) {
+                m_pStatusBar->m_pAllPicNumLabel->setText(str.arg(QString::number(count)));
+            }
+        };
+        DBAsyncManager::instance()->query(this, count, callback, "AllPicView::restorePicNum");
+        return;
+    }
+    int selPicNum = 0;
+    if (VIEW_SEARCH == m_pStackedWidget->currentIndex()) {
         selPicNum = m_pSearchView->m_searchPicNum;
     }
     m_pStatusBar->m_pAllPicNumLabel->setText(str.arg(QString::number(selPicNum)));
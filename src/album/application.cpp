@@ -66,11 +66,12 @@ void ImageLoader::ImportImageLoader(DBImgInfoList dbInfos, QString albumname)
     }
 
     bool bcustalbum = false;
+    //相册引用ImageId，须先写入图片
+    DBManager::instance()->insertImgInfos(dbInfoList);
     if (albumname.length() > 0) {
         DBManager::instance()->insertIntoAlbumNoSignal(albumname, pathlist);
         bcustalbum = true;
     }
-    DBManager::instance()->insertImgInfos(dbInfoList);
     if (pathlist.size() > 0) {
         emit dApp->signalM->updateStatusBarImportLabel(pathlist, 1, bcustalbum, albumname);
     } else {
@@ -61,6 +61,7 @@ static CMOption options[] = {
 //    {"e", "edit", "Go to edit view and begin editing <image-file>.", "image-file"},
     {"w", "wallpaper", "Set <image-file> as wallpaper.", "image-file"},
     {"new-window", "new-window", "Display a window.", ""},
+    {"startup-profile", "startup-profile", "Print startup phase timings.", ""},
     {"", "", "", ""}
 };
 
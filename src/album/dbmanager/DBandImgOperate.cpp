@@ -107,6 +107,7 @@ void DBandImgOperate::threadSltLoad80Thumbnail(DBImgInfoList infos)
     imageDatas.clear();
     for (auto info : infosLoad) {
         ImageDataSt data = loadOneThumbnail(info.filePath);
+        data.dbi = info;
         imageDatas[info.filePath] = data;
     }
     emit sig80ImgInfosReady(imageDatas);
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "dbasyncmanager.h"
+#include <QCoreApplication>
+#include <QThread>
+#include <QDebug>
+
+DBAsyncManager *DBAsyncManager::m_instance = nullptr;
+
+DBAsyncManager *DBAsyncManager::instance()
+{
+    if (!m_instance) {
+        m_instance = new DBAsyncManager();
+    }
+    return m_instance;
+}
+
+DBAsyncManager::DBAsyncManager(QObject *parent)
+    : QObject(parent)
+{
+    //回调经由本对象投递，须位于GUI线程
+    if (QCoreApplication::instance()) {
+        moveToThread(QCoreApplication::instance()->thread());
+    }
+    //单线程，保证请求按提交顺序执行
+    m_pool.setMaxThreadCount(1);
+    m_pool.setExpiryTimeout(-1);
+}
+
+DBAsyncManager::~DBAsyncManager()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void DBAsyncManager::cancel(const QString &tag)
+{
+    if (tag.isEmpty()) {
+        return;
+    }
+    nextTicket(tag);
+}
+
+bool DBAsyncManager::isGuiThread()
+{
+    QCoreApplication *app = QCoreApplication::instance();
+    return app && QThread::currentThread() == app->thread();
+}
+
+quint64 DBAsyncManager::nextTicket(const QString &tag)
+{
+    QMutexLocker locker(&m_ticketMutex);
+    ++m_ticketSeq;
+    if (!tag.isEmpty()) {
+        m_tickets[tag] = m_ticketSeq;
+    }
+    return m_ticketSeq;
+}
+
+bool DBAsyncManager::isCurrent(const QString &tag, quint64 ticket) const
+{
+    if (tag.isEmpty()) {
+        return true;
+    }
+    QMutexLocker locker(&m_ticketMutex);
+    return m_tickets.value(tag) == ticket;
+}
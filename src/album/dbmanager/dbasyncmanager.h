@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DBASYNCMANAGER_H
+#define DBASYNCMANAGER_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QPointer>
+#include <QThreadPool>
+#include <QFuture>
+#include <QtConcurrent>
+#include <functional>
+
+//GUI线程上同步数据库调用超过该时长(ms)时打印警告
+const int GUI_THREAD_DB_WARN_MS = 30;
+
+/**
+ * @brief The DBAsyncManager class
+ * DBManager的异步外观：查询在专用的数据库线程上顺序执行，结果回到GUI线程。
+ * 带tag的请求在同tag的新请求到来时自动作废(如搜索)，作废的请求不会执行或不会回调。
+ */
+class DBAsyncManager : public QObject
+{
+    Q_OBJECT
+public:
+    static DBAsyncManager *instance();
+    ~DBAsyncManager() override;
+
+    //在数据库线程执行func，结果通过callback在GUI线程返回；receiver销毁后不再回调
+    template <typename T>
+    void query(QObject *receiver, std::function<T()> func,
+               std::function<void(const T &)> callback, const QString &tag = QString());
+
+    //在数据库线程执行func，返回future
+    template <typename T>
+    QFuture<T> future(std::function<T()> func)
+    {
+        return QtConcurrent::run(&m_pool, func);
+    }
+
+    //作废tag下尚未完成的请求
+    void cancel(const QString &tag);
+
+    static bool isGuiThread();
+
+private:
+    explicit DBAsyncManager(QObject *parent = nullptr);
+    quint64 nextTicket(const QString &tag);
+    bool isCurrent(const QString &tag, quint64 ticket) const;
+
+    static DBAsyncManager *m_instance;
+    QThreadPool m_pool;
+    mutable QMutex m_ticketMutex;
+    QHash<QString, quint64> m_tickets;
+    quint64 m_ticketSeq = 0;
+};
+
+template <typename T>
+void DBAsyncManager::query(QObject *receiver, std::function<T()> func,
+                           std::function<void(const T &)> callback, const QString &tag)
+{
+    const quint64 ticket = nextTicket(tag);
+    QPointer<QObject> guard(receiver);
+    QtConcurrent::run(&m_pool, [ = ]() {
+        if (!isCurrent(tag, ticket)) {
+            return;
+        }
+        const T result = func();
+        if (!isCurrent(tag, ticket)) {
+            return;
+        }
+        QMetaObject::invokeMethod(this, [ = ]() {
+            if (!guard.isNull() && isCurrent(tag, ticket) && callback) {
+                callback(result);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+#endif // DBASYNCMANAGER_H
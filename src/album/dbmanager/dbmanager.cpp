@@ -15,12 +15,16 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "dbmanager.h"
+#include "dbasyncmanager.h"
+#include "photocatalog.h"
 #include "application.h"
 #include "controller/signalmanager.h"
 #include "utils/baseutils.h"
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QMutex>
+#include <QSet>
 #include <QSqlDatabase>
 #include <QSqlError>
 #include <QSqlQuery>
@@ -30,7 +34,180 @@ namespace {
 const QString DATABASE_PATH = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
                               + QDir::separator() + "deepin" + QDir::separator() + "deepin-album" + QDir::separator();
 const QString DATABASE_NAME = "deepinalbum.db";
+//旧版数据库中空相册占位行的PathHash，仅迁移时使用
 const QString EMPTY_HASH_STR = utils::base::hash(QString(" "));
+//空相册占位行的ImageId
+const qint64 EMPTY_IMAGE_ID = 0;
+//临时路径表中路径对应的ImageId，PathKey可能冲突，需同时比较FilePath
+const QString IMAGE_IDS_OF_PATH_TABLE = "SELECT i.ImageId FROM ImageTable3 AS i INNER JOIN %1 AS r "
+                                        "ON i.PathKey = r.PathKey AND i.FilePath = r.FilePath";
+//ImageTable3中导入时记录的图片元数据列，用于在解码前完成布局
+const QString IMAGE_META_COLUMNS = "Width, Height, Orientation, FileSize, MTime, Fingerprint, DHash, PreviewColor";
+const QString IMAGE_META_COLUMNS_I = "i.Width, i.Height, i.Orientation, i.FileSize, i.MTime, i.Fingerprint, i.DHash, i.PreviewColor";
+
+//搜索关键字作为参数绑定，不拼进SQL；%和_按普通字符匹配
+QString escapeLikeKeyword(const QString &keyword)
+{
+    QString escaped = keyword;
+    escaped.replace("\\", "\\\\").replace("%", "\\%").replace("_", "\\_");
+    return escaped;
+}
+
+//路径写入临时表，供与ImageTable3按PathKey联合查询
+template <typename Paths>
+bool fillPathTable(QSqlQuery &query, const QString &table, const Paths &paths)
+{
+    query.exec(QString("CREATE TEMP TABLE IF NOT EXISTS %1 (PathKey INTEGER, FilePath TEXT)").arg(table));
+    query.exec(QString("DELETE FROM %1").arg(table));
+    QVariantList keys, filePaths;
+    for (const QString &path : paths) {
+        keys << utils::base::pathHash(path);
+        filePaths << path;
+    }
+    query.prepare(QString("INSERT INTO %1 (PathKey, FilePath) VALUES (?, ?)").arg(table));
+    query.addBindValue(keys);
+    query.addBindValue(filePaths);
+    if (!query.execBatch()) {
+        qWarning() << "fill" << table << "failed: " << query.lastError();
+        return false;
+    }
+    return true;
+}
+
+//按路径查出ImageId写入相册，已在相册中的不重复写入；" "表示空相册占位
+//inserted返回写入后在相册中的路径(含占位" ")，不在ImageTable3中的路径不会写入
+bool insertAlbumRows(QSqlQuery &query, const QString &album, const QStringList &paths, AlbumDBType atype, QStringList &inserted)
+{
+    inserted.clear();
+    if (paths.contains(" ")) {
+        query.prepare("INSERT INTO AlbumTable3 (AlbumName, ImageId, AlbumDBType) SELECT ?, ?, ? "
+                      "WHERE NOT EXISTS (SELECT 1 FROM AlbumTable3 WHERE AlbumName = ? AND ImageId = ? AND AlbumDBType = ?)");
+        query.addBindValue(album);
+        query.addBindValue(EMPTY_IMAGE_ID);
+        query.addBindValue(atype);
+        query.addBindValue(album);
+        query.addBindValue(EMPTY_IMAGE_ID);
+        query.addBindValue(atype);
+        if (!query.exec()) {
+            qWarning() << "insertIntoAlbum failed: " << query.lastError();
+            return false;
+        }
+        inserted << " ";
+    }
+    if (!fillPathTable(query, "AlbumPathTable", paths)) {
+        return false;
+    }
+    query.prepare(QString("INSERT INTO AlbumTable3 (AlbumName, ImageId, AlbumDBType) "
+                          "SELECT DISTINCT ?, ImageId, ? FROM (%1) AS n "
+                          "WHERE NOT EXISTS (SELECT 1 FROM AlbumTable3 AS a "
+                          "WHERE a.AlbumName = ? AND a.ImageId = n.ImageId AND a.AlbumDBType = ?)")
+                  .arg(IMAGE_IDS_OF_PATH_TABLE.arg("AlbumPathTable")));
+    query.addBindValue(album);
+    query.addBindValue(atype);
+    query.addBindValue(album);
+    query.addBindValue(atype);
+    if (!query.exec()) {
+        qWarning() << "insertIntoAlbum failed: " << query.lastError();
+        return false;
+    }
+    if (!query.exec("SELECT DISTINCT r.FilePath FROM ImageTable3 AS i INNER JOIN AlbumPathTable AS r "
+                    "ON i.PathKey = r.PathKey AND i.FilePath = r.FilePath")) {
+        qWarning() << "insertIntoAlbum failed: " << query.lastError();
+        return false;
+    }
+    while (query.next()) {
+        inserted << query.value(0).toString();
+    }
+    return true;
+}
+
+void createImageTables(QSqlQuery &query)
+{
+    // ImageTable3
+    //////////////////////////////////////////////////////////////
+    //ImageId               | PathKey | FilePath | FileName   | Dir  | Time | ChangeTime | ImportTime | Width   | Height  | Orientation | FileSize | MTime   | Fingerprint | DHash   | PreviewColor //
+    //INTEGER primari key   | INTEGER | TEXT     | TEXT       | TEXT | TEXT | TEXT       | TEXT       | INTEGER | INTEGER | INTEGER     | INTEGER  | INTEGER | INTEGER     | INTEGER | INTEGER      //
+    //////////////////////////////////////////////////////////////
+    query.exec(QString("CREATE TABLE IF NOT EXISTS ImageTable3 ( "
+                       "ImageId INTEGER primary key, "
+                       "PathKey INTEGER, "
+                       "FilePath TEXT, "
+                       "FileName TEXT, "
+                       "Dir TEXT, "
+                       "Time TEXT, "
+                       "ChangeTime TEXT, "
+                       "ImportTime TEXT, "
+                       "Width INTEGER default 0, "
+                       "Height INTEGER default 0, "
+                       "Orientation INTEGER default 0, "
+                       "FileSize INTEGER default 0, "
+                       "MTime INTEGER default 0, "
+                       "Fingerprint INTEGER default 0, "
+                       "DHash INTEGER default 0, "
+                       "PreviewColor INTEGER default 0)"));
+    query.exec("CREATE INDEX IF NOT EXISTS ImagePathKeyIndex ON ImageTable3 (PathKey)");
+
+    // AlbumTable3
+    ///////////////////////////////////////////////////////////////////////////
+    //AlbumId               | AlbumName         | ImageId       |AlbumDBType //
+    //INTEGER primari key   | TEXT              | INTEGER       |INTEGER     //
+    ///////////////////////////////////////////////////////////////////////////
+    query.exec(QString("CREATE TABLE IF NOT EXISTS AlbumTable3 ( "
+                       "AlbumId INTEGER primary key, "
+                       "AlbumName TEXT, "
+                       "ImageId INTEGER, "
+                       "AlbumDBType INTEGER)"));
+    query.exec("CREATE INDEX IF NOT EXISTS AlbumNameImageIndex ON AlbumTable3 (AlbumName, ImageId)");
+    query.exec("CREATE INDEX IF NOT EXISTS AlbumImageIdIndex ON AlbumTable3 (ImageId)");
+}
+
+void readImgMetas(const QSqlQuery &query, int column, DBImgInfo &info)
+{
+    info.width = query.value(column).toInt();
+    info.height = query.value(column + 1).toInt();
+    info.orientation = query.value(column + 2).toInt();
+    info.fileSize = query.value(column + 3).toLongLong();
+    info.mtime = query.value(column + 4).toLongLong();
+    info.fingerprint = query.value(column + 5).toLongLong();
+    info.dhash = query.value(column + 6).toLongLong();
+    info.previewColor = query.value(column + 7).toUInt();
+}
+
+//加锁并统计耗时：GUI线程上的数据库调用超过阈值时打印警告，便于找出仍在同步调用的地方
+class DBCallLocker
+{
+public:
+    DBCallLocker(QMutex *mutex, const char *func)
+        : m_mutex(mutex), m_func(func), m_onGuiThread(DBAsyncManager::isGuiThread())
+    {
+        if (m_onGuiThread) {
+            m_timer.start();
+        }
+        m_mutex->lock();
+        m_locked = true;
+    }
+    ~DBCallLocker()
+    {
+        unlock();
+    }
+    void unlock()
+    {
+        if (!m_locked) {
+            return;
+        }
+        m_mutex->unlock();
+        m_locked = false;
+        if (m_onGuiThread && m_timer.elapsed() > GUI_THREAD_DB_WARN_MS) {
+            qWarning() << "DB call on GUI thread took" << m_timer.elapsed() << "ms:" << m_func;
+        }
+    }
+private:
+    QMutex *m_mutex;
+    const char *m_func;
+    bool m_onGuiThread;
+    bool m_locked = false;
+    QElapsedTimer m_timer;
+};
 
 }  // namespace
 
@@ -50,11 +227,16 @@ DBManager::DBManager(QObject *parent)
 {
     m_db.setDatabaseName(DATABASE_PATH + DATABASE_NAME);
     checkDatabase();
+    //相册缓存在数据库线程上预先加载，GUI线程的相册查询不再等待数据库
+    std::function<void()> warm = [this]() {
+        loadAlbumCache();
+    };
+    DBAsyncManager::instance()->future(warm);
 }
 
 const QStringList DBManager::getAllPaths() const
 {
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     QStringList paths;
     QSqlDatabase db = getDatabase();
     if (! db.isValid())
@@ -80,7 +262,7 @@ const QStringList DBManager::getAllPaths() const
 
 const DBImgInfoList DBManager::getAllInfos(int loadCount) const
 {
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     DBImgInfoList infos;
     QSqlDatabase db = getDatabase();
     if (! db.isValid()) {
@@ -89,9 +271,9 @@ const DBImgInfoList DBManager::getAllInfos(int loadCount) const
     QSqlQuery query(db);
     query.setForwardOnly(true);
     if (loadCount == 0) {
-        query.prepare("SELECT FilePath, FileName, Dir, Time, ChangeTime, ImportTime FROM ImageTable3 order by Time desc");
+        query.prepare("SELECT FilePath, FileName, Dir, Time, ChangeTime, ImportTime, " + IMAGE_META_COLUMNS + " FROM ImageTable3 order by Time desc");
     } else {
-        query.prepare("SELECT FilePath, FileName, Dir, Time, ChangeTime, ImportTime FROM ImageTable3 order by Time desc limit 80");
+        query.prepare("SELECT FilePath, FileName, Dir, Time, ChangeTime, ImportTime, " + IMAGE_META_COLUMNS + " FROM ImageTable3 order by Time desc limit 80");
     }
     if (! query.exec()) {
         qDebug() << query.lastError();
@@ -106,6 +288,7 @@ const DBImgInfoList DBManager::getAllInfos(int loadCount) const
             info.time = stringToDateTime(query.value(3).toString());
             info.changeTime = QDateTime::fromString(query.value(4).toString(), DATETIME_FORMAT_DATABASE);
             info.importTime = QDateTime::fromString(query.value(5).toString(), DATETIME_FORMAT_DATABASE);
+            readImgMetas(query, 6, info);
             infos << info;
         }
     }
@@ -114,7 +297,7 @@ const DBImgInfoList DBManager::getAllInfos(int loadCount) const
 
 const QStringList DBManager::getAllTimelines() const
 {
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     QStringList times;
     QSqlDatabase db = getDatabase();
     if (! db.isValid())
@@ -147,7 +330,7 @@ const DBImgInfoList DBManager::getInfosByTimeline(const QString &timeline) const
 
 const QStringList DBManager::getImportTimelines() const
 {
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     QStringList importtimes;
     QSqlDatabase db = getDatabase();
     if (! db.isValid())
@@ -178,6 +361,16 @@ const DBImgInfoList DBManager::getInfosByImportTimeline(const QString &timeline)
     }
 }
 
+const DBTimelineSections DBManager::getTimelineSections() const
+{
+    return getInfosGroupedBy("Time");
+}
+
+const DBTimelineSections DBManager::getImportTimelineSections() const
+{
+    return getInfosGroupedBy("ImportTime");
+}
+
 const DBImgInfo DBManager::getInfoByPath(const QString &path) const
 {
     DBImgInfoList list = getImgInfos("FilePath", path);
@@ -188,103 +381,218 @@ const DBImgInfo DBManager::getInfoByPath(const QString &path) const
     }
 }
 
+const DBImgInfoList DBManager::getInfosByPaths(const QStringList &paths) const
+{
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
+    DBImgInfoList infos;
+    QSqlDatabase db = getDatabase();
+    if (paths.isEmpty() || ! db.isValid()) {
+        return infos;
+    }
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (! fillPathTable(query, "InfoPathTable", paths)) {
+        db.close();
+        return infos;
+    }
+    query.prepare("SELECT i.FilePath, i.FileName, i.Dir, i.Time, i.ChangeTime, i.ImportTime, " + IMAGE_META_COLUMNS_I + " "
+                  "FROM ImageTable3 AS i INNER JOIN InfoPathTable AS r ON i.PathKey = r.PathKey AND i.FilePath = r.FilePath");
+    if (! query.exec()) {
+        qWarning() << "getInfosByPaths failed: " << query.lastError();
+    } else {
+        using namespace utils::base;
+        while (query.next()) {
+            DBImgInfo info;
+            info.filePath = query.value(0).toString();
+            info.fileName = query.value(1).toString();
+            info.dirHash = query.value(2).toString();
+            info.time = stringToDateTime(query.value(3).toString());
+            info.changeTime = QDateTime::fromString(query.value(4).toString(), DATETIME_FORMAT_DATABASE);
+            info.importTime = QDateTime::fromString(query.value(5).toString(), DATETIME_FORMAT_DATABASE);
+            readImgMetas(query, 6, info);
+            infos << info;
+        }
+    }
+    query.exec("DELETE FROM InfoPathTable");
+    db.close();
+    return infos;
+}
+
 int DBManager::getImgsCount() const
 {
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     QSqlDatabase db = getDatabase();
     if (! db.isValid()) {
         return 0;
     }
     QSqlQuery query(db);
     query.setForwardOnly(true);
-    query.exec("BEGIN IMMEDIATE TRANSACTION");
+    //只读统计不需要写事务
     query.prepare("SELECT COUNT(*) FROM ImageTable3");
-    if (query.exec()) {
-        query.first();
-        int count = query.value(0).toInt();
-        query.exec("COMMIT");
-        return count;
+    int count = 0;
+    if (query.exec() && query.first()) {
+        count = query.value(0).toInt();
     }
-    return 0;
+    db.close();
+    return count;
 }
 
 void DBManager::insertImgInfos(const DBImgInfoList &infos)
 {
-    QMutexLocker mutex(&m_mutex);
+    if (insertImgInfosNoSignal(infos)) {
+        emit dApp->signalM->imagesInserted(/*infos*/);
+    }
+}
+
+bool DBManager::insertImgInfosNoSignal(const DBImgInfoList &infos)
+{
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     QSqlDatabase db = getDatabase();
     if (infos.isEmpty() || ! db.isValid()) {
-        return;
+        return false;
     }
-    QVariantList pathhashs, filenames, filepaths, dirs, times, changetimes, importtimes;
+    QVariantList pathkeys, filenames, filepaths, dirs, times, changetimes, importtimes;
+    QVariantList widths, heights, orientations, filesizes, mtimes, fingerprints, dhashes, colors;
     for (DBImgInfo info : infos) {
         filenames << info.fileName;
         filepaths << info.filePath;
-        pathhashs << utils::base::hash(info.filePath);
+        pathkeys << utils::base::pathHash(info.filePath);
         dirs << info.dirHash;
         times << info.time.toString("yyyy.MM.dd");
         changetimes << info.changeTime.toString(DATETIME_FORMAT_DATABASE);
         importtimes << info.importTime.toString(DATETIME_FORMAT_DATABASE);
+        widths << info.width;
+        heights << info.height;
+        orientations << info.orientation;
+        filesizes << info.fileSize;
+        mtimes << info.mtime;
+        fingerprints << info.fingerprint;
+        dhashes << info.dhash;
+        colors << info.previewColor;
     }
     QSqlQuery query(db);
     query.setForwardOnly(true);
     query.exec("BEGIN IMMEDIATE TRANSACTION");
-    query.prepare("REPLACE INTO ImageTable3 (PathHash, FilePath, FileName, Dir, Time, ChangeTime, ImportTime) VALUES (?, ?, ?, ?, ?, ?, ?)");
-    query.addBindValue(pathhashs);
+    //已有的行原地更新，保留ImageId，相册引用不受影响
+    query.prepare("UPDATE ImageTable3 SET FileName = ?, Dir = ?, Time = ?, ChangeTime = ?, ImportTime = ?, "
+                  "Width = ?, Height = ?, Orientation = ?, FileSize = ?, MTime = ?, "
+                  "Fingerprint = COALESCE(NULLIF(?, 0), Fingerprint), DHash = COALESCE(NULLIF(?, 0), DHash), "
+                  "PreviewColor = COALESCE(NULLIF(?, 0), PreviewColor) "
+                  "WHERE PathKey = ? AND FilePath = ?");
+    query.addBindValue(filenames);
+    query.addBindValue(dirs);
+    query.addBindValue(times);
+    query.addBindValue(changetimes);
+    query.addBindValue(importtimes);
+    query.addBindValue(widths);
+    query.addBindValue(heights);
+    query.addBindValue(orientations);
+    query.addBindValue(filesizes);
+    query.addBindValue(mtimes);
+    query.addBindValue(fingerprints);
+    query.addBindValue(dhashes);
+    query.addBindValue(colors);
+    query.addBindValue(pathkeys);
+    query.addBindValue(filepaths);
+    bool suc = query.execBatch();
+    query.prepare("INSERT INTO ImageTable3 (PathKey, FilePath, FileName, Dir, Time, ChangeTime, ImportTime, "
+                  "Width, Height, Orientation, FileSize, MTime, Fingerprint, DHash, PreviewColor) "
+                  "SELECT ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ? "
+                  "WHERE NOT EXISTS (SELECT 1 FROM ImageTable3 WHERE PathKey = ? AND FilePath = ?)");
+    query.addBindValue(pathkeys);
     query.addBindValue(filepaths);
     query.addBindValue(filenames);
     query.addBindValue(dirs);
     query.addBindValue(times);
     query.addBindValue(changetimes);
     query.addBindValue(importtimes);
-    if (! query.execBatch()) {
-        query.exec("COMMIT");
-        db.close();
-    } else {
-        query.exec("COMMIT");
+    query.addBindValue(widths);
+    query.addBindValue(heights);
+    query.addBindValue(orientations);
+    query.addBindValue(filesizes);
+    query.addBindValue(mtimes);
+    query.addBindValue(fingerprints);
+    query.addBindValue(dhashes);
+    query.addBindValue(colors);
+    query.addBindValue(pathkeys);
+    query.addBindValue(filepaths);
+    if (! suc || ! query.execBatch()) {
+        //更新与插入同属一批，任一失败整体回滚，数据库与内存目录保持一致
+        qWarning() << "insertImgInfos failed: " << query.lastError();
+        query.exec("ROLLBACK");
         db.close();
-        mutex.unlock();
-        emit dApp->signalM->imagesInserted(/*infos*/);
+        return false;
     }
+    query.exec("COMMIT");
+    db.close();
+    PhotoCatalog::instance()->insertInfos(infos);
+    return true;
 }
 
-void DBManager::removeImgInfos(const QStringList &paths)
+void DBManager::updateImgMetas(const DBImgInfoList &infos)
 {
-    if (paths.isEmpty()) {
-        return;
-    }
-    // Collect info before removing data
-    DBImgInfoList infos;
-    QStringList pathHashs;
-    for (QString path : paths) {
-        pathHashs << utils::base::hash(path);
-        infos = getImgInfos("FilePath", path, false);
-    }
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     QSqlDatabase db = getDatabase();
-    if (! db.isValid()) {
+    if (infos.isEmpty() || ! db.isValid()) {
         return;
     }
+    QVariantList pathkeys, filepaths, widths, heights, orientations, filesizes, mtimes, dhashes, colors;
+    for (const DBImgInfo &info : infos) {
+        pathkeys << utils::base::pathHash(info.filePath);
+        filepaths << info.filePath;
+        widths << info.width;
+        heights << info.height;
+        orientations << info.orientation;
+        filesizes << info.fileSize;
+        mtimes << info.mtime;
+        dhashes << info.dhash;
+        colors << info.previewColor;
+    }
     QSqlQuery query(db);
-    // Remove from albums table
     query.setForwardOnly(true);
     query.exec("BEGIN IMMEDIATE TRANSACTION");
-    QString qs = "DELETE FROM AlbumTable3 WHERE PathHash=?";
-    query.prepare(qs);
-    query.addBindValue(pathHashs);
-    query.execBatch();
-    query.exec("COMMIT");
-    // Remove from image table
-    query.exec("BEGIN IMMEDIATE TRANSACTION");
-    qs = "DELETE FROM ImageTable3 WHERE PathHash=?";
-    query.prepare(qs);
-    query.addBindValue(pathHashs);
+    //只改写缺少元数据、缺少感知哈希或主色、或文件已变化的行
+    query.prepare("UPDATE ImageTable3 SET Width = ?, Height = ?, Orientation = ?, FileSize = ?, MTime = ?, "
+                  "DHash = COALESCE(NULLIF(?, 0), DHash), PreviewColor = COALESCE(NULLIF(?, 0), PreviewColor) "
+                  "WHERE PathKey = ? AND FilePath = ? AND (Width = 0 OR MTime != ? "
+                  "OR (DHash = 0 AND ? != 0) OR (PreviewColor = 0 AND ? != 0))");
+    query.addBindValue(widths);
+    query.addBindValue(heights);
+    query.addBindValue(orientations);
+    query.addBindValue(filesizes);
+    query.addBindValue(mtimes);
+    query.addBindValue(dhashes);
+    query.addBindValue(colors);
+    query.addBindValue(pathkeys);
+    query.addBindValue(filepaths);
+    query.addBindValue(mtimes);
+    query.addBindValue(dhashes);
+    query.addBindValue(colors);
     if (! query.execBatch()) {
-        query.exec("COMMIT");
-        db.close();
-    } else {
-        query.exec("COMMIT");
-        db.close();
-        mutex.unlock();
+        qDebug() << query.lastError();
+    }
+    query.exec("COMMIT");
+    db.close();
+    PhotoCatalog::instance()->updateMetas(infos);
+}
+
+void DBManager::removeImgInfos(const QStringList &paths)
+{
+    QSet<QString> pathSet;
+    pathSet.reserve(paths.size());
+    for (const QString &path : paths) {
+        pathSet.insert(path);
+    }
+    removeImgInfos(pathSet);
+}
+
+void DBManager::removeImgInfos(const QSet<QString> &paths)
+{
+    if (paths.isEmpty()) {
+        return;
+    }
+    DBImgInfoList infos;
+    if (removeImgInfosInTransaction(paths, &infos)) {
         emit dApp->signalM->imagesRemoved();
         emit dApp->signalM->imagesRemovedPar(infos);
     }
@@ -292,41 +600,82 @@ void DBManager::removeImgInfos(const QStringList &paths)
 
 void DBManager::removeImgInfosNoSignal(const QStringList &paths)
 {
-    QMutexLocker mutex(&m_mutex);
-    QSqlDatabase db = getDatabase();
-    if (paths.isEmpty() || ! db.isValid()) {
+    if (paths.isEmpty()) {
         return;
     }
+    QSet<QString> pathSet;
+    pathSet.reserve(paths.size());
+    for (const QString &path : paths) {
+        pathSet.insert(path);
+    }
+    removeImgInfosInTransaction(pathSet, nullptr);
+}
 
-    // Collect info before removing data
-    QStringList pathHashs;
-    for (QString path : paths) {
-        pathHashs << utils::base::hash(path);
+bool DBManager::removeImgInfosNoSignal(const QSet<QString> &paths, DBImgInfoList *removedInfos)
+{
+    if (paths.isEmpty()) {
+        return false;
     }
+    return removeImgInfosInTransaction(paths, removedInfos);
+}
 
+//批量删除：路径先写入临时表，再用一次联合查询收集被删除的数据，所有删除在同一个事务内完成
+bool DBManager::removeImgInfosInTransaction(const QSet<QString> &paths, DBImgInfoList *removedInfos)
+{
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
+    QSqlDatabase db = getDatabase();
+    if (paths.isEmpty() || ! db.isValid()) {
+        return false;
+    }
     QSqlQuery query(db);
-    // Remove from albums table
     query.setForwardOnly(true);
     query.exec("BEGIN IMMEDIATE TRANSACTION");
-    QString qs = "DELETE FROM AlbumTable3 WHERE PathHash=?";
-    query.prepare(qs);
-    query.addBindValue(pathHashs);
-    query.execBatch();
-    query.exec("COMMIT");
+    if (! fillPathTable(query, "RemoveTable", paths)) {
+        query.exec("ROLLBACK");
+        db.close();
+        return false;
+    }
 
-    // Remove from image table
-    query.exec("BEGIN IMMEDIATE TRANSACTION");
-    qs = "DELETE FROM ImageTable3 WHERE PathHash=?";
-    query.prepare(qs);
-    query.addBindValue(pathHashs);
-    query.execBatch();
-    query.exec("COMMIT");
+    // Collect info before removing data
+    if (removedInfos) {
+        query.prepare("SELECT i.FilePath, i.FileName, i.Dir, i.Time, i.ChangeTime, i.ImportTime, " + IMAGE_META_COLUMNS_I + " "
+                      "FROM ImageTable3 AS i INNER JOIN RemoveTable AS r ON i.PathKey = r.PathKey AND i.FilePath = r.FilePath");
+        if (query.exec()) {
+            using namespace utils::base;
+            while (query.next()) {
+                DBImgInfo info;
+                info.filePath = query.value(0).toString();
+                info.fileName = query.value(1).toString();
+                info.dirHash = query.value(2).toString();
+                info.time = stringToDateTime(query.value(3).toString());
+                info.changeTime = QDateTime::fromString(query.value(4).toString(), DATETIME_FORMAT_DATABASE);
+                info.importTime = QDateTime::fromString(query.value(5).toString(), DATETIME_FORMAT_DATABASE);
+                readImgMetas(query, 6, info);
+                *removedInfos << info;
+            }
+        }
+    }
+
+    // Remove from albums table and image table
+    const QString removeIds = IMAGE_IDS_OF_PATH_TABLE.arg("RemoveTable");
+    bool suc = query.exec(QString("DELETE FROM AlbumTable3 WHERE ImageId IN (%1)").arg(removeIds))
+               && query.exec(QString("DELETE FROM ImageTable3 WHERE ImageId IN (%1)").arg(removeIds));
+    if (!suc) {
+        qWarning() << "removeImgInfos failed: " << query.lastError();
+    }
+    query.exec("DELETE FROM RemoveTable");
+    query.exec(suc ? "COMMIT" : "ROLLBACK");
     db.close();
+    if (suc) {
+        cacheRemovePaths(paths);
+        PhotoCatalog::instance()->removePaths(paths);
+    }
+    return suc;
 }
 
 const QStringList DBManager::getAllAlbumNames(AlbumDBType atype) const
 {
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     QStringList list;
     QSqlDatabase db = getDatabase();
     if (! db.isValid()) {
@@ -349,7 +698,7 @@ const QStringList DBManager::getAllAlbumNames(AlbumDBType atype) const
 
 const QStringList DBManager::getPathsByAlbum(const QString &album, AlbumDBType atype) const
 {
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     QStringList list;
     QSqlDatabase db = getDatabase();
     if (! db.isValid()) {
@@ -359,7 +708,7 @@ const QStringList DBManager::getPathsByAlbum(const QString &album, AlbumDBType a
     query.setForwardOnly(true);
     query.prepare("SELECT DISTINCT i.FilePath "
                   "FROM ImageTable3 AS i, AlbumTable3 AS a "
-                  "WHERE i.PathHash=a.PathHash "
+                  "WHERE i.ImageId=a.ImageId "
                   "AND a.AlbumName=:album "
                   "AND a.AlbumDBType=:atype "
                   /*"AND FilePath != \" \" "*/);
@@ -378,7 +727,7 @@ const QStringList DBManager::getPathsByAlbum(const QString &album, AlbumDBType a
 
 const DBImgInfoList DBManager::getInfosByAlbum(const QString &album, AlbumDBType atype) const
 {
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     DBImgInfoList infos;
     QSqlDatabase db = getDatabase();
     if (! db.isValid()) {
@@ -386,9 +735,9 @@ const DBImgInfoList DBManager::getInfosByAlbum(const QString &album, AlbumDBType
     }
     QSqlQuery query(db);
     query.setForwardOnly(true);
-    query.prepare("SELECT DISTINCT i.FilePath, i.FileName, i.Dir, i.Time, i.ChangeTime, i.ImportTime "
+    query.prepare("SELECT DISTINCT i.FilePath, i.FileName, i.Dir, i.Time, i.ChangeTime, i.ImportTime, " + IMAGE_META_COLUMNS_I + " "
                   "FROM ImageTable3 AS i, AlbumTable3 AS a "
-                  "WHERE i.PathHash=a.PathHash "
+                  "WHERE i.ImageId=a.ImageId "
                   "AND a.AlbumName=:album "
                   "AND a.AlbumDBType=:atype ");
     query.bindValue(":album", album);
@@ -405,6 +754,7 @@ const DBImgInfoList DBManager::getInfosByAlbum(const QString &album, AlbumDBType
             info.time = stringToDateTime(query.value(3).toString());
             info.changeTime = QDateTime::fromString(query.value(4).toString(), DATETIME_FORMAT_DATABASE);
             info.importTime = QDateTime::fromString(query.value(5).toString(), DATETIME_FORMAT_DATABASE);
+            readImgMetas(query, 6, info);
             infos << info;
         }
     }
@@ -414,166 +764,77 @@ const DBImgInfoList DBManager::getInfosByAlbum(const QString &album, AlbumDBType
 
 int DBManager::getImgsCountByAlbum(const QString &album, AlbumDBType atype) const
 {
-    QMutexLocker mutex(&m_mutex);
-    QSqlDatabase db = getDatabase();
-    if (! db.isValid()) {
-        return 0;
-    }
-    QSqlQuery query(db);
-    query.setForwardOnly(true);
-    QString ps = "SELECT COUNT(*) FROM AlbumTable3 "
-                 "WHERE AlbumName =:album "
-                 "AND PathHash != \"%1\" "
-                 "AND AlbumDBType =:atype ";
-    query.prepare(ps.arg(EMPTY_HASH_STR));
-    query.bindValue(":album", album);
-    query.bindValue(":atype", atype);
-    if (query.exec()) {
-        query.first();
-        db.close();
-        return query.value(0).toInt();
-    } else {
-        db.close();
-        return 0;
-    }
+    loadAlbumCache();
+    QReadLocker locker(&m_albumCacheLock);
+    return m_albumPathsCache[atype].value(album).size();
 }
 
 bool DBManager::isImgExistInAlbum(const QString &album, const QString &path, AlbumDBType atype) const
 {
-    QMutexLocker mutex(&m_mutex);
-    QSqlDatabase db = getDatabase();
-    if (! db.isValid()) {
-        return false;
+    loadAlbumCache();
+    QReadLocker locker(&m_albumCacheLock);
+    auto it = m_albumPathsCache[atype].constFind(album);
+    return it != m_albumPathsCache[atype].constEnd() && it->contains(path);
+}
+
+QVector<bool> DBManager::isImgsExistInAlbum(const QString &album, const QStringList &paths, AlbumDBType atype) const
+{
+    loadAlbumCache();
+    QReadLocker locker(&m_albumCacheLock);
+    QVector<bool> result(paths.size(), false);
+    auto it = m_albumPathsCache[atype].constFind(album);
+    if (it == m_albumPathsCache[atype].constEnd()) {
+        return result;
     }
-    QSqlQuery query(db);
-    query.setForwardOnly(true);
-    query.prepare("SELECT COUNT(*) FROM AlbumTable3 WHERE PathHash = :hash "
-                  "AND AlbumName = :album "
-                  "AND AlbumDBType =:atype ");
-    query.bindValue(":hash", utils::base::hash(path));
-    query.bindValue(":album", album);
-    query.bindValue(":atype", atype);
-    if (query.exec()) {
-        query.first();
-        db.close();
-        return (query.value(0).toInt() == 1);
-    } else {
-        db.close();
-        return false;
+    for (int i = 0; i < paths.size(); i++) {
+        result[i] = it->contains(paths.at(i));
     }
+    return result;
 }
 
 bool DBManager::isAlbumExistInDB(const QString &album, AlbumDBType atype) const
 {
-    QMutexLocker mutex(&m_mutex);
-    QSqlDatabase db = getDatabase();
-    if (! db.isValid()) {
-        return false;
-    }
-    QSqlQuery query(db);
-    query.setForwardOnly(true);
-    query.prepare("SELECT COUNT(*) FROM AlbumTable3 WHERE AlbumName = :album AND AlbumDBType =:atype");
-    query.bindValue(":album", album);
-    query.bindValue(":atype", atype);
-    if (query.exec()) {
-        query.first();
-        // 连接使用完后需要释放回数据库连接池
-        db.close();
-        return (query.value(0).toInt() >= 1);
-    } else {
-        // 连接使用完后需要释放回数据库连接池
-        db.close();
-        return false;
-    }
+    //相册缓存包含只有占位行的空相册，不必查询数据库
+    loadAlbumCache();
+    QReadLocker locker(&m_albumCacheLock);
+    return m_albumPathsCache[atype].contains(album);
 }
 
 void DBManager::insertIntoAlbum(const QString &album, const QStringList &paths, AlbumDBType atype)
 {
-    QMutexLocker mutex(&m_mutex);
-    QSqlDatabase db = getDatabase();
-    if (!db.isValid() || album.isEmpty()) {
-        return;
-    }
-    QStringList nameRows, pathHashRows;
-    QVariantList atypes;
-    for (QString path : paths) {
-        nameRows << album;
-        pathHashRows << utils::base::hash(path);
-        atypes << atype;
-    }
-    QSqlQuery query(db);
-    query.setForwardOnly(true);
-    query.exec("BEGIN IMMEDIATE TRANSACTION");
-    query.prepare("REPLACE INTO AlbumTable3 (AlbumId, AlbumName, PathHash, AlbumDBType) VALUES (null, ?, ?, ?)");
-    query.addBindValue(nameRows);
-    query.addBindValue(pathHashRows);
-    query.addBindValue(atypes);
-
-    if (! query.execBatch()) {
-    }
-    query.exec("COMMIT");
-
-    //FIXME: Don't insert the repeated filepath into the same album
-    //Delete the same data
-    QString ps = "DELETE FROM AlbumTable3 where AlbumId NOT IN"
-                 "(SELECT min(AlbumId) FROM AlbumTable3 GROUP BY"
-                 " AlbumName, PathHash, AlbumDBType) AND PathHash != \"%1\""
-                 " AND AlbumDBType =:atype ";
-    query.prepare(ps.arg(EMPTY_HASH_STR));
-    query.bindValue(":atype", atype);
-    if (!query.exec()) {
-        //   qDebug() << "delete same date failed!";
-    }
-    query.exec("COMMIT");
-    db.close();
-    mutex.unlock();
+    QStringList inserted;
+    insertIntoAlbumInTransaction(album, paths, atype, inserted);
 }
 
 void DBManager::insertIntoAlbumNoSignal(const QString &album, const QStringList &paths, AlbumDBType atype)
 {
-    QMutexLocker mutex(&m_mutex);
+    QStringList inserted;
+    insertIntoAlbumInTransaction(album, paths, atype, inserted);
+}
+
+bool DBManager::insertIntoAlbumInTransaction(const QString &album, const QStringList &paths, AlbumDBType atype, QStringList &inserted)
+{
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     QSqlDatabase db = getDatabase();
     if (! db.isValid() || album.isEmpty()) {
-        return;
-    }
-    QStringList nameRows, pathHashRows;
-    QVariantList atypes;
-    for (QString path : paths) {
-        nameRows << album;
-        pathHashRows << utils::base::hash(path);
-        atypes << atype;
+        return false;
     }
-
     QSqlQuery query(db);
     query.setForwardOnly(true);
     query.exec("BEGIN IMMEDIATE TRANSACTION");
-    query.prepare("REPLACE INTO AlbumTable3 (AlbumId, AlbumName, PathHash, AlbumDBType) "
-                  "VALUES (null, ?, ?, ?)");
-    query.addBindValue(nameRows);
-    query.addBindValue(pathHashRows);
-    query.addBindValue(atypes);
-    if (! query.execBatch()) {
-    }
-    query.exec("COMMIT");
-
-    //FIXME: Don't insert the repeated filepath into the same album
-    //Delete the same data
-    QString ps = "DELETE FROM AlbumTable3 where AlbumId NOT IN "
-                 "(SELECT min(AlbumId) FROM AlbumTable3 GROUP BY "
-                 " AlbumName, PathHash) AND PathHash != \"%1\" "
-                 " AND AlbumDBType =:atype ";
-    query.prepare(ps.arg(EMPTY_HASH_STR));
-    query.bindValue(":atype", atype);
-    if (!query.exec()) {
-    }
-    query.exec("COMMIT");
+    bool suc = insertAlbumRows(query, album, paths, atype, inserted);
+    query.exec(suc ? "COMMIT" : "ROLLBACK");
     db.close();
+    //只缓存实际写入的路径，库中没有的图片不会出现在相册缓存里
+    if (suc)
+        cacheInsertIntoAlbum(album, inserted, atype);
+    return suc;
 }
 
 
 void DBManager::removeAlbum(const QString &album, AlbumDBType atype)
 {
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     QSqlDatabase db = getDatabase();
     if (! db.isValid()) {
         return;
@@ -583,48 +844,95 @@ void DBManager::removeAlbum(const QString &album, AlbumDBType atype)
     query.prepare("DELETE FROM AlbumTable3 WHERE AlbumName=:album AND AlbumDBType =:atype");
     query.bindValue(":album", album);
     query.bindValue(":atype", atype);
-    if (!query.exec()) {
+    if (query.exec()) {
+        cacheRemoveAlbum(album, atype);
     }
     db.close();
 }
 
 void DBManager::removeFromAlbum(const QString &album, const QStringList &paths, AlbumDBType atype)
 {
-    QMutexLocker mutex(&m_mutex);
-    QSqlDatabase db = getDatabase();
-    if (! db.isValid()) {
+    if (removeFromAlbumInTransaction(album, paths, atype)) {
+        emit dApp->signalM->removedFromAlbum(album, paths);
+    }
+}
+
+void DBManager::insertIntoAlbumAsync(const QString &album, const QStringList &paths, AlbumDBType atype)
+{
+    if (album.isEmpty()) {
         return;
     }
+    //先更新相册缓存，GUI线程随后的查询立即可见；写库在数据库线程上按提交顺序执行
+    bool albumAdded = false;
+    const QStringList added = cacheInsertIntoAlbum(album, paths, atype, &albumAdded);
+    std::function<void()> write = [this, album, paths, atype, added, albumAdded]() {
+        QStringList inserted;
+        if (!insertIntoAlbumInTransaction(album, paths, atype, inserted)) {
+            inserted.clear();
+        }
+        //写库失败或图片不在库中：撤销先前加入缓存的项
+        if (albumAdded && inserted.isEmpty()) {
+            cacheRemoveAlbum(album, atype);
+            return;
+        }
+        const QSet<QString> written = inserted.toSet();
+        QStringList rollback;
+        for (const QString &path : added) {
+            if (!written.contains(path)) {
+                rollback << path;
+            }
+        }
+        if (!rollback.isEmpty()) {
+            cacheRemoveFromAlbum(album, rollback, atype);
+        }
+    };
+    DBAsyncManager::instance()->future(write);
+}
 
-    QStringList pathHashs;
-    QVariantList atypes;
-    for (QString path : paths) {
-        pathHashs << utils::base::hash(path);
-        atypes << atype;
+void DBManager::removeFromAlbumAsync(const QString &album, const QStringList &paths, AlbumDBType atype)
+{
+    cacheRemoveFromAlbum(album, paths, atype);
+    std::function<bool()> write = [album, paths, atype]() {
+        return DBManager::instance()->removeFromAlbumInTransaction(album, paths, atype);
+    };
+    std::function<void(const bool &)> callback = [album, paths](const bool &suc) {
+        if (suc) {
+            emit dApp->signalM->removedFromAlbum(album, paths);
+        }
+    };
+    DBAsyncManager::instance()->query(this, write, callback);
+}
+
+bool DBManager::removeFromAlbumInTransaction(const QString &album, const QStringList &paths, AlbumDBType atype)
+{
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
+    QSqlDatabase db = getDatabase();
+    if (! db.isValid()) {
+        return false;
     }
+
     QSqlQuery query(db);
     query.setForwardOnly(true);
     query.exec("BEGIN IMMEDIATE TRANSACTION");
     // Remove from albums table
-    QString qs("DELETE FROM AlbumTable3 WHERE AlbumName=\"%1\" AND PathHash=? AND AlbumDBType=? ");
-    query.prepare(qs.arg(album));
-    query.addBindValue(pathHashs);
-    query.addBindValue(atypes);
     bool suc = false;
-    if (! query.execBatch()) {
-    } else {
-        suc = true;
-    }
-    query.exec("COMMIT");
+    if (fillPathTable(query, "AlbumPathTable", paths)) {
+        query.prepare(QString("DELETE FROM AlbumTable3 WHERE AlbumName = ? AND AlbumDBType = ? AND ImageId IN (%1)")
+                      .arg(IMAGE_IDS_OF_PATH_TABLE.arg("AlbumPathTable")));
+        query.addBindValue(album);
+        query.addBindValue(atype);
+        suc = query.exec();
+    }
+    query.exec(suc ? "COMMIT" : "ROLLBACK");
     db.close();
-    mutex.unlock();
     if (suc)
-        emit dApp->signalM->removedFromAlbum(album, paths);
+        cacheRemoveFromAlbum(album, paths, atype);
+    return suc;
 }
 
 void DBManager::renameAlbum(const QString &oldAlbum, const QString &newAlbum, AlbumDBType atype)
 {
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     QSqlDatabase db = getDatabase();
     if (! db.isValid()) {
         return;
@@ -639,14 +947,15 @@ void DBManager::renameAlbum(const QString &oldAlbum, const QString &newAlbum, Al
     query.bindValue(":newName", newAlbum);
     query.bindValue(":oldName", oldAlbum);
     query.bindValue(":atype",  atype);
-    if (! query.exec()) {
+    if (query.exec()) {
+        cacheRenameAlbum(oldAlbum, newAlbum, atype);
     }
     db.close();
 }
 
-const DBImgInfoList DBManager::getInfosByNameTimeline(const QString &value) const
+const DBImgInfoList DBManager::getInfosByNameTimeline(const QString &value, int limit) const
 {
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     DBImgInfoList infos;
     QSqlDatabase db = getDatabase();
     if (! db.isValid()) {
@@ -655,10 +964,16 @@ const DBImgInfoList DBManager::getInfosByNameTimeline(const QString &value) cons
     QSqlQuery query(db);
     query.setForwardOnly(true);
 
-    QString queryStr = "SELECT FilePath, FileName, Dir, Time, ChangeTime, ImportTime FROM ImageTable3 "
-                       "WHERE FileName like '%" + value + "%' OR Time like '%" + value + "%' ORDER BY Time DESC";
+    QString queryStr = "SELECT FilePath, FileName, Dir, Time, ChangeTime, ImportTime, " + IMAGE_META_COLUMNS + " FROM ImageTable3 "
+                       "WHERE FileName LIKE '%' || :kw || '%' ESCAPE '\\' OR Time LIKE '%' || :kwTime || '%' ESCAPE '\\' "
+                       "ORDER BY Time DESC";
+    if (limit > 0) {
+        queryStr += QString(" LIMIT %1").arg(limit);
+    }
 
     query.prepare(queryStr);
+    query.bindValue(":kw", escapeLikeKeyword(value));
+    query.bindValue(":kwTime", escapeLikeKeyword(value));
 
     if (!query.exec()) {
     } else {
@@ -671,6 +986,7 @@ const DBImgInfoList DBManager::getInfosByNameTimeline(const QString &value) cons
             info.time = stringToDateTime(query.value(3).toString());
             info.changeTime = QDateTime::fromString(query.value(4).toString(), DATETIME_FORMAT_DATABASE);
             info.importTime = QDateTime::fromString(query.value(5).toString(), DATETIME_FORMAT_DATABASE);
+            readImgMetas(query, 6, info);
             infos << info;
         }
     }
@@ -678,9 +994,9 @@ const DBImgInfoList DBManager::getInfosByNameTimeline(const QString &value) cons
     return infos;
 }
 
-const DBImgInfoList DBManager::getInfosForKeyword(const QString &keywords) const
+const DBImgInfoList DBManager::getInfosForKeyword(const QString &keywords, int limit) const
 {
-    const DBImgInfoList list = getInfosByNameTimeline(keywords);
+    const DBImgInfoList list = getInfosByNameTimeline(keywords, limit);
     if (list.count() < 1) {
         return DBImgInfoList();
     } else {
@@ -688,9 +1004,9 @@ const DBImgInfoList DBManager::getInfosForKeyword(const QString &keywords) const
     }
 }
 
-const DBImgInfoList DBManager::getTrashInfosForKeyword(const QString &keywords) const
+const DBImgInfoList DBManager::getTrashInfosForKeyword(const QString &keywords, int limit) const
 {
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     DBImgInfoList infos;
     QSqlDatabase db = getDatabase();
     if (! db.isValid()) {
@@ -699,10 +1015,16 @@ const DBImgInfoList DBManager::getTrashInfosForKeyword(const QString &keywords)
     QSqlQuery query(db);
     query.setForwardOnly(true);
 
-    QString queryStr = "SELECT FilePath, FileName, Dir, Time, ChangeTime, ImportTime AlbumName FROM TrashTable3 "
-                       "WHERE FileName like '%" + keywords + "%' OR Time like '%" + keywords + "%' ORDER BY Time DESC";
+    QString queryStr = "SELECT FilePath, FileName, Dir, Time, ChangeTime, ImportTime FROM TrashTable3 "
+                       "WHERE FileName LIKE '%' || :kw || '%' ESCAPE '\\' OR Time LIKE '%' || :kwTime || '%' ESCAPE '\\' "
+                       "ORDER BY Time DESC";
+    if (limit > 0) {
+        queryStr += QString(" LIMIT %1").arg(limit);
+    }
 
     query.prepare(queryStr);
+    query.bindValue(":kw", escapeLikeKeyword(keywords));
+    query.bindValue(":kwTime", escapeLikeKeyword(keywords));
 
     if (!query.exec()) {
     } else {
@@ -722,9 +1044,9 @@ const DBImgInfoList DBManager::getTrashInfosForKeyword(const QString &keywords)
     return infos;
 }
 
-const DBImgInfoList DBManager::getInfosForKeyword(const QString &album, const QString &keywords) const
+const DBImgInfoList DBManager::getInfosForKeyword(const QString &album, const QString &keywords, int limit) const
 {
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
 
     DBImgInfoList infos;
     QSqlDatabase db = getDatabase();
@@ -732,15 +1054,21 @@ const DBImgInfoList DBManager::getInfosForKeyword(const QString &album, const QS
         return infos;
     }
 
-    QString queryStr = "SELECT DISTINCT i.FilePath, i.FileName, i.Dir, i.Time, i.ChangeTime, i.ImportTime "
+    QString queryStr = "SELECT DISTINCT i.FilePath, i.FileName, i.Dir, i.Time, i.ChangeTime, i.ImportTime, " + IMAGE_META_COLUMNS_I + " "
                        "FROM ImageTable3 AS i "
-                       "inner join AlbumTable3 AS a on i.PathHash=a.PathHash AND a.AlbumName=:album "
-                       "WHERE i.FileName like %" + keywords + "%' OR Time like %" + keywords + "%' ORDER BY Time DESC";
+                       "inner join AlbumTable3 AS a on i.ImageId=a.ImageId AND a.AlbumName=:album "
+                       "WHERE i.FileName LIKE '%' || :kw || '%' ESCAPE '\\' OR i.Time LIKE '%' || :kwTime || '%' ESCAPE '\\' "
+                       "ORDER BY i.Time DESC";
+    if (limit > 0) {
+        queryStr += QString(" LIMIT %1").arg(limit);
+    }
 
     QSqlQuery query(db);
     query.setForwardOnly(true);
     query.prepare(queryStr);
     query.bindValue(":album", album);
+    query.bindValue(":kw", escapeLikeKeyword(keywords));
+    query.bindValue(":kwTime", escapeLikeKeyword(keywords));
 
 
     if (! query.exec()) {
@@ -754,6 +1082,7 @@ const DBImgInfoList DBManager::getInfosForKeyword(const QString &album, const QS
             info.time = stringToDateTime(query.value(3).toString());
             info.changeTime = QDateTime::fromString(query.value(4).toString(), DATETIME_FORMAT_DATABASE);
             info.importTime = QDateTime::fromString(query.value(5).toString(), DATETIME_FORMAT_DATABASE);
+            readImgMetas(query, 6, info);
             infos << info;
         }
     }
@@ -763,39 +1092,191 @@ const DBImgInfoList DBManager::getInfosForKeyword(const QString &album, const QS
 
 const QMultiMap<QString, QString> DBManager::getAllPathAlbumNames() const
 {
-    QMutexLocker mutex(&m_mutex);
-
+    loadAlbumCache();
     QMultiMap<QString, QString> infos;
-    infos.clear();
-    QSqlDatabase db = getDatabase();
-    if (! db.isValid()) {
-        return infos;
+    QReadLocker locker(&m_albumCacheLock);
+    for (auto it = m_pathAlbumsCache.constBegin(); it != m_pathAlbumsCache.constEnd(); ++it) {
+        for (const QString &album : it.value()) {
+            infos.insert(it.key(), album);
+        }
     }
+    return infos;
+}
 
-    QString queryStr = "SELECT DISTINCT i.FilePath, a.AlbumName "
-                       "FROM ImageTable3 AS i, AlbumTable3 AS a "
-                       "inner join AlbumTable3 on i.PathHash=a.PathHash "
-                       "where a.AlbumDBType = 1";
+const QStringList DBManager::getAlbumNamesByPath(const QString &path) const
+{
+    loadAlbumCache();
+    QReadLocker locker(&m_albumCacheLock);
+    return m_pathAlbumsCache.value(path).toList();
+}
 
+void DBManager::loadAlbumCache() const
+{
+    {
+        QReadLocker locker(&m_albumCacheLock);
+        if (m_albumCacheLoaded) {
+            return;
+        }
+    }
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
+    QSqlDatabase db = getDatabase();
+    if (! db.isValid()) {
+        return;
+    }
     QSqlQuery query(db);
     query.setForwardOnly(true);
-    query.prepare(queryStr);
+    //LEFT JOIN保留空相册的占位行，相册名同样进入缓存
+    query.prepare("SELECT i.FilePath, a.AlbumName, a.AlbumDBType "
+                  "FROM AlbumTable3 AS a "
+                  "LEFT JOIN ImageTable3 AS i ON i.ImageId = a.ImageId");
     if (! query.exec()) {
-        qWarning() << "getAllPathAlbumNames failed: " << query.lastError();
-    } else {
-        using namespace utils::base;
-        while (query.next()) {
-            infos.insert(query.value(0).toString(), query.value(1).toString());
+        qWarning() << "loadAlbumCache failed: " << query.lastError();
+        db.close();
+        return;
+    }
+    QWriteLocker locker(&m_albumCacheLock);
+    if (m_albumCacheLoaded) {
+        db.close();
+        return;
+    }
+    while (query.next()) {
+        const QString path = query.value(0).toString();
+        const QString album = query.value(1).toString();
+        const int atype = query.value(2).toInt();
+        if (atype < AlbumDBType::Favourite || atype > AlbumDBType::Custom) {
+            continue;
+        }
+        QSet<QString> &albumPaths = m_albumPathsCache[atype][album];
+        if (query.value(0).isNull()) {
+            continue;
+        }
+        albumPaths.insert(path);
+        if (AlbumDBType::Custom == atype) {
+            m_pathAlbumsCache[path].insert(album);
         }
     }
+    m_albumCacheLoaded = true;
     db.close();
-    return infos;
+}
+
+QStringList DBManager::cacheInsertIntoAlbum(const QString &album, const QStringList &paths, AlbumDBType atype, bool *albumAdded)
+{
+    QStringList added;
+    QWriteLocker locker(&m_albumCacheLock);
+    if (!m_albumCacheLoaded) {
+        return added;
+    }
+    if (albumAdded) {
+        *albumAdded = !m_albumPathsCache[atype].contains(album);
+    }
+    QSet<QString> &albumPaths = m_albumPathsCache[atype][album];
+    for (const QString &path : paths) {
+        //" "为创建空相册时的占位路径，不计入相册
+        if (path == " " || albumPaths.contains(path)) {
+            continue;
+        }
+        albumPaths.insert(path);
+        added << path;
+        if (AlbumDBType::Custom == atype) {
+            m_pathAlbumsCache[path].insert(album);
+        }
+    }
+    return added;
+}
+
+void DBManager::cacheRemoveFromAlbum(const QString &album, const QStringList &paths, AlbumDBType atype)
+{
+    QWriteLocker locker(&m_albumCacheLock);
+    if (!m_albumCacheLoaded) {
+        return;
+    }
+    auto albumIt = m_albumPathsCache[atype].find(album);
+    for (const QString &path : paths) {
+        if (albumIt != m_albumPathsCache[atype].end()) {
+            albumIt->remove(path);
+        }
+        if (AlbumDBType::Custom == atype) {
+            auto pathIt = m_pathAlbumsCache.find(path);
+            if (pathIt != m_pathAlbumsCache.end()) {
+                pathIt->remove(album);
+                if (pathIt->isEmpty()) {
+                    m_pathAlbumsCache.erase(pathIt);
+                }
+            }
+        }
+    }
+}
+
+void DBManager::cacheRemoveAlbum(const QString &album, AlbumDBType atype)
+{
+    QWriteLocker locker(&m_albumCacheLock);
+    if (!m_albumCacheLoaded) {
+        return;
+    }
+    const QSet<QString> albumPaths = m_albumPathsCache[atype].take(album);
+    if (AlbumDBType::Custom == atype) {
+        for (const QString &path : albumPaths) {
+            auto pathIt = m_pathAlbumsCache.find(path);
+            if (pathIt != m_pathAlbumsCache.end()) {
+                pathIt->remove(album);
+                if (pathIt->isEmpty()) {
+                    m_pathAlbumsCache.erase(pathIt);
+                }
+            }
+        }
+    }
+}
+
+void DBManager::cacheRenameAlbum(const QString &oldAlbum, const QString &newAlbum, AlbumDBType atype)
+{
+    QWriteLocker locker(&m_albumCacheLock);
+    if (!m_albumCacheLoaded || oldAlbum == newAlbum) {
+        return;
+    }
+    const QSet<QString> albumPaths = m_albumPathsCache[atype].take(oldAlbum);
+    m_albumPathsCache[atype][newAlbum].unite(albumPaths);
+    if (AlbumDBType::Custom == atype) {
+        for (const QString &path : albumPaths) {
+            QSet<QString> &albums = m_pathAlbumsCache[path];
+            albums.remove(oldAlbum);
+            albums.insert(newAlbum);
+        }
+    }
+}
+
+void DBManager::cacheRemovePaths(const QSet<QString> &paths)
+{
+    QWriteLocker locker(&m_albumCacheLock);
+    if (!m_albumCacheLoaded) {
+        return;
+    }
+    for (const QString &path : paths) {
+        m_pathAlbumsCache.remove(path);
+    }
+    for (auto &albums : m_albumPathsCache) {
+        for (auto it = albums.begin(); it != albums.end(); ++it) {
+            if (it->isEmpty()) {
+                continue;
+            }
+            //取较小的一方遍历
+            if (paths.size() <= it->size()) {
+                it->subtract(paths);
+            } else {
+                QMutableSetIterator<QString> pathIt(*it);
+                while (pathIt.hasNext()) {
+                    if (paths.contains(pathIt.next())) {
+                        pathIt.remove();
+                    }
+                }
+            }
+        }
+    }
 }
 
 const DBImgInfoList DBManager::getImgInfos(const QString &key, const QString &value, const bool &needlock) const
 {
     Q_UNUSED(needlock)
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     DBImgInfoList infos;
     QSqlDatabase db = getDatabase();
     if (! db.isValid()) {
@@ -803,7 +1284,7 @@ const DBImgInfoList DBManager::getImgInfos(const QString &key, const QString &va
     }
     QSqlQuery query(db);
     query.setForwardOnly(true);
-    query.prepare(QString("SELECT FilePath, FileName, Dir, Time, ChangeTime, ImportTime FROM ImageTable3 "
+    query.prepare(QString("SELECT FilePath, FileName, Dir, Time, ChangeTime, ImportTime, " + IMAGE_META_COLUMNS + " FROM ImageTable3 "
                           "WHERE %1= :value ORDER BY Time DESC").arg(key));
 
     query.bindValue(":value", value);
@@ -819,6 +1300,7 @@ const DBImgInfoList DBManager::getImgInfos(const QString &key, const QString &va
             info.time = stringToDateTime(query.value(3).toString());
             info.changeTime = QDateTime::fromString(query.value(4).toString(), DATETIME_FORMAT_DATABASE);
             info.importTime = QDateTime::fromString(query.value(5).toString(), DATETIME_FORMAT_DATABASE);
+            readImgMetas(query, 6, info);
             infos << info;
         }
     }
@@ -826,6 +1308,41 @@ const DBImgInfoList DBManager::getImgInfos(const QString &key, const QString &va
     return infos;
 }
 
+//key为Time或ImportTime；按key倒序扫描一遍，相同key的连续行归为一组
+const DBTimelineSections DBManager::getInfosGroupedBy(const QString &key) const
+{
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
+    DBTimelineSections sections;
+    QSqlDatabase db = getDatabase();
+    if (! db.isValid()) {
+        return sections;
+    }
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare(QString("SELECT %1, FilePath, FileName, Dir, Time, ChangeTime, ImportTime, " + IMAGE_META_COLUMNS + " "
+                          "FROM ImageTable3 ORDER BY %1 DESC, Time DESC").arg(key));
+    if (query.exec()) {
+        using namespace utils::base;
+        while (query.next()) {
+            DBImgInfo info;
+            info.filePath = query.value(1).toString();
+            info.fileName = query.value(2).toString();
+            info.dirHash = query.value(3).toString();
+            info.time = stringToDateTime(query.value(4).toString());
+            info.changeTime = QDateTime::fromString(query.value(5).toString(), DATETIME_FORMAT_DATABASE);
+            info.importTime = QDateTime::fromString(query.value(6).toString(), DATETIME_FORMAT_DATABASE);
+            readImgMetas(query, 7, info);
+            const QString timeline = query.value(0).toString();
+            if (sections.isEmpty() || sections.last().first != timeline) {
+                sections << qMakePair(timeline, DBImgInfoList());
+            }
+            sections.last().second << info;
+        }
+    }
+    db.close();
+    return sections;
+}
+
 const QSqlDatabase DBManager::getDatabase() const
 {
     if (!m_db.open()) {
@@ -840,6 +1357,55 @@ const QSqlDatabase DBManager::getDatabase() const
     return m_db;
 }
 
+//旧表改名后按新结构重建，数据整体复制，相册行改为引用ImageId，全部在一个事务内完成
+bool DBManager::migrateToImageIds(QSqlDatabase &db)
+{
+    QSqlQuery query(db);
+    query.exec("BEGIN IMMEDIATE TRANSACTION");
+    bool suc = query.exec("ALTER TABLE ImageTable3 RENAME TO ImageTableOld")
+               && query.exec("ALTER TABLE AlbumTable3 RENAME TO AlbumTableOld");
+    if (suc) {
+        createImageTables(query);
+        suc = query.exec("INSERT INTO ImageTable3 (PathKey, FilePath, FileName, Dir, Time, ChangeTime, ImportTime, "
+                         "Width, Height, Orientation, FileSize, MTime, Fingerprint, DHash, PreviewColor) "
+                         "SELECT 0, FilePath, FileName, Dir, Time, ChangeTime, ImportTime, "
+                         "Width, Height, Orientation, FileSize, MTime, Fingerprint, DHash, PreviewColor FROM ImageTableOld");
+    }
+    if (suc) {
+        QVariantList ids, keys;
+        suc = query.exec("SELECT ImageId, FilePath FROM ImageTable3");
+        while (suc && query.next()) {
+            ids << query.value(0);
+            keys << utils::base::pathHash(query.value(1).toString());
+        }
+        query.prepare("UPDATE ImageTable3 SET PathKey = ? WHERE ImageId = ?");
+        query.addBindValue(keys);
+        query.addBindValue(ids);
+        suc = suc && (ids.isEmpty() || query.execBatch());
+    }
+    if (suc) {
+        //相册名各保留一行占位，图片已失效的相册迁移后仍然存在
+        query.prepare("INSERT INTO AlbumTable3 (AlbumName, ImageId, AlbumDBType) "
+                      "SELECT DISTINCT AlbumName, ?, AlbumDBType FROM AlbumTableOld");
+        query.addBindValue(EMPTY_IMAGE_ID);
+        suc = query.exec();
+    }
+    if (suc) {
+        suc = query.exec(QString("INSERT INTO AlbumTable3 (AlbumName, ImageId, AlbumDBType) "
+                                 "SELECT DISTINCT a.AlbumName, i.ImageId, a.AlbumDBType FROM AlbumTableOld AS a "
+                                 "INNER JOIN ImageTableOld AS o ON o.PathHash = a.PathHash "
+                                 "INNER JOIN ImageTable3 AS i ON i.FilePath = o.FilePath "
+                                 "WHERE a.PathHash != \"%1\"").arg(EMPTY_HASH_STR))
+              && query.exec("DROP TABLE ImageTableOld")
+              && query.exec("DROP TABLE AlbumTableOld");
+    }
+    if (!suc) {
+        qWarning() << "migrateToImageIds failed: " << query.lastError();
+    }
+    query.exec(suc ? "COMMIT" : "ROLLBACK");
+    return suc;
+}
+
 void DBManager::checkDatabase()
 {
     QDir dd(DATABASE_PATH);
@@ -847,7 +1413,7 @@ void DBManager::checkDatabase()
         dd.mkpath(DATABASE_PATH);
     } else {
     }
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     QSqlDatabase db = getDatabase();
     if (! db.isValid()) {
         return;
@@ -863,30 +1429,7 @@ void DBManager::checkDatabase()
     //if tables not exist, create it.
     if (!tableExist) {
         QSqlQuery queryCreate(db);
-        // ImageTable3
-        //////////////////////////////////////////////////////////////
-        //PathHash           | FilePath | FileName   | Dir  | Time | ChangeTime | ImportTime//
-        //TEXT primari key   | TEXT     | TEXT       | TEXT | TEXT | TEXT       | TEXT      //
-        //////////////////////////////////////////////////////////////
-        queryCreate.exec(QString("CREATE TABLE IF NOT EXISTS ImageTable3 ( "
-                                 "PathHash TEXT primary key, "
-                                 "FilePath TEXT, "
-                                 "FileName TEXT, "
-                                 "Dir TEXT, "
-                                 "Time TEXT, "
-                                 "ChangeTime TEXT, "
-                                 "ImportTime TEXT)"));
-
-        // AlbumTable3
-        ///////////////////////////////////////////////////////////////////////////
-        //AlbumId               | AlbumName         | PathHash      |AlbumDBType //
-        //INTEGER primari key   | TEXT              | TEXT          |TEXT        //
-        ///////////////////////////////////////////////////////////////////////////
-        queryCreate.exec(QString("CREATE TABLE IF NOT EXISTS AlbumTable3 ( "
-                                 "AlbumId INTEGER primary key, "
-                                 "AlbumName TEXT, "
-                                 "PathHash TEXT,"
-                                 "AlbumDBType INTEGER)"));
+        createImageTables(queryCreate);
 
         // TrashTable
         //////////////////////////////////////////////////////////////
@@ -904,6 +1447,35 @@ void DBManager::checkDatabase()
 //        // Check if there is an old version table exist or not
 //        //TODO: AlbumTable's primary key is changed, need to importVersion again
     } else {
+        // 旧版ImageTable3没有图片元数据、内容指纹、感知哈希和主色字段，补齐后由缩略图加载时回填
+        QStringList columns;
+        QSqlQuery queryColumns(db);
+        if (queryColumns.exec("PRAGMA table_info(ImageTable3)")) {
+            while (queryColumns.next()) {
+                columns << queryColumns.value(1).toString();
+            }
+        }
+        for (const QString &column : IMAGE_META_COLUMNS.split(", ")) {
+            if (!columns.contains(column)
+                    && !queryColumns.exec(QString("ALTER TABLE ImageTable3 ADD COLUMN %1 INTEGER default 0").arg(column))) {
+                qDebug() << queryColumns.lastError();
+            }
+        }
+        // 旧版以MD5字符串PathHash为主键，迁移为整数ImageId
+        if (columns.contains("PathHash") && !migrateToImageIds(db)) {
+            //迁移已回滚，旧表改名保留以便下次升级时人工恢复，另建新表保证程序可用，图片由目录监控重新导入
+            const QString suffix = QString::number(QDateTime::currentSecsSinceEpoch());
+            QSqlQuery queryBackup(db);
+            queryBackup.exec("BEGIN IMMEDIATE TRANSACTION");
+            bool suc = queryBackup.exec(QString("ALTER TABLE ImageTable3 RENAME TO ImageTable3_old_%1").arg(suffix))
+                       && queryBackup.exec(QString("ALTER TABLE AlbumTable3 RENAME TO AlbumTable3_old_%1").arg(suffix));
+            if (suc) {
+                createImageTables(queryBackup);
+            } else {
+                qCritical() << "backup of unmigrated tables failed: " << queryBackup.lastError();
+            }
+            queryBackup.exec(suc ? "COMMIT" : "ROLLBACK");
+        }
         // 判断ImageTable3中是否有ChangeTime字段
 //        QString strSqlImage = QString::fromLocal8Bit("select sql from sqlite_master where name = \"ImageTable3\" and sql like \"%ChangeTime%\"");
 //        QSqlQuery queryImage1(db);
@@ -975,7 +1547,7 @@ void DBManager::checkDatabase()
 
 const QStringList DBManager::getAllTrashPaths() const
 {
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     QStringList paths;
     QSqlDatabase db = getDatabase();
     if (! db.isValid())
@@ -1005,7 +1577,7 @@ const QStringList DBManager::getAllTrashPaths() const
 
 const DBImgInfoList DBManager::getAllTrashInfos() const
 {
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     DBImgInfoList infos;
     QSqlDatabase db = getDatabase();
     if (! db.isValid()) {
@@ -1044,7 +1616,7 @@ const DBImgInfoList DBManager::getAllTrashInfos() const
 
 void DBManager::insertTrashImgInfos(const DBImgInfoList &infos)
 {
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     QSqlDatabase db = getDatabase();
     if (infos.isEmpty() || ! db.isValid()) {
         return;
@@ -1092,7 +1664,7 @@ void DBManager::insertTrashImgInfos(const DBImgInfoList &infos)
 
 void DBManager::removeTrashImgInfos(const QStringList &paths)
 {
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     QSqlDatabase db = getDatabase();
     if (paths.isEmpty() || ! db.isValid()) {
         return;
@@ -1132,7 +1704,7 @@ void DBManager::removeTrashImgInfos(const QStringList &paths)
 
 void DBManager::removeTrashImgInfosNoSignal(const QStringList &paths)
 {
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     QSqlDatabase db = getDatabase();
     if (paths.isEmpty() || ! db.isValid()) {
         return;
@@ -1150,10 +1722,11 @@ void DBManager::removeTrashImgInfosNoSignal(const QStringList &paths)
     // Remove from albums table
     query.setForwardOnly(true);
     query.exec("BEGIN IMMEDIATE TRANSACTION");
-    QString qs = "DELETE FROM AlbumTable3 WHERE PathHash=?";
-    query.prepare(qs);
-    query.addBindValue(pathHashs);
-    query.execBatch();
+    if (fillPathTable(query, "RemoveTable", paths)
+            && query.exec(QString("DELETE FROM AlbumTable3 WHERE ImageId IN (%1)")
+                          .arg(IMAGE_IDS_OF_PATH_TABLE.arg("RemoveTable")))) {
+        cacheRemovePaths(QSet<QString>::fromList(paths));
+    }
     query.exec("COMMIT");
 //    if (! query.execBatch()) {
 //        //  qWarning() << "Remove data from AlbumTable3 failed: "
@@ -1165,7 +1738,7 @@ void DBManager::removeTrashImgInfosNoSignal(const QStringList &paths)
 
     // Remove from image table
     query.exec("BEGIN IMMEDIATE TRANSACTION");
-    qs = "DELETE FROM TrashTable3 WHERE PathHash=?";
+    QString qs = "DELETE FROM TrashTable3 WHERE PathHash=?";
     query.prepare(qs);
     query.addBindValue(pathHashs);
     query.execBatch();
@@ -1194,7 +1767,7 @@ const DBImgInfo DBManager::getTrashInfoByPath(const QString &path) const
 
 const DBImgInfoList DBManager::getTrashImgInfos(const QString &key, const QString &value) const
 {
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     DBImgInfoList infos;
     QSqlDatabase db = getDatabase();
     if (! db.isValid()) {
@@ -1233,26 +1806,20 @@ const DBImgInfoList DBManager::getTrashImgInfos(const QString &key, const QStrin
 
 int DBManager::getTrashImgsCount() const
 {
-    QMutexLocker mutex(&m_mutex);
+    DBCallLocker mutex(&m_mutex, Q_FUNC_INFO);
     QSqlDatabase db = getDatabase();
     if (!db.isValid()) {
         return 0;
     }
     QSqlQuery query(db);
     query.setForwardOnly(true);
-    query.exec("BEGIN IMMEDIATE TRANSACTION");
     query.prepare("SELECT COUNT(*) FROM TrashTable3");
-    if (query.exec()) {
-        query.first();
-        int count = query.value(0).toInt();
-        query.exec("COMMIT");
-        // 连接使用完后需要释放回数据库连接池
-        ////ConnectionPool::closeConnection(db);
-        db.close();
-        return count;
+    int count = 0;
+    if (query.exec() && query.first()) {
+        count = query.value(0).toInt();
     }
     // 连接使用完后需要释放回数据库连接池
     ////ConnectionPool::closeConnection(db);
     db.close();
-    return 0;
+    return count;
 }
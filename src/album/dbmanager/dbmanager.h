@@ -19,19 +19,24 @@
 
 // ImageTable
 ///////////////////////////////////////////////////////
-//FilePath           | FileName | Dir        | Time | ChangeTime //
-//TEXT primari key   | TEXT     | TEXT       | TEXT | TEXT //
+//ImageId             | PathKey | FilePath | FileName | Dir  | Time | ChangeTime | Width | Height | Orientation | FileSize | MTime | Fingerprint | DHash //
+//INTEGER primari key | INT     | TEXT     | TEXT     | TEXT | TEXT | TEXT       | INT   | INT    | INT         | INT      | INT   | INT         | INT   //
 ///////////////////////////////////////////////////////
 
 // AlbumTable
 /////////////////////////////////////////////////////
-//AP               | AlbumName         | FilePath  //
-//TEXT primari key | TEXT              | TEXT      //
+//AlbumId             | AlbumName         | ImageId  //
+//INTEGER primari key | TEXT              | INTEGER  //
 /////////////////////////////////////////////////////
 
 #include <QObject>
 #include <QDateTime>
+#include <QSize>
 #include <QMutex>
+#include <QReadWriteLock>
+#include <QHash>
+#include <QSet>
+#include <QVector>
 #include <QDebug>
 #include <QSqlDatabase>
 //#include "connectionpool.h"
@@ -54,6 +59,23 @@ struct DBImgInfo {
     QDateTime importTime;   // 导入时间 Or 删除时间
     QString albumname;      // 图片所属相册名，以","分隔
     QString albumSize;      //原图片分辨率
+    int width = 0;          //原图宽度(未旋转)
+    int height = 0;         //原图高度(未旋转)
+    int orientation = 0;    //EXIF方向，0表示未知
+    qint64 fileSize = 0;    //文件大小
+    qint64 mtime = 0;       //文件修改时间(秒)
+    qint64 fingerprint = 0; //内容指纹，0表示未计算
+    qint64 dhash = 0;       //缩略图感知哈希(dHash)，0表示未计算
+    quint32 previewColor = 0;   //缩略图主色(ARGB)，快速滚动时作占位，0表示未计算
+
+    //按EXIF方向旋转后的显示尺寸，未记录时为空
+    QSize displaySize() const
+    {
+        if (width <= 0 || height <= 0) {
+            return QSize();
+        }
+        return orientation >= 5 ? QSize(height, width) : QSize(width, height);
+    }
 
     bool operator==(const DBImgInfo &other) const
     {
@@ -64,7 +86,15 @@ struct DBImgInfo {
                 changeTime == other.changeTime &&
                 importTime == other.importTime &&
                 albumname == other.albumname &&
-                albumSize == other.albumSize);
+                albumSize == other.albumSize &&
+                width == other.width &&
+                height == other.height &&
+                orientation == other.orientation &&
+                fileSize == other.fileSize &&
+                mtime == other.mtime &&
+                fingerprint == other.fingerprint &&
+                dhash == other.dhash &&
+                previewColor == other.previewColor);
     }
 
     friend QDebug operator<<(QDebug &dbg, const DBImgInfo &info)
@@ -78,11 +108,20 @@ struct DBImgInfo {
             << "ImportTime:" << info.importTime
             << "AlbumName:" << info.albumname
             << "AlbumSize:" << info.albumSize
+            << "Size:" << info.width << "x" << info.height
+            << "Orientation:" << info.orientation
+            << "FileSize:" << info.fileSize
+            << "MTime:" << info.mtime
+            << "Fingerprint:" << info.fingerprint
+            << "DHash:" << info.dhash
+            << "PreviewColor:" << info.previewColor
             << "]";
         return dbg;
     }
 };
 typedef QList<DBImgInfo> DBImgInfoList;
+//按时间线分组的图片：(时间线, 该时间线下的图片)，时间线倒序
+typedef QList<QPair<QString, DBImgInfoList>> DBTimelineSections;
 
 enum AlbumDBType {
     Favourite,
@@ -109,21 +148,35 @@ public:
     const DBImgInfoList     getInfosByTimeline(const QString &timeline) const;
     const QStringList       getImportTimelines() const;
     const DBImgInfoList     getInfosByImportTimeline(const QString &timeline) const;
+    //一次查询取出全部图片并按拍摄日期/导入时间分组，代替逐个时间线查询
+    const DBTimelineSections getTimelineSections() const;
+    const DBTimelineSections getImportTimelineSections() const;
 //    const DBImgInfo         getInfoByName(const QString &name) const;
     const DBImgInfo         getInfoByPath(const QString &path) const;
+    //一次联合查询取出多张图片的数据，不在库中的路径被忽略
+    const DBImgInfoList     getInfosByPaths(const QStringList &paths) const;
 //    const DBImgInfo         getInfoByPathHash(const QString &pathHash) const;
     int                     getImgsCount() const;
 //    bool                    isImgExist(const QString &path) const;
     void                    insertImgInfos(const DBImgInfoList &infos);
+    //同上但不发送imagesInserted，由调用方在写完相册行等后续数据后合并通知；返回是否提交成功
+    bool                    insertImgInfosNoSignal(const DBImgInfoList &infos);
+    //回填图片元数据(宽高、方向、大小、修改时间)，不发送信号
+    void                    updateImgMetas(const DBImgInfoList &infos);
     void                    insertImgInfo(const DBImgInfo &info);
     void                    removeImgInfos(const QStringList &paths);
+    void                    removeImgInfos(const QSet<QString> &paths);
     void                    removeImgInfosNoSignal(const QStringList &paths);
-    const DBImgInfoList     getInfosForKeyword(const QString &keywords) const;
-    const DBImgInfoList     getTrashInfosForKeyword(const QString &keywords) const;
-    const DBImgInfoList     getInfosForKeyword(const QString &album, const QString &keywords) const;
+    //单个事务内删除，不发送信号，removedInfos返回被删除的数据，由调用方在GUI线程发送通知
+    bool                    removeImgInfosNoSignal(const QSet<QString> &paths, DBImgInfoList *removedInfos);
+    //limit大于0时只取前limit条，用于先显示首批搜索结果
+    const DBImgInfoList     getInfosForKeyword(const QString &keywords, int limit = 0) const;
+    const DBImgInfoList     getTrashInfosForKeyword(const QString &keywords, int limit = 0) const;
+    const DBImgInfoList     getInfosForKeyword(const QString &album, const QString &keywords, int limit = 0) const;
 
     // TableAlbum
     const QMultiMap<QString, QString> getAllPathAlbumNames() const;
+    const QStringList       getAlbumNamesByPath(const QString &path) const;
     const QStringList       getAllAlbumNames(AlbumDBType atype = AlbumDBType::Custom) const;
     const QStringList       getPathsByAlbum(const QString &album, AlbumDBType atype = AlbumDBType::Custom) const;
     const DBImgInfoList     getInfosByAlbum(const QString &album, AlbumDBType atype = AlbumDBType::Custom) const;
@@ -131,12 +184,17 @@ public:
 //    int                     getAlbumsCount() const;
     bool                    isAlbumExistInDB(const QString &album, AlbumDBType atype = AlbumDBType::Custom) const;
     bool                    isImgExistInAlbum(const QString &album, const QString &path, AlbumDBType atype = AlbumDBType::Custom) const;
+    QVector<bool>           isImgsExistInAlbum(const QString &album, const QStringList &paths, AlbumDBType atype = AlbumDBType::Custom) const;
     void                    insertIntoAlbum(const QString &album, const QStringList &paths, AlbumDBType atype = AlbumDBType::Custom);
     void                    removeAlbum(const QString &album, AlbumDBType atype = AlbumDBType::Custom);
     void                    removeFromAlbum(const QString &album, const QStringList &paths, AlbumDBType atype = AlbumDBType::Custom);
     void                    renameAlbum(const QString &oldAlbum, const QString &newAlbum, AlbumDBType atype = AlbumDBType::Custom);
 //    void                    removeFromAlbumNoSignal(const QString &album, const QStringList &paths, AlbumDBType atype = AlbumDBType::Custom);
     void                    insertIntoAlbumNoSignal(const QString &album, const QStringList &paths, AlbumDBType atype = AlbumDBType::Custom);
+    //GUI线程使用：相册缓存立即更新，写库排队到数据库线程，失败或图片不在库中时撤销缓存；之后经DBAsyncManager的查询按顺序在写入之后执行
+    void                    insertIntoAlbumAsync(const QString &album, const QStringList &paths, AlbumDBType atype = AlbumDBType::Custom);
+    //同上，写入完成后在GUI线程发送removedFromAlbum
+    void                    removeFromAlbumAsync(const QString &album, const QStringList &paths, AlbumDBType atype = AlbumDBType::Custom);
     // TabelTrash
     const QStringList       getAllTrashPaths() const;
     const DBImgInfoList     getAllTrashInfos() const;
@@ -148,16 +206,38 @@ public:
     int                     getTrashImgsCount() const;
     const QSqlDatabase      getDatabase() const;
 private:
-    const DBImgInfoList     getInfosByNameTimeline(const QString &value) const;
+    const DBImgInfoList     getInfosByNameTimeline(const QString &value, int limit = 0) const;
     const DBImgInfoList     getImgInfos(const QString &key, const QString &value, const bool &needlock = true) const;
+    const DBTimelineSections getInfosGroupedBy(const QString &key) const;
+    bool                    removeImgInfosInTransaction(const QSet<QString> &paths, DBImgInfoList *removedInfos);
+    bool                    removeFromAlbumInTransaction(const QString &album, const QStringList &paths, AlbumDBType atype);
+    // inserted返回写入后在相册中的路径，失败时事务已回滚
+    bool                    insertIntoAlbumInTransaction(const QString &album, const QStringList &paths, AlbumDBType atype, QStringList &inserted);
 
 
     void                    checkDatabase();
+    // 失败时事务已回滚并返回false，旧表保持原样
+    bool                    migrateToImageIds(QSqlDatabase &db);
+
+    // 相册成员缓存，首次访问时从数据库加载；cache*函数在持有m_mutex时调用
+    void                    loadAlbumCache() const;
+    // 返回新加入缓存的路径，albumAdded返回相册是否为新建
+    QStringList             cacheInsertIntoAlbum(const QString &album, const QStringList &paths, AlbumDBType atype, bool *albumAdded = nullptr);
+    void                    cacheRemoveFromAlbum(const QString &album, const QStringList &paths, AlbumDBType atype);
+    void                    cacheRemoveAlbum(const QString &album, AlbumDBType atype);
+    void                    cacheRenameAlbum(const QString &oldAlbum, const QString &newAlbum, AlbumDBType atype);
+    void                    cacheRemovePaths(const QSet<QString> &paths);
     static DBManager       *m_dbManager;
 private:
     //QString m_connectionName;
     mutable QMutex m_mutex;
 
+    //相册成员缓存: 相册名->路径 及 路径->自定义相册名，随相册增删改增量更新
+    mutable QReadWriteLock m_albumCacheLock;
+    mutable bool m_albumCacheLoaded = false;
+    mutable QHash<QString, QSet<QString>> m_albumPathsCache[AlbumDBType::Custom + 1];
+    mutable QHash<QString, QSet<QString>> m_pathAlbumsCache;
+
 //    mutable QMutex m_mutex1;
     mutable QSqlDatabase m_db;
 };
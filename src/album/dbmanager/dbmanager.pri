@@ -1,9 +1,15 @@
 HEADERS += \
     $$PWD/dbmanager.h \
+    $$PWD/dbasyncmanager.h \
+    $$PWD/photocatalog.h \
+    $$PWD/similarindex.h \
    # $$PWD/dbmanagersuthd.h \
    # $$PWD/connectionpool.h
 
 SOURCES += \
     $$PWD/dbmanager.cpp \
+    $$PWD/dbasyncmanager.cpp \
+    $$PWD/photocatalog.cpp \
+    $$PWD/similarindex.cpp \
     #$$PWD/dbmanagersuthd.cpp \
     #$$PWD/connectionpool.cpp
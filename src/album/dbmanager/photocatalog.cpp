@@ -0,0 +1,515 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "photocatalog.h"
+#include "dbasyncmanager.h"
+
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+qint64 toMSecs(const QDateTime &time)
+{
+    return time.isValid() ? time.toMSecsSinceEpoch() : 0;
+}
+
+QDateTime fromMSecs(qint64 msecs)
+{
+    return msecs ? QDateTime::fromMSecsSinceEpoch(msecs) : QDateTime();
+}
+
+}  // namespace
+
+PhotoCatalog *PhotoCatalog::m_instance = nullptr;
+
+PhotoCatalog *PhotoCatalog::instance()
+{
+    if (!m_instance) {
+        m_instance = new PhotoCatalog();
+    }
+    return m_instance;
+}
+
+PhotoCatalog::PhotoCatalog(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void PhotoCatalog::loadAsync()
+{
+    std::function<void()> task = [this]() {
+        if (!isLoaded()) {
+            load();
+        }
+    };
+    DBAsyncManager::instance()->future(task);
+}
+
+void PhotoCatalog::load()
+{
+    quint64 generation = 0;
+    {
+        QWriteLocker locker(&m_lock);
+        generation = ++m_loadGeneration;
+        ++m_loadsInFlight;
+    }
+    //先在锁外查询数据库，避免与DBManager的锁交叉；期间的变更由insertInfos等记入m_pendingChanges
+    const DBImgInfoList infos = DBManager::instance()->getAllInfos();
+    QWriteLocker locker(&m_lock);
+    --m_loadsInFlight;
+    if (generation != m_loadGeneration) {
+        //已有更晚开始的load()，其快照更新，本次结果丢弃
+        if (0 == m_loadsInFlight) {
+            m_pendingChanges.clear();
+        }
+        return;
+    }
+    clearLocked();
+    m_pathOffset.reserve(infos.size());
+    m_pathLength.reserve(infos.size());
+    m_nameOffset.reserve(infos.size());
+    m_dirId.reserve(infos.size());
+    m_time.reserve(infos.size());
+    m_changeTime.reserve(infos.size());
+    m_importTime.reserve(infos.size());
+    m_fileSize.reserve(infos.size());
+    m_mtime.reserve(infos.size());
+    m_dims.reserve(infos.size());
+    m_orientation.reserve(infos.size());
+    m_fingerprint.reserve(infos.size());
+    m_dhash.reserve(infos.size());
+    m_previewColor.reserve(infos.size());
+    m_alive.reserve(infos.size());
+    m_pathIndex.reserve(infos.size());
+    for (const DBImgInfo &info : infos) {
+        appendLocked(info);
+    }
+    //变更都在数据库提交之后才通知，重放是幂等的：快照中已有的记录只会被再次更新
+    for (const PendingChange &change : m_pendingChanges) {
+        switch (change.type) {
+        case PendingChange::Insert:
+            insertInfosLocked(change.infos);
+            break;
+        case PendingChange::Remove:
+            removePathsLocked(change.paths);
+            break;
+        case PendingChange::UpdateMetas:
+            updateMetasLocked(change.infos);
+            break;
+        }
+    }
+    if (0 == m_loadsInFlight) {
+        m_pendingChanges.clear();
+    }
+    m_pathArena.squeeze();
+    m_loaded = true;
+    qDebug() << "PhotoCatalog loaded" << m_aliveCount << "photos," << m_pathArena.size() << "path bytes";
+}
+
+bool PhotoCatalog::isLoaded() const
+{
+    QReadLocker locker(&m_lock);
+    return m_loaded;
+}
+
+void PhotoCatalog::insertInfos(const DBImgInfoList &infos)
+{
+    QWriteLocker locker(&m_lock);
+    if (m_loadsInFlight > 0) {
+        m_pendingChanges.append({PendingChange::Insert, infos, QSet<QString>()});
+    }
+    if (m_loaded) {
+        insertInfosLocked(infos);
+    }
+}
+
+void PhotoCatalog::insertInfosLocked(const DBImgInfoList &infos)
+{
+    for (const DBImgInfo &info : infos) {
+        PhotoId id = findLocked(info.filePath, qHash(info.filePath));
+        if (INVALID_PHOTO_ID == id) {
+            appendLocked(info);
+        } else {
+            updateLocked(id, info);
+        }
+    }
+}
+
+void PhotoCatalog::removePaths(const QSet<QString> &paths)
+{
+    QWriteLocker locker(&m_lock);
+    if (m_loadsInFlight > 0) {
+        m_pendingChanges.append({PendingChange::Remove, DBImgInfoList(), paths});
+    }
+    if (m_loaded) {
+        removePathsLocked(paths);
+    }
+}
+
+void PhotoCatalog::removePathsLocked(const QSet<QString> &paths)
+{
+    for (const QString &path : paths) {
+        const uint pathHash = qHash(path);
+        PhotoId id = findLocked(path, pathHash);
+        if (INVALID_PHOTO_ID != id) {
+            m_alive[id] = false;
+            m_pathIndex.remove(pathHash, id);
+            setFingerprintLocked(id, 0);
+            setDHashLocked(id, 0);
+            --m_aliveCount;
+        }
+    }
+}
+
+void PhotoCatalog::updateMetas(const DBImgInfoList &infos)
+{
+    QWriteLocker locker(&m_lock);
+    if (m_loadsInFlight > 0) {
+        m_pendingChanges.append({PendingChange::UpdateMetas, infos, QSet<QString>()});
+    }
+    updateMetasLocked(infos);
+}
+
+void PhotoCatalog::updateMetasLocked(const DBImgInfoList &infos)
+{
+    for (const DBImgInfo &info : infos) {
+        PhotoId id = findLocked(info.filePath, qHash(info.filePath));
+        if (INVALID_PHOTO_ID == id) {
+            continue;
+        }
+        m_fileSize[id] = info.fileSize;
+        m_mtime[id] = info.mtime;
+        m_dims[id] = (static_cast<quint64>(static_cast<quint32>(info.width)) << 32)
+                     | static_cast<quint32>(info.height);
+        m_orientation[id] = static_cast<quint8>(info.orientation);
+        if (info.dhash) {
+            setDHashLocked(id, info.dhash);
+        }
+        if (info.previewColor) {
+            m_previewColor[id] = info.previewColor;
+        }
+    }
+}
+
+int PhotoCatalog::count() const
+{
+    QReadLocker locker(&m_lock);
+    return m_aliveCount;
+}
+
+PhotoId PhotoCatalog::idOf(const QString &path) const
+{
+    QReadLocker locker(&m_lock);
+    return findLocked(path, qHash(path));
+}
+
+bool PhotoCatalog::contains(const QString &path) const
+{
+    return INVALID_PHOTO_ID != idOf(path);
+}
+
+QVector<bool> PhotoCatalog::contains(const QStringList &paths) const
+{
+    QReadLocker locker(&m_lock);
+    QVector<bool> result;
+    result.reserve(paths.size());
+    for (const QString &path : paths) {
+        result << (INVALID_PHOTO_ID != findLocked(path, qHash(path)));
+    }
+    return result;
+}
+
+QVector<PhotoId> PhotoCatalog::idsByFingerprint(qint64 fingerprint) const
+{
+    QReadLocker locker(&m_lock);
+    return fingerprint ? m_fingerprintIndex.values(fingerprint).toVector() : QVector<PhotoId>();
+}
+
+QVector<PhotoId> PhotoCatalog::similarTo(PhotoId id, int maxDistance) const
+{
+    QReadLocker locker(&m_lock);
+    if (id < 0 || id >= m_dhash.size() || !m_dhash[id]) {
+        return QVector<PhotoId>();
+    }
+    QMutexLocker similarLocker(&m_similarMutex);
+    QVector<PhotoId> ids = similarIndexLocked().find(m_dhash[id], maxDistance);
+    ids.removeOne(id);
+    return ids;
+}
+
+QVector<QVector<PhotoId>> PhotoCatalog::similarGroups(int maxDistance) const
+{
+    QReadLocker locker(&m_lock);
+    QMutexLocker similarLocker(&m_similarMutex);
+    return similarIndexLocked().groups(maxDistance);
+}
+
+bool PhotoCatalog::isValid(PhotoId id) const
+{
+    QReadLocker locker(&m_lock);
+    return id >= 0 && id < m_alive.size() && m_alive[id];
+}
+
+QVector<PhotoId> PhotoCatalog::idsByTime() const
+{
+    QReadLocker locker(&m_lock);
+    QVector<PhotoId> ids;
+    ids.reserve(m_aliveCount);
+    for (PhotoId id = 0; id < m_alive.size(); ++id) {
+        if (m_alive[id]) {
+            ids << id;
+        }
+    }
+    std::stable_sort(ids.begin(), ids.end(), [this](PhotoId a, PhotoId b) {
+        return m_time[a] > m_time[b];
+    });
+    return ids;
+}
+
+QString PhotoCatalog::path(PhotoId id) const
+{
+    QReadLocker locker(&m_lock);
+    return pathLocked(id);
+}
+
+QString PhotoCatalog::fileName(PhotoId id) const
+{
+    QReadLocker locker(&m_lock);
+    if (id < 0 || id >= m_pathOffset.size()) {
+        return QString();
+    }
+    const quint32 offset = m_pathOffset[id] + m_nameOffset[id];
+    return QString::fromUtf8(m_pathArena.constData() + offset,
+                             static_cast<int>(m_pathLength[id] - m_nameOffset[id]));
+}
+
+QString PhotoCatalog::dirHash(PhotoId id) const
+{
+    QReadLocker locker(&m_lock);
+    if (id < 0 || id >= m_dirId.size()) {
+        return QString();
+    }
+    return m_dirs.value(m_dirId[id]);
+}
+
+qint64 PhotoCatalog::time(PhotoId id) const
+{
+    QReadLocker locker(&m_lock);
+    return m_time.value(id);
+}
+
+qint64 PhotoCatalog::importTime(PhotoId id) const
+{
+    QReadLocker locker(&m_lock);
+    return m_importTime.value(id);
+}
+
+QSize PhotoCatalog::size(PhotoId id) const
+{
+    QReadLocker locker(&m_lock);
+    if (id < 0 || id >= m_dims.size()) {
+        return QSize();
+    }
+    return QSize(static_cast<int>(m_dims[id] >> 32), static_cast<int>(m_dims[id] & 0xffffffff));
+}
+
+DBImgInfo PhotoCatalog::info(PhotoId id) const
+{
+    QReadLocker locker(&m_lock);
+    DBImgInfo info;
+    if (id < 0 || id >= m_pathOffset.size()) {
+        return info;
+    }
+    info.filePath = pathLocked(id);
+    info.fileName = info.filePath.mid(info.filePath.lastIndexOf('/') + 1);
+    info.dirHash = m_dirs.value(m_dirId[id]);
+    info.time = fromMSecs(m_time[id]);
+    info.changeTime = fromMSecs(m_changeTime[id]);
+    info.importTime = fromMSecs(m_importTime[id]);
+    info.width = static_cast<int>(m_dims[id] >> 32);
+    info.height = static_cast<int>(m_dims[id] & 0xffffffff);
+    info.orientation = m_orientation[id];
+    info.fileSize = m_fileSize[id];
+    info.mtime = m_mtime[id];
+    info.previewColor = m_previewColor[id];
+    return info;
+}
+
+QVector<quint32> PhotoCatalog::previewColors(const QStringList &paths) const
+{
+    QReadLocker locker(&m_lock);
+    QVector<quint32> colors;
+    colors.reserve(paths.size());
+    for (const QString &path : paths) {
+        const PhotoId id = findLocked(path, qHash(path));
+        colors << (INVALID_PHOTO_ID == id ? 0 : m_previewColor[id]);
+    }
+    return colors;
+}
+
+QStringList PhotoCatalog::paths(const QVector<PhotoId> &ids) const
+{
+    QReadLocker locker(&m_lock);
+    QStringList list;
+    list.reserve(ids.size());
+    for (PhotoId id : ids) {
+        list << pathLocked(id);
+    }
+    return list;
+}
+
+PhotoId PhotoCatalog::findLocked(const QString &path, uint pathHash) const
+{
+    auto it = m_pathIndex.constFind(pathHash);
+    while (it != m_pathIndex.constEnd() && it.key() == pathHash) {
+        if (pathLocked(it.value()) == path) {
+            return it.value();
+        }
+        ++it;
+    }
+    return INVALID_PHOTO_ID;
+}
+
+QString PhotoCatalog::pathLocked(PhotoId id) const
+{
+    if (id < 0 || id >= m_pathOffset.size()) {
+        return QString();
+    }
+    return QString::fromUtf8(m_pathArena.constData() + m_pathOffset[id], static_cast<int>(m_pathLength[id]));
+}
+
+void PhotoCatalog::appendLocked(const DBImgInfo &info)
+{
+    const PhotoId id = m_alive.size();
+    const QByteArray utf8 = info.filePath.toUtf8();
+    const int slash = utf8.lastIndexOf('/');
+    m_pathOffset << static_cast<quint32>(m_pathArena.size());
+    m_pathLength << static_cast<quint32>(utf8.size());
+    m_nameOffset << static_cast<quint16>(slash + 1);
+    m_pathArena.append(utf8);
+    m_dirId << internDirLocked(info.dirHash);
+    m_time << 0;
+    m_changeTime << 0;
+    m_importTime << 0;
+    m_fileSize << 0;
+    m_mtime << 0;
+    m_dims << 0;
+    m_orientation << 0;
+    m_fingerprint << 0;
+    m_dhash << 0;
+    m_previewColor << 0;
+    m_alive << true;
+    m_pathIndex.insert(qHash(info.filePath), id);
+    ++m_aliveCount;
+    updateLocked(id, info);
+}
+
+void PhotoCatalog::updateLocked(PhotoId id, const DBImgInfo &info)
+{
+    m_dirId[id] = internDirLocked(info.dirHash);
+    m_time[id] = toMSecs(info.time);
+    m_changeTime[id] = toMSecs(info.changeTime);
+    m_importTime[id] = toMSecs(info.importTime);
+    m_fileSize[id] = info.fileSize;
+    m_mtime[id] = info.mtime;
+    m_dims[id] = (static_cast<quint64>(static_cast<quint32>(info.width)) << 32)
+                 | static_cast<quint32>(info.height);
+    m_orientation[id] = static_cast<quint8>(info.orientation);
+    //未计算指纹的更新不覆盖已有指纹
+    if (info.fingerprint) {
+        setFingerprintLocked(id, info.fingerprint);
+    }
+    if (info.dhash) {
+        setDHashLocked(id, info.dhash);
+    }
+    if (info.previewColor) {
+        m_previewColor[id] = info.previewColor;
+    }
+}
+
+void PhotoCatalog::setFingerprintLocked(PhotoId id, qint64 fingerprint)
+{
+    if (m_fingerprint[id] == fingerprint) {
+        return;
+    }
+    if (m_fingerprint[id]) {
+        m_fingerprintIndex.remove(m_fingerprint[id], id);
+    }
+    m_fingerprint[id] = fingerprint;
+    if (fingerprint) {
+        m_fingerprintIndex.insert(fingerprint, id);
+    }
+}
+
+void PhotoCatalog::setDHashLocked(PhotoId id, qint64 dhash)
+{
+    if (m_dhash[id] != static_cast<quint64>(dhash)) {
+        m_dhash[id] = static_cast<quint64>(dhash);
+        QMutexLocker similarLocker(&m_similarMutex);
+        m_similarDirty = true;
+    }
+}
+
+const SimilarIndex &PhotoCatalog::similarIndexLocked() const
+{
+    if (m_similarDirty) {
+        m_similarIndex.build(m_dhash);
+        m_similarDirty = false;
+    }
+    return m_similarIndex;
+}
+
+int PhotoCatalog::internDirLocked(const QString &dir)
+{
+    auto it = m_dirIndex.constFind(dir);
+    if (it != m_dirIndex.constEnd()) {
+        return it.value();
+    }
+    const int index = m_dirs.size();
+    m_dirs << dir;
+    m_dirIndex.insert(dir, index);
+    return index;
+}
+
+void PhotoCatalog::clearLocked()
+{
+    m_loaded = false;
+    m_aliveCount = 0;
+    m_pathArena.clear();
+    m_pathOffset.clear();
+    m_pathLength.clear();
+    m_nameOffset.clear();
+    m_dirId.clear();
+    m_time.clear();
+    m_changeTime.clear();
+    m_importTime.clear();
+    m_fileSize.clear();
+    m_mtime.clear();
+    m_dims.clear();
+    m_orientation.clear();
+    m_fingerprint.clear();
+    m_dhash.clear();
+    m_previewColor.clear();
+    m_alive.clear();
+    m_dirs.clear();
+    m_dirIndex.clear();
+    m_pathIndex.clear();
+    m_fingerprintIndex.clear();
+    QMutexLocker similarLocker(&m_similarMutex);
+    m_similarIndex.clear();
+    m_similarDirty = true;
+}
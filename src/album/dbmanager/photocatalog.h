@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PHOTOCATALOG_H
+#define PHOTOCATALOG_H
+
+#include "dbmanager.h"
+#include "similarindex.h"
+
+#include <QObject>
+#include <QByteArray>
+#include <QVector>
+#include <QHash>
+#include <QMultiHash>
+#include <QReadWriteLock>
+#include <QMutex>
+#include <QSize>
+
+typedef int PhotoId;
+const PhotoId INVALID_PHOTO_ID = -1;
+
+/**
+ * @brief The PhotoCatalog class
+ * 图库的紧凑内存目录，启动时从数据库加载一次，各视图只读共享。
+ * 图库图片的元数据只存在这里，ImageEngineApi的缩略图缓存中只留路径和文件名。
+ * 按列存储：路径以UTF-8存放在一块连续内存中，目录名去重，时间为int64毫秒，宽高打包为一个整数。
+ * id在两次load()之间保持不变，删除的图片只做标记，下次load()时压缩。
+ */
+class PhotoCatalog : public QObject
+{
+    Q_OBJECT
+public:
+    static PhotoCatalog *instance();
+    //除全局实例外也可单独创建，供测试及离线工具使用
+    explicit PhotoCatalog(QObject *parent = nullptr);
+
+    //从数据库加载全部图片，可在任意线程调用
+    void load();
+    //排队到数据库线程加载，启动时在首屏之后调用
+    void loadAsync();
+    bool isLoaded() const;
+
+    //由DBManager在数据库变更后调用，保持目录与数据库一致
+    void insertInfos(const DBImgInfoList &infos);
+    void removePaths(const QSet<QString> &paths);
+    void updateMetas(const DBImgInfoList &infos);
+
+    int count() const;
+    PhotoId idOf(const QString &path) const;
+    bool contains(const QString &path) const;
+    //批量判断路径是否在图库中，只加一次锁，用于导入判重
+    QVector<bool> contains(const QStringList &paths) const;
+    //内容指纹相同的图片，用于跨路径判重
+    QVector<PhotoId> idsByFingerprint(qint64 fingerprint) const;
+    //感知哈希相近的图片(不含自身)，按距离由近到远
+    QVector<PhotoId> similarTo(PhotoId id, int maxDistance = SimilarIndex::MAX_DISTANCE) const;
+    //相似图片分组，用于连拍和近似重复图片的归并
+    QVector<QVector<PhotoId>> similarGroups(int maxDistance = SimilarIndex::MAX_DISTANCE) const;
+    bool isValid(PhotoId id) const;
+    //按拍摄时间倒序的全部有效id
+    QVector<PhotoId> idsByTime() const;
+
+    QString path(PhotoId id) const;
+    QString fileName(PhotoId id) const;
+    QString dirHash(PhotoId id) const;
+    qint64 time(PhotoId id) const;
+    qint64 importTime(PhotoId id) const;
+    QSize size(PhotoId id) const;
+    //兼容旧接口，按需组装DBImgInfo
+    DBImgInfo info(PhotoId id) const;
+
+    QStringList paths(const QVector<PhotoId> &ids) const;
+    //批量取缩略图主色(ARGB)，未计算或不在图库中的为0，用于滚动时的占位
+    QVector<quint32> previewColors(const QStringList &paths) const;
+
+private:
+    PhotoId findLocked(const QString &path, uint pathHash) const;
+    QString pathLocked(PhotoId id) const;
+    void appendLocked(const DBImgInfo &info);
+    void updateLocked(PhotoId id, const DBImgInfo &info);
+    void insertInfosLocked(const DBImgInfoList &infos);
+    void removePathsLocked(const QSet<QString> &paths);
+    void updateMetasLocked(const DBImgInfoList &infos);
+    void setFingerprintLocked(PhotoId id, qint64 fingerprint);
+    void setDHashLocked(PhotoId id, qint64 dhash);
+    //在读锁下调用，按需重建相似索引
+    const SimilarIndex &similarIndexLocked() const;
+    int internDirLocked(const QString &dir);
+    void clearLocked();
+
+    static PhotoCatalog *m_instance;
+
+    mutable QReadWriteLock m_lock;
+    bool m_loaded = false;
+    int m_aliveCount = 0;
+
+    //load()在锁外查询数据库期间到来的变更先记下，快照装入后按序重放，避免丢失
+    struct PendingChange {
+        enum Type {
+            Insert,
+            Remove,
+            UpdateMetas
+        } type;
+        DBImgInfoList infos;
+        QSet<QString> paths;
+    };
+    QVector<PendingChange> m_pendingChanges;
+    int m_loadsInFlight = 0;
+    quint64 m_loadGeneration = 0;
+
+    QByteArray m_pathArena;             //所有路径的UTF-8字节
+    QVector<quint32> m_pathOffset;
+    QVector<quint32> m_pathLength;
+    QVector<quint16> m_nameOffset;      //文件名在路径中的字节偏移
+    QVector<qint32> m_dirId;
+    QVector<qint64> m_time;
+    QVector<qint64> m_changeTime;
+    QVector<qint64> m_importTime;
+    QVector<qint64> m_fileSize;
+    QVector<qint64> m_mtime;
+    QVector<quint64> m_dims;            //高32位宽，低32位高
+    QVector<quint8> m_orientation;
+    QVector<qint64> m_fingerprint;
+    QVector<quint64> m_dhash;           //缩略图感知哈希
+    QVector<quint32> m_previewColor;    //缩略图主色
+    QVector<bool> m_alive;
+
+    QVector<QString> m_dirs;            //去重后的目录(Dir字段)
+    QHash<QString, int> m_dirIndex;
+    QMultiHash<uint, PhotoId> m_pathIndex;
+    QMultiHash<qint64, PhotoId> m_fingerprintIndex;
+    //相似索引在首次查询时构建，感知哈希变化后作废
+    mutable QMutex m_similarMutex;
+    mutable SimilarIndex m_similarIndex;
+    mutable bool m_similarDirty = true;
+};
+
+#endif // PHOTOCATALOG_H
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "similarindex.h"
+#include "utils/imageutils.h"
+
+#include <QHash>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+int findRoot(QVector<int> &parents, int i)
+{
+    while (parents[i] != i) {
+        parents[i] = parents[parents[i]];
+        i = parents[i];
+    }
+    return i;
+}
+
+}  // namespace
+
+int SimilarIndex::chunkOf(quint64 hash, int chunk)
+{
+    //前64%CHUNKS段多一位，各段连续且覆盖全部64位
+    const int extra = 64 % CHUNKS;
+    const int width = 64 / CHUNKS + (chunk < extra ? 1 : 0);
+    const int start = chunk * (64 / CHUNKS) + qMin(chunk, extra);
+    return static_cast<int>((hash >> start) & ((Q_UINT64_C(1) << width) - 1));
+}
+
+void SimilarIndex::build(const QVector<quint64> &hashes)
+{
+    clear();
+    m_hashes = hashes;
+    const int buckets = 1 << CHUNK_BITS;
+    for (int c = 0; c < CHUNKS; c++) {
+        //计数排序：先统计每桶数量，再按前缀和放入
+        QVector<int> &offsets = m_offsets[c];
+        offsets.fill(0, buckets + 1);
+        for (quint64 hash : m_hashes) {
+            if (hash) {
+                ++offsets[chunkOf(hash, c) + 1];
+            }
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        QVector<int> cursor = offsets;
+        QVector<int> &entries = m_entries[c];
+        entries.resize(offsets.last());
+        for (int i = 0; i < m_hashes.size(); i++) {
+            if (m_hashes[i]) {
+                entries[cursor[chunkOf(m_hashes[i], c)]++] = i;
+            }
+        }
+    }
+    m_count = m_entries[0].size();
+}
+
+void SimilarIndex::clear()
+{
+    m_hashes.clear();
+    m_count = 0;
+    for (int c = 0; c < CHUNKS; c++) {
+        m_offsets[c].clear();
+        m_entries[c].clear();
+    }
+}
+
+bool SimilarIndex::isEmpty() const
+{
+    return 0 == m_count;
+}
+
+QVector<int> SimilarIndex::find(quint64 hash, int maxDistance) const
+{
+    QVector<int> result;
+    if (!hash || isEmpty()) {
+        return result;
+    }
+    maxDistance = qBound(0, maxDistance, static_cast<int>(MAX_DISTANCE));
+    QHash<int, int> distances;
+    for (int c = 0; c < CHUNKS; c++) {
+        const int bucket = chunkOf(hash, c);
+        for (int e = m_offsets[c][bucket]; e < m_offsets[c][bucket + 1]; e++) {
+            const int index = m_entries[c][e];
+            const int distance = utils::image::hashDistance(hash, m_hashes[index]);
+            if (distance <= maxDistance) {
+                distances.insert(index, distance);
+            }
+        }
+    }
+    result = distances.keys().toVector();
+    std::sort(result.begin(), result.end(), [&distances](int a, int b) {
+        const int da = distances.value(a), db = distances.value(b);
+        return da != db ? da < db : a < b;
+    });
+    return result;
+}
+
+QVector<QVector<int>> SimilarIndex::groups(int maxDistance) const
+{
+    QVector<QVector<int>> result;
+    if (isEmpty()) {
+        return result;
+    }
+    maxDistance = qBound(0, maxDistance, static_cast<int>(MAX_DISTANCE));
+    QVector<int> parents(m_hashes.size());
+    std::iota(parents.begin(), parents.end(), 0);
+    //相近的两个哈希必在某一段的同一个桶中，只需桶内两两比较
+    for (int c = 0; c < CHUNKS; c++) {
+        const QVector<int> &offsets = m_offsets[c];
+        const QVector<int> &entries = m_entries[c];
+        for (int b = 0; b + 1 < offsets.size(); b++) {
+            for (int i = offsets[b]; i < offsets[b + 1]; i++) {
+                const int a = entries[i];
+                for (int j = i + 1; j < offsets[b + 1]; j++) {
+                    const int other = entries[j];
+                    if (utils::image::hashDistance(m_hashes[a], m_hashes[other]) <= maxDistance) {
+                        const int ra = findRoot(parents, a), rb = findRoot(parents, other);
+                        if (ra != rb) {
+                            parents[rb] = ra;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    QHash<int, int> groupOfRoot;
+    for (int i = 0; i < m_hashes.size(); i++) {
+        if (!m_hashes[i]) {
+            continue;
+        }
+        const int root = findRoot(parents, i);
+        auto it = groupOfRoot.constFind(root);
+        if (it == groupOfRoot.constEnd()) {
+            it = groupOfRoot.insert(root, result.size());
+            result << QVector<int>();
+        }
+        result[it.value()] << i;
+    }
+    result.erase(std::remove_if(result.begin(), result.end(), [](const QVector<int> &group) {
+        return group.size() < 2;
+    }), result.end());
+    return result;
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SIMILARINDEX_H
+#define SIMILARINDEX_H
+
+#include <QVector>
+
+/**
+ * @brief The SimilarIndex class
+ * 64位感知哈希的多索引哈希(multi-index hashing)：哈希切成MAX_DISTANCE+1段，每段建一张桶表。
+ * 由抽屉原理，汉明距离不超过MAX_DISTANCE的两个哈希至少有一段完全相同，只需比较同桶的元素。
+ * 下标即调用方的id，哈希为0的位置不参与索引。
+ */
+class SimilarIndex
+{
+public:
+    static const int MAX_DISTANCE = 5;
+
+    void build(const QVector<quint64> &hashes);
+    void clear();
+    bool isEmpty() const;
+
+    //与hash距离不超过maxDistance的全部下标，按距离由近到远
+    QVector<int> find(quint64 hash, int maxDistance = MAX_DISTANCE) const;
+    //相近的下标归为一组(传递闭包)，只返回至少两个元素的组
+    QVector<QVector<int>> groups(int maxDistance = MAX_DISTANCE) const;
+
+private:
+    static const int CHUNKS = MAX_DISTANCE + 1;
+    static const int CHUNK_BITS = 64 / CHUNKS + 1;
+    static int chunkOf(quint64 hash, int chunk);
+
+    QVector<quint64> m_hashes;
+    int m_count = 0;
+    //每段一张按桶排列的表：m_entries[c]中m_offsets[c][b]到m_offsets[c][b+1]为桶b的下标
+    QVector<int> m_offsets[CHUNKS];
+    QVector<int> m_entries[CHUNKS];
+};
+
+#endif // SIMILARINDEX_H
@@ -146,12 +146,14 @@ const QString AlbumCreateDialog::getNewAlbumName(const QString &baseName, bool i
         nan = baseName;
         albumName = nan + QString::number(num);
     }
-    QStringList albums = DBManager::instance()->getAllAlbumNames();
-    if (isWithOutSelf) {
-        albums.removeOne(beforeName);
-    }
-
-    while (albums.contains(albumName)) {
+    //相册名查重走相册缓存，不在GUI线程查询数据库
+    auto isTaken = [ & ](const QString & name) {
+        if (isWithOutSelf && name == beforeName) {
+            return false;
+        }
+        return DBManager::instance()->isAlbumExistInDB(name);
+    };
+    while (isTaken(albumName)) {
         albumName = nan + QString::number(num);
         num++;
     }
@@ -174,10 +176,10 @@ void AlbumCreateDialog::createAlbum(const QString &newName)
 {
     if (!DBManager::instance()->isAlbumExistInDB(newName)) {
         m_createAlbumName = newName;
-        DBManager::instance()->insertIntoAlbum(newName, QStringList(" "));
+        DBManager::instance()->insertIntoAlbumAsync(newName, QStringList(" "));
     } else {
         m_createAlbumName = getNewAlbumName(newName);
-        DBManager::instance()->insertIntoAlbum(m_createAlbumName, QStringList(" "));
+        DBManager::instance()->insertIntoAlbumAsync(m_createAlbumName, QStringList(" "));
     }
 
     emit albumAdded();
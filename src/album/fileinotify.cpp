@@ -2,7 +2,9 @@
 #include "application.h"
 #include "imageengineapi.h"
 #include "signalmanager.h"
+#include "dbmanager/photocatalog.h"
 #include "utils/unionimage.h"
+#include "utils/dirsnapshot.h"
 
 #include <sys/inotify.h>
 #include <dirent.h>
@@ -10,13 +12,26 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <stdio.h>
+#include <errno.h>
+#include <poll.h>
 
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
 
-enum {MASK = IN_MODIFY | IN_CREATE | IN_DELETE};
+//文件写完、移入移出、删除，以及子目录的创建和自身删除/移动
+enum {MASK = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_CREATE | IN_DELETE_SELF | IN_MOVE_SELF};
+
+namespace {
+
+const int SEND_CHECK_INTERVAL_MS = 300;
+const int SEND_QUIET_MS = 800;          //事件停止这么久后发送
+const int SEND_MAX_DELAY_MS = 3000;     //持续有事件时最长等待
+const int SEND_MAX_BATCH = 500;         //攒够这么多立即发送
+const int POLL_TIMEOUT_MS = 500;
+
+}  // namespace
 
 FileInotify::FileInotify(QObject *parent): QThread(parent)
 {
@@ -29,12 +44,17 @@ FileInotify::FileInotify(QObject *parent): QThread(parent)
 
     m_timer = new QTimer();
     connect(m_timer, &QTimer::timeout, this, &FileInotify::onNeedSendPictures);
-    m_timer->start(1500);
+    m_timer->start(SEND_CHECK_INTERVAL_MS);
 }
 
 FileInotify::~FileInotify()
 {
+    requestInterruption();
+    wait();
     clear();
+    if (m_handleId != -1) {
+        close(m_handleId);
+    }
 }
 
 bool FileInotify::isVaild()
@@ -47,24 +67,20 @@ void FileInotify::addWather(const QString &paths)
     if (m_handleId < 0)
         return;
 
-    QMutexLocker loker(&m_mutex);
-    if (!isVaild())
-        return;
-    QFileInfo info(paths);
-    if (!info.exists() || !info.isDir()) {
-        return;
-    }
-    m_currentDir = paths + "/";
-
-    std::string str = m_currentDir.toStdString();
-    const char *path = str.data();
-
-    m_wd = inotify_add_watch(m_handleId, path, IN_MODIFY);
-    if (m_wd == -1) {
-        qDebug() << " inotify_add_watch failed";
-        return;
+    {
+        QMutexLocker loker(&m_mutex);
+        if (!isVaild())
+            return;
+        QFileInfo info(paths);
+        if (!info.exists() || !info.isDir()) {
+            return;
+        }
+        m_currentDir = paths + "/";
+        if (!watchDirLocked(paths)) {
+            return;
+        }
+        m_wd = watchedDirId.value(paths);
     }
-    watchedDirId.insert(paths, m_wd);
 
     if (!m_running) {
         m_running = true;
@@ -78,25 +94,21 @@ void FileInotify::removeWatcher(const QString &path)
     QMutexLocker loker(&m_mutex);
     if (!isVaild())
         return;
-    auto it = watchedDirId.find(path);
-    if (it != watchedDirId.end()) {
-        inotify_rm_watch(m_handleId, it.value());
-        watchedDirId.erase(it);
-    }
+    unwatchTreeLocked(path);
 }
 
 void FileInotify::clear()
 {
+    QMutexLocker loker(&m_mutex);
     m_allPic.clear();
-    m_Supported.clear();
     m_newFile.clear();
     m_Supported.clear();
-    QMutexLocker loker(&m_mutex);
     for (auto it : watchedDirId) {
         inotify_rm_watch(m_handleId, it);
     }
     watchedDirId.clear();
-    if (m_timer->isActive()) {
+    m_wdDir.clear();
+    if (m_timer && m_timer->isActive()) {
         m_timer->stop();
         delete m_timer;
         m_timer = nullptr;
@@ -105,37 +117,250 @@ void FileInotify::clear()
 
 void FileInotify::getAllPicture(bool isFirst)
 {
-    QDir dir(m_currentDir);
-    if (!dir.exists()) {
+    //初次加载走目录快照，之后只在事件队列溢出时重新扫描已监控目录
+    if (isFirst) {
+        loadFromSnapshot();
         return;
     }
-    dir.setFilter(QDir::Files); //设置类型过滤器，只为文件格式
-    unsigned int dir_count = dir.count();
-    if (dir_count <= 0) {
+    QMutexLocker loker(&m_mutex);
+    rescanWatchedLocked();
+}
+
+void FileInotify::loadFromSnapshot()
+{
+    QMutexLocker loker(&m_mutex);
+    if (m_currentDir.isEmpty()) {
         return;
     }
-    QFileInfoList list = dir.entryInfoList();
+    DirSnapshot snapshot(m_Supported);
+    const QString snapshotFile = DirSnapshot::snapshotFile(m_currentDir);
+    //没有快照(首次启动或快照损坏)时全部文件都需要与图库比对
+    const bool hasSnapshot = snapshot.load(snapshotFile);
+    DirSnapshot::Changes changes;
+    const QStringList files = snapshot.rescan(m_currentDir, &changes);
+    //子目录也加入监控
+    for (const QString &dir : snapshot.dirs()) {
+        watchDirLocked(dir);
+    }
 
-    //筛选出新增图片文件
-    for (auto fileinfo : list) {
-        if (m_Supported.contains(fileinfo.suffix().toUpper())) {
-            QString filename = fileinfo.fileName();
-            filename = m_currentDir + filename;
-            if (!m_allPic.contains(filename)) {
-                m_allPic << filename;
-                m_newFile << filename;
+    //目录mtime未变时rescan不会列目录，只有上次退出后新增的文件需要判重
+    QStringList candidates;
+    for (const QString &file : files) {
+        if (!m_allPic.contains(file)) {
+            m_allPic << file;
+            if (!hasSnapshot) {
+                candidates << file;
             }
         }
     }
-    //初次导入，判重
-    if (isFirst) {
-        QStringList allpaths = DBManager::instance()->getAllPaths();
-        for (int i = 0; i < m_allPic.size(); i++) {
-            if (allpaths.contains(m_allPic.at(i))) {
-                m_newFile.removeOne(m_allPic.at(i));
+    if (hasSnapshot) {
+        candidates = changes.added;
+    }
+    if (!candidates.isEmpty()) {
+        //初次导入，判重
+        PhotoCatalog *catalog = PhotoCatalog::instance();
+        if (!catalog->isLoaded()) {
+            catalog->load();
+        }
+        const QVector<bool> imported = catalog->contains(candidates);
+        for (int i = 0; i < candidates.size(); i++) {
+            if (!imported.at(i)) {
+                if (m_newFile.isEmpty()) {
+                    m_firstPending.start();
+                }
+                m_newFile << candidates.at(i);
+                m_lastEvent.start();
+            }
+        }
+    }
+
+    //待导入的照片发送之后才保存快照，否则中途退出时这些照片下次不会再被检出
+    if (m_newFile.isEmpty()) {
+        snapshot.save(snapshotFile);
+    } else {
+        m_pendingSnapshot = snapshot;
+        m_snapshotPending = true;
+    }
+}
+
+bool FileInotify::isSupported(const QString &name) const
+{
+    const int dot = name.lastIndexOf('.');
+    return dot >= 0 && m_Supported.contains(name.mid(dot + 1).toUpper());
+}
+
+bool FileInotify::watchDirLocked(const QString &dir)
+{
+    if (watchedDirId.contains(dir)) {
+        return true;
+    }
+    const int wd = inotify_add_watch(m_handleId, QFile::encodeName(dir).constData(), MASK);
+    if (wd == -1) {
+        //多半是达到了max_user_watches上限
+        qDebug() << " inotify_add_watch failed" << dir;
+        return false;
+    }
+    watchedDirId.insert(dir, wd);
+    m_wdDir.insert(wd, dir);
+    return true;
+}
+
+void FileInotify::watchTreeLocked(const QString &dir, bool collectFiles)
+{
+    //先加监控再列目录，期间新建的文件要么被扫描到要么产生事件，m_allPic保证不会重复
+    QStringList dirs;
+    dirs << dir;
+    while (!dirs.isEmpty()) {
+        const QString current = dirs.takeLast();
+        if (!watchDirLocked(current)) {
+            continue;
+        }
+        if (collectFiles) {
+            scanDirLocked(current);
+        }
+        const QStringList subDirs = QDir(current).entryList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks);
+        for (const QString &sub : subDirs) {
+            dirs << current + "/" + sub;
+        }
+    }
+}
+
+void FileInotify::unwatchTreeLocked(const QString &dir)
+{
+    const QString prefix = dir + "/";
+    for (auto it = watchedDirId.begin(); it != watchedDirId.end();) {
+        if (it.key() == dir || it.key().startsWith(prefix)) {
+            inotify_rm_watch(m_handleId, it.value());
+            m_wdDir.remove(it.value());
+            it = watchedDirId.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = m_allPic.begin(); it != m_allPic.end();) {
+        if (it->startsWith(prefix)) {
+            m_newFile.removeAll(*it);
+            it = m_allPic.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void FileInotify::scanDirLocked(const QString &dir)
+{
+    const QStringList names = QDir(dir).entryList(QDir::Files);
+    for (const QString &name : names) {
+        if (isSupported(name)) {
+            addFileLocked(dir + "/" + name);
+        }
+    }
+}
+
+void FileInotify::rescanWatchedLocked()
+{
+    //先按磁盘现状去掉已删除或移走的照片，只处理已监控目录中的，再补上新增的
+    QSet<QString> present;
+    QStringList newDirs;
+    for (auto it = watchedDirId.cbegin(); it != watchedDirId.cend(); ++it) {
+        const QDir dir(it.key());
+        for (const QString &name : dir.entryList(QDir::Files)) {
+            if (isSupported(name)) {
+                present.insert(it.key() + "/" + name);
+            }
+        }
+        for (const QString &sub : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks)) {
+            const QString subDir = it.key() + "/" + sub;
+            if (!watchedDirId.contains(subDir)) {
+                newDirs << subDir;
             }
         }
     }
+    for (auto it = m_allPic.begin(); it != m_allPic.end();) {
+        if (!present.contains(*it) && watchedDirId.contains(it->left(it->lastIndexOf('/')))) {
+            m_newFile.removeAll(*it);
+            it = m_allPic.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (const QString &path : present) {
+        addFileLocked(path);
+    }
+    //溢出期间新建的子目录没有收到事件，补上监控
+    for (const QString &dir : newDirs) {
+        watchTreeLocked(dir, true);
+    }
+}
+
+void FileInotify::addFileLocked(const QString &path)
+{
+    if (m_allPic.contains(path)) {
+        return;
+    }
+    m_allPic.insert(path);
+    if (m_newFile.isEmpty()) {
+        m_firstPending.start();
+    }
+    m_newFile << path;
+    m_lastEvent.start();
+}
+
+void FileInotify::removeFileLocked(const QString &path)
+{
+    if (m_allPic.remove(path)) {
+        m_newFile.removeAll(path);
+    }
+}
+
+void FileInotify::handleEventLocked(const inotify_event *event)
+{
+    //内核队列溢出，丢失的事件无法得知属于哪个目录，重新扫描已监控的目录
+    if (event->mask & IN_Q_OVERFLOW) {
+        qDebug() << "inotify queue overflow, rescan watched dirs";
+        rescanWatchedLocked();
+        return;
+    }
+    const QString dir = m_wdDir.value(event->wd);
+    if (dir.isEmpty()) {
+        return;
+    }
+    //监控已被内核移除(目录删除或所在设备卸载)
+    if (event->mask & IN_IGNORED) {
+        watchedDirId.remove(dir);
+        m_wdDir.remove(event->wd);
+        return;
+    }
+    //目录自身被删除或移走，移到监控范围内的部分会以IN_MOVED_TO重新加入
+    if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+        unwatchTreeLocked(dir);
+        return;
+    }
+    if (event->len == 0) {
+        return;
+    }
+    const QString name = QFile::decodeName(event->name);
+    if (name.startsWith('.')) {
+        return;
+    }
+    const QString path = dir + "/" + name;
+    if (event->mask & IN_ISDIR) {
+        if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+            watchTreeLocked(path, true);
+        } else if (event->mask & IN_MOVED_FROM) {
+            unwatchTreeLocked(path);
+        }
+        return;
+    }
+    if (!isSupported(name)) {
+        return;
+    }
+    //IN_CREATE时文件可能还在写入，等IN_CLOSE_WRITE再导入
+    if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+        addFileLocked(path);
+    } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+        removeFileLocked(path);
+    }
 }
 
 //void FileInotify::fileNumChange()
@@ -170,27 +395,60 @@ void FileInotify::pathLoadOnce()
 
 void FileInotify::onNeedSendPictures()
 {
-    //发送导入
-    if (m_newFile.size() > 0) {
-        emit dApp->signalM->sigMonitorChanged(m_newFile);
-        m_newFile.clear();
+    //合并发送：事件停歇、等待过久或攒够一批时才发送导入
+    QStringList newFile;
+    DirSnapshot snapshot;
+    QString snapshotFile;
+    {
+        QMutexLocker loker(&m_mutex);
+        if (m_newFile.isEmpty()) {
+            return;
+        }
+        if (m_lastEvent.elapsed() < SEND_QUIET_MS && m_firstPending.elapsed() < SEND_MAX_DELAY_MS
+                && m_newFile.size() < SEND_MAX_BATCH) {
+            return;
+        }
+        newFile.swap(m_newFile);
+        if (m_snapshotPending) {
+            snapshot = m_pendingSnapshot;
+            snapshotFile = DirSnapshot::snapshotFile(m_currentDir);
+            m_pendingSnapshot = DirSnapshot();
+            m_snapshotPending = false;
+        }
+    }
+    emit dApp->signalM->sigMonitorChanged(newFile);
+    if (!snapshotFile.isEmpty()) {
+        snapshot.save(snapshotFile);
     }
 }
 
 void FileInotify::run()
 {
-    int len, nread;
-    char buf[1024];
-    inotify_event *event;
-    len = static_cast<int>(read(m_handleId, buf, sizeof(buf) - 1));
-    while ((len = static_cast<int>(read(m_handleId, buf, sizeof(buf) - 1))) > 0) {
-        nread = 0;
-        while (len > 0) {
-            event = (inotify_event *)&buf[nread];
-            nread = nread + static_cast<int>(sizeof(inotify_event) + event->len);
-            len = len - static_cast<int>(sizeof(inotify_event) + event->len);
-            qDebug() << " need to get new file" <<  event->mask;
-            getAllPicture(false);
+    //一次读取尽量多的事件，按事件中的文件名增量处理，不再整目录重扫
+    //poll带超时，析构时请求中断后线程能及时退出
+    alignas(inotify_event) char buf[64 * 1024];
+    struct pollfd pfd = {m_handleId, POLLIN, 0};
+    while (!isInterruptionRequested()) {
+        const int ready = poll(&pfd, 1, POLL_TIMEOUT_MS);
+        if (ready == 0 || (ready < 0 && errno == EINTR)) {
+            continue;
+        }
+        if (ready < 0) {
+            break;
+        }
+        const ssize_t len = read(m_handleId, buf, sizeof(buf));
+        //被信号打断时重试，其余错误或描述符关闭时退出
+        if (len < 0 && errno == EINTR) {
+            continue;
+        }
+        if (len <= 0) {
+            break;
+        }
+        QMutexLocker loker(&m_mutex);
+        for (char *ptr = buf; ptr < buf + len;) {
+            const inotify_event *event = reinterpret_cast<const inotify_event *>(ptr);
+            handleEventLocked(event);
+            ptr += sizeof(inotify_event) + event->len;
         }
     }
 }
@@ -5,8 +5,20 @@
 #include <QObject>
 #include <QMutex>
 #include <QMap>
+#include <QHash>
+#include <QSet>
 #include <QTimer>
+#include <QElapsedTimer>
 
+#include "utils/dirsnapshot.h"
+
+struct inotify_event;
+
+/**
+ * @brief The FileInotify class
+ * 递归监控固定文件夹，按事件中的文件名增量维护照片列表，新增照片合并后批量发出sigMonitorChanged。
+ * 内核事件队列溢出时只重新扫描已监控的目录。
+ */
 class FileInotify : public QThread
 {
     Q_OBJECT
@@ -20,7 +32,7 @@ public:
     void removeWatcher(const QString &path);
 
     void clear();
-    //获取监控目录所有照片
+    //获取监控目录所有照片：isFirst为启动时按快照加载，否则重新扫描全部已监控目录
     void getAllPicture(bool isFirst);
     //文件数量改变
 //    void fileNumChange(); //预留，暂未使用
@@ -34,17 +46,40 @@ public slots:
 protected:
     void run() override;
 
+    //以下函数需持有m_mutex；事件处理对子类可见，便于注入构造的事件
+    void handleEventLocked(const inotify_event *event);
+    bool watchDirLocked(const QString &dir);
+    //监控dir及其全部子目录，collectFiles为true时同时收集其中的照片
+    void watchTreeLocked(const QString &dir, bool collectFiles);
+    void unwatchTreeLocked(const QString &dir);
+    void scanDirLocked(const QString &dir);
+    //重新列出全部已监控目录：补上新增的照片和子目录，去掉已不存在的照片
+    void rescanWatchedLocked();
+    void addFileLocked(const QString &path);
+    void removeFileLocked(const QString &path);
+
+    QMutex m_mutex;
+    QMap<QString, int> watchedDirId;
+    QHash<int, QString> m_wdDir;    //监控描述符对应的目录
+    QSet<QString> m_allPic;     //目前所有照片
+    QStringList m_newFile;      //当前新添加的，等待合并发送
+
 private:
+    //按上次保存的目录快照找出退出期间新增的照片
+    void loadFromSnapshot();
+    bool isSupported(const QString &name) const;
+
     int  m_handleId = -1;
     int m_wd = -1;
     bool m_running = false;
-    QMutex m_mutex;
-    QMap<QString, int> watchedDirId;
-    QStringList m_allPic;       //目前所有照片
-    QStringList m_newFile;      //当前新添加的
+    QElapsedTimer m_firstPending;   //最早一个未发送照片的时间
+    QElapsedTimer m_lastEvent;      //最近一次新增照片的时间
     QString m_currentDir;       //给定的当前监控路径
     QStringList  m_Supported;   //支持的格式
     QTimer *m_timer;
+    //启动时检出的照片发送导入后再保存的目录快照
+    DirSnapshot m_pendingSnapshot;
+    bool m_snapshotPending = false;
 };
 
 #endif // FILEINOTIFY_H
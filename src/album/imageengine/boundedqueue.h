@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QList>
+
+/**
+ * @brief The BoundedQueue class
+ * 导入流水线各阶段之间的有界队列：满时阻塞生产者，空时阻塞消费者。
+ * close()表示生产结束，消费者取完剩余数据后退出；abort()用于取消，丢弃数据并唤醒所有等待者。
+ */
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(int capacity)
+        : m_capacity(capacity > 0 ? capacity : 1)
+    {
+    }
+
+    //队列已关闭或已取消时返回false
+    bool push(const T &item)
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_queue.size() >= m_capacity && !m_closed && !m_aborted) {
+            m_notFull.wait(&m_mutex);
+        }
+        if (m_closed || m_aborted) {
+            return false;
+        }
+        m_queue.enqueue(item);
+        m_notEmpty.wakeOne();
+        return true;
+    }
+
+    //队列已取消，或已关闭且取空时返回false
+    bool pop(T &item)
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_queue.isEmpty() && !m_closed && !m_aborted) {
+            m_notEmpty.wait(&m_mutex);
+        }
+        if (m_aborted || m_queue.isEmpty()) {
+            return false;
+        }
+        item = m_queue.dequeue();
+        m_notFull.wakeOne();
+        return true;
+    }
+
+    //最多等待timeoutMs，取出至多maxCount个；超时返回true但items可能为空
+    bool popBatch(QList<T> &items, int maxCount, unsigned long timeoutMs)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_queue.isEmpty() && !m_closed && !m_aborted) {
+            m_notEmpty.wait(&m_mutex, timeoutMs);
+        }
+        if (m_aborted) {
+            return false;
+        }
+        if (m_queue.isEmpty()) {
+            return !m_closed;
+        }
+        while (!m_queue.isEmpty() && items.size() < maxCount) {
+            items << m_queue.dequeue();
+        }
+        m_notFull.wakeAll();
+        return true;
+    }
+
+    void close()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_closed = true;
+        m_notEmpty.wakeAll();
+        m_notFull.wakeAll();
+    }
+
+    void abort()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_aborted = true;
+        m_queue.clear();
+        m_notEmpty.wakeAll();
+        m_notFull.wakeAll();
+    }
+
+    bool isAborted() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_aborted;
+    }
+
+private:
+    const int m_capacity;
+    mutable QMutex m_mutex;
+    QWaitCondition m_notFull;
+    QWaitCondition m_notEmpty;
+    QQueue<T> m_queue;
+    bool m_closed = false;
+    bool m_aborted = false;
+};
+
+#endif // BOUNDEDQUEUE_H
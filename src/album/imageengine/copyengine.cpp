@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "copyengine.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QDebug>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+namespace {
+
+const int COPY_IN_FLIGHT = 4;
+const qint64 COPY_CHUNK_SIZE = 8 * 1024 * 1024;    //每次内核复制的字节数，期间检查取消
+const int COPY_BUFFER_SIZE = 1024 * 1024;          //无法内核复制时的读写缓冲
+
+bool writeAll(int fd, const char *data, ssize_t size)
+{
+    while (size > 0) {
+        const ssize_t n = write(fd, data, static_cast<size_t>(size));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+}  // namespace
+
+CopyEngine::CopyEngine(const QString &targetDir, const QString &journalFile)
+    : m_targetDir(targetDir)
+    , m_journalFile(journalFile)
+    , m_inFlight(COPY_IN_FLIGHT)
+{
+    QDir().mkpath(m_targetDir);
+    loadJournal();
+    m_timer.start();
+}
+
+CopyEngine::~CopyEngine()
+{
+    QMutexLocker locker(&m_journalMutex);
+    if (m_journal.isOpen()) {
+        m_journal.close();
+    }
+}
+
+void CopyEngine::setInFlight(int count)
+{
+    m_inFlight = qMax(1, count);
+}
+
+QString CopyEngine::defaultJournal()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/deepin/deepin-album/import.journal";
+}
+
+bool CopyEngine::copyFile(const QString &source, const QString &target, const QAtomicInt *canceled, qint64 *copied)
+{
+    const int in = open(QFile::encodeName(source).constData(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+        return false;
+    }
+    struct stat st;
+    if (0 != fstat(in, &st) || !S_ISREG(st.st_mode)) {
+        close(in);
+        return false;
+    }
+    posix_fadvise(in, 0, 0, POSIX_FADV_SEQUENTIAL);
+    //先写到同目录的隐藏临时文件，校验通过后再改名，监控和扫描都不会看到半个文件
+    const int slash = target.lastIndexOf('/');
+    const QByteArray part = QFile::encodeName(target.left(slash + 1) + "." + target.mid(slash + 1) + ".part");
+    const int out = open(part.constData(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out < 0) {
+        close(in);
+        return false;
+    }
+
+    enum { CopyRange, SendFile, ReadWrite } mode = CopyRange;
+    const qint64 size = st.st_size;
+    qint64 done = 0;
+    QByteArray buffer;
+    bool ok = true;
+    while (done < size) {
+        if (canceled && canceled->load()) {
+            ok = false;
+            break;
+        }
+        const size_t chunk = static_cast<size_t>(qMin(size - done, COPY_CHUNK_SIZE));
+        ssize_t n = -1;
+        if (CopyRange == mode) {
+            n = syscall(SYS_copy_file_range, in, nullptr, out, nullptr, chunk, 0u);
+            //跨文件系统(如gvfs/MTP)或内核不支持时退回sendfile，只在开头判断，之后的错误是真错误
+            if (n <= 0 && 0 == done) {
+                mode = SendFile;
+                continue;
+            }
+        } else if (SendFile == mode) {
+            n = sendfile(out, in, nullptr, chunk);
+            if (n < 0 && 0 == done && (errno == EINVAL || errno == ENOSYS)) {
+                mode = ReadWrite;
+                continue;
+            }
+        } else {
+            if (buffer.isEmpty()) {
+                buffer.resize(COPY_BUFFER_SIZE);
+            }
+            n = read(in, buffer.data(), qMin(chunk, static_cast<size_t>(buffer.size())));
+            if (n > 0 && !writeAll(out, buffer.constData(), n)) {
+                n = -1;
+            }
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        //0表示源文件变短，视为失败
+        if (n <= 0) {
+            ok = false;
+            break;
+        }
+        done += n;
+    }
+    close(in);
+
+    //校验写入的大小与源文件一致
+    struct stat outSt;
+    ok = ok && done == size && 0 == fstat(out, &outSt) && outSt.st_size == size;
+    ok = (0 == close(out)) && ok;
+    if (ok) {
+        const QByteArray dst = QFile::encodeName(target);
+        //link不会覆盖已存在的文件；不支持硬链接的文件系统退回rename
+        if (0 == link(part.constData(), dst.constData())) {
+            unlink(part.constData());
+        } else if (errno == EEXIST) {
+            ok = false;
+        } else if (0 == access(dst.constData(), F_OK) || 0 != rename(part.constData(), dst.constData())) {
+            ok = false;
+        }
+    }
+    if (!ok) {
+        unlink(part.constData());
+        return false;
+    }
+    if (copied) {
+        *copied = done;
+    }
+    return true;
+}
+
+QString CopyEngine::journalKey(const QString &source, qint64 size, qint64 mtime) const
+{
+    return QString("%1:%2:%3").arg(source).arg(size).arg(mtime);
+}
+
+QString CopyEngine::newTargetPath(const QString &source)
+{
+    //与原有命名一致：文件名 + 毫秒时间戳 + 后缀，重名时再加序号
+    const QString fileName = source.mid(source.lastIndexOf('/') + 1);
+    const QStringList nameList = fileName.split(".", QString::SkipEmptyParts);
+    const QString stem = nameList.isEmpty() ? QString("image") : nameList.first();
+    const QString suffix = nameList.size() > 1 ? "." + nameList.last() : QString();
+    const QString base = QString("%1/%2%3").arg(m_targetDir, stem, QString::number(QDateTime::currentDateTime().toMSecsSinceEpoch()));
+    QString target = base + suffix;
+    //并行复制时同名文件可能在同一毫秒生成，已分配但尚未写入的名字也要避开
+    for (int i = 1; QFileInfo::exists(target) || m_reserved.contains(target); i++) {
+        target = QString("%1_%2%3").arg(base).arg(i).arg(suffix);
+    }
+    m_reserved.insert(target);
+    return target;
+}
+
+void CopyEngine::loadJournal()
+{
+    QFile journal(m_journalFile);
+    if (!journal.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    while (!journal.atEnd()) {
+        const QByteArray line = journal.readLine().trimmed();
+        const int tab = line.indexOf('\t');
+        if (tab <= 0) {
+            continue;
+        }
+        const QString key = QString::fromUtf8(QByteArray::fromPercentEncoding(line.left(tab)));
+        const QString target = QString::fromUtf8(QByteArray::fromPercentEncoding(line.mid(tab + 1)));
+        m_done.insert(key, target);
+    }
+    if (!m_done.isEmpty()) {
+        qDebug() << "resume device import," << m_done.size() << "files copied before";
+    }
+}
+
+void CopyEngine::appendJournal(const QString &key, const QString &target)
+{
+    QMutexLocker locker(&m_journalMutex);
+    if (!m_journal.isOpen()) {
+        QDir().mkpath(QFileInfo(m_journalFile).path());
+        m_journal.setFileName(m_journalFile);
+        if (!m_journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            return;
+        }
+    }
+    m_journal.write(key.toUtf8().toPercentEncoding() + '\t' + target.toUtf8().toPercentEncoding() + '\n');
+    m_journal.flush();
+    m_done.insert(key, target);
+}
+
+CopyEngine::Item CopyEngine::copyOne(const QString &source)
+{
+    Item item;
+    item.source = source;
+    struct stat st;
+    if (0 != stat(QFile::encodeName(source).constData(), &st) || !S_ISREG(st.st_mode)) {
+        return item;
+    }
+    item.size = st.st_size;
+    const QString key = journalKey(source, item.size, st.st_mtim.tv_sec);
+    QString target;
+    {
+        QMutexLocker locker(&m_journalMutex);
+        target = m_done.value(key);
+    }
+    //上次已复制且目标文件完整，直接使用
+    if (!target.isEmpty() && QFileInfo(target).size() == item.size) {
+        item.target = target;
+        item.ok = true;
+        item.resumed = true;
+        return item;
+    }
+    {
+        QMutexLocker locker(&m_journalMutex);
+        target = newTargetPath(source);
+    }
+    qint64 copied = 0;
+    if (!copyFile(source, target, &m_canceled, &copied)) {
+        return item;
+    }
+    item.target = target;
+    item.ok = true;
+    m_bytes.fetchAndAddRelaxed(copied);
+    m_files.ref();
+    appendJournal(key, target);
+    return item;
+}
+
+bool CopyEngine::run(const QStringList &sources, const std::function<bool(const Item &)> &onCopied)
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(m_inFlight);
+    QAtomicInt next(0);
+    for (int i = 0; i < m_inFlight; i++) {
+        QtConcurrent::run(&pool, [ &, this]() {
+            forever {
+                const int index = next.fetchAndAddOrdered(1);
+                if (index >= sources.size() || isCanceled()) {
+                    break;
+                }
+                const Item item = copyOne(sources.at(index));
+                if (onCopied && !onCopied(item)) {
+                    cancel();
+                }
+            }
+        });
+    }
+    pool.waitForDone();
+    qDebug() << "device import copied" << filesCopied() << "files," << mbPerSecond() << "MB/s," << filesPerSecond() << "files/s";
+    return !isCanceled();
+}
+
+void CopyEngine::cancel()
+{
+    m_canceled.storeRelease(1);
+}
+
+bool CopyEngine::isCanceled() const
+{
+    return m_canceled.loadAcquire();
+}
+
+void CopyEngine::finish()
+{
+    QMutexLocker locker(&m_journalMutex);
+    if (m_journal.isOpen()) {
+        m_journal.close();
+    }
+    QFile::remove(m_journalFile);
+    m_done.clear();
+}
+
+qint64 CopyEngine::bytesCopied() const
+{
+    return m_bytes.load();
+}
+
+int CopyEngine::filesCopied() const
+{
+    return m_files.load();
+}
+
+double CopyEngine::mbPerSecond() const
+{
+    const qint64 ms = qMax<qint64>(1, m_timer.elapsed());
+    return bytesCopied() / (1024.0 * 1024.0) / (ms / 1000.0);
+}
+
+double CopyEngine::filesPerSecond() const
+{
+    const qint64 ms = qMax<qint64>(1, m_timer.elapsed());
+    return filesCopied() / (ms / 1000.0);
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef COPYENGINE_H
+#define COPYENGINE_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QSet>
+#include <QFile>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+
+#include <functional>
+
+/**
+ * @brief The CopyEngine class
+ * 从外接设备导入时把图片复制到本地目录。
+ * 优先使用copy_file_range/sendfile在内核中复制，多个文件同时进行，复制完校验大小后再改名为目标文件。
+ * 每复制完成一个文件记入日志，导入中断后再次导入同一设备时跳过已复制的文件，全部完成后删除日志。
+ */
+class CopyEngine
+{
+public:
+    struct Item {
+        QString source;
+        QString target;
+        qint64 size = 0;
+        bool ok = false;
+        bool resumed = false;   //上次导入已复制，本次未再复制
+    };
+
+    explicit CopyEngine(const QString &targetDir, const QString &journalFile = defaultJournal());
+    ~CopyEngine();
+
+    //同时复制的文件数
+    void setInFlight(int count);
+
+    //并行复制sources，每个文件复制完成后即在复制线程中调用onCopied(可能并发调用)，
+    //以便直接进入元数据读取；onCopied返回false或cancel()时停止，返回是否全部处理完
+    bool run(const QStringList &sources, const std::function<bool(const Item &)> &onCopied);
+    //复制单个文件，可在多个线程中同时调用
+    Item copyOne(const QString &source);
+    void cancel();
+    bool isCanceled() const;
+    //导入正常结束后调用，删除续传日志
+    void finish();
+
+    qint64 bytesCopied() const;
+    int filesCopied() const;
+    double mbPerSecond() const;
+    double filesPerSecond() const;
+
+    //复制到target，失败时不留下target；copied返回实际复制的字节数
+    static bool copyFile(const QString &source, const QString &target,
+                         const QAtomicInt *canceled = nullptr, qint64 *copied = nullptr);
+    static QString defaultJournal();
+
+private:
+    QString journalKey(const QString &source, qint64 size, qint64 mtime) const;
+    //需持有m_journalMutex
+    QString newTargetPath(const QString &source);
+    void loadJournal();
+    void appendJournal(const QString &key, const QString &target);
+
+    QString m_targetDir;
+    QString m_journalFile;
+    int m_inFlight;
+    QMutex m_journalMutex;
+    QFile m_journal;
+    QHash<QString, QString> m_done;         //续传日志：源文件(路径、大小、mtime) -> 已复制的目标
+    QSet<QString> m_reserved;               //已分配的目标文件名
+    QAtomicInt m_canceled;
+    QAtomicInteger<qint64> m_bytes;
+    QAtomicInt m_files;
+    QElapsedTimer m_timer;
+};
+
+#endif // COPYENGINE_H
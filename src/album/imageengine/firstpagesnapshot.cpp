@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "firstpagesnapshot.h"
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QPainter>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+
+namespace {
+const quint32 SNAPSHOT_MAGIC = 0x41465053;      //"AFPS"
+const quint32 SNAPSHOT_VERSION = 1;
+//与缓存缩略图一致，短边不超过200
+const int THUMBNAIL_SIZE = 200;
+const int ATLAS_WIDTH = 2048;
+const int ATLAS_JPEG_QUALITY = 90;
+}
+
+FirstPageSnapshot::FirstPageSnapshot()
+{
+}
+
+void FirstPageSnapshot::append(const DBImgInfo &info, const QImage &thumbnail)
+{
+    Entry entry;
+    entry.info = info;
+    QImage image = thumbnail;
+    if (!image.isNull()) {
+        if (qMin(image.width(), image.height()) > THUMBNAIL_SIZE) {
+            image = image.width() > image.height() ? image.scaledToHeight(THUMBNAIL_SIZE, Qt::SmoothTransformation)
+                    : image.scaledToWidth(THUMBNAIL_SIZE, Qt::SmoothTransformation);
+        }
+        if (image.width() > ATLAS_WIDTH) {
+            image = image.scaledToWidth(ATLAS_WIDTH, Qt::SmoothTransformation);
+        }
+        //当前行放不下时换行
+        if (m_shelfX + image.width() > ATLAS_WIDTH) {
+            m_shelfY += m_shelfHeight;
+            m_shelfX = 0;
+            m_shelfHeight = 0;
+        }
+        entry.rect = QRect(m_shelfX, m_shelfY, image.width(), image.height());
+        m_shelfX += image.width();
+        m_shelfHeight = qMax(m_shelfHeight, image.height());
+        m_atlasWidth = qMax(m_atlasWidth, m_shelfX);
+    }
+    m_entries << entry;
+    m_images << image;
+}
+
+void FirstPageSnapshot::setGeometry(const QSize &windowSize, int zoomLevel)
+{
+    m_windowSize = windowSize;
+    m_zoomLevel = zoomLevel;
+}
+
+QSize FirstPageSnapshot::windowSize() const
+{
+    return m_windowSize;
+}
+
+int FirstPageSnapshot::zoomLevel() const
+{
+    return m_zoomLevel;
+}
+
+bool FirstPageSnapshot::matches(const QSize &windowSize, int zoomLevel) const
+{
+    return m_windowSize == windowSize && m_zoomLevel == zoomLevel;
+}
+
+int FirstPageSnapshot::count() const
+{
+    return m_entries.size();
+}
+
+bool FirstPageSnapshot::isEmpty() const
+{
+    return m_entries.isEmpty();
+}
+
+const DBImgInfo &FirstPageSnapshot::info(int index) const
+{
+    return m_entries.at(index).info;
+}
+
+QImage FirstPageSnapshot::thumbnail(int index) const
+{
+    const QRect &rect = m_entries.at(index).rect;
+    if (rect.isEmpty()) {
+        return QImage();
+    }
+    if (index < m_images.size()) {
+        return m_images.at(index);
+    }
+    return m_atlas.copy(rect);
+}
+
+QImage FirstPageSnapshot::buildAtlas() const
+{
+    if (m_atlasWidth <= 0) {
+        return QImage();
+    }
+    bool alpha = false;
+    for (const QImage &image : m_images) {
+        alpha = alpha || image.hasAlphaChannel();
+    }
+    QImage atlas(m_atlasWidth, m_shelfY + m_shelfHeight, alpha ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+    atlas.fill(alpha ? Qt::transparent : Qt::white);
+    QPainter painter(&atlas);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    for (int i = 0; i < m_entries.size(); i++) {
+        if (!m_entries.at(i).rect.isEmpty()) {
+            painter.drawImage(m_entries.at(i).rect.topLeft(), m_images.at(i));
+        }
+    }
+    painter.end();
+    return atlas;
+}
+
+bool FirstPageSnapshot::load(const QString &file)
+{
+    m_entries.clear();
+    m_images.clear();
+    m_atlas = QImage();
+    QFile f(file);
+    if (!f.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&f);
+    quint32 magic = 0, version = 0;
+    in >> magic >> version;
+    if (magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION) {
+        return false;
+    }
+    qint32 zoomLevel = -1;
+    quint32 count = 0;
+    in >> m_windowSize >> zoomLevel >> count;
+    m_zoomLevel = zoomLevel;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+        Entry entry;
+        in >> entry.info.filePath >> entry.info.fileName >> entry.info.dirHash
+           >> entry.info.time >> entry.info.changeTime >> entry.info.importTime >> entry.rect;
+        m_entries << entry;
+    }
+    QByteArray atlasData;
+    in >> atlasData;
+    if (in.status() != QDataStream::Ok) {
+        qDebug() << "broken first page snapshot" << file;
+        m_entries.clear();
+        return false;
+    }
+    //整个首屏只解码这一次
+    if (!atlasData.isEmpty() && !m_atlas.loadFromData(atlasData)) {
+        qDebug() << "broken first page snapshot atlas" << file;
+        m_entries.clear();
+        return false;
+    }
+    return true;
+}
+
+bool FirstPageSnapshot::save(const QString &file) const
+{
+    QDir().mkpath(file.left(file.lastIndexOf('/')));
+    QByteArray atlasData;
+    const QImage atlas = buildAtlas();
+    if (!atlas.isNull()) {
+        QBuffer buffer(&atlasData);
+        buffer.open(QIODevice::WriteOnly);
+        //照片用JPEG保存，体积小、解码快；有透明通道时用PNG
+        if (atlas.hasAlphaChannel()) {
+            atlas.save(&buffer, "PNG");
+        } else {
+            atlas.save(&buffer, "JPG", ATLAS_JPEG_QUALITY);
+        }
+    }
+    //先写临时文件再替换，中途退出不会留下半个快照
+    QSaveFile f(file);
+    if (!f.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream out(&f);
+    out << SNAPSHOT_MAGIC << SNAPSHOT_VERSION << m_windowSize << qint32(m_zoomLevel) << quint32(m_entries.size());
+    for (const Entry &entry : m_entries) {
+        out << entry.info.filePath << entry.info.fileName << entry.info.dirHash
+            << entry.info.time << entry.info.changeTime << entry.info.importTime << entry.rect;
+    }
+    out << atlasData;
+    return f.commit();
+}
+
+QString FirstPageSnapshot::snapshotFile()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+           + "/deepin/deepin-album/snapshots/firstpage.snap";
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef FIRSTPAGESNAPSHOT_H
+#define FIRSTPAGESNAPSHOT_H
+
+#include "dbmanager/dbmanager.h"
+
+#include <QImage>
+#include <QRect>
+#include <QSize>
+#include <QVector>
+
+/**
+ * @brief The FirstPageSnapshot class
+ * 首屏快照：退出时按显示顺序记录所有照片首屏的图片信息、窗口尺寸和缩放级别，
+ * 缩略图按行打包进一张图集，下次启动只需读一个文件、解码一次即可显示首屏，
+ * 不再查询数据库和逐个解码缓存缩略图。快照可能过期，显示后由数据库加载结果核对。
+ */
+class FirstPageSnapshot
+{
+public:
+    FirstPageSnapshot();
+
+    //按显示顺序加入一张缩略图，thumbnail为空时表示损坏或不支持的图片
+    void append(const DBImgInfo &info, const QImage &thumbnail);
+    void setGeometry(const QSize &windowSize, int zoomLevel);
+    QSize windowSize() const;
+    int zoomLevel() const;
+    //窗口尺寸和缩放级别都相同时，快照正好是一屏
+    bool matches(const QSize &windowSize, int zoomLevel) const;
+
+    int count() const;
+    bool isEmpty() const;
+    const DBImgInfo &info(int index) const;
+    QImage thumbnail(int index) const;
+
+    bool load(const QString &file);
+    bool save(const QString &file) const;
+
+    static QString snapshotFile();
+
+private:
+    struct Entry {
+        DBImgInfo info;
+        QRect rect;     //在图集中的位置，空表示没有缩略图
+    };
+    QImage buildAtlas() const;
+
+    QVector<Entry> m_entries;
+    QVector<QImage> m_images;   //append加入、尚未打包的缩略图
+    QImage m_atlas;             //load读入的图集
+    QSize m_windowSize;
+    int m_zoomLevel = -1;
+    //按行打包的当前位置
+    int m_shelfX = 0;
+    int m_shelfY = 0;
+    int m_shelfHeight = 0;
+    int m_atlasWidth = 0;
+};
+
+#endif // FIRSTPAGESNAPSHOT_H
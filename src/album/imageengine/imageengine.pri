@@ -1,9 +1,16 @@
 HEADERS += \
+    $$PWD/boundedqueue.h \
+    $$PWD/copyengine.h \
+    $$PWD/firstpagesnapshot.h \
     $$PWD/imageengineapi.h \
     $$PWD/imageengineobject.h \
-    $$PWD/imageenginethread.h
+    $$PWD/imageenginethread.h \
+    $$PWD/libraryreconciler.h
 
 SOURCES += \
+    $$PWD/copyengine.cpp \
+    $$PWD/firstpagesnapshot.cpp \
     $$PWD/imageengineapi.cpp \
     $$PWD/imageengineobject.cpp \
-    $$PWD/imageenginethread.cpp
+    $$PWD/imageenginethread.cpp \
+    $$PWD/libraryreconciler.cpp
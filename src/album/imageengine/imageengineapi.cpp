@@ -3,14 +3,19 @@
 #include "controller/signalmanager.h"
 #include "application.h"
 #include "imageengineapi.h"
+#include "libraryreconciler.h"
+#include "firstpagesnapshot.h"
+#include "dbmanager/photocatalog.h"
 #include <QMetaType>
 #include <QDirIterator>
 #include <QStandardPaths>
 #include <QSqlDatabase>
 #include <QSqlError>
 #include <QSqlQuery>
+#include <QTimer>
 #include "utils/unionimage.h"
 #include "utils/baseutils.h"
+#include "dbmanager/dbasyncmanager.h"
 
 namespace {
 const QString CACHE_PATH = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
@@ -52,6 +57,15 @@ ImageEngineApi::ImageEngineApi(QObject *parent)
     qRegisterMetaType<ImageDataSt>("ImageDataSt");
     qRegisterMetaType<DBImgInfoList>("DBImgInfoList");
     qRegisterMetaType<QMap<QString, ImageDataSt>>("QMap<QString,ImageDataSt>");
+
+    m_dbRemoveTimer = new QTimer(this);
+    m_dbRemoveTimer->setSingleShot(true);
+    m_dbRemoveTimer->setInterval(200);
+    connect(m_dbRemoveTimer, &QTimer::timeout, this, &ImageEngineApi::sltFlushRemovedImages);
+    m_dbMetaTimer = new QTimer(this);
+    m_dbMetaTimer->setSingleShot(true);
+    m_dbMetaTimer->setInterval(1000);
+    connect(m_dbMetaTimer, &QTimer::timeout, this, &ImageEngineApi::sltFlushImageMetas);
 #ifdef NOGLOBAL
     m_qtpool.setMaxThreadCount(4);
     cacheThreadPool.setMaxThreadCount(4);
@@ -89,13 +103,9 @@ bool ImageEngineApi::ifObjectExist(void *obj)
 
 bool ImageEngineApi::removeImage(QString imagepath)
 {
-    static QStringList dbremovelist;
-    dbremovelist.append(imagepath);
-    if (QThreadPool::globalInstance()->activeThreadCount() < 1) {
-        DBManager::instance()->removeImgInfos(dbremovelist);
-        dbremovelist.clear();
-        emit dApp->signalM->updatePicView(0);
-    }
+    //失效图片先缓存，短时间内的多次删除合并为一次数据库操作
+    m_dbRemoveSet.insert(imagepath);
+    m_dbRemoveTimer->start();
     QMap<QString, ImageDataSt>::iterator it;
     it = m_AllImageData.find(imagepath);
     if (it != m_AllImageData.end()) {
@@ -105,6 +115,53 @@ bool ImageEngineApi::removeImage(QString imagepath)
     return false;
 }
 
+void ImageEngineApi::sltFlushRemovedImages()
+{
+    if (m_dbRemoveSet.isEmpty()) {
+        return;
+    }
+    QSet<QString> removeSet;
+    removeSet.swap(m_dbRemoveSet);
+    //删除在数据库线程执行，完成后在GUI线程只通知一次
+    std::function<DBImgInfoList()> remove = [removeSet]() {
+        DBImgInfoList infos;
+        DBManager::instance()->removeImgInfosNoSignal(removeSet, &infos);
+        return infos;
+    };
+    std::function<void(const DBImgInfoList &)> callback = [](const DBImgInfoList & infos) {
+        if (!infos.isEmpty()) {
+            emit dApp->signalM->imagesRemoved();
+            emit dApp->signalM->imagesRemovedPar(infos);
+        }
+        emit dApp->signalM->updatePicView(0);
+    };
+    DBAsyncManager::instance()->query(this, remove, callback);
+}
+
+void ImageEngineApi::queueImageMetas(const DBImgInfo &info)
+{
+    if (info.width <= 0 && !info.dhash && !info.previewColor) {
+        return;
+    }
+    m_dbMetaUpdates.insert(info.filePath, info);
+    if (!m_dbMetaTimer->isActive()) {
+        m_dbMetaTimer->start();
+    }
+}
+
+void ImageEngineApi::sltFlushImageMetas()
+{
+    if (m_dbMetaUpdates.isEmpty()) {
+        return;
+    }
+    DBImgInfoList infos = m_dbMetaUpdates.values();
+    m_dbMetaUpdates.clear();
+    std::function<void()> update = [infos]() {
+        DBManager::instance()->updateImgMetas(infos);
+    };
+    DBAsyncManager::instance()->future(update);
+}
+
 bool ImageEngineApi::removeImage(QStringList imagepathList)
 {
     for (const auto &imagepath : imagepathList) {
@@ -173,10 +230,17 @@ bool ImageEngineApi::reQuestImageData(QString imagepath, ImageEngineObject *obj,
         return false;
     }
     dynamic_cast<ImageEngineObject *>(obj)->addCheckPath(imagepath);
+    //请求缩略图的都是可见项，优先核对其是否存在
+    LibraryReconciler::instance()->prioritize(imagepath);
     if (ImageLoadStatu_Loaded == data.loaded) {
         dynamic_cast<ImageEngineObject *>(obj)->checkAndReturnPath(imagepath);
     } else if (ImageLoadStatu_PreLoaded == data.loaded) {
-        data.dbi = getDBInfo(imagepath);
+        //快照中的图片已在图库中时不必再读文件
+        if (PhotoCatalog::instance()->contains(imagepath)) {
+            dropCatalogedInfo(imagepath, data);
+        } else {
+            data.dbi = getDBInfo(imagepath);
+        }
         data.loaded = ImageLoadStatu_Loaded;
         m_AllImageData[imagepath] = data;
         //DBManager::instance()->insertImgInfos(DBImgInfoList() << dbi);
@@ -233,7 +297,11 @@ void ImageEngineApi::sltAborted(QString path)
 
 void ImageEngineApi::sltImageLoaded(void *imgobject, QString path, ImageDataSt &data)
 {
-    m_AllImageData[path] = data;
+    //旧版数据库中没有元数据的图片，加载缩略图时顺带回填
+    queueImageMetas(data.dbi);
+    ImageDataSt stored = data;
+    dropCatalogedInfo(path, stored);
+    m_AllImageData[path] = stored;
 //    ImageEngineThread *thread = dynamic_cast<ImageEngineThread *>(sender());
 //    if (nullptr != thread)
 //        thread->needStop(imgobject);
@@ -403,8 +471,11 @@ bool ImageEngineApi::loadImageDateToMemory(QStringList pathlist, QString devName
     return iRet;
 }
 
-void ImageEngineApi::loadFirstPageThumbnails(int num)
+void ImageEngineApi::loadFirstPageThumbnails(int num, const QSize &windowSize, int zoomLevel)
 {
+    if (loadFirstPageSnapshot(num, windowSize, zoomLevel)) {
+        return;
+    }
     thumbnailLoadThread(num);
 
     DBImgInfoList infos;
@@ -429,12 +500,109 @@ void ImageEngineApi::loadFirstPageThumbnails(int num)
             info.changeTime = QDateTime::fromString(query.value(4).toString(), DATETIME_FORMAT_DATABASE);
             info.importTime = QDateTime::fromString(query.value(5).toString(), DATETIME_FORMAT_DATABASE);
             infos << info;
+            m_firstPagePaths << info.filePath;
         }
     }
     emit sigLoad80Thumbnails(infos);
     db.close();
 }
 
+bool ImageEngineApi::loadFirstPageSnapshot(int num, const QSize &windowSize, int zoomLevel)
+{
+    FirstPageSnapshot snapshot;
+    if (!snapshot.load(FirstPageSnapshot::snapshotFile()) || snapshot.isEmpty()) {
+        return false;
+    }
+    //窗口和缩放没变时快照正好一屏，否则按估算的数量取
+    int count = snapshot.count();
+    if (!snapshot.matches(windowSize, zoomLevel) && num > 0) {
+        count = qMin(count, num);
+    }
+    for (int i = 0; i < count; i++) {
+        ImageDataSt data;
+        data.dbi = snapshot.info(i);
+        data.imgpixmap = QPixmap::fromImage(snapshot.thumbnail(i));
+        //与数据库加载的首屏一致，请求时再取最新的数据库信息
+        data.loaded = ImageLoadStatu_PreLoaded;
+        m_AllImageData[data.dbi.filePath] = data;
+        m_firstPagePaths << data.dbi.filePath;
+    }
+    m_80isLoaded = true;
+    emit sigLoad80ThumbnailsToView();
+    reconcileFirstPage(m_firstPagePaths);
+    return true;
+}
+
+void ImageEngineApi::reconcileFirstPage(const QStringList &paths)
+{
+    //快照可能已过期，后台核对快照中的图片是否仍在图库中，不在的从内存中去掉
+    std::function<QStringList()> query = [paths]() {
+        //一次查出快照中仍在图库中的图片
+        QSet<QString> found;
+        for (const DBImgInfo &info : DBManager::instance()->getInfosByPaths(paths)) {
+            found.insert(info.filePath);
+        }
+        QStringList missing;
+        for (const QString &path : paths) {
+            if (!found.contains(path)) {
+                missing << path;
+            }
+        }
+        return missing;
+    };
+    std::function<void(const QStringList &)> callback = [this](const QStringList &missing) {
+        for (const QString &path : missing) {
+            m_firstPagePaths.removeAll(path);
+            ImageDataSt data;
+            //已被重新加载的图片不处理
+            if (getImageData(path, data) && ImageLoadStatu_PreLoaded == data.loaded) {
+                m_AllImageData.remove(path);
+            }
+        }
+    };
+    DBAsyncManager::instance()->query(this, query, callback);
+}
+
+void ImageEngineApi::saveFirstPageSnapshot(const QStringList &paths, const QSize &windowSize, int zoomLevel)
+{
+    const QString file = FirstPageSnapshot::snapshotFile();
+    //图库为空时不保留快照，下次启动直接显示导入界面
+    if (paths.isEmpty()) {
+        QFile::remove(file);
+        return;
+    }
+    FirstPageSnapshot snapshot;
+    snapshot.setGeometry(windowSize, zoomLevel);
+    for (const QString &path : paths) {
+        ImageDataSt data;
+        if (!getImageData(path, data)) {
+            continue;
+        }
+        PhotoCatalog *catalog = PhotoCatalog::instance();
+        const PhotoId id = catalog->idOf(path);
+        DBImgInfo info = catalog->isValid(id) ? catalog->info(id) : data.dbi;
+        if (info.filePath.isEmpty()) {
+            info.filePath = path;
+            info.fileName = QFileInfo(path).fileName();
+        }
+        snapshot.append(info, data.imgpixmap.toImage());
+    }
+    if (!snapshot.save(file)) {
+        qDebug() << "save first page snapshot failed" << file;
+    }
+}
+
+void ImageEngineApi::dropCatalogedInfo(const QString &path, ImageDataSt &data) const
+{
+    if (!PhotoCatalog::instance()->contains(path)) {
+        return;
+    }
+    DBImgInfo info;
+    info.filePath = path;
+    info.fileName = data.dbi.fileName.isEmpty() ? QFileInfo(path).fileName() : data.dbi.fileName;
+    data.dbi = info;
+}
+
 void ImageEngineApi::thumbnailLoadThread(int num)
 {
     int index = num / 3;
@@ -518,17 +686,6 @@ int ImageEngineApi::CacheThreadNum()
 #endif
 }
 
-void ImageEngineApi::setImgPathAndAlbumNames(const QMultiMap<QString, QString> &imgPahtAlbums)
-{
-    m_allPathAndAlbumNames.clear();
-    m_allPathAndAlbumNames = imgPahtAlbums;
-}
-
-const QMultiMap<QString, QString> &ImageEngineApi::getImgPathAndAlbumNames()
-{
-    return m_allPathAndAlbumNames;
-}
-
 //从外部启动，启用线程加载图片
 bool ImageEngineApi::loadImagesFromNewAPP(QStringList files, ImageEngineImportObject *obj)
 {
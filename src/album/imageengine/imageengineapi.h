@@ -3,6 +3,8 @@
 
 #include <QObject>
 #include <QMap>
+#include <QSet>
+#include <QHash>
 #include <QUrl>
 #include "imageenginethread.h"
 #include "imageengineobject.h"
@@ -13,6 +15,7 @@ const int Number_Of_Displays_Per_Time = 32;
 
 //#define   NOGLOBAL;     //是否启用全局线程
 class DBandImgOperate;
+class QTimer;
 
 class ImageEngineApi: public QObject
 {
@@ -39,9 +42,9 @@ public:
     bool loadImagesFromTrash(DBImgInfoList files, ImageEngineObject *obj);
     bool loadImagesFromDB(ThumbnailDelegate::DelegateType type, ImageEngineObject *obj, QString name = "", int loadCount = 0);
     bool SaveImagesCache(QStringList files);
+    //元数据、感知哈希和主色攒批后写回数据库，须在GUI线程调用
+    void queueImageMetas(const DBImgInfo &info);
     int CacheThreadNum();
-    void setImgPathAndAlbumNames(const QMultiMap<QString, QString> &imgPahtAlbums);
-    const QMultiMap<QString, QString> &getImgPathAndAlbumNames();
 
     //从外部启动，启用线程加载图片
     bool loadImagesFromNewAPP(QStringList files, ImageEngineImportObject *obj);
@@ -65,8 +68,11 @@ public:
     {
         return bcloseFg;
     }
-    void loadFirstPageThumbnails(int num);
+    //有首屏快照时直接显示快照，否则查询数据库并解码前num张缩略图
+    void loadFirstPageThumbnails(int num, const QSize &windowSize = QSize(), int zoomLevel = -1);
     void thumbnailLoadThread(int num);
+    //退出时保存所有照片首屏的快照，paths为按显示顺序的首屏图片
+    void saveFirstPageSnapshot(const QStringList &paths, const QSize &windowSize, int zoomLevel);
 private slots:
     void sltImageLoaded(void *imgobject, QString path, ImageDataSt &data);
     void sltInsert(QString imagepath, QString remainDay);
@@ -76,6 +82,8 @@ private slots:
     void sltAborted(QString path);
     void sltImageFilesImported(void *imgobject, QStringList &filelist);
     void sltstopCacheSave();
+    void sltFlushRemovedImages();
+    void sltFlushImageMetas();
 
     void sigImageBackLoaded(QString path, ImageDataSt data);
 
@@ -89,10 +97,14 @@ signals:
     void sigLoadOneThumbnailToThumbnailView(QString imagepath, ImageDataSt data);
 public:
     QMap<QString, ImageDataSt>m_AllImageData;
-    QMultiMap<QString, QString> m_allPathAndAlbumNames;
     bool m_80isLoaded = false;
+    QStringList m_firstPagePaths;       //首屏图片，按显示顺序
 private:
     explicit ImageEngineApi(QObject *parent = nullptr);
+    bool loadFirstPageSnapshot(int num, const QSize &windowSize, int zoomLevel);
+    //图库中的图片元数据由PhotoCatalog保存，缓存中只留路径和文件名
+    void dropCatalogedInfo(const QString &path, ImageDataSt &data) const;
+    void reconcileFirstPage(const QStringList &paths);
 
     QMap<void *, void *>m_AllObject;
 
@@ -100,6 +112,10 @@ private:
     ImageCacheSaveObject *m_imageCacheSaveobj = nullptr;
     bool bcloseFg = false;
     QThreadPool *m_pool = nullptr;
+    QSet<QString> m_dbRemoveSet;        //待从数据库删除的失效图片
+    QTimer *m_dbRemoveTimer = nullptr;
+    QHash<QString, DBImgInfo> m_dbMetaUpdates;   //待回填到数据库的图片元数据
+    QTimer *m_dbMetaTimer = nullptr;
 #ifdef NOGLOBAL
     QThreadPool m_qtpool;
     QThreadPool cacheThreadPool;
@@ -1,5 +1,6 @@
 #include "imageenginethread.h"
 #include "imageengineapi.h"
+#include "libraryreconciler.h"
 #include <dgiovolumemanager.h>
 #include <dgiofile.h>
 #include <dgiofileinfo.h>
@@ -13,12 +14,31 @@
 #include <QStandardPaths>
 #include <QDirIterator>
 #include <QSvgGenerator>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include "utils/baseutils.h"
 #include "utils/imageutils.h"
+#include "utils/dirsnapshot.h"
+#include "utils/dirwalker.h"
 #include "utils/unionimage.h"
 #include "dbmanager/dbmanager.h"
+#include "dbmanager/photocatalog.h"
 #include "application.h"
 #include "controller/signalmanager.h"
 
+namespace {
+//导入流水线参数
+const int IMPORT_MAX_WORKERS = 8;
+const int IMPORT_QUEUE_CAPACITY = 512;
+const int IMPORT_SCAN_CHUNK = 256;
+const int IMPORT_BATCH_SIZE = 200;
+const unsigned long IMPORT_BATCH_INTERVAL_MS = 500;
+//各视图收到imagesInserted会整体刷新，导入期间最多每秒通知一次
+const qint64 IMPORT_NOTIFY_INTERVAL_MS = 1000;
+}  // namespace
+
 DBImgInfo getDBInfo(const QString &srcpath)
 {
     using namespace utils::base;
@@ -41,9 +61,52 @@ DBImgInfo getDBInfo(const QString &srcpath)
     }
     dbi.changeTime = QDateTime::fromString(mds.value("DateTimeDigitized"), "yyyy/MM/dd hh:mm");
     dbi.importTime = QDateTime::currentDateTime();
+    readImageMetas(srcpath, dbi);
     return dbi;
 }
 
+void readImageMetas(const QString &srcpath, DBImgInfo &dbi)
+{
+    QFileInfo srcfi(srcpath);
+    dbi.fileSize = srcfi.size();
+    dbi.mtime = srcfi.lastModified().toSecsSinceEpoch();
+    //只读取文件头，不解码像素
+    QImageReader reader(srcpath);
+    const QSize size = reader.size();
+    if (size.isValid()) {
+        dbi.width = size.width();
+        dbi.height = size.height();
+        dbi.albumSize = QString::number(size.width()) + "x" + QString::number(size.height());
+    }
+    //Qt的变换与EXIF方向一一对应
+    switch (reader.transformation()) {
+    case QImageIOHandler::TransformationNone:
+        dbi.orientation = 1;
+        break;
+    case QImageIOHandler::TransformationMirror:
+        dbi.orientation = 2;
+        break;
+    case QImageIOHandler::TransformationRotate180:
+        dbi.orientation = 3;
+        break;
+    case QImageIOHandler::TransformationFlip:
+        dbi.orientation = 4;
+        break;
+    case QImageIOHandler::TransformationFlipAndRotate90:
+        dbi.orientation = 5;
+        break;
+    case QImageIOHandler::TransformationRotate90:
+        dbi.orientation = 6;
+        break;
+    case QImageIOHandler::TransformationMirrorAndRotate90:
+        dbi.orientation = 7;
+        break;
+    case QImageIOHandler::TransformationRotate270:
+        dbi.orientation = 8;
+        break;
+    }
+}
+
 namespace {
 const QString CACHE_PATH = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QDir::separator() + "deepin" + QDir::separator() + "deepin-album";
 }
@@ -96,195 +159,300 @@ void ImportImagesThread::run()
         m_obj->removeThread(this);
         return;
     }
-    QStringList image_list;
-    QStringList curAlbumImgPathList;
-    if (m_albumname.length() > 0) {
-        // 在相册中导入时,
-        curAlbumImgPathList = DBManager::instance()->getPathsByAlbum(m_albumname);
-    } else {
-        // 不是在相册中导入时,allpic timeline .etc
-        curAlbumImgPathList = DBManager::instance()->getAllPaths();
+    // 判重使用图库目录和相册缓存中的哈希索引
+    static QString cfgGroupName = QStringLiteral("General"), cfgContentCheck = QStringLiteral("ContentDuplicateCheck");
+    m_checkContent = dApp->setter->value(cfgGroupName, cfgContentCheck, true).toBool();
+    if ((m_albumname.isEmpty() || m_checkContent) && !PhotoCatalog::instance()->isLoaded()) {
+        PhotoCatalog::instance()->load();
     }
+
+    // 流水线：扫描(1线程) -> 识别格式并读取元数据(N线程) -> 分批入库(本线程) -> 生成缩略图
+    // 各阶段之间为有界队列，入库一批即通知界面显示，取消时各阶段依次退出
+    const int workerCount = qBound(1, QThread::idealThreadCount(), IMPORT_MAX_WORKERS);
+    BoundedQueue<QString> pathQueue(IMPORT_QUEUE_CAPACITY);
+    BoundedQueue<DBImgInfo> infoQueue(IMPORT_QUEUE_CAPACITY);
+    QThreadPool pool;
+    pool.setMaxThreadCount(workerCount + 1);
     QStringList curAlbumImportedPathList;
-    // 拖拽导入 url
-    if (m_type == DataType_UrlList) {
-        QStringList urlLocalPathList;
-        for (QUrl url : m_urls) {
-            const QString path = url.toLocalFile();
-            urlLocalPathList << path;
-            if (QFileInfo(path).isDir()) {
-                auto finfos =  utils::image::getImagesInfo(path, true);
-                for (auto finfo : finfos) {
-                    if (utils::image::imageSupportRead(finfo.absoluteFilePath())) {
-                        // if path imported album
-                        if (curAlbumImgPathList.contains(finfo.absoluteFilePath())) {
-                            curAlbumImportedPathList << finfo.absoluteFilePath();
-                        } else {
-                            image_list << finfo.absoluteFilePath();
-                        }
-                    }
-                }
-            } else if (utils::image::imageSupportRead(path)) {
+    QAtomicInt runningWorkers(workerCount);
 
-                // if path imported album
-                if (curAlbumImgPathList.contains(path)) {
-                    curAlbumImportedPathList << path;
-                } else {
-                    image_list << path;
-                }
+    QtConcurrent::run(&pool, [ &, this]() {
+        scanPaths(pathQueue, curAlbumImportedPathList);
+        pathQueue.close();
+    });
+    for (int i = 0; i < workerCount; i++) {
+        QtConcurrent::run(&pool, [ &, this]() {
+            readMetas(pathQueue, infoQueue);
+            // 最后一个工作线程退出时通知入库阶段
+            if (!runningWorkers.deref()) {
+                infoQueue.close();
             }
-        }
+        });
     }
-    // 文件管理器选中
-    else if (m_type == DataType_StringList) {
-        foreach (QString path, m_paths) {
-            if (bneedstop) {
-                m_obj->imageImported(false);
-                m_obj->removeThread(this);
-                return;
-            }
-            QFileInfo file(path);
-            if (file.isDir()) {
-                auto finfos =  utils::image::getImagesInfo(path, true);
-                for (auto finfo : finfos) {
-                    if (utils::image::imageSupportRead(finfo.absoluteFilePath())) {
-                        // if path imported album
-                        if (curAlbumImgPathList.contains(finfo.absoluteFilePath())) {
-                            curAlbumImportedPathList << finfo.absoluteFilePath();
-                        } else {
-                            image_list << finfo.absoluteFilePath();
-                        }
-                    }
-                }
-            } else if (file.exists()) { //文件存在
 
-                // if path imported album
-                if (curAlbumImgPathList.contains(path)) {
-                    curAlbumImportedPathList << path;
-                } else {
-                    image_list << path;
-                }
-            }
+    QStringList importedPaths;
+    DBImgInfoList batch;
+    QElapsedTimer batchTimer;
+    batchTimer.start();
+    int lastProgress = -1;
+    //首批入库立即通知，之后按间隔合并
+    QElapsedTimer notifyTimer;
+    bool notifyPending = false;
+    while (!isCanceled()) {
+        QList<DBImgInfo> infos;
+        const bool more = infoQueue.popBatch(infos, IMPORT_BATCH_SIZE - batch.size(), IMPORT_BATCH_INTERVAL_MS);
+        batch << infos;
+        const int processed = m_processedCount.load();
+        if (processed != lastProgress) {
+            lastProgress = processed;
+            emit dApp->signalM->progressOfWaitDialog(m_scannedCount.load(), processed);
+        }
+        // 攒够一批或等待超时即提交，保证首批图片尽快出现
+        if (!batch.isEmpty() && (batch.size() >= IMPORT_BATCH_SIZE || !more
+                                 || batchTimer.elapsed() >= static_cast<qint64>(IMPORT_BATCH_INTERVAL_MS))) {
+            const QStringList committed = commitBatch(batch);
+            importedPaths << committed;
+            notifyPending = notifyPending || !committed.isEmpty();
+            batch.clear();
+            batchTimer.restart();
+        }
+        if (notifyPending && (!notifyTimer.isValid() || notifyTimer.elapsed() >= IMPORT_NOTIFY_INTERVAL_MS)) {
+            emit dApp->signalM->imagesInserted();
+            notifyPending = false;
+            notifyTimer.start();
+        }
+        if (!more) {
+            break;
         }
     }
-    // 导入列表为空并且导入相同照片的列表也为空，视为导入失败,直接返回
-    if (image_list.size() < 1 && curAlbumImportedPathList.size() < 1) {
-        emit dApp->signalM->ImportFailed();
+
+    if (isCanceled()) {
+        if (m_copyEngine) {
+            m_copyEngine->cancel();
+        }
+        pathQueue.abort();
+        infoQueue.abort();
+        pool.waitForDone();
+        //已提交的批次保留在图库中
+        if (notifyPending) {
+            emit dApp->signalM->imagesInserted();
+        }
         m_obj->imageImported(false);
         m_obj->removeThread(this);
         return;
-    } else if (image_list.size() < 1 && curAlbumImportedPathList.size() > 0) {
+    }
+    pool.waitForDone();
+    if (m_copyEngine) {
+        qDebug() << "device import copied" << m_copyEngine->filesCopied() << "files,"
+                 << m_copyEngine->mbPerSecond() << "MB/s," << m_copyEngine->filesPerSecond() << "files/s";
+        m_copyEngine->finish();
+    }
+
+    if (m_unreadableCount.load() > 0) {
+        qDebug() << "import skipped" << m_unreadableCount.load() << "unreadable files";
+    }
+    // 内容重复的图片不再导入，提示时标记图库中已有的那一张
+    if (!m_contentDuplicates.isEmpty()) {
+        if (m_albumname.length() > 0) {
+            DBManager::instance()->insertIntoAlbumNoSignal(m_albumname, m_contentDuplicates);
+        }
+        curAlbumImportedPathList << m_contentDuplicates;
+        notifyPending = notifyPending || m_albumname.length() > 0;
+    }
+    if (notifyPending) {
+        emit dApp->signalM->imagesInserted();
+    }
+    // 导入列表为空并且导入相同照片的列表也为空，视为导入失败
+    if (importedPaths.isEmpty() && curAlbumImportedPathList.isEmpty()) {
+        emit dApp->signalM->ImportFailed();
+        m_obj->imageImported(false);
+    } else if (importedPaths.isEmpty()) {
         // 视为导入的图片全部为重复图片
-        // ImportImageLoader() 中，底部状态栏将显示导入状态，之后，核对是否存在重复图片，发送信号准备提示
-        emit dApp->signalM->RepeatImportingTheSamePhotos(image_list, curAlbumImportedPathList, m_albumname);
+        emit dApp->signalM->RepeatImportingTheSamePhotos(importedPaths, curAlbumImportedPathList, m_albumname);
         // 导入重复照片提示
         emit dApp->signalM->sigAddDuplicatePhotos();
         m_obj->imageImported(true);
-        m_obj->removeThread(this);
-        return;
-    } else if (image_list.size() > 0) {
-        if (m_bdialogselect) {
-            QFileInfo firstFileInfo(image_list.first());
-            static QString cfgGroupName = QStringLiteral("General"), cfgLastOpenPath = QStringLiteral("LastOpenPath");
-            dApp->setter->setValue(cfgGroupName, cfgLastOpenPath, firstFileInfo.path());
-        }
-        // 判断当前导入路径是否为外接设备
-        int isMountFlag = 0;
-        DGioVolumeManager *pvfsManager = new DGioVolumeManager;
-        QList<QExplicitlySharedDataPointer<DGioMount>> mounts = pvfsManager->getMounts();
-        for (auto mount : mounts) {
-            if (bneedstop || ImageEngineApi::instance()->closeFg()) {
-                m_obj->imageImported(false);
-                m_obj->removeThread(this);
-                return;
-            }
-            QExplicitlySharedDataPointer<DGioFile> LocationFile = mount->getDefaultLocationFile();
-            QString strPath = LocationFile->path();
-            if (0 == image_list.first().compare(strPath)) {
-                isMountFlag = 1;
-                break;
-            }
+    } else {
+        // 底部状态栏显示导入状态，之后，核对是否存在重复图片，发送信号准备提示
+        emit dApp->signalM->updateStatusBarImportLabel(importedPaths, 1, m_albumname.length() > 0, m_albumname);
+        m_obj->imageImported(true);
+        if (curAlbumImportedPathList.count() > 0) {
+            emit dApp->signalM->RepeatImportingTheSamePhotos(importedPaths, curAlbumImportedPathList, m_albumname);
         }
+    }
+    m_obj->removeThread(this);
+}
 
-        // 当前导入路径
-        if (isMountFlag) {
-            QString strHomePath = QDir::homePath();
-            //获取系统现在的时间
-            QString strDate = QDateTime::currentDateTime().toString("yyyy-MM-dd");
-            QString basePath = QString("%1%2%3").arg(strHomePath, "/Pictures/照片/", strDate);
-            QDir dir;
-            if (!dir.exists(basePath)) {
-                dir.mkpath(basePath);
-            }
-            QStringList newImagePaths;
-            foreach (QString strPath, image_list) {
-                if (bneedstop || ImageEngineApi::instance()->closeFg()) {
-                    m_obj->imageImported(false);
-                    m_obj->removeThread(this);
-                    return;
-                }
-                //取出文件名称
-                QStringList pathList = strPath.split("/", QString::SkipEmptyParts);
-                QStringList nameList = pathList.last().split(".", QString::SkipEmptyParts);
-                QString strNewPath = QString("%1%2%3%4%5%6").arg(basePath, "/", nameList.first(), QString::number(QDateTime::currentDateTime().toMSecsSinceEpoch()), ".", nameList.last());
-
-                newImagePaths << strNewPath;
-                //判断新路径下是否存在目标文件，若存在，下一次张
-                if (dir.exists(strNewPath)) {
-                    continue;
-                }
+bool ImportImagesThread::isCanceled() const
+{
+    return bneedstop || ImageEngineApi::instance()->closeFg();
+}
 
-                // 外接设备图片拷贝到系统
-                if (QFile::copy(strPath, strNewPath)) {
+QVector<bool> ImportImagesThread::isImported(const QStringList &paths) const
+{
+    if (m_albumname.length() > 0) {
+        // 在相册中导入时,
+        return DBManager::instance()->isImgsExistInAlbum(m_albumname, paths);
+    }
+    // 不是在相册中导入时,allpic timeline .etc
+    return PhotoCatalog::instance()->contains(paths);
+}
 
+bool ImportImagesThread::offerPaths(BoundedQueue<QString> &pathQueue, const QStringList &paths, QStringList &repeatPaths)
+{
+    if (paths.isEmpty()) {
+        return true;
+    }
+    const QVector<bool> imported = isImported(paths);
+    for (int i = 0; i < paths.size(); i++) {
+        const QString &path = paths.at(i);
+        // if path imported album
+        if (imported.at(i)) {
+            repeatPaths << path;
+            continue;
+        }
+        if (0 == m_scannedCount.load()) {
+            // 根据第一张图片记录上次打开路径，并判断当前导入路径是否为外接设备
+            if (m_bdialogselect) {
+                static QString cfgGroupName = QStringLiteral("General"), cfgLastOpenPath = QStringLiteral("LastOpenPath");
+                dApp->setter->setValue(cfgGroupName, cfgLastOpenPath, QFileInfo(path).path());
+            }
+            for (auto mount : DGioVolumeManager::getMounts()) {
+                QExplicitlySharedDataPointer<DGioFile> LocationFile = mount->getDefaultLocationFile();
+                if (0 == path.compare(LocationFile->path())) {
+                    //获取系统现在的时间
+                    QString strDate = QDateTime::currentDateTime().toString("yyyy-MM-dd");
+                    m_mountCopyDir = QString("%1%2%3").arg(QDir::homePath(), "/Pictures/照片/", strDate);
+                    m_copyEngine.reset(new CopyEngine(m_mountCopyDir));
+                    break;
                 }
             }
+        }
+        m_scannedCount.ref();
+        if (!pathQueue.push(path)) {
+            return false;
+        }
+    }
+    return true;
+}
 
-            image_list.clear();
-            image_list = newImagePaths;
+void ImportImagesThread::scanPaths(BoundedQueue<QString> &pathQueue, QStringList &repeatPaths)
+{
+    QStringList roots;
+    if (m_type == DataType_UrlList) {
+        // 拖拽导入 url
+        for (QUrl url : m_urls) {
+            roots << url.toLocalFile();
         }
+    } else if (m_type == DataType_StringList) {
+        // 文件管理器选中
+        roots = m_paths;
+    }
+    // 并行遍历，只按后缀过滤，格式识别放到工作线程中；每块批量判重，减少加锁次数
+    DirWalker walker(utils::image::imageSupportSuffixes());
+    walker.setBatchSize(IMPORT_SCAN_CHUNK);
+    walker.walk(roots, [&](const QStringList & candidates) {
+        return !isCanceled() && offerPaths(pathQueue, candidates, repeatPaths);
+    });
+}
 
-        DBImgInfoList dbInfos;
-        using namespace utils::image;
-        int noReadCount = 0;
-        for (auto imagePath : image_list) {
-            if (!imageSupportRead(imagePath)) {
-                noReadCount++;
+void ImportImagesThread::readMetas(BoundedQueue<QString> &pathQueue, BoundedQueue<DBImgInfo> &infoQueue)
+{
+    QString path;
+    while (!isCanceled() && pathQueue.pop(path)) {
+        if (m_copyEngine) {
+            // 外接设备图片先拷贝到系统，拷贝完成后在本线程直接读取元数据
+            const CopyEngine::Item item = m_copyEngine->copyOne(path);
+            if (!item.ok) {
+                m_unreadableCount.ref();
+                m_processedCount.ref();
                 continue;
             }
-            QFileInfo srcfi(imagePath);
-            if (!srcfi.exists()) {  //当前文件不存在
+            path = item.target;
+            // 上次中断的导入中已拷贝并入库的图片按重复图片处理
+            if (item.resumed && PhotoCatalog::instance()->contains(path)) {
+                QMutexLocker locker(&m_contentMutex);
+                m_contentDuplicates << path;
+                m_processedCount.ref();
                 continue;
             }
-            dbInfos << getDBInfo(imagePath);
-            emit dApp->signalM->progressOfWaitDialog(image_list.size(), dbInfos.size());
         }
-
-        if (bneedstop) {
-            m_obj->imageImported(false);
-            m_obj->removeThread(this);
-            return;
+        if (!utils::image::imageSupportRead(path) || !QFileInfo(path).exists()) {
+            m_unreadableCount.ref();
+            m_processedCount.ref();
+            continue;
         }
-        DBImgInfoList tempdbInfos;
-        for (auto Info : dbInfos) {
-            QFileInfo fi(Info.filePath);
-            if (!fi.exists())
+        DBImgInfo info = getDBInfo(path);
+        if (m_checkContent) {
+            info.fingerprint = utils::base::contentFingerprint(path);
+            const QString original = findContentDuplicate(info);
+            if (!original.isEmpty()) {
+                QMutexLocker locker(&m_contentMutex);
+                m_contentDuplicates << original;
+                m_processedCount.ref();
                 continue;
-            tempdbInfos << Info;
-        }
-        if (image_list.length() == tempdbInfos.length() && !tempdbInfos.isEmpty()) {
-            dApp->m_imageloader->ImportImageLoader(tempdbInfos, m_albumname);// 导入照片提示在此处理中
-            m_obj->imageImported(true);
-            // ImportImageLoader() 中，底部状态栏将显示导入状态，之后，核对是否存在重复图片，发送信号准备提示
-            if (curAlbumImportedPathList.count() > 0) {
-                emit dApp->signalM->RepeatImportingTheSamePhotos(image_list, curAlbumImportedPathList, m_albumname);
             }
-        } else {
-            emit dApp->signalM->ImportFailed();
-            m_obj->imageImported(false);
         }
-        m_obj->removeThread(this);
+        m_processedCount.ref();
+        if (!infoQueue.push(info)) {
+            return;
+        }
+    }
+}
+
+QString ImportImagesThread::findContentDuplicate(const DBImgInfo &info)
+{
+    if (!info.fingerprint) {
+        return QString();
+    }
+    QStringList candidates;
+    PhotoCatalog *catalog = PhotoCatalog::instance();
+    for (PhotoId id : catalog->idsByFingerprint(info.fingerprint)) {
+        candidates << catalog->path(id);
     }
+    {
+        // 本次导入中尚未入库的图片也要参与比较，先到者登记
+        QMutexLocker locker(&m_contentMutex);
+        candidates << m_pendingFingerprints.values(info.fingerprint);
+        m_pendingFingerprints.insert(info.fingerprint, info.filePath);
+    }
+    candidates.removeDuplicates();
+    // 采样指纹相同时才计算整个文件的哈希确认
+    QByteArray contentHash;
+    for (const QString &candidate : candidates) {
+        if (candidate == info.filePath || !QFileInfo(candidate).exists()) {
+            continue;
+        }
+        if (contentHash.isEmpty()) {
+            contentHash = utils::base::fileContentHash(info.filePath);
+        }
+        if (!contentHash.isEmpty() && contentHash == utils::base::fileContentHash(candidate)) {
+            QMutexLocker locker(&m_contentMutex);
+            m_pendingFingerprints.remove(info.fingerprint, info.filePath);
+            return candidate;
+        }
+    }
+    return QString();
+}
+
+QStringList ImportImagesThread::commitBatch(const DBImgInfoList &batch)
+{
+    QStringList paths;
+    for (const DBImgInfo &info : batch) {
+        paths << info.filePath;
+    }
+    //相册引用ImageId，须先写入图片，再写相册行；imagesInserted由run()在两者都写完后合并发送
+    if (!DBManager::instance()->insertImgInfosNoSignal(batch)) {
+        return QStringList();
+    }
+    if (m_albumname.length() > 0) {
+        DBManager::instance()->insertIntoAlbumNoSignal(m_albumname, paths);
+    }
+    // 缩略图缓存在界面线程排队生成
+    QMetaObject::invokeMethod(ImageEngineApi::instance(), [paths]() {
+        ImageEngineApi::instance()->SaveImagesCache(paths);
+    }, Qt::QueuedConnection);
+    return paths;
 }
 
 ImageRecoveryImagesFromTrashThread::ImageRecoveryImagesFromTrashThread()
@@ -343,38 +511,30 @@ void ImageMoveImagesToTrashThread::run()
         DBManager::instance()->removeTrashImgInfos(paths);
         emit dApp->signalM->sigDeletePhotos(paths.length());
     } else {
-        DBImgInfoList infos;
         int pathsCount = paths.size();
-        int remoneOffset = pathsCount / 200;//分100次删除
+        int progressOffset = qMax(pathsCount / 100, 1);//进度分100次刷新
         int removedCount = 0;
-        QStringList removedPaths;
+        QSet<QString> removedPaths;
+        removedPaths.reserve(pathsCount);
         emit dApp->signalM->progressOfWaitDialog(paths.size(), 0);
-        for (auto path : paths) {
-            DBImgInfo info;
-            info = DBManager::instance()->getInfoByPath(path);
-            info.importTime = QDateTime::currentDateTime();
-            QStringList allalbumnames = DBManager::instance()->getAllAlbumNames();
-            for (auto eachname : allalbumnames) {
-                if (DBManager::instance()->isImgExistInAlbum(eachname, path)) {
-                    info.albumname += (eachname + ",");
-                }
+        //一次联合查询取出全部待删除图片的数据，相册名取自相册缓存
+        DBImgInfoList infos = DBManager::instance()->getInfosByPaths(paths);
+        const QDateTime now = QDateTime::currentDateTime();
+        for (DBImgInfo &info : infos) {
+            info.importTime = now;
+            for (const QString &eachname : DBManager::instance()->getAlbumNamesByPath(info.filePath)) {
+                info.albumname += (eachname + ",");
             }
-            infos << info;
-            removedPaths << path;
+            removedPaths.insert(info.filePath);
             removedCount++;
-            if (removedCount == remoneOffset) {
-                DBManager::instance()->insertTrashImgInfos(infos);
-                DBManager::instance()->removeImgInfos(removedPaths);
+            if (removedCount % progressOffset == 0) {
                 emit dApp->signalM->progressOfWaitDialog(paths.size(), removedCount);
-                remoneOffset += remoneOffset;
-                removedPaths.clear();
-                infos.clear();
             }
-//            emit dApp->signalM->progressOfWaitDialog(paths.size(), infos.size());
         }
+        //一次事务写入回收站并删除，只发送一次删除通知
         DBManager::instance()->insertTrashImgInfos(infos);
         DBManager::instance()->removeImgInfos(removedPaths);
-        emit dApp->signalM->progressOfWaitDialog(paths.size(), removedCount);
+        emit dApp->signalM->progressOfWaitDialog(paths.size(), paths.size());
 //        DBImgInfoList infos;
 //        //获取全部数据
 //        DBImgInfoList infosAll = DBManager::instance()->getAllInfos(0);
@@ -456,57 +616,29 @@ void ImageImportFilesFromMountThread::run()
     //获取系统现在的时间
     QString strDate = QDateTime::currentDateTime().toString("yyyy-MM-dd");
     QString basePath = QString("%1%2%3").arg(strHomePath, "/Pictures/照片/", strDate);
-    QDir dir;
-    if (!dir.exists(basePath)) {
-        dir.mkpath(basePath);
-    }
 
-    foreach (QString strPath, m_paths) {
+    //多个文件同时拷贝，每拷贝完一个即在拷贝线程中读取元数据
+    CopyEngine engine(basePath);
+    QMutex resultMutex;
+    const bool finished = engine.run(m_paths, [&](const CopyEngine::Item & item) {
         if (bneedstop || ImageEngineApi::instance()->closeFg()) {
-            return;
-        }
-        //取出文件名称
-        QStringList pathList = strPath.split("/", QString::SkipEmptyParts);
-        QStringList nameList = pathList.last().split(".", QString::SkipEmptyParts);
-        QString strNewPath = QString("%1%2%3%4%5%6").arg(basePath, "/", nameList.first(),
-                                                         QString::number(QDateTime::currentDateTime().toMSecsSinceEpoch()), ".", nameList.last());
-
-        //判断新路径下是否存在目标文件，若不存在，继续循环
-        if (!dir.exists(strPath)) {
-            continue;
-        }
-        //判断新路径下是否存在目标文件，若存在，先删除掉
-        if (dir.exists(strNewPath)) {
-            dir.remove(strNewPath);
+            return false;
         }
-        newPathList << strNewPath;
-        QFileInfo fi(strNewPath);
-        using namespace utils::image;
-        using namespace utils::base;
-        if (QFile::copy(strPath, strNewPath)) {
-            qDebug() << "onCopyPhotoFromPhone()";
+        if (!item.ok) {
+            return true;
         }
-//        auto mds = getAllMetaData(strNewPath);
-//        QString value = mds.value("DateTimeOriginal");
-//        DBImgInfo dbi;
-//        dbi.fileName = fi.fileName();
-//        dbi.filePath = strNewPath;
-//        dbi.dirHash = utils::base::hash(QString());
-//        if ("" != value) {
-//            dbi.time = QDateTime::fromString(value, "yyyy/MM/dd hh:mm:ss");
-//        } else if (fi.birthTime().isValid()) {
-//            dbi.time = fi.birthTime();
-//        } else if (fi.metadataChangeTime().isValid()) {
-//            dbi.time = fi.metadataChangeTime();
-//        } else {
-//            dbi.time = QDateTime::currentDateTime();
-//        }
-
-//        dbi.changeTime = QDateTime::currentDateTime();
-        dbInfos << getDBInfo(strNewPath);
-
+        const DBImgInfo info = getDBInfo(item.target);
+        QMutexLocker locker(&resultMutex);
+        newPathList << item.target;
+        dbInfos << info;
         emit dApp->signalM->progressOfWaitDialog(m_paths.size(), dbInfos.size());
+        return true;
+    });
+    //中断时保留续传日志，下次导入同一批图片时不再重复拷贝
+    if (!finished || bneedstop || ImageEngineApi::instance()->closeFg()) {
+        return;
     }
+    engine.finish();
     if (!dbInfos.isEmpty()) {
         DBImgInfoList dbInfoList;
         QStringList pathslist;
@@ -519,10 +651,13 @@ void ImageImportFilesFromMountThread::run()
             dbInfoList << dbInfos[i];
         }
 
-        if (m_albumname.length() > 0) {
-            DBManager::instance()->insertIntoAlbumNoSignal(m_albumname, pathslist);
+        //相册引用ImageId，须先写入图片，相册行写完后再通知
+        if (DBManager::instance()->insertImgInfosNoSignal(dbInfoList)) {
+            if (m_albumname.length() > 0) {
+                DBManager::instance()->insertIntoAlbumNoSignal(m_albumname, pathslist);
+            }
+            emit dApp->signalM->imagesInserted();
         }
-        DBManager::instance()->insertImgInfos(dbInfoList);
 
         if (bneedstop) {
             return;
@@ -603,32 +738,42 @@ void ImageGetFilesFromMountThread::run()
     if (bneedstop) {
         return;
     }
-    QString strPath = m_path;
-    //获取所选文件类型过滤器
-    QStringList filters;
-    for (QString i : UnionImage_NameSpace::unionImageSupportFormat()) {
-        filters << "*." + i;
-    }
-    //定义迭代器并设置过滤器，包括子目录：QDirIterator::Subdirectories
-    QDirIterator dir_iterator(m_path,
-                              filters,
-                              QDir::Files | QDir::NoSymLinks,
-                              QDirIterator::Subdirectories);
+    //按支持的格式后缀过滤，包括子目录，不跟随符号链接；
+    //设备上次扫描的目录快照保存在本地，再次挂载时只重新列出mtime变化的目录
+    DirSnapshot snapshot(UnionImage_NameSpace::unionImageSupportFormat());
+    snapshot.setSkipSymlinks(true);
+    snapshot.setCancelCheck([this]() {
+        return bneedstop || ImageEngineApi::instance()->closeFg();
+    });
+    const QString snapshotFile = DirSnapshot::snapshotFile(m_mountname + ":" + m_path);
+    const bool hasSnapshot = snapshot.load(snapshotFile);
     QStringList allfiles;
-    while (dir_iterator.hasNext()) {
-        if (bneedstop || ImageEngineApi::instance()->closeFg()) {
-            return;
-        }
-        dir_iterator.next();
-        QFileInfo fileInfo = dir_iterator.fileInfo();
-        allfiles << fileInfo.filePath();
+    if (hasSnapshot) {
+        allfiles = snapshot.rescan(m_path);
+    } else {
+        //首次挂载没有快照，每个目录都要列出，用DirWalker并行遍历，先把结果交给界面
+        DirWalker walker(UnionImage_NameSpace::unionImageSupportFormat());
+        walker.setSkipSymlinks(true);
+        walker.walk(QStringList() << m_path, [&](const QStringList & files) {
+            allfiles << files;
+            return !bneedstop && !ImageEngineApi::instance()->closeFg();
+        });
     }
-    if (bneedstop) {
+    if (bneedstop || ImageEngineApi::instance()->closeFg()) {
         return;
     }
     emit sigImageFilesGeted(m_imgobject, allfiles, m_path);
     m_imgobject->removeThread(this);
     emit dApp->signalM->sigLoadMountImagesEnd(m_mountname);
+
+    //再建立快照供下次挂载时增量扫描，刚遍历过的目录项还在缓存中
+    if (!hasSnapshot) {
+        snapshot.rescan(m_path);
+        if (bneedstop || ImageEngineApi::instance()->closeFg()) {
+            return;
+        }
+    }
+    snapshot.save(snapshotFile);
 }
 
 ImageLoadFromDBThread::ImageLoadFromDBThread(int loadCount)
@@ -667,22 +812,29 @@ void ImageLoadFromDBThread::run()
         return;
     }
     QStringList image_list;
-    QStringList fail_image_list;
     if (ThumbnailDelegate::AllPicViewType == m_type) {
-        auto infos = DBManager::instance()->getAllInfos(m_loadCount);
-        for (auto info : infos) {
-            //记录源文件不存在的数据
-            if (!QFileInfo(info.filePath).exists()) {
-                fail_image_list << info.filePath;
-                emit dApp->signalM->updatePicView(0);
-                continue;
+        QStringList all_paths;
+        if (0 == m_loadCount) {
+            //全量加载使用共享的图片目录，只在首次时查询数据库
+            PhotoCatalog *catalog = PhotoCatalog::instance();
+            if (!catalog->isLoaded()) {
+                catalog->load();
             }
-            image_list << info.filePath;
+            all_paths = catalog->paths(catalog->idsByTime());
+        } else {
+            for (const DBImgInfo &info : DBManager::instance()->getAllInfos(m_loadCount)) {
+                all_paths << info.filePath;
+            }
+        }
+        //先按图库显示，文件是否存在交给后台核对，丢失的文件分批从数据库删除
+        for (const QString &path : all_paths) {
             if (bneedstop || ImageEngineApi::instance()->closeFg()) {
                 return;
             }
-            emit sigInsert(info.filePath);
+            emit sigInsert(path);
         }
+        image_list = all_paths;
+        LibraryReconciler::instance()->reconcile(all_paths);
         if (m_nametype.isEmpty())
             ImageEngineApi::instance()->SaveImagesCache(image_list);
     }
@@ -690,11 +842,6 @@ void ImageLoadFromDBThread::run()
         return;
     }
 
-    //删除数据库失效的图片
-    DBManager::instance()->removeImgInfosNoSignal(fail_image_list);
-    // 相册照片更新时的．更新路径相册名缓存,用于listview的setdata userrole + 2
-    ImageEngineApi::instance()->setImgPathAndAlbumNames(DBManager::instance()->getAllPathAlbumNames());
-
     //先处理图片再存数据库
     emit sigImageLoaded(m_imgobject, image_list);
 
@@ -901,6 +1048,8 @@ void ImageEngineThread::run()
     QString errMsg;
     QString dimension;
     QFileInfo srcfi(m_path);
+    quint64 thumbnailHash = 0;
+    quint32 thumbnailColor = 0;
     if (m_data.imgpixmap.isNull()) {
         bool cache_exist = false;
         if (file.exists()) {
@@ -958,11 +1107,17 @@ void ImageEngineThread::run()
             pixmap.save(spath, "PNG");
         }
         m_data.imgpixmap = pixmap;
+        //缩略图已解码，顺带计算感知哈希和主色
+        const QImage thumbnailImage = pixmap.toImage();
+        thumbnailHash = utils::image::dHash(thumbnailImage);
+        thumbnailColor = utils::image::dominantColor(thumbnailImage);
     }
     DBImgInfo dbi = getDBInfo(m_path);
     if (!dimension.isEmpty()) {
         dbi.albumSize = dimension;
     }
+    dbi.dhash = static_cast<qint64>(thumbnailHash);
+    dbi.previewColor = thumbnailColor;
     m_data.dbi = dbi;
     m_data.loaded = ImageLoadStatu_Loaded;
     if (getNeedStop()) {
@@ -1113,6 +1268,16 @@ void ImageCacheQueuePopThread::saveCache(QString m_path)
         return;
     utils::base::mkMutiDir(spath.mid(0, spath.lastIndexOf('/')));
     pixmap.save(spath, "PNG");
+    //生成缓存时计算感知哈希和主色，连同元数据回填数据库
+    DBImgInfo dbi;
+    dbi.filePath = m_path;
+    readImageMetas(m_path, dbi);
+    const QImage thumbnailImage = pixmap.toImage();
+    dbi.dhash = static_cast<qint64>(utils::image::dHash(thumbnailImage));
+    dbi.previewColor = utils::image::dominantColor(thumbnailImage);
+    QMetaObject::invokeMethod(ImageEngineApi::instance(), [dbi]() {
+        ImageEngineApi::instance()->queueImageMetas(dbi);
+    }, Qt::QueuedConnection);
 }
 
 void ImageCacheQueuePopThread::run()
@@ -4,9 +4,16 @@
 #include <QObject>
 #include <QMutex>
 #include <QUrl>
+#include <QAtomicInt>
+#include <QMultiHash>
+#include <QScopedPointer>
 #include "imageengineobject.h"
+#include "boundedqueue.h"
+#include "copyengine.h"
 
 DBImgInfo getDBInfo(const QString &srcpath);
+//读取图片宽高、方向、大小和修改时间
+void readImageMetas(const QString &srcpath, DBImgInfo &dbi);
 
 class ImportImagesThread : public ImageEngineThreadObject, public QRunnable
 {
@@ -29,12 +36,34 @@ private:
         DataType_StringList,
         DataType_UrlList
     };
+    bool isCanceled() const;
+    //扫描阶段：遍历导入路径，跳过已导入的图片
+    void scanPaths(BoundedQueue<QString> &pathQueue, QStringList &repeatPaths);
+    bool offerPaths(BoundedQueue<QString> &pathQueue, const QStringList &paths, QStringList &repeatPaths);
+    //批量判断是否已导入到图库或当前相册
+    QVector<bool> isImported(const QStringList &paths) const;
+    //工作线程：识别格式并读取元数据
+    void readMetas(BoundedQueue<QString> &pathQueue, BoundedQueue<DBImgInfo> &infoQueue);
+    //按内容指纹查找已有的相同图片，返回其路径
+    QString findContentDuplicate(const DBImgInfo &info);
+    //入库一批，返回入库的路径
+    QStringList commitBatch(const DBImgInfoList &batch);
+
     QStringList m_paths;
     QList<QUrl> m_urls;
     QString m_albumname;
     ImageEngineImportObject *m_obj = nullptr;
     bool m_bdialogselect = false;
     DataType m_type = DataType_NULL;
+    QString m_mountCopyDir;     //从外接设备导入时的拷贝目录，为空表示本地导入
+    QScopedPointer<CopyEngine> m_copyEngine;
+    QAtomicInt m_scannedCount;
+    QAtomicInt m_processedCount;
+    QAtomicInt m_unreadableCount;
+    bool m_checkContent = false;    //是否按内容指纹判重
+    QMutex m_contentMutex;
+    QMultiHash<qint64, QString> m_pendingFingerprints;
+    QStringList m_contentDuplicates;
 };
 
 class ImageRecoveryImagesFromTrashThread : public ImageEngineThreadObject, public QRunnable
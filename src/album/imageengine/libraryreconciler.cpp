@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "libraryreconciler.h"
+#include "imageengineapi.h"
+#include "dbmanager/dbmanager.h"
+
+#include <QFile>
+#include <QtConcurrent>
+#include <QDebug>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+namespace {
+
+const int RECONCILE_MAX_WORKERS = 4;
+const int RECONCILE_BATCH_SIZE = 128;
+const int RECONCILE_FLUSH_COUNT = 500;      //攒够这么多丢失文件就删除一次
+const int RECONCILE_FLUSH_INTERVAL_MS = 1000;
+
+}  // namespace
+
+LibraryReconciler *LibraryReconciler::m_instance = nullptr;
+
+LibraryReconciler *LibraryReconciler::instance()
+{
+    if (!m_instance) {
+        m_instance = new LibraryReconciler();
+    }
+    return m_instance;
+}
+
+LibraryReconciler::LibraryReconciler(QObject *parent)
+    : QObject(parent)
+{
+    m_pool.setMaxThreadCount(RECONCILE_MAX_WORKERS);
+}
+
+LibraryReconciler::~LibraryReconciler()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopped = true;
+    }
+    cancel();
+    m_pool.waitForDone();
+}
+
+bool LibraryReconciler::fileExists(const QString &path)
+{
+    const QByteArray name = QFile::encodeName(path);
+    int ret = -1;
+#ifdef STATX_TYPE
+    //只取文件类型，并允许使用缓存的属性，NFS等不必每个文件都回源
+    struct statx stx;
+    ret = statx(AT_FDCWD, name.constData(), AT_STATX_DONT_SYNC, STATX_TYPE, &stx);
+    if (ret != 0 && errno == ENOSYS)
+#endif
+    {
+        struct stat st;
+        ret = stat(name.constData(), &st);
+    }
+    return ret == 0 || (errno != ENOENT && errno != ENOTDIR);
+}
+
+void LibraryReconciler::reconcile(const QStringList &paths)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_stopped) {
+        return;
+    }
+    for (const QString &path : paths) {
+        if (!m_verified.contains(path) && !m_queued.contains(path)) {
+            m_queued.insert(path);
+            m_pending << path;
+        }
+    }
+    const int remain = m_pending.size() - m_pendingPos;
+    while (m_workers < RECONCILE_MAX_WORKERS && m_workers * RECONCILE_BATCH_SIZE < remain) {
+        ++m_workers;
+        QtConcurrent::run(&m_pool, [this]() {
+            work();
+        });
+    }
+}
+
+void LibraryReconciler::prioritize(const QString &path)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_queued.contains(path)) {
+        m_urgent << path;
+    }
+}
+
+void LibraryReconciler::cancel()
+{
+    QMutexLocker locker(&m_mutex);
+    m_pending.clear();
+    m_pendingPos = 0;
+    m_urgent.clear();
+    m_queued.clear();
+}
+
+bool LibraryReconciler::takeBatch(QStringList &batch)
+{
+    //可见项优先，之后按加入顺序；优先核对过的路径在m_pending中再遇到时跳过
+    while (batch.size() < RECONCILE_BATCH_SIZE && !m_urgent.isEmpty()) {
+        const QString path = m_urgent.takeLast();
+        if (m_queued.remove(path)) {
+            batch << path;
+        }
+    }
+    while (batch.size() < RECONCILE_BATCH_SIZE && m_pendingPos < m_pending.size()) {
+        const QString &path = m_pending.at(m_pendingPos++);
+        if (m_queued.remove(path)) {
+            batch << path;
+        }
+    }
+    if (m_pendingPos >= m_pending.size()) {
+        m_pending.clear();
+        m_pendingPos = 0;
+    }
+    return !batch.isEmpty();
+}
+
+void LibraryReconciler::work()
+{
+    QStringList batch;
+    forever {
+        batch.clear();
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_stopped || ImageEngineApi::instance()->closeFg() || !takeBatch(batch)) {
+                --m_workers;
+                break;
+            }
+        }
+        QStringList existing;
+        QStringList missing;
+        for (const QString &path : batch) {
+            if (fileExists(path)) {
+                existing << path;
+            } else {
+                missing << path;
+            }
+        }
+        {
+            QMutexLocker locker(&m_mutex);
+            for (const QString &path : existing) {
+                m_verified.insert(path);
+            }
+            m_missing << missing;
+        }
+        flushMissing(false);
+    }
+    flushMissing(true);
+}
+
+void LibraryReconciler::flushMissing(bool force)
+{
+    QStringList missing;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_missing.isEmpty()) {
+            return;
+        }
+        //最后一个线程退出时或攒够一批时删除，避免各视图频繁刷新
+        const bool due = m_missing.size() >= RECONCILE_FLUSH_COUNT
+                         || (m_lastFlush.isValid() && m_lastFlush.elapsed() >= RECONCILE_FLUSH_INTERVAL_MS);
+        if (!(force && 0 == m_workers) && !due) {
+            if (!m_lastFlush.isValid()) {
+                m_lastFlush.start();
+            }
+            return;
+        }
+        missing.swap(m_missing);
+        m_lastFlush.start();
+    }
+    qDebug() << "library reconcile, missing files:" << missing.size();
+    //删除数据库中失效的图片，各视图随imagesRemoved刷新
+    DBManager::instance()->removeImgInfos(missing);
+}
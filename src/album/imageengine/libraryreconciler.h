@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBRARYRECONCILER_H
+#define LIBRARYRECONCILER_H
+
+#include <QObject>
+#include <QStringList>
+#include <QSet>
+#include <QMutex>
+#include <QThreadPool>
+#include <QElapsedTimer>
+
+/**
+ * @brief The LibraryReconciler class
+ * 后台核对图库中的文件是否仍然存在，视图先按图库直接显示，不再逐个stat阻塞启动。
+ * 多个线程分批statx，可见的图片优先核对；丢失的文件分批从数据库删除，各视图随imagesRemoved刷新。
+ * 本次运行中核对过且存在的路径不再重复核对。
+ */
+class LibraryReconciler : public QObject
+{
+    Q_OBJECT
+public:
+    static LibraryReconciler *instance();
+    ~LibraryReconciler() override;
+
+    //加入待核对队列，已核对或已在队列中的路径跳过
+    void reconcile(const QStringList &paths);
+    //path在队列中时提前核对，用于当前可见的图片
+    void prioritize(const QString &path);
+    //丢弃队列中尚未核对的路径
+    void cancel();
+
+    //只有确定不存在(ENOENT/ENOTDIR)时返回false，网络文件系统的临时错误不当作丢失
+    static bool fileExists(const QString &path);
+
+private:
+    explicit LibraryReconciler(QObject *parent = nullptr);
+    void work();
+    bool takeBatch(QStringList &batch);
+    void flushMissing(bool force);
+
+    static LibraryReconciler *m_instance;
+    QThreadPool m_pool;
+    QMutex m_mutex;
+    QStringList m_pending;          //按加入顺序
+    int m_pendingPos = 0;
+    QStringList m_urgent;           //可见项，后加入的先核对
+    QSet<QString> m_queued;
+    QSet<QString> m_verified;
+    QStringList m_missing;
+    QElapsedTimer m_lastFlush;
+    int m_workers = 0;
+    bool m_stopped = false;
+};
+
+#endif // LIBRARYRECONCILER_H
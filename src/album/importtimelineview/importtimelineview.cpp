@@ -3,6 +3,7 @@
 #include "utils/baseutils.h"
 #include "utils/imageutils.h"
 #include "imageengine/imageengineapi.h"
+#include "dbmanager/dbasyncmanager.h"
 #include "ac-desktop-define.h"
 #include <QScrollBar>
 #include <QScroller>
@@ -20,17 +21,17 @@
 namespace  {
 const int SUBTITLE_HEIGHT = 37;
 const int VIEW_MAINWINDOW_ALBUM = 2;
+const int TITLEHEIGHT = 50;
+const int BOTTOM_MARGIN = 27;
 } //namespace
 
 ImportTimeLineView::ImportTimeLineView(DWidget *parent)
     : DWidget(parent), m_mainLayout(nullptr), m_dateItem(nullptr)
     , pSuspensionChose(nullptr), pTimeLineViewWidget(nullptr), pImportView(nullptr)
     , allnum(0), m_pDate(nullptr), pNum_up(nullptr)
-    , pNum_dn(nullptr), m_pImportTitle(nullptr), m_DSlider(nullptr)
+    , m_pImportTitle(nullptr), m_DSlider(nullptr)
     , m_oe(nullptr), m_oet(nullptr), m_ctrlPress(false)
-    , lastClickedIndex(-1), lastRow(-1), m_lastShiftRow(-1)
-    , m_lastShiftClickedIndex(-1), lastChanged(false), m_iBaseHeight(0)
-    , m_index(0), m_mainListWidget(nullptr), currentTimeLineLoad(0)
+    , m_iBaseHeight(0), m_index(0), m_timelineView(nullptr)
 {
     setAcceptDrops(true);
     m_oe = new QGraphicsOpacityEffect(this);
@@ -82,44 +83,136 @@ int ImportTimeLineView::getIBaseHeight()
 
 void ImportTimeLineView::getCurrentSelectPics()
 {
-    bool bDeleteAll = false;
-    bool first = true;
-    QStringList paths;
-
-    for (int i = 0; i < m_allThumbnailListView.size(); i++) {
-        paths << m_allThumbnailListView[i]->selectedPaths();
-        bDeleteAll = m_allThumbnailListView[i]->isAllPicSeleted();
-        if (first && paths.length() > 0) {
-            if (!bDeleteAll) {
-                selectPrePaths = m_allThumbnailListView[i]->m_model->index(m_allThumbnailListView[i]->m_timeLineSelectPrePic, 0).data().toList().at(1).toString();
-                int index = 1;
-                while (paths.contains(selectPrePaths)) {
-                    selectPrePaths = m_allThumbnailListView[i]->m_model->index(index, 0).data().toList().at(1).toString();
-                    index ++ ;
-                    if (index == m_allThumbnailListView[i]->m_model->rowCount() - 1)
-                        break;
-                }
-            } else {
-                if (i > 1) {
-                    selectPrePaths = m_allThumbnailListView[i - 1]->m_model->index(0, 0).data().toList().at(1).toString();
-                } else {
-                    selectPrePaths = "";
-                }
-            }
-            first = false;
+    ThumbnailModel *model = m_timelineView->m_model;
+    const QStringList paths = m_timelineView->selectedPaths();
+    selectPrePaths = "";
+    if (paths.isEmpty() || m_timelineView->isAllPicSeleted()) {
+        return;
+    }
+    //删除后跳转到第一张选中图片之前的图片，没有则取之后第一张未删除的
+    const QSet<QString> deleted = paths.toSet();
+    int firstSelected = model->rowCount();
+    for (const QModelIndex &index : m_timelineView->selectionModel()->selectedIndexes()) {
+        firstSelected = qMin(firstSelected, index.row());
+    }
+    for (int row = firstSelected - 1; row >= 0 && selectPrePaths.isEmpty(); row--) {
+        if (!model->isHeader(row)) {
+            selectPrePaths = model->pathAt(row);
+        }
+    }
+    for (int row = firstSelected + 1; row < model->rowCount() && selectPrePaths.isEmpty(); row++) {
+        if (!model->isHeader(row) && !deleted.contains(model->pathAt(row))) {
+            selectPrePaths = model->pathAt(row);
         }
     }
 }
 
-
 void ImportTimeLineView::initConnections()
 {
-    connect(m_mainListWidget, &TimelineListWidget::sigNewTime, this, &ImportTimeLineView::onNewTime);
-//    connect(m_mainListWidget, &TimelineListWidget::sigDelTime, this, &ImportTimeLineView::on_DelLabel);
-    connect(m_mainListWidget, &TimelineListWidget::sigMoveTime, this, &ImportTimeLineView::on_MoveLabel);
     connect(DApplicationHelper::instance(), &DApplicationHelper::themeTypeChanged, this, &ImportTimeLineView::themeChangeSlot);
     // 重复导入图片选中
     connect(dApp->signalM, &SignalManager::RepeatImportingTheSamePhotos, this, &ImportTimeLineView::onRepeatImportingTheSamePhotos);
+
+    //悬浮标题跟随滚动位置
+    connect(m_timelineView->verticalScrollBar(), &QScrollBar::valueChanged, this, &ImportTimeLineView::updateDateItem);
+    connect(this, &ImportTimeLineView::sigResizeTimelineBlock, m_timelineView, &ThumbnailListView::slotReCalcTimelineSize);
+    connect(m_timelineView, &ThumbnailListView::sigMoveToTrash, this, &ImportTimeLineView::getCurrentSelectPics);
+    connect(m_timelineView, &ThumbnailListView::openImage, this, [ = ](int index) {
+        SignalManager::ViewInfo info;
+        info.album = "";
+        info.lastPanel = nullptr;
+        //与原来一样只在同一次导入的图片中浏览
+        const QStringList paths = sectionPaths(index);
+        if (paths.size() > 1) {
+            info.paths = paths;
+        }
+        info.path = m_timelineView->m_model->pathAt(index);
+        info.viewType = COMMON_STR_RECENT_IMPORTED;
+        info.viewMainWindowID = VIEW_MAINWINDOW_ALBUM;
+        emit dApp->signalM->viewImage(info);
+        emit dApp->signalM->showImageView(VIEW_MAINWINDOW_ALBUM);
+    });
+    connect(m_timelineView, &ThumbnailListView::menuOpenImage, this, [ = ](QString path, QStringList paths, bool isFullScreen, bool isSlideShow) {
+        SignalManager::ViewInfo info;
+        info.album = "";
+        info.lastPanel = nullptr;
+        const QStringList photolist = sectionPaths(m_timelineView->m_model->rowOf(path));
+        if (paths.size() > 1) {
+            info.paths = paths;
+        } else if (photolist.size() > 1) {
+            info.paths = photolist;
+        }
+        info.path = path;
+        info.fullScreen = isFullScreen;
+        info.slideShow = isSlideShow;
+        info.viewType = COMMON_STR_RECENT_IMPORTED;
+        info.viewMainWindowID = VIEW_MAINWINDOW_ALBUM;
+        if (info.slideShow) {
+            if (photolist.count() == 1) {
+                info.paths = paths;
+            }
+
+            QStringList pathlist;
+            pathlist.clear();
+            for (auto path : info.paths) {
+                if (QFileInfo(path).exists()) {
+                    pathlist << path;
+                }
+            }
+
+            info.paths = pathlist;
+            emit dApp->signalM->startSlideShow(info);
+            emit dApp->signalM->showSlidePanel(VIEW_MAINWINDOW_ALBUM);
+        } else {
+            emit dApp->signalM->viewImage(info);
+            emit dApp->signalM->showImageView(VIEW_MAINWINDOW_ALBUM);
+        }
+    });
+    connect(m_timelineView, &ThumbnailListView::sigMousePress, this, [ = ](QMouseEvent * event) {
+        if (event->button() == Qt::LeftButton) {
+            m_ctrlPress = false;
+        }
+    });
+    //连选已在列表内按行号完成，这里只刷新计数
+    connect(m_timelineView, &ThumbnailListView::sigShiftMousePress, this, [ = ] {
+        emit sigUpdatePicNum();
+        updateChoseText();
+    });
+    connect(m_timelineView, &ThumbnailListView::sigCtrlMousePress, this, [ = ] {
+        m_ctrlPress = true;
+        emit sigUpdatePicNum();
+        updateChoseText();
+    });
+    connect(m_timelineView, &ThumbnailListView::sigGetSelectedPaths, this, [ = ](QStringList * pPaths) {
+        pPaths->clear();
+        pPaths->append(m_timelineView->selectedPaths());
+    });
+    connect(m_timelineView, &ThumbnailListView::sigSelectAll, this, [ = ] {
+        m_ctrlPress = true;
+        emit sigUpdatePicNum();
+        updateChoseText();
+    });
+    connect(m_timelineView, &ThumbnailListView::sigMouseMove, this, [ = ] {
+        emit sigUpdatePicNum();
+        updateChoseText();
+    });
+    connect(m_timelineView, &ThumbnailListView::sigMouseRelease, this, [ = ] {
+        emit sigUpdatePicNum();
+        updateChoseText();
+    });
+    connect(m_timelineView, &ThumbnailListView::customContextMenuRequested, this, [ = ] {
+        emit sigUpdatePicNum();
+        updateChoseText();
+    });
+    connect(m_timelineView, &ThumbnailListView::sigSectionSelectionChanged, this, [ = ] {
+        m_ctrlPress = true;
+        emit sigUpdatePicNum();
+        updateChoseText();
+    });
+    connect(m_timelineView, &ThumbnailListView::sigMenuItemDeal, this, [ = ](QAction * action) {
+        m_timelineView->menuItemDeal(m_timelineView->selectedPaths(), action);
+    });
+    connect(m_timelineView, &ThumbnailListView::sigKeyEvent, this, &ImportTimeLineView::on_KeyEvent);
 }
 
 void ImportTimeLineView::themeChangeSlot(DGuiApplicationHelper::ColorType themeType)
@@ -158,55 +251,22 @@ void ImportTimeLineView::themeChangeSlot(DGuiApplicationHelper::ColorType themeT
     m_pDate->setPalette(pal1);
     pNum_up->setPalette(pal1);
 
-    for (int i = 1; i < m_mainListWidget->count(); i++) {
-        TimelineItem *item = static_cast<TimelineItem *>(m_mainListWidget->itemWidget(m_mainListWidget->item(i)));
-        QList<DLabel *> pLabelList = item->findChildren<DLabel *>();
-//        DPalette color = DApplicationHelper::instance()->palette(pLabelList[0]);
-//        color.setBrush(DPalette::Text, color.color(DPalette::ToolTipText));
-//        pLabelList[0]->setForegroundRole(DPalette::Text);
-//        pLabelList[0]->setPalette(color);
-        if (pLabelList.size() < 2) {
-            break;
-        }
-        DPalette pal = DApplicationHelper::instance()->palette(pLabelList[1]);
-        QColor color_BT = pal.color(DPalette::BrightText);
-        DGuiApplicationHelper::ColorType themeType = DGuiApplicationHelper::instance()->themeType();
-        if (themeType == DGuiApplicationHelper::LightType) {
-            color_BT.setAlphaF(0.5);
-            pal.setBrush(DPalette::Text, color_BT);
-        } else if (themeType == DGuiApplicationHelper::DarkType) {
-            color_BT.setAlphaF(0.75);
-            pal.setBrush(DPalette::Text, color_BT);
-        }
-        pLabelList[1]->setForegroundRole(DPalette::Text);
-        pLabelList[0]->setForegroundRole(DPalette::Text);
-        pLabelList[0]->setPalette(pal);
-        pLabelList[1]->setPalette(pal);
-    }
+    //分组标题由代理按当前主题绘制，重绘即可
+    m_timelineView->viewport()->update();
 }
 
 void ImportTimeLineView::resizeHand()
 {
-    for (ThumbnailListView *list : m_allThumbnailListView) {
-        list->resizeHand();
-    }
+    m_timelineView->resizeHand();
 }
 
 ThumbnailListView *ImportTimeLineView::getFirstListView()
 {
-    if (m_allThumbnailListView.count() > 0)
-        return m_allThumbnailListView.at(0);
-    else
-        return nullptr;
+    return m_timelineView;
 }
 
 void ImportTimeLineView::updateSize()
 {
-    for (int i = 0; i < m_allThumbnailListView.length(); i++) {
-        m_allThumbnailListView[i]->setFixedWidth(width() + 2);
-        ThumbnailListView *view = m_allThumbnailListView[i];
-        emit view->needResizeLabel();
-    }
     m_dateItem->setFixedSize(width() - 15, SUBTITLE_HEIGHT);
     m_pImportTitle->setFixedSize(width() - 15, 47); //add 3
 }
@@ -223,86 +283,81 @@ void ImportTimeLineView::onRepeatImportingTheSamePhotos(QStringList importPaths,
     // 导入的照片重复照片提示
     if (duplicatePaths.size() > 0 && albumName.length() < 1 && dApp->getMainWindow()->getCurrentViewType() == 2) {
         QTimer::singleShot(100, this, [ = ] {
-            for (ThumbnailListView *list : m_allThumbnailListView)
-            {
-                // 注意导入界面为多行listview处理类型
-                list->selectDuplicatePhotos(duplicatePaths, true);
-            }
+            m_timelineView->selectDuplicatePhotos(duplicatePaths);
         });
     }
 }
 
 void ImportTimeLineView::onSuspensionChoseBtnClicked()
 {
-    if (QObject::tr("Select") == pSuspensionChose->text()) {
-        pSuspensionChose->setText(QObject::tr("Unselect"));
-        QList<ThumbnailListView *> p = m_mainListWidget->itemWidget(m_mainListWidget->item(m_index))->findChildren<ThumbnailListView *>();
-        if (p.size() > 0) {
-            p[0]->selectAll();
-            emit sigUpdatePicNum();
-        }
-        for (int i = 0; i < m_allChoseButton.length(); i++) {
-            if (m_allThumbnailListView[i] == p[0]) {
-                lastClickedIndex = i;
-                lastRow = 0;
-                lastChanged = true;
-            }
-        }
-    } else {
-        pSuspensionChose->setText(QObject::tr("Select"));
-        QList<ThumbnailListView *> p = m_mainListWidget->itemWidget(m_mainListWidget->item(m_index))->findChildren<ThumbnailListView *>();
-        if (p.size() > 0) {
-            p[0]->clearSelection();
-            emit sigUpdatePicNum();
-        }
-    }
-#if 1
-    QList<DCommandLinkButton *> b = m_mainListWidget->itemWidget(m_mainListWidget->item(m_index))->findChildren<DCommandLinkButton *>();
-    if (b.size() > 0) {
-        b[0]->setText(pSuspensionChose->text());
-    }
-#endif
+    const bool select = QObject::tr("Select") == pSuspensionChose->text();
+    pSuspensionChose->setText(select ? QObject::tr("Unselect") : QObject::tr("Select"));
+    m_timelineView->setSectionSelected(m_index, select);
+    emit sigUpdatePicNum();
 }
 
 QStringList ImportTimeLineView::selectPaths()
+{
+    return m_timelineView->selectedPaths();
+}
+
+void ImportTimeLineView::updateChoseText()
+{
+    //列表中的选择文字在绘制时按选中状态生成，这里只同步悬浮标题
+    if (m_timelineView->m_model->isHeader(m_index)) {
+        pSuspensionChose->setText(m_timelineView->isSectionSelected(m_index) ? QObject::tr("Unselect") : QObject::tr("Select"));
+    }
+    m_timelineView->viewport()->update();
+}
+
+QStringList ImportTimeLineView::sectionPaths(int row) const
 {
     QStringList paths;
-    for (int i = 0; i < m_allThumbnailListView.length(); i++) {
-        paths << m_allThumbnailListView[i]->selectedPaths();
+    const int header = m_timelineView->m_model->sectionOf(row);
+    if (header < 0) {
+        return paths;
+    }
+    const int last = m_timelineView->m_model->sectionEnd(header);
+    for (int i = header + 1; i <= last; i++) {
+        paths << m_timelineView->m_model->pathAt(i);
     }
     return paths;
 }
 
-void ImportTimeLineView::updateChoseText()
+void ImportTimeLineView::updateDateItem()
 {
-    for (int i = 0; i < m_allChoseButton.length(); i++) {
-        if (m_allThumbnailListView[i]->model()->rowCount() == m_allThumbnailListView[i]->selectedPaths().length() && QObject::tr("Select") == m_allChoseButton[i]->text()) {
-            m_allChoseButton[i]->setText(QObject::tr("Unselect"));
-        }
-
-        if (m_allThumbnailListView[i]->model()->rowCount() != m_allThumbnailListView[i]->selectedPaths().length() && QObject::tr("Unselect") == m_allChoseButton[i]->text()) {
-            m_allChoseButton[i]->setText(QObject::tr("Select"));
-        }
+    ThumbnailModel *model = m_timelineView->m_model;
+    const int header = m_timelineView->sectionAtTop();
+    if (header < 0) {
+        return;
+    }
+    const QString date = model->item(header).name;
+    const QString num = QString(QObject::tr("%1 photo(s)")).arg(model->item(header).sectionCount);
+    if (header != m_index) {
+        onNewTime(date, num, header);
     }
+    on_MoveLabel(0, date, num, pSuspensionChose->text());
 }
 
 void ImportTimeLineView::initTimeLineViewWidget()
 {
     m_mainLayout = new QVBoxLayout();
-    m_mainLayout->setContentsMargins(0, 0, 0, 0);
     pTimeLineViewWidget->setLayout(m_mainLayout);
 
     DPalette palcolor = DApplicationHelper::instance()->palette(pTimeLineViewWidget);
     palcolor.setBrush(DPalette::Base, palcolor.color(DPalette::Window));
     pTimeLineViewWidget->setPalette(palcolor);
 
-    m_mainListWidget = new TimelineListWidget(this);
-    m_mainListWidget->setFocusPolicy(Qt::NoFocus);
-    m_mainListWidget->setResizeMode(QListWidget::Adjust);
-    m_mainListWidget->setVerticalScrollMode(QListWidget::ScrollPerPixel);
-    m_mainListWidget->verticalScrollBar()->setSingleStep(20);
-    m_mainLayout->addWidget(m_mainListWidget);
-    m_mainListWidget->setFrameShape(DTableView::NoFrame);
+    //所有导入批次的图片放在同一个列表中，批次标题是不可选中的整行项
+    m_timelineView = new ThumbnailListView(ThumbnailDelegate::NullType, COMMON_STR_RECENT_IMPORTED);
+    m_timelineView->setFocusPolicy(Qt::NoFocus);
+    m_timelineView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_timelineView->setContextMenuPolicy(Qt::CustomContextMenu);
+    m_timelineView->setContentsMargins(0, 0, 0, 0);
+    m_timelineView->setFrameShape(DTableView::NoFrame);
+    m_timelineView->setVerticalScrollMode(QListView::ScrollPerPixel);
+    m_timelineView->verticalScrollBar()->setSingleStep(20);
+    m_mainLayout->addWidget(m_timelineView);
 
     //添加悬浮title
 
@@ -315,6 +370,7 @@ void ImportTimeLineView::initTimeLineViewWidget()
 //    m_pImportTitle->setFixedSize(width() - 10, 47);
     m_pImportTitle->setFixedHeight(36);
     m_pImportTitle->move(0, 50);
+    m_mainLayout->setContentsMargins(0, TITLEHEIGHT + m_pImportTitle->height(), 0, BOTTOM_MARGIN);
 
     DPalette ppal_light2 = DApplicationHelper::instance()->palette(m_pImportTitle);
     ppal_light2.setBrush(DPalette::Background, ppal_light2.color(DPalette::Base));
@@ -395,510 +451,79 @@ void ImportTimeLineView::initTimeLineViewWidget()
     m_dateItem->setAutoFillBackground(true);
     m_dateItem->setFixedSize(this->width() - 10, SUBTITLE_HEIGHT);
     m_dateItem->setContentsMargins(0, 0, 0, 0);
-    m_dateItem->move(0, 50 + m_pImportTitle->height()); //edit 3975
+    m_dateItem->move(0, TITLEHEIGHT + m_pImportTitle->height()); //edit 3975
     m_dateItem->show();
     m_dateItem->setVisible(true);
 }
 
 void ImportTimeLineView::clearAndStop()
 {
-    for (ThumbnailListView *list : m_allThumbnailListView) {
-        list->stopLoadAndClear();
-        delete list;
-    }
-    m_mainListWidget->clear();
-    m_allThumbnailListView.clear();
-    m_allChoseButton.clear();
-    currentTimeLineLoad = 0;
+    m_timelineView->stopLoadAndClear();
 }
 
 void ImportTimeLineView::clearAndStartLayout()
 {
-    for (ThumbnailListView *list : m_allThumbnailListView) {
-        list->stopLoadAndClear();
-        delete list;
-    }
-    m_allChoseButton.clear();
-    m_allThumbnailListView.clear();
-    m_mainListWidget->clear();
-    m_timelines.clear();
-    //获取所有时间线
-    m_timelines = DBManager::instance()->getImportTimelines();
-    qDebug() << __func__ << m_timelines.size();
-
-
-    if (0 < m_timelines.size()) {
-    } else {
-        m_dateItem->setVisible(false);
-    }
-    currentTimeLineLoad = 0;
-    //add start 3975
-    TimelineItem *blankWidget = new TimelineItem(this);
-    blankWidget->m_type = "blank";
-    QListWidgetItem *blankItem = new QListWidgetItem();
-    blankItem->setFlags(Qt::NoItemFlags);
-    m_mainListWidget->addItemForWidget(blankItem);
-    m_mainListWidget->setItemWidget(blankItem, blankWidget);
-    blankItem->setSizeHint(QSize(0, m_pImportTitle->height()));
-
-    addTimelineLayout();
+    //全部导入时间线及其图片在数据库线程一次查出，回调中装入列表
+    std::function<DBTimelineSections()> load = []() {
+        return DBManager::instance()->getImportTimelineSections();
+    };
+    std::function<void(const DBTimelineSections &)> callback = [this](const DBTimelineSections &result) {
+        loadTimelineSections(result);
+    };
+    DBAsyncManager::instance()->query(this, load, callback, "ImportTimeLineView::clearAndStartLayout");
 }
 
-void ImportTimeLineView::addTimelineLayout()
+void ImportTimeLineView::loadTimelineSections(const DBTimelineSections &result)
 {
-    if (currentTimeLineLoad >= m_timelines.size()) {
-        return;
-    }
-    int nowTimeLineLoad = currentTimeLineLoad;
-    //获取当前时间照片
-    DBImgInfoList ImgInfoList = DBManager::instance()->getInfosByImportTimeline(m_timelines.at(nowTimeLineLoad));
-
-    QListWidgetItem *item = new QListWidgetItem;
-    TimelineItem *listItem = new TimelineItem(this);
-    listItem->adjustSize();
-    QVBoxLayout *listItemlayout = new QVBoxLayout();
-    listItem->setLayout(listItemlayout);
-    listItemlayout->setContentsMargins(0, 0, 0, 0);
-
-    //添加title
-    DWidget *TitleView = new DWidget;
-    QHBoxLayout *TitleViewLayout = new QHBoxLayout();
-    TitleViewLayout->setContentsMargins(12, 0, 0, 0);
-    TitleView->setLayout(TitleViewLayout);
-    DLabel *pDate = new DLabel();
-    DFontSizeManager::instance()->bind(pDate, DFontSizeManager::T6, QFont::Medium);
-    pNum_dn = new DLabel();
-    DFontSizeManager::instance()->bind(pNum_dn, DFontSizeManager::T6, QFont::Medium);
-    pDate->setForegroundRole(DPalette::Text);
-    pDate->setFixedHeight(20);
-    pNum_dn->setFixedHeight(20);
-    QStringList dateTimeList = m_timelines.at(nowTimeLineLoad).split(" ");
-    QStringList datelist = dateTimeList.at(0).split(".");
-    if (datelist.count() > 2) {
-        if (dateTimeList.count() == 2) {
-            listItem->m_sdate = QString(QObject::tr("Imported on") + QObject::tr(" %1-%2-%3 %4"))
-                                .arg(datelist[0]).arg(datelist[1]).arg(datelist[2]).arg(dateTimeList[1]);
-        } else {
-            listItem->m_sdate = QString(QObject::tr("Imported on ") + QObject::tr("%1/%2/%3"))
-                                .arg(datelist[0]).arg(datelist[1]).arg(datelist[2]);
-        }
+    m_timelines.clear();
+    if (result.isEmpty()) {
+        m_dateItem->setVisible(false);
     }
 
-    QFont ft6 = DFontSizeManager::instance()->get(DFontSizeManager::T6);
-    ft6.setFamily("SourceHanSansSC");
-    ft6.setWeight(QFont::Medium);
-    DPalette pal = DApplicationHelper::instance()->palette(pNum_dn);
-    QColor color_BT = pal.color(DPalette::BrightText);
-    DGuiApplicationHelper::ColorType themeType = DGuiApplicationHelper::instance()->themeType();
-    if (themeType == DGuiApplicationHelper::LightType) {
-        color_BT.setAlphaF(0.5);
-        pal.setBrush(DPalette::Text, color_BT);
-
-    } else if (themeType == DGuiApplicationHelper::DarkType) {
-        color_BT.setAlphaF(0.75);
-        pal.setBrush(DPalette::Text, color_BT);
+    QStringList titles;
+    QList<DBImgInfoList> sections;
+    for (const auto &section : result) {
+        const QString &timeline = section.first;
+        m_timelines << timeline;
+        QString title;
+        QStringList dateTimeList = timeline.split(" ");
+        QStringList datelist = dateTimeList.at(0).split(".");
+        if (datelist.count() > 2) {
+            if (dateTimeList.count() == 2) {
+                title = QString(QObject::tr("Imported on") + QObject::tr(" %1-%2-%3 %4"))
+                        .arg(datelist[0]).arg(datelist[1]).arg(datelist[2]).arg(dateTimeList[1]);
+            } else {
+                title = QString(QObject::tr("Imported on ") + QObject::tr("%1/%2/%3"))
+                        .arg(datelist[0]).arg(datelist[1]).arg(datelist[2]);
+            }
+        }
+        titles << title;
+        sections << section.second;
     }
-    pDate->setForegroundRole(DPalette::Text);
-    pNum_dn->setForegroundRole(DPalette::Text);
-    pDate->setFont(ft6);
-    pNum_dn->setFont(ft6);
-    pDate->setPalette(pal);
-    pNum_dn->setPalette(pal);
-    pDate->setText(listItem->m_sdate);
-    listItem->m_date = pDate;
-    listItem->m_snum = QString(QObject::tr("%1 photo(s)")).arg(ImgInfoList.size());
-    pNum_dn->setForegroundRole(DPalette::Text);
-    pNum_dn->setText(listItem->m_snum);
 
-    QHBoxLayout *Layout = new QHBoxLayout();
-    DCommandLinkButton *pChose = new DCommandLinkButton(QObject::tr("Select"));
-    pChose->setFocusPolicy(Qt::NoFocus);
-    m_allChoseButton << pChose;
-    DFontSizeManager::instance()->bind(pChose, DFontSizeManager::T5);
-    pChose->setFont(DFontSizeManager::instance()->get(DFontSizeManager::T5));
-    pChose->resize(36, 30);
-
-    pNum_dn->setLayout(Layout);
-    Layout->addStretch(1);
-    Layout->setAlignment(Qt::AlignLeft | Qt::AlignTop);
-    Layout->setContentsMargins(0, 0, 36, 0);
-    Layout->addWidget(pChose);
-
-    listItem->m_Chose = pChose;
-    listItem->m_num = pNum_dn;
-    TitleViewLayout->addWidget(pDate);
-    TitleViewLayout->addWidget(pNum_dn);
-    TitleView->setFixedHeight(SUBTITLE_HEIGHT);
-    listItem->m_title = TitleView;
-
-    //添加照片
-    ThumbnailListView *pThumbnailListView = new ThumbnailListView(ThumbnailDelegate::NullType, COMMON_STR_RECENT_IMPORTED);
-    pThumbnailListView->setFocusPolicy(Qt::NoFocus);
-    int m_Baseheight =  getIBaseHeight();
+    int m_Baseheight = getIBaseHeight();
     if (m_Baseheight == 0) {
         return;
-    } else {
-        pThumbnailListView->setIBaseHeight(m_Baseheight);
-    }
-
-    connect(pThumbnailListView, &ThumbnailListView::loadEnd, this, &ImportTimeLineView::addTimelineLayout);
-    connect(this, &ImportTimeLineView::sigResizeTimelineBlock, pThumbnailListView, &ThumbnailListView::slotReCalcTimelineSize);
-    connect(pThumbnailListView, &ThumbnailListView::needResize, this, [ = ](int h) {
-        if (!pThumbnailListView->checkResizeNum())
-            return ;
-        if (isVisible()) {
-            int mh = h;
-            if (0 == nowTimeLineLoad) {
-                mh += 50;
-            }
-            if (nowTimeLineLoad == m_timelines.size() - 1) {
-                mh += 27;
-            }
-            pThumbnailListView->setFixedHeight(mh);
-            listItem->setFixedHeight(TitleView->height() + mh);
-            item->setSizeHint(listItem->rect().size());
-        }
-    });
-
-    m_allThumbnailListView.append(pThumbnailListView);
-    pThumbnailListView->setEditTriggers(QAbstractItemView::NoEditTriggers);
-    pThumbnailListView->setContextMenuPolicy(Qt::CustomContextMenu);
-    pThumbnailListView->setContentsMargins(0, 0, 0, 0);
-    pThumbnailListView->setFrameShape(DTableView::NoFrame);
-    //保存当前时间照片
-    pThumbnailListView->loadFilesFromLocal(ImgInfoList);
-    pThumbnailListView->m_imageType = COMMON_STR_RECENT_IMPORTED;
-    connect(pThumbnailListView, &ThumbnailListView::sigMoveToTrash, this, &ImportTimeLineView::getCurrentSelectPics);
-
-    if (0 == nowTimeLineLoad) {
-        DWidget *topwidget = new DWidget;
-        topwidget->setFixedHeight(50);
-        listItemlayout->addWidget(topwidget);
-    }
-    listItemlayout->addWidget(TitleView);
-    listItemlayout->addSpacing(-8);
-    listItemlayout->addWidget(pThumbnailListView);
-    if (nowTimeLineLoad == m_timelines.size() - 1) {
-        DWidget *bottomwidget = new DWidget;
-        bottomwidget->setFixedHeight(27);
-        listItemlayout->addWidget(bottomwidget);
     }
-    item->setFlags(Qt::NoItemFlags);
-    m_mainListWidget->addItemForWidget(item);
-    m_mainListWidget->setItemWidget(item, listItem);
-
-    connect(pThumbnailListView, &ThumbnailListView::openImage, this, [ = ](int index) {
-        SignalManager::ViewInfo info;
-        info.album = "";
-        info.lastPanel = nullptr;
-        if (ImgInfoList.size() <= 1) {
-            info.paths.clear();
-        } else {
-            for (auto image : ImgInfoList) {
-                info.paths << image.filePath;
-            }
-        }
-        info.path = ImgInfoList[index].filePath;
-        info.viewType = COMMON_STR_RECENT_IMPORTED;
-        info.viewMainWindowID = VIEW_MAINWINDOW_ALBUM;
-        emit dApp->signalM->viewImage(info);
-        emit dApp->signalM->showImageView(VIEW_MAINWINDOW_ALBUM);
-    });
-    connect(pThumbnailListView, &ThumbnailListView::menuOpenImage, this, [ = ](QString path, QStringList paths, bool isFullScreen, bool isSlideShow) {
-        SignalManager::ViewInfo info;
-        info.album = "";
-        info.lastPanel = nullptr;
-
-
-        if (paths.size() > 1) {
-            info.paths = paths;
-        } else {
-            auto photolist = pThumbnailListView->getAllFileList();
-            if (photolist.size() > 1) {
-                for (auto image : photolist) {
-                    info.paths << image;
-                }
-            } else {
-                info.paths.clear();
-            }
-        }
-        info.path = path;
-        info.fullScreen = isFullScreen;
-        info.slideShow = isSlideShow;
-        info.viewType = COMMON_STR_RECENT_IMPORTED;
-        info.viewMainWindowID = VIEW_MAINWINDOW_ALBUM;
-        if (info.slideShow) {
-            if (ImgInfoList.count() == 1) {
-                info.paths = paths;
-            }
-
-            QStringList pathlist;
-            pathlist.clear();
-            for (auto path : info.paths) {
-                if (QFileInfo(path).exists()) {
-                    pathlist << path;
-                }
-            }
-
-            info.paths = pathlist;
-            emit dApp->signalM->startSlideShow(info);
-            emit dApp->signalM->showSlidePanel(VIEW_MAINWINDOW_ALBUM);
-        } else {
-            emit dApp->signalM->viewImage(info);
-            emit dApp->signalM->showImageView(VIEW_MAINWINDOW_ALBUM);
-        }
-    });
-    connect(pChose, &DCommandLinkButton::clicked, this, [ = ] {
-        if (QObject::tr("Select") == pChose->text())
-        {
-            pChose->setText(QObject::tr("Unselect"));
-            pThumbnailListView->selectAll();
-            for (int j = 0; j < m_allChoseButton.length(); j++) {
-                if (pChose == m_allChoseButton[j])
-                    lastClickedIndex = j;
-            }
-            lastRow = 0;
-            lastChanged = true;
-            m_ctrlPress = true;
-        } else
-        {
-            pChose->setText(QObject::tr("Select"));
-            pThumbnailListView->clearSelection();
-        }
-        emit sigUpdatePicNum();
-    });
-#if 1
-
-    connect(pThumbnailListView, &ThumbnailListView::sigMousePress, this, [ = ](QMouseEvent * event) {
-        lastRow = -1;
-//       If required only select one image at a time add this code
-        if (event->button() == Qt::LeftButton) {
-            for (int j = 0; j < m_allThumbnailListView.length(); j++) {
-                if (pThumbnailListView != m_allThumbnailListView[j]) {
-                    m_allThumbnailListView[j]->clearSelection();
-                }
-            }
-            m_ctrlPress = false;
-        }
-
-        for (int j = 0; j < m_allThumbnailListView.length(); j++) {
-            if (pThumbnailListView == m_allThumbnailListView[j]) {
-                lastClickedIndex = j;
-                lastRow = pThumbnailListView->getRow(QPoint(event->x(), event->y()));
-
-                if (-1 != lastRow)
-                    lastChanged = true;
-            }
-        }
-    });
-
-    connect(pThumbnailListView, &ThumbnailListView::sigShiftMousePress, this, [ = ](QMouseEvent * event) {
-        int curClickedIndex = -1;
-        int curRow = -1;
-        for (int j = 0; j < m_allThumbnailListView.length(); j++) {
-            if (pThumbnailListView == m_allThumbnailListView[j]) {
-                curClickedIndex = j;
-                curRow = pThumbnailListView->getRow(QPoint(event->x(), event->y()));
-            }
-        }
-
-        if (!lastChanged && -1 != curRow && -1 != m_lastShiftRow) {
-            for (int j = 0; j < m_allThumbnailListView.length(); j++) {
-                m_allThumbnailListView[j]->clearSelection();
-            }
-        }
-
-        if (curRow == -1 || lastRow == -1) {
-            for (int j = 0; j < m_allThumbnailListView.length(); j++) {
-                m_allThumbnailListView[j]->clearSelection();
-            }
-        } else {
-            if (lastClickedIndex < curClickedIndex) {
-                m_allThumbnailListView[lastClickedIndex]->selectRear(lastRow);
-                m_allThumbnailListView[curClickedIndex]->selectFront(curRow);
-                for (int j = lastClickedIndex + 1; j < curClickedIndex; j++) {
-                    m_allThumbnailListView[j]->selectAll();
-                }
-            } else if (lastClickedIndex > curClickedIndex) {
-                m_allThumbnailListView[lastClickedIndex]->selectFront(lastRow);
-                m_allThumbnailListView[curClickedIndex]->selectRear(curRow);
-                for (int j = curClickedIndex + 1; j < lastClickedIndex; j++) {
-                    m_allThumbnailListView[j]->selectAll();
-                }
-            } else if (lastClickedIndex == curClickedIndex) {
-                if (lastRow <= curRow)
-                    pThumbnailListView->selectExtent(lastRow, curRow);
-                else
-                    pThumbnailListView->selectExtent(curRow, lastRow);
-            }
-            emit sigUpdatePicNum();
-            updateChoseText();
-            m_lastShiftRow = curRow;
-            m_lastShiftClickedIndex = curClickedIndex;
-            curRow = -1;
-            lastChanged = false;
-        }
-    });
-
-    connect(pThumbnailListView, &ThumbnailListView::sigCtrlMousePress, this, [ = ](QMouseEvent * event) {
-
-        m_ctrlPress = true;
-
-        for (int j = 0; j < m_allThumbnailListView.length(); j++) {
-            if (pThumbnailListView == m_allThumbnailListView[j]) {
-                lastClickedIndex = j;
-                lastRow = pThumbnailListView->getRow(QPoint(event->x(), event->y()));
-                if (-1 != lastRow)
-                    lastChanged = true;
-            }
-        }
-        emit sigUpdatePicNum();
-        updateChoseText();
-    });
-
-    connect(pThumbnailListView, &ThumbnailListView::sigGetSelectedPaths, this, [ = ](QStringList * pPaths) {
-        pPaths->clear();
-        for (int j = 0; j < m_allThumbnailListView.size(); j++) {
-            pPaths->append(m_allThumbnailListView[j]->selectedPaths());
-        }
-    });
-
-    connect(pThumbnailListView, &ThumbnailListView::sigSelectAll, this, [ = ] {
-        m_ctrlPress = true;
-        for (int j = 0; j < m_allThumbnailListView.length(); j++)
-        {
-            m_allThumbnailListView[j]->selectAll();
-        }
-        emit sigUpdatePicNum();
-        updateChoseText();
-        QList<DCommandLinkButton *> b = m_mainListWidget->itemWidget(m_mainListWidget->item(m_index))->findChildren<DCommandLinkButton *>();
-        pSuspensionChose->setText(b[0]->text());
-    });
-
-    connect(pThumbnailListView, &ThumbnailListView::sigMouseMove, this, [ = ] {
-        emit sigUpdatePicNum();
-        updateChoseText();
-    });
-
-    connect(pThumbnailListView, &ThumbnailListView::sigMouseRelease, this, [ = ] {
-        if (!m_ctrlPress)
-        {
-            for (int j = 0; j < m_allThumbnailListView.length(); j++) {
-                if (pThumbnailListView != m_allThumbnailListView[j]) {
-                    m_allThumbnailListView[j]->clearSelection();
-                }
-            }
-        }
-        emit sigUpdatePicNum();
-        updateChoseText();
-        QList<DCommandLinkButton *> b = m_mainListWidget->itemWidget(m_mainListWidget->item(m_index))->findChildren<DCommandLinkButton *>();
-        pSuspensionChose->setText(b[0]->text());
-    });
-
-    connect(pThumbnailListView, &ThumbnailListView::customContextMenuRequested, this, [ = ] {
-        QStringList paths = pThumbnailListView->selectedPaths();
-        if (pThumbnailListView->model()->rowCount() == paths.length() && QObject::tr("Select") == pChose->text())
-        {
-            pChose->setText(QObject::tr("Unselect"));
-        }
-
-        if (pThumbnailListView->model()->rowCount() != paths.length() && QObject::tr("Unselect") == pChose->text())
-        {
-            pChose->setText(QObject::tr("Select"));
-        }
-        emit sigUpdatePicNum();
-    });
-    connect(pThumbnailListView, &ThumbnailListView::sigMenuItemDeal, this, [ = ](QAction * action) {
-        QStringList paths;
-        paths.clear();
-        for (int j = 0; j < m_allThumbnailListView.size(); j++) {
-            paths << m_allThumbnailListView[j]->selectedPaths();
-        }
-        pThumbnailListView->menuItemDeal(paths, action);
-    });
-    connect(pThumbnailListView, &ThumbnailListView::needResizeLabel, this, [ = ] {
-        listItem->m_title->setFixedWidth(width() - 14);
-    });
-    connect(listItem, &TimelineItem::sigMousePress, this, [ = ] {
-        for (int j = 0; j < m_allThumbnailListView.length(); j++)
-        {
-            m_allThumbnailListView[j]->clearSelection();
-        }
-        lastRow = -1;
-        emit sigUpdatePicNum();
-        updateChoseText();
-    });
-#endif
-    connect(m_allThumbnailListView[nowTimeLineLoad], &ThumbnailListView::sigKeyEvent, this, &ImportTimeLineView::on_KeyEvent);
+    m_timelineView->setIBaseHeight(m_Baseheight);
+    m_timelineView->loadSections(titles, sections, SUBTITLE_HEIGHT);
+    m_index = -1;
+    updateDateItem();
     emit sigUpdatePicNum();
-    currentTimeLineLoad++;
 
     //界面可见时,调整整体大小
     if (m_bshow) {
         updateSize();
     }
 
-    //判断跳转位置图片是否包含在当前listview
-    if (selectPrePaths.length() > 0 && !isFindPic) {
-        for (DBImgInfo &imgInfo : ImgInfoList) {
-            if (imgInfo.filePath == selectPrePaths) {
-                hasPicViewNum = nowTimeLineLoad;
-                qDebug() << "have find pic view num: " << hasPicViewNum;
-                isFindPic = true;
-                break;
-            }
+    //跳转到删除前的位置
+    if (!selectPrePaths.isEmpty()) {
+        const int row = m_timelineView->m_model->rowOf(selectPrePaths);
+        if (row >= 0) {
+            m_timelineView->scrollTo(m_timelineView->m_model->index(row, 0), QAbstractItemView::PositionAtCenter);
         }
+        selectPrePaths = "";
     }
-    QTimer::singleShot(150, this, [ = ] {
-        if (nowTimeLineLoad == m_timelines.size() - 1 && hasPicViewNum >= 0)
-        {
-            int height = 0;
-            for (int i = 0; i < m_timelines.size(); i++) {
-                if (i < hasPicViewNum) {
-                    height = height + m_allThumbnailListView[i]->height() + m_allChoseButton[0]->height();
-                }
-                if (i == hasPicViewNum) {
-                    for (int j = 0; j < m_allThumbnailListView[i]->m_model->rowCount(); j ++) {
-                        QModelIndex index = m_allThumbnailListView[i]->m_model->index(j, 0);
-                        QVariantList lst = index.model()->data(index, Qt::DisplayRole).toList();
-                        int rowcount = 0;
-                        int allrowcount = 0;
-                        if (lst.count() >= 12) {
-                            QString path = lst.at(1).toString();
-                            if (path == selectPrePaths) {
-                                if (index.row() % m_allThumbnailListView[i]->rowSizeHint == 0) {
-                                    rowcount = index.row() / m_allThumbnailListView[i]->rowSizeHint;
-                                } else {
-                                    rowcount = index.row() / m_allThumbnailListView[i]->rowSizeHint + 1;
-                                }
-                                if ((m_allThumbnailListView[i]->m_model->rowCount() % m_allThumbnailListView[i]->rowSizeHint) == 0) {
-                                    allrowcount = m_allThumbnailListView[i]->m_model->rowCount() / m_allThumbnailListView[i]->rowSizeHint ;
-                                } else {
-                                    allrowcount = m_allThumbnailListView[i]->m_model->rowCount() / m_allThumbnailListView[i]->rowSizeHint + 1;
-                                }
-                                double tempheight = rowcount / static_cast<double>(allrowcount);
-                                int thumbnailheight =  m_allThumbnailListView[i]->m_height;
-                                double finalheight = tempheight * thumbnailheight;
-                                height = height + static_cast<int>(finalheight) ;
-
-                                if (hasPicViewNum == 0)
-                                    height = height - m_allThumbnailListView[i]->m_onePicWidth;
-                                break;
-                            }
-                        }
-                    }
-                    break;
-                }
-            }
-            //相对界面调整位置
-            int modify = (dApp->getMainWindow()->height() - 140 - m_allThumbnailListView[0]->m_onePicWidth) / 2;
-            height -= modify;
-            m_mainListWidget->verticalScrollBar()->setValue(height);
-            hasPicViewNum = -1;
-            selectPrePaths = "";
-            isFindPic = false;
-        }
-    });
 }
 
 void ImportTimeLineView::getFatherStatusBar(DSlider *s)
@@ -908,17 +533,14 @@ void ImportTimeLineView::getFatherStatusBar(DSlider *s)
 
 void ImportTimeLineView::on_AddLabel(QString date, QString num)
 {
-    if ((nullptr != m_dateItem) && (nullptr != m_mainListWidget)) {
+    if ((nullptr != m_dateItem) && (nullptr != m_timelineView)) {
         QList<QLabel *> labelList = m_dateItem->findChildren<QLabel *>();
         labelList[0]->setText(date);
         labelList[1]->setText(num);
         m_dateItem->setVisible(true);
-        m_dateItem->move(0, 50 + m_pImportTitle->height()); //edit 3975
+        m_dateItem->move(0, TITLEHEIGHT + m_pImportTitle->height()); //edit 3975
+        pSuspensionChose->setText(m_timelineView->isSectionSelected(m_index) ? QObject::tr("Unselect") : QObject::tr("Select"));
     }
-#if 1
-    QList<DCommandLinkButton *> b = m_mainListWidget->itemWidget(m_mainListWidget->item(m_index))->findChildren<DCommandLinkButton *>();
-    pSuspensionChose->setText(b[0]->text());
-#endif
 }
 
 //void ImportTimeLineView::on_DelLabel()
@@ -937,7 +559,7 @@ void ImportTimeLineView::on_MoveLabel(int y, QString date, QString num, QString
 #endif
 {
     Q_UNUSED(y);
-    if ((nullptr != m_dateItem) && (nullptr != m_mainListWidget)) {
+    if ((nullptr != m_dateItem) && (nullptr != m_timelineView)) {
         QList<QLabel *> labelList = m_dateItem->findChildren<QLabel *>();
         labelList[0]->setText(date);
         labelList[1]->setText(num);
@@ -951,18 +573,18 @@ void ImportTimeLineView::on_KeyEvent(int key)
     qDebug() << key;
 
     if (key == Qt::Key_PageDown) {
-        QScrollBar *vb = m_mainListWidget->verticalScrollBar();
+        QScrollBar *vb = m_timelineView->verticalScrollBar();
         int posValue = vb->value();
         qDebug() << "posValue" << posValue;
 
-        posValue += m_mainListWidget->height();
+        posValue += m_timelineView->height();
         vb->setValue(posValue);
     } else if (key == Qt::Key_PageUp) {
-        QScrollBar *vb = m_mainListWidget->verticalScrollBar();
+        QScrollBar *vb = m_timelineView->verticalScrollBar();
         int posValue = vb->value();
         qDebug() << "posValue" << posValue;
 
-        posValue -= m_mainListWidget->height();
+        posValue -= m_timelineView->height();
         vb->setValue(posValue);
     }
 
@@ -1029,9 +651,7 @@ void ImportTimeLineView::mousePressEvent(QMouseEvent *e)
 {
     qDebug() << "鼠标按下：";
     if (!m_ctrlPress && e->button() == Qt::LeftButton) {
-        for (int i = 0; i < m_allThumbnailListView.length(); i++) {
-            m_allThumbnailListView[i]->clearSelection();
-        }
+        m_timelineView->clearSelection();
         emit sigUpdatePicNum();
         updateChoseText();
     }
@@ -72,7 +72,7 @@ private:
 
 public:
     void clearAndStartLayout();
-    void addTimelineLayout();
+    void loadTimelineSections(const DBTimelineSections &result);
     void getFatherStatusBar(DSlider *s);
     void themeChangeSlot(DGuiApplicationHelper::ColorType themeType);
     void resizeHand();  //手动计算大小
@@ -90,12 +90,16 @@ private slots:
     void onNewTime(QString date, QString num, int index);
     void onRepeatImportingTheSamePhotos(QStringList importPaths, QStringList duplicatePaths, QString albumName);
     void onSuspensionChoseBtnClicked();
+    //按滚动位置更新悬浮的导入时间标题
+    void updateDateItem();
 
 signals:
     void sigUpdatePicNum();
 
 private:
     void clearAndStop();
+    //row所在导入批次的全部图片
+    QStringList sectionPaths(int row) const;
     QLayout *m_mainLayout;
     QList<QString> m_timelines;
     DWidget *m_dateItem;
@@ -106,30 +110,19 @@ private:
     int allnum;
     DLabel *m_pDate;
     DLabel *pNum_up;
-    DLabel *pNum_dn;
     DLabel *m_pImportTitle; //add 3975
     DSlider *m_DSlider;
-    QList<ThumbnailListView *> m_allThumbnailListView;
-    QList<DCommandLinkButton *> m_allChoseButton;
     QGraphicsOpacityEffect *m_oe;
     QGraphicsOpacityEffect *m_oet;
 
     bool m_ctrlPress;
-    int lastClickedIndex;
-    int lastRow;
-    int m_lastShiftRow;
-    int m_lastShiftClickedIndex;
-    bool lastChanged;
     int m_iBaseHeight;
     bool m_bshow = false;
 
 public:
-    int m_index;
-    TimelineListWidget *m_mainListWidget;
-    int currentTimeLineLoad;
+    int m_index;                        //悬浮标题对应的标题行
+    ThumbnailListView *m_timelineView;  //全部导入批次共用的列表
     QString selectPrePaths = "";//跳转的上一图片位置
-    int hasPicViewNum = -1;//包含跳转图片的view索引
-    bool isFindPic = false;
 };
 
 #endif // IMPORTTIMELINEVIEW_H
@@ -7,8 +7,10 @@
 #include "mainwindow.h"
 #include "dtktest.h"
 #include "imageengine/imageengineapi.h"
+#include "dbmanager/photocatalog.h"
 #include "accessibledefine.h"
 #include "accessible.h"
+#include "utils/startupprofiler.h"
 
 #include <DMainWindow>
 #include <DWidgetUtil>
@@ -55,6 +57,8 @@ QUrl UrlInfo(QString path)
 
 int main(int argc, char *argv[])
 {
+    //启动计时起点
+    StartupProfiler *profiler = StartupProfiler::instance();
 #if (DTK_VERSION < DTK_VERSION_CHECK(5, 4, 0, 0))
     QScopedPointer<DApplication> dAppNew(new DApplication(argc, argv));
 #else
@@ -76,7 +80,11 @@ int main(int argc, char *argv[])
     qputenv("DTK_USE_SEMAPHORE_SINGLEINSTANCE", "1");
 
     QCommandLineParser parser;
+    QCommandLineOption profileOption("startup-profile", "Print startup phase timings.");
+    parser.addOption(profileOption);
     parser.process(*dAppNew);
+    profiler->setEnabled(parser.isSet(profileOption));
+    profiler->mark("application created");
 
     QStringList urls;
     QStringList arguments = parser.positionalArguments();
@@ -173,12 +181,21 @@ int main(int argc, char *argv[])
     int picsize = picSize.value(num);
     int number = ((restoredFrameGeometry.width() - 50) * (restoredFrameGeometry.height() - 50)) / (picsize * picsize);
 
+    profiler->mark("settings loaded");
     DBManager::instance();
+    profiler->mark("database opened");
     ImageEngineApi::instance(dAppNew.get());
-    ImageEngineApi::instance()->loadFirstPageThumbnails(number);
+    //有上次退出时保存的首屏快照时直接显示，数据库在后台核对
+    ImageEngineApi::instance()->loadFirstPageThumbnails(number, restoredFrameGeometry.size(), num);
+    profiler->mark("first page requested");
+    //首屏之后加载图库目录，各视图共享
+    PhotoCatalog::instance()->loadAsync();
     MainWindow w;
+    profiler->mark("main window constructed");
 
+    profiler->watchFirstFrame(&w);
     w.show();
+    profiler->mark("main window shown");
     dApp->setMainWindow(&w);
     Dtk::Widget::moveToCenter(&w);
     w.startMonitor();
@@ -4,6 +4,10 @@
 #include "dialogs/albumcreatedialog.h"
 #include "utils/unionimage.h"
 #include "imageengine/imageengineapi.h"
+#include "dbmanager/dbasyncmanager.h"
+#include "searchview/searchcontroller.h"
+#include "module/view/viewpanel.h"
+#include "utils/startupprofiler.h"
 #include "accessibledefine.h"
 #include "viewerthememanager.h"
 #include "ac-desktop-define.h"
@@ -13,6 +17,7 @@
 #include <dgiofileinfo.h>
 #include <dgiovolume.h>
 #include <QShortcut>
+#include <QTimer>
 #include <DTableView>
 #include <DApplicationHelper>
 #include <DFileDialog>
@@ -35,6 +40,8 @@ const int VIEW_ALBUM = 2;
 const int VIEW_SEARCH = 3;
 const int VIEW_IMAGE = 4;
 const int VIEW_SLIDE = 5;
+//首屏显示后空闲时预建查看界面，避免首次打开图片时等待
+const int IMAGEVIEW_PRELOAD_DELAY = 1000;
 
 //const QString TITLEBAR_NEWALBUM = "新建相册";
 //const QString TITLEBAR_IMPORT = "导入照片";
@@ -57,6 +64,7 @@ MainWindow::MainWindow()
     , m_pTimeLineView(nullptr)
     , m_pTimeLineWidget(nullptr)
     , m_pSearchView(nullptr)
+    , m_slidePanel(nullptr)
     , m_pSearchEdit(nullptr)
     , m_commandLine(nullptr)
     , m_pDBManager(nullptr)
@@ -86,6 +94,9 @@ MainWindow::MainWindow()
     loadZoomRatio();
     m_bVector << true << true << true;
     connect(dApp->signalM, &SignalManager::showImageView, this, &MainWindow::onShowImageView);
+    //查看界面和幻灯片界面在第一次使用时才创建
+    connect(dApp->signalM, &SignalManager::viewImage, this, &MainWindow::onViewImage);
+    connect(dApp->signalM, &SignalManager::startSlideShow, this, &MainWindow::onStartSlideShow);
 }
 
 MainWindow::~MainWindow()
@@ -95,6 +106,11 @@ MainWindow::~MainWindow()
 //    delete m_pTimeLineView;                 //时间线界面视图
 //    delete m_pSearchView;                   //搜索界面视图
     emit dApp->signalM->sigPauseOrStart(false); //唤醒外设后台挂载,防止析构时线程挂起卡住页面无法退出
+    //保存所有照片首屏快照，下次启动直接显示
+    if (m_pAllPicView && m_processOptionIsEmpty) {
+        ImageEngineApi::instance()->saveFirstPageSnapshot(m_pAllPicView->getThumbnailListView()->firstScreenPaths(),
+                                                          frameGeometry().size(), m_pSliderPos);
+    }
     ImageEngineApi::instance()->close();
     QThreadPool::globalInstance()->clear();
     QThreadPool::globalInstance()->waitForDone();
@@ -174,6 +190,8 @@ void MainWindow::initConnections()
 #endif
     connect(m_pSearchEdit, &DSearchEdit::editingFinished, this, &MainWindow::onSearchEditFinished);
     connect(m_pSearchEdit, &DSearchEdit::textChanged, this, &MainWindow::onSearchEditTextChanged);
+    //边输入边搜索，输入停顿后再查询
+    connect(SearchController::instance(), &SearchController::inputSettled, this, &MainWindow::onSearchEditFinished);
     connect(m_pTitleBarMenu, &DMenu::triggered, this, &MainWindow::onTitleBarMenuClicked);
     connect(this, &MainWindow::sigTitleMenuImportClicked, this, &MainWindow::onImprotBtnClicked);
     //当有图片添加时，搜索栏可用
@@ -377,11 +395,8 @@ void MainWindow::initTitleBar()
     m_pSearchEdit->lineEdit()->setFocusPolicy(Qt::StrongFocus);
 //    m_pSearchEdit->setFixedSize(350, 36);
     m_pSearchEdit->setMaximumSize(350, 36);
-    if (0 < DBManager::instance()->getImgsCount()) {
-        m_pSearchEdit->setEnabled(true);
-    } else {
-        m_pSearchEdit->setEnabled(false);
-    }
+    m_pSearchEdit->setEnabled(false);
+    updateSearchEditEnabled();
 
 //    pTitleSearchLayout->addWidget(m_pSearchEdit);
     //m_titleSearchWidget->setLayout(pTitleSearchLayout);
@@ -440,7 +455,8 @@ void MainWindow::initCentralWidget()
 
     m_commandLine = CommandLine::instance();
     m_commandLine->setThreads(this);
-    m_slidePanel = new SlideShowPanel();
+    //幻灯片界面在第一次播放时创建
+    m_pSlidePanelWidget = new QWidget();
 
     m_pCenterWidget->addWidget(m_pAllPicView);
 
@@ -452,12 +468,13 @@ void MainWindow::initCentralWidget()
     //m_pCenterWidget->addWidget(m_pSearchView);
     m_pCenterWidget->addWidget(m_pSearchViewWidget);
     m_pCenterWidget->addWidget(m_commandLine);
-    m_pCenterWidget->addWidget(m_slidePanel);
+    m_pCenterWidget->addWidget(m_pSlidePanelWidget);
 
     QStringList pas;
     m_commandLine->processOption(pas);
     if (pas.length() > 0) {
         m_processOptionIsEmpty = false;
+        m_imageViewInited = true;
         titlebar()->setVisible(false);
         setTitlebarShadowEnabled(false);
         m_commandLine->viewImage(QFileInfo(pas.at(0)).absoluteFilePath(), pas);
@@ -469,6 +486,67 @@ void MainWindow::initCentralWidget()
         //m_commandLine->viewImage("", {});
         m_pCenterWidget->setCurrentIndex(VIEW_ALLPIC);
     }
+    StartupProfiler::instance()->watchFirstGrid(m_pAllPicView->getThumbnailListView());
+}
+
+//时间线界面在第一次切换时创建
+void MainWindow::createTimeLineView()
+{
+    if (nullptr != m_pTimeLineView) {
+        return;
+    }
+    m_pCenterWidget->removeWidget(m_pTimeLineWidget);
+    int index = m_pCenterWidget->indexOf(m_pAllPicView) + 1;
+    m_pTimeLineView = new TimeLineView();
+    m_pCenterWidget->insertWidget(index, m_pTimeLineView);
+}
+
+//相册界面在第一次切换时创建，设备扫描也随之推迟
+void MainWindow::createAlbumView()
+{
+    if (nullptr != m_pAlbumview) {
+        return;
+    }
+    createTimeLineView();
+    m_pCenterWidget->removeWidget(m_pAlbumWidget);
+    int index = m_pCenterWidget->indexOf(m_pTimeLineView) + 1;
+    m_pAlbumview = new AlbumView();
+    connect(m_pAlbumview, &AlbumView::sigSearchEditIsDisplay, this, &MainWindow::onSearchEditIsDisplay);
+    m_pCenterWidget->insertWidget(index, m_pAlbumview);
+}
+
+//搜索界面在第一次搜索时创建
+void MainWindow::createSearchView()
+{
+    if (nullptr != m_pSearchView) {
+        return;
+    }
+    int index = m_pCenterWidget->indexOf(m_pSearchViewWidget);
+    m_pSearchView = new SearchView();
+    m_pCenterWidget->insertWidget(index, m_pSearchView);
+    m_pCenterWidget->removeWidget(m_pSearchViewWidget);
+}
+
+//幻灯片界面在第一次播放时创建
+void MainWindow::createSlidePanel()
+{
+    if (nullptr != m_slidePanel) {
+        return;
+    }
+    int index = m_pCenterWidget->indexOf(m_pSlidePanelWidget);
+    m_slidePanel = new SlideShowPanel();
+    m_pCenterWidget->insertWidget(index, m_slidePanel);
+    m_pCenterWidget->removeWidget(m_pSlidePanelWidget);
+}
+
+//查看界面只创建一次
+void MainWindow::initImageView()
+{
+    if (m_imageViewInited) {
+        return;
+    }
+    m_imageViewInited = true;
+    m_commandLine->viewImage("", {});
 }
 
 void MainWindow::initInstallFilter()
@@ -895,12 +973,7 @@ void MainWindow::allPicBtnClicked()
 void MainWindow::timeLineBtnClicked()
 {
     clearFocus();
-    if (nullptr == m_pTimeLineView) {
-        m_pCenterWidget->removeWidget(m_pTimeLineWidget);
-        int index = m_pCenterWidget->indexOf(m_pAllPicView) + 1;
-        m_pTimeLineView = new TimeLineView();
-        m_pCenterWidget->insertWidget(index, m_pTimeLineView);
-    }
+    createTimeLineView();
     emit dApp->signalM->hideExtensionPanel();
     m_pSearchEdit->clearEdit();
     m_SearchKey.clear();
@@ -930,20 +1003,7 @@ void MainWindow::timeLineBtnClicked()
 void MainWindow::albumBtnClicked()
 {
     clearFocus();
-    if (nullptr == m_pAlbumview) {
-        int index = 0;
-        if (nullptr == m_pTimeLineView) {
-            m_pCenterWidget->removeWidget(m_pTimeLineWidget);
-            index = m_pCenterWidget->indexOf(m_pAllPicView) + 1;
-            m_pTimeLineView = new TimeLineView();
-            m_pCenterWidget->insertWidget(index, m_pTimeLineView);
-        }
-        m_pCenterWidget->removeWidget(m_pAlbumWidget);
-        index = m_pCenterWidget->indexOf(m_pTimeLineView) + 1;
-        m_pAlbumview = new AlbumView();
-        connect(m_pAlbumview, &AlbumView::sigSearchEditIsDisplay, this, &MainWindow::onSearchEditIsDisplay);
-        m_pCenterWidget->insertWidget(index, m_pAlbumview);
-    }
+    createAlbumView();
     emit dApp->signalM->hideExtensionPanel();
     m_pSearchEdit->clearEdit();
     m_SearchKey.clear();
@@ -1015,14 +1075,13 @@ void MainWindow::onViewCreateAlbum(QString imgpath, bool bmodel)
     d->move(this->x() + (this->width() - d->width()) / 2, this->y() + (this->height() - d->height()) / 2);
     connect(d, &AlbumCreateDialog::albumAdded, this, [ = ] {
         emit dApp->signalM->hideExtensionPanel();
-        DBManager::instance()->insertIntoAlbum(d->getCreateAlbumName(), imgpath.isEmpty() ? QStringList(" ") : QStringList(imgpath));
+        DBManager::instance()->insertIntoAlbumAsync(d->getCreateAlbumName(), imgpath.isEmpty() ? QStringList(" ") : QStringList(imgpath));
         emit dApp->signalM->sigCreateNewAlbumFrom(d->getCreateAlbumName());
         QIcon icon(":/images/logo/resources/images/other/icon_toast_sucess.svg");
         QString str = tr("Successfully added to “%1”");
         floatMessage(str.arg(d->getCreateAlbumName()), icon);
         if (imgpath.count() > 0 && imgpath != " ")
         {
-            ImageEngineApi::instance()->setImgPathAndAlbumNames(DBManager::instance()->getAllPathAlbumNames());
             QStringList paths;
             paths << imgpath;
             emit SignalManager::instance()->sigSyncListviewModelData(paths, d->getCreateAlbumName(), 4);
@@ -1040,18 +1099,7 @@ void MainWindow::showCreateDialog(QStringList imgpaths)
         //double insert problem from here ,first insert at AlbumCreateDialog::createAlbum(albumname)
         if (nullptr == m_pAlbumview)
         {
-            int index = 0;
-            if (nullptr == m_pTimeLineView) {
-                m_pCenterWidget->removeWidget(m_pTimeLineWidget);
-                index = m_pCenterWidget->indexOf(m_pAllPicView) + 1;
-                m_pTimeLineView = new TimeLineView();
-                m_pCenterWidget->insertWidget(index, m_pTimeLineView);
-            }
-            m_pCenterWidget->removeWidget(m_pAlbumWidget);
-            index = m_pCenterWidget->indexOf(m_pTimeLineView) + 1;
-            m_pAlbumview = new AlbumView();
-            connect(m_pAlbumview, &AlbumView::sigSearchEditIsDisplay, this, &MainWindow::onSearchEditIsDisplay);
-            m_pCenterWidget->insertWidget(index, m_pAlbumview);
+            createAlbumView();
 //            emit dApp->signalM->sigCreateNewAlbumFromDialog(d->getCreateAlbumName());
             m_pAlbumBtn->setChecked(true);
             m_pSearchEdit->clearEdit();
@@ -1067,14 +1115,12 @@ void MainWindow::showCreateDialog(QStringList imgpaths)
             m_pAlbumview->m_pStatusBar->m_pSlider->setValue(m_pSliderPos);
         }
         m_backIndex = VIEW_ALBUM;
-        DBManager::instance()->insertIntoAlbum(d->getCreateAlbumName(), imgpaths);
+        DBManager::instance()->insertIntoAlbumAsync(d->getCreateAlbumName(), imgpaths);
         emit dApp->signalM->insertedIntoAlbum(m_pAlbumview->m_currentAlbum, imgpaths);
         emit dApp->signalM->hideImageView();    //该信号针对查看界面新建相册(快捷键 crtl+n)，正常退出
-        // 相册照片更新时的．更新路径相册名缓存,用于listview的setdata userrole + 2
         // " " 新建空的相册
         if (imgpaths.first() != " ")
         {
-            ImageEngineApi::instance()->setImgPathAndAlbumNames(DBManager::instance()->getAllPathAlbumNames());
             emit SignalManager::instance()->sigSyncListviewModelData(imgpaths, d->getCreateAlbumName(), 4);
         }
     });
@@ -1083,10 +1129,14 @@ void MainWindow::showCreateDialog(QStringList imgpaths)
 //搜索框
 void MainWindow::onSearchEditFinished()
 {
+    SearchController::instance()->flushInput();
     QString keywords = m_pSearchEdit->text();
     if (m_SearchKey == keywords) //两次搜索条件相同，跳过
         return;
     m_SearchKey = keywords;
+    if (!keywords.isEmpty()) {
+        createSearchView();
+    }
     emit dApp->signalM->hideExtensionPanel();
     if (VIEW_ALLPIC == m_iCurrentView) {
         if (keywords.isEmpty()) {
@@ -1291,11 +1341,7 @@ void MainWindow::onLoadingFinished()
 {
 //    m_pTimeLineBtn->setEnabled(true);
 //    m_pAlbumBtn->setEnabled(true);
-    if (0 < DBManager::instance()->getImgsCount()) {
-        m_pSearchEdit->setEnabled(true);
-    } else {
-        m_pSearchEdit->setEnabled(false);
-    }
+    updateSearchEditEnabled();
 }
 
 QButtonGroup *MainWindow::getButG()
@@ -1327,14 +1373,9 @@ void MainWindow::showEvent(QShowEvent *event)
     }
     QMetaObject::invokeMethod(this, [ = ]() {
         if (m_isFirstStart) {
-            if (nullptr == m_pSearchView) {
-                int index = m_pCenterWidget->indexOf(m_pSearchViewWidget);
-                m_pSearchView = new SearchView();
-                m_pCenterWidget->insertWidget(index, m_pSearchView);
-                m_pCenterWidget->removeWidget(m_pSearchViewWidget);
-            }
+            //搜索、时间线、相册、幻灯片界面都在第一次使用时创建；查看界面在首屏显示后空闲时预建
             if (m_processOptionIsEmpty) {
-                m_commandLine->viewImage("", {});
+                QTimer::singleShot(IMAGEVIEW_PRELOAD_DELAY, this, &MainWindow::initImageView);
             }
 
             initShortcut();
@@ -1342,11 +1383,7 @@ void MainWindow::showEvent(QShowEvent *event)
             initDBus();
 
             //loadZoomRatio();
-            if (0 < DBManager::instance()->getImgsCount()) {
-                // dothing
-            } else {
-                m_pSearchEdit->setEnabled(false);
-            }
+            updateSearchEditEnabled();
         }
         m_isFirstStart = false;
         m_pCenterWidget->setFixedSize(size());
@@ -1704,31 +1741,11 @@ void MainWindow::onButtonClicked(int id)
         allPicBtnClicked();
         m_pSearchEdit->setVisible(true);
     }
-    int index = 0;
     if (1 == id) {
-        if (nullptr == m_pTimeLineView) {
-            m_pCenterWidget->removeWidget(m_pTimeLineWidget);
-            index = m_pCenterWidget->indexOf(m_pAllPicView) + 1;
-            m_pTimeLineView = new TimeLineView();
-            m_pCenterWidget->insertWidget(index, m_pTimeLineView);
-        }
         timeLineBtnClicked();
         m_pSearchEdit->setVisible(true);
     }
     if (2 == id) {
-        if (nullptr == m_pAlbumview) {
-            if (nullptr == m_pTimeLineView) {
-                m_pCenterWidget->removeWidget(m_pTimeLineWidget);
-                index = m_pCenterWidget->indexOf(m_pAllPicView) + 1;
-                m_pTimeLineView = new TimeLineView();
-                m_pCenterWidget->insertWidget(index, m_pTimeLineView);
-            }
-            m_pCenterWidget->removeWidget(m_pAlbumWidget);
-            index = m_pCenterWidget->indexOf(m_pTimeLineView) + 1;
-            m_pAlbumview = new AlbumView();
-            connect(m_pAlbumview, &AlbumView::sigSearchEditIsDisplay, this, &MainWindow::onSearchEditIsDisplay);
-            m_pCenterWidget->insertWidget(index, m_pAlbumview);
-        }
         albumBtnClicked();
         // 如果是最近删除或者移动设备,则搜索框不显示
         if (2 == m_pAlbumview->m_pRightStackWidget->currentIndex() || 5 == m_pAlbumview->m_pRightStackWidget->currentIndex()) {
@@ -1754,7 +1771,10 @@ void MainWindow::onImageImported(bool success)
 
 void MainWindow::onSearchEditTextChanged(QString text)
 {
-    if (text.isEmpty()) {
+    if (!text.isEmpty()) {
+        SearchController::instance()->inputChanged(text);
+    } else {
+        SearchController::instance()->cancel();
         m_SearchKey.clear();
         switch (m_iCurrentView) {
         case VIEW_ALLPIC: {
@@ -1851,11 +1871,18 @@ void MainWindow::onCloseWaitDialog()
 
 void MainWindow::onImagesRemoved()
 {
-    if (0 < DBManager::instance()->getImgsCount()) {
-        m_pSearchEdit->setEnabled(true);
-    } else {
-        m_pSearchEdit->setEnabled(false);
-    }
+    updateSearchEditEnabled();
+}
+
+void MainWindow::updateSearchEditEnabled()
+{
+    std::function<int()> count = []() {
+        return DBManager::instance()->getImgsCount();
+    };
+    std::function<void(const int &)> callback = [this](const int &count) {
+        m_pSearchEdit->setEnabled(0 < count);
+    };
+    DBAsyncManager::instance()->query(this, count, callback, "MainWindow::updateSearchEditEnabled");
 }
 
 void MainWindow::onHideImageView()
@@ -1865,6 +1892,27 @@ void MainWindow::onHideImageView()
     m_pCenterWidget->setCurrentIndex(m_backIndex);
 }
 
+void MainWindow::onStartSlideShow(const SignalManager::ViewInfo &vinfo, bool inDB)
+{
+    //本次信号发出时幻灯片界面还未连接，创建后直接转发；之后由其自身连接处理
+    if (nullptr == m_slidePanel) {
+        createSlidePanel();
+        m_slidePanel->startSlideShow(vinfo, inDB);
+    }
+}
+
+void MainWindow::onViewImage(const SignalManager::ViewInfo &info)
+{
+    //首屏预建前就打开图片时在此创建查看界面，并把本次信号转发给新建的ViewPanel
+    if (!m_imageViewInited) {
+        initImageView();
+        ViewPanel *panel = m_commandLine->findChild<ViewPanel *>();
+        if (panel) {
+            panel->onSigViewImage(info);
+        }
+    }
+}
+
 void MainWindow::onShowSlidePanel(int index)
 {
     m_backIndex_fromSlide = index;
@@ -65,6 +65,11 @@ public:
     void initShortcutKey();
     void initTitleBar();
     void initCentralWidget();
+    void createTimeLineView();
+    void createAlbumView();
+    void createSearchView();
+    void createSlidePanel();
+    void initImageView();
     // install filter
     void initInstallFilter();
     // 设置初始启动,没有图片时的allpicview tab切换顺序
@@ -107,6 +112,8 @@ private:
     bool compareVersion();
 //    void viewImageClose();
     void floatMessage(const QString &str, const QIcon &icon);
+    //按图库是否为空启用搜索框，图片数在数据库线程统计
+    void updateSearchEditEnabled();
 protected:
     void wheelEvent(QWheelEvent *event) Q_DECL_OVERRIDE;
     void resizeEvent(QResizeEvent *e) Q_DECL_OVERRIDE;
@@ -132,6 +139,8 @@ public slots:
     void onCloseWaitDialog();
     void onImagesRemoved();
     void onHideImageView();
+    void onStartSlideShow(const SignalManager::ViewInfo &vinfo, bool inDB);
+    void onViewImage(const SignalManager::ViewInfo &info);
     void onShowSlidePanel(int index);
     void onHideSlidePanel();
     void onExportImage(QStringList paths);
@@ -181,6 +190,7 @@ public:
     SearchView *m_pSearchView;                  //搜索界面视图
     QWidget *m_pSearchViewWidget = nullptr;
     SlideShowPanel *m_slidePanel;               //幻灯片播放视图
+    QWidget *m_pSlidePanelWidget = nullptr;
     DSearchEdit *m_pSearchEdit;
     CommandLine *m_commandLine;
 private:
@@ -205,6 +215,7 @@ private:
     dbusclient *m_pDBus;//LMH0407DBus
     bool m_isFirstStart = true;
     bool m_processOptionIsEmpty = false;
+    bool m_imageViewInited = false;             //查看界面是否已创建
     QSettings *m_settings;
     // 所有照片空白界面时的taborder
     QList<QWidget *> m_emptyAllViewTabOrder;
@@ -59,20 +59,20 @@ const int TOOLBAR_HEIGHT = 60;
 
 const int TOOLBAR_DVALUE = 114 + 8;
 
-const int THUMBNAIL_WIDTH = 32;
 const int THUMBNAIL_ADD_WIDTH = 32;
 const int THUMBNAIL_LIST_ADJUST = 9;
 const int THUMBNAIL_VIEW_DVALUE = 668;
 
-const int LOAD_LEFT_RIGHT = 25;     //前后加载图片数（动态）
+const QSize ITEM_NORMAL_SIZE = QSize(32, 40);
+const QSize ITEM_SELECTED_SIZE = QSize(58, 58);
+const int FILMSTRIP_SLOT_MARGIN = 4;    //可见范围两侧各预留的槽位数
 
 }  // namespace
 
 MyImageListWidget::MyImageListWidget(QWidget *parent)
-    : QWidget(parent), m_timer(new QTimer(this))
+    : QWidget(parent)
 {
     setMouseTracking(true);
-    m_timer->setSingleShot(200);
     m_animationTimer = new QTimer(this);
     m_animationTimer->setInterval(100);
 }
@@ -157,6 +157,11 @@ void MyImageListWidget::stopAnimation()
     m_resetAnimation->stop();
 }
 
+void MyImageListWidget::setItemCount(int count)
+{
+    m_itemCount = count;
+}
+
 //bool MyImageListWidget::isAnimationStart()
 //{
 //    if (m_resetAnimation->state() == QPropertyAnimation::State::Running) {
@@ -168,14 +173,10 @@ void MyImageListWidget::stopAnimation()
 
 void MyImageListWidget::findSelectItem()
 {
-    QObjectList list = dynamic_cast<DWidget *>(m_obj)->children();
-    for (int i = 0; i < list.size(); i++) {
-        QList<ImageItem *> labelList = dynamic_cast<DWidget *>(m_obj)->findChildren<ImageItem *>(QString("%1").arg(i));
-        if (labelList.size() <= 0) {
-            continue;
-        }
-        ImageItem *img = labelList.at(0);
-        if (nullptr == img) {
+    //子控件只有固定数量的槽位，直接遍历即可，未绑定的槽位下标为-1
+    QList<ImageItem *> labelList = dynamic_cast<DWidget *>(m_obj)->findChildren<ImageItem *>();
+    for (ImageItem *img : labelList) {
+        if (nullptr == img || img->index() < 0) {
             continue;
         }
         if (img->index() == img->indexNow()) {
@@ -198,12 +199,11 @@ void MyImageListWidget::thumbnailIsMoving()
         return;
     }
     int index = 0;
-    QObjectList list = dynamic_cast<DWidget *>(m_obj)->children();
     if (dynamic_cast<DWidget *>(m_obj)->geometry().width() <= this->width()) {
         if (offsetLimit < 0) {
             index = m_selectItem->index() + 1;
-            if (index >= list.size()) {
-                index = list.size() - 1;
+            if (index >= m_itemCount) {
+                index = m_itemCount - 1;
             }
         } else {
             index = m_selectItem->index() - 1;
@@ -227,8 +227,8 @@ void MyImageListWidget::thumbnailIsMoving()
             }
         } else if (offset < 0) {
             index = m_preSelectItemIndex + abs(offset) / 32;
-            if (index >= list.size()) {
-                index = list.size() - 1;
+            if (index >= m_itemCount) {
+                index = m_itemCount - 1;
             }
         }
         QList<ImageItem *> labelList2 = dynamic_cast<DWidget *>(m_obj)->findChildren<ImageItem *>(QString("%1").arg(index));
@@ -254,7 +254,8 @@ void MyImageListWidget::animationValueChanged(const QVariant value)
 bool MyImageListWidget::eventFilter(QObject *obj, QEvent *e)
 {
     Q_UNUSED(obj)
-    if (e->type() == QEvent::Leave) {
+    if (e->type() == QEvent::Move && obj == m_obj) {
+        emit listMoved();
     }
     if (e->type() == QEvent::MouseButtonPress) {
         m_resetAnimation->stop();
@@ -276,26 +277,6 @@ bool MyImageListWidget::eventFilter(QObject *obj, QEvent *e)
 
     if (e->type() == QEvent::MouseButtonRelease) {
         bmouseleftpressed = false;
-        int posX = dynamic_cast<DWidget *>(m_obj)->x();
-        int viewwidth = dynamic_cast<DWidget *>(m_obj)->width() + dynamic_cast<DWidget *>(m_obj)->x();
-        //向右加载数据
-        if ((viewwidth - this->width()) < 32 && viewwidth - this->width() > -32) {
-            if (m_timer->isActive()) {
-                return false;
-            } else {
-                m_timer->start();
-                emit testloadRight();
-            }
-        }
-        //向左加载数据
-        if (posX > -32 && posX < 32) {
-            if (m_timer->isActive()) {
-                return false;
-            } else {
-                m_timer->start();
-                emit testloadLeft();
-            }
-        }
         emit mouseLeftReleased();
         if (m_isMoving) {
             if (m_movePoints.size() > 0) {
@@ -337,34 +318,9 @@ bool MyImageListWidget::eventFilter(QObject *obj, QEvent *e)
         m_prepoint = mouseEvent->globalPos();
         dynamic_cast<DWidget *>(m_obj)->move((dynamic_cast<DWidget *>(m_obj))->x() + p.x() - m_presspoint.x(), ((dynamic_cast<DWidget *>(m_obj))->y()));
         m_presspoint = p;
-        int posX = dynamic_cast<DWidget *>(m_obj)->x();
-        int viewwidth = dynamic_cast<DWidget *>(m_obj)->width() + dynamic_cast<DWidget *>(m_obj)->x();
         //多动过程中显示选中图元
         thumbnailIsMoving();
-
-        QObjectList list = dynamic_cast<DWidget *>(m_obj)->children();
-        //向右加载数据
-        if ((viewwidth - this->width()) < 32 && viewwidth - this->width() > -32) {
-//            emit needContinueRequest();
-            if (m_timer->isActive()) {
-                return false;
-            } else {
-                m_timer->start();
-                emit testloadRight();
-            }
-        } else {
-            emit silmoved();
-        }
-
-        //向左加载数据
-        if (posX > -32 && posX < 32) {
-            if (m_timer->isActive()) {
-                return false;
-            } else {
-                m_timer->start();
-                emit testloadLeft();
-            }
-        }
+        emit silmoved();
     }
     return false;
 }
@@ -478,7 +434,7 @@ void MyImageListWidget::animationFinished()
 ImageItem::ImageItem(int index, ImageDataSt data, QWidget *parent):
     QLabel(parent)
 {
-    m_timer = new QTimer();
+    m_timer = new QTimer(this);
     m_timer->setInterval(200);
     m_timer->setSingleShot(true);
     _index = index;
@@ -507,6 +463,13 @@ void ImageItem::setPic(QPixmap pixmap)
     update();
 }
 
+void ImageItem::clearPic()
+{
+    m_bPicNotSuppOrDamaged = false;
+    _pixmap = QPixmap();
+    update();
+}
+
 void ImageItem::mouseReleaseEvent(QMouseEvent *ev)
 {
     Q_UNUSED(ev);
@@ -837,8 +800,8 @@ TTBContent::TTBContent(bool inDB, QStringList filelist, QWidget *parent) : QLabe
     m_imgListView->setObj(m_imgList);
     m_imgListView->setObjectName("MyImageListWidget");
     m_imgList->installEventFilter(m_imgListView);
-    connect(m_imgListView, &MyImageListWidget::testloadRight, this, &TTBContent::onImgListViewTestloadRight);
-    connect(m_imgListView, &MyImageListWidget::testloadLeft, this, &TTBContent::onImgListViewTestloadLeft);
+    m_imgListView->setItemCount(m_allfileslist.size());
+    connect(m_imgListView, &MyImageListWidget::listMoved, this, &TTBContent::layoutSlots);
     connect(dApp->signalM, &SignalManager::hideImageView, this, &TTBContent::onHideImageView);
     connect(m_imgListView, &MyImageListWidget::silmoved, this, &TTBContent::onSilmoved);
     connect(m_imgListView, &MyImageListWidget::needContinueRequest, this, &TTBContent::onNeedContinueRequest);
@@ -850,12 +813,8 @@ TTBContent::TTBContent(bool inDB, QStringList filelist, QWidget *parent) : QLabe
         m_imgList->setFixedSize(QSize(qMin((TOOLBAR_MINIMUN_WIDTH + THUMBNAIL_ADD_WIDTH * (m_allfileslist.size() - 3)), qMax(m_windowWidth - RT_SPACING, TOOLBAR_MINIMUN_WIDTH)) - THUMBNAIL_VIEW_DVALUE + THUMBNAIL_LIST_ADJUST, TOOLBAR_HEIGHT));
     }
 
+    //缩略图不再使用布局，由固定数量的槽位按下标直接定位
     m_imgList->setDisabled(false);
-    m_imglayout = new QHBoxLayout();
-    m_imglayout->setAlignment(Qt::AlignLeft | Qt::AlignTop);
-    m_imglayout->setMargin(0);
-    m_imglayout->setSpacing(0);
-    m_imgList->setLayout(m_imglayout);
 
     if (m_allfileslist.size() <= 3) {
         m_imgListView->setFixedSize(QSize(TOOLBAR_DVALUE, TOOLBAR_HEIGHT));
@@ -886,8 +845,6 @@ TTBContent::TTBContent(bool inDB, QStringList filelist, QWidget *parent) : QLabe
     m_fileNameLabel = new ElidedLabel();
 
     connect(m_trashBtn, &DIconButton::clicked, this, &TTBContent::onTrashBtnClicked);
-    m_filesbeleft << filelist;
-    m_allNeedRequestFilesCount += filelist.size();
     connect(this, &TTBContent::sigRequestSomeImages, this, &TTBContent::requestSomeImages);
 }
 
@@ -895,49 +852,28 @@ TTBContent::TTBContent(bool inDB, QStringList filelist, QWidget *parent) : QLabe
 void TTBContent::requestSomeImages()
 {
     bneedloadimage = false;
-
-    if (m_filesbeleft.size() < Number_Of_Displays_Per_Time) {
-        m_requestCount += m_filesbeleft.size();
-    } else {
-        m_requestCount += Number_Of_Displays_Per_Time;
-    }
-    for (int i = 0; i < Number_Of_Displays_Per_Time; i++) {
-        if (m_filesbeleft.size() <= 0) {
-            brequestallfiles = true;
-            updateScreen();
-            return;
-        }
-        QString firstfilesbeleft = m_filesbeleft.first();
-        m_filesbeleft.removeFirst();
-        ImageEngineApi::instance()->reQuestImageData(firstfilesbeleft, this);
+    //只请求可见槽位的缩略图，打开时不再按列表逐批加载
+    updateScreen();
+    if (m_nowIndex > -1 && !bfilefind) {
+        bfilefind = true;
+        emit feedBackCurrentIndex(m_nowIndex, m_currentpath);
     }
 }
 
-void TTBContent::setRightlist(const QStringList &rightlist)
-{
-    m_rightlist = rightlist;
-}
-
-void TTBContent::setLeftlist(const QStringList &leftlist)
-{
-    m_leftlist = leftlist;
-}
-
 bool TTBContent::imageLoaded(QString filepath)
 {
-    m_requestCount--;
-    m_allNeedRequestFilesCount--;
-    bool reb = false;
+    m_requestedPaths.remove(filepath);
     ImageDataSt data;
-    if (ImageEngineApi::instance()->getImageData(filepath, data)) {
-        insertImageItem(data);
-        reb = true;
+    if (!ImageEngineApi::instance()->getImageData(filepath, data)) {
+        return false;
     }
-    if (m_requestCount < 1
-       ) {
-        requestSomeImages();
+    //已滑出可见范围的槽位已被回收，找不到时直接丢弃
+    for (ImageItem *item : m_slots) {
+        if (item->index() >= 0 && item->_path == filepath) {
+            item->setPic(data.imgpixmap);
+        }
     }
-    return reb;
+    return true;
 }
 
 int TTBContent::itemLoadedSize()
@@ -953,144 +889,29 @@ QString TTBContent::getIndexPath(int index)
 void TTBContent::updateScreen()
 {
     qDebug() << "zy------TTBContent::updateScreen";
-    if (m_ItemLoaded.size() > 3) {
-        m_imgList->setFixedSize((m_ItemLoaded.size() + 1)*THUMBNAIL_WIDTH, TOOLBAR_HEIGHT);
-        m_imgList->resize((m_ItemLoaded.size() + 1)*THUMBNAIL_WIDTH + THUMBNAIL_LIST_ADJUST, TOOLBAR_HEIGHT);
-
-        m_imgList->setContentsMargins(0, 0, 0, 0);
-        m_imgListView->show();
-
-        QList<ImageItem *> labelList = m_imgList->findChildren<ImageItem *>(QString("%1").arg(m_nowIndex));
-
-        if (m_nowIndex > -1) {
-
-            if (labelList.isEmpty())
-                return;
-
-            labelList.at(0)->setIndexNow(m_nowIndex);
-            m_imgListView->setSelectItem(labelList.at(0));
-
-            if (m_lastIndex > -1 && m_lastIndex != m_nowIndex) {
-                QList<ImageItem *> lastlabelList = m_imgList->findChildren<ImageItem *>(QString("%1").arg(m_lastIndex));
-                if (lastlabelList.isEmpty()) {
-                    return;
-                }
-                auto num = 32;
-                lastlabelList.at(0)->setFixedSize(QSize(num, 40));
-                lastlabelList.at(0)->resize(QSize(num, 40));
-                lastlabelList.at(0)->setIndexNow(m_nowIndex);
-            }
-            if (labelList.size() > 0) {
-                labelList.at(0)->setFixedSize(QSize(58, 58));
-                labelList.at(0)->resize(QSize(58, 58));
-            }
-
-            m_imgListView->update();
-            m_imgList->update();
-            m_preButton->show();
-            m_preButton_spc->show();
-            m_nextButton->show();
-            m_nextButton_spc->show();
-
-            if (m_nowIndex == 0) {
-                m_preButton->setDisabled(true);
-            } else {
-                m_preButton->setDisabled(false);
-            }
-            if (m_nowIndex == m_allfileslist.size() - 1) {
-                m_nextButton->setDisabled(true);
-            } else {
-                m_nextButton->setDisabled(false);
-            }
-            m_lastIndex = m_nowIndex;
+    const int count = m_allfileslist.size();
+    m_imgListView->setItemCount(count);
+    if (count > 1) {
+        if (count > 3) {
+            m_imgList->setFixedSize((count + 1)*THUMBNAIL_WIDTH + THUMBNAIL_LIST_ADJUST, TOOLBAR_HEIGHT);
+        } else {
+            m_imgList->setFixedSize((count + 1)*THUMBNAIL_WIDTH, TOOLBAR_HEIGHT);
         }
-    } else if (m_ItemLoaded.size() > 1) {
-        m_imgList->setFixedSize((m_ItemLoaded.size() + 1)*THUMBNAIL_WIDTH, TOOLBAR_HEIGHT);
-        m_imgList->resize((m_ItemLoaded.size() + 1)*THUMBNAIL_WIDTH, TOOLBAR_HEIGHT);
-
         m_imgList->setContentsMargins(0, 0, 0, 0);
-
+        m_imgList->show();
         m_imgListView->show();
-        if (!binsertneedupdate)
-            return;
-        QList<ImageItem *> labelList = m_imgList->findChildren<ImageItem *>(QString("%1").arg(m_nowIndex));
-        if (m_nowIndex > -1) {
-
-            if (labelList.isEmpty())
-                return;
-            if (m_nowIndex < m_ItemLoaded.size()) {
-                labelList.at(0)->setIndexNow(m_nowIndex);
-            }
-            if (m_lastIndex > -1 && m_lastIndex != m_nowIndex) {
-                QList<ImageItem *> lastlabelList = m_imgList->findChildren<ImageItem *>(QString("%1").arg(m_lastIndex));
-                if (lastlabelList.isEmpty())
-                    return;
-                auto num = 32;
-                lastlabelList.at(0)->setFixedSize(QSize(num, 40));
-                lastlabelList.at(0)->resize(QSize(num, 40));
-                lastlabelList.at(0)->setIndexNow(m_nowIndex);
-            }
-            if (labelList.size() > 0) {
-                labelList.at(0)->setFixedSize(QSize(58, 58));
-                labelList.at(0)->resize(QSize(58, 58));
-                m_imgListView->setSelectItem(labelList.at(0));
-            }
-
-//            m_imgListView->show();
-            m_imgList->show();
-            m_imgListView->update();
-            m_imgList->update();
-            m_preButton->show();
-            m_preButton_spc->show();
-            m_nextButton->show();
-            m_nextButton_spc->show();
-
-
-            if (m_nowIndex == 0) {
-                m_preButton->setDisabled(true);
-            } else {
-                m_preButton->setDisabled(false);
-            }
-            if (m_nowIndex == m_ItemLoaded.size() - 1) {
-                m_nextButton->setDisabled(true);
-            } else {
-                m_nextButton->setDisabled(false);
-            }
-            m_lastIndex = m_nowIndex;
+        if (m_nowIndex > -1 && nullptr == slotOfIndex(m_nowIndex)) {
+            //当前项不在已绑定范围内（刚打开或跳转），先把列表移到当前项附近
+            m_imgList->move(qMin(0, m_imgListView->width() / 2 - itemX(m_nowIndex) - ITEM_SELECTED_SIZE.width() / 2), m_imgList->y());
         }
-    } else if (m_ItemLoaded.size() == 1 && m_allfileslist.size() > 1) {
-        m_imgList->setFixedSize((m_ItemLoaded.size() + 1)*THUMBNAIL_WIDTH, TOOLBAR_HEIGHT);
-        m_imgList->resize((m_ItemLoaded.size() + 1)*THUMBNAIL_WIDTH, TOOLBAR_HEIGHT);
-
-        m_imgList->setContentsMargins(0, 0, 0, 0);
+        layoutSlots();
 
-        m_imgListView->show();
-        if (!binsertneedupdate)
-            return;
-        QList<ImageItem *> labelList = m_imgList->findChildren<ImageItem *>(QString("%1").arg(m_nowIndex));
         if (m_nowIndex > -1) {
-            if (labelList.isEmpty())
-                return;
-            if (m_nowIndex < labelList.size()) {
-                labelList.at(0)->setIndexNow(m_nowIndex);
-            }
-            if (m_lastIndex > -1) {
-                QList<ImageItem *> lastlabelList = m_imgList->findChildren<ImageItem *>(QString("%1").arg(m_lastIndex));
-                if (lastlabelList.isEmpty()) {
-                    return;
-                }
-                auto num = 32;
-                lastlabelList.at(0)->setFixedSize(QSize(num, 40));
-                lastlabelList.at(0)->resize(QSize(num, 40));
-                lastlabelList.at(0)->setIndexNow(m_nowIndex);
-            }
-            if (labelList.size() > 0) {
-                labelList.at(0)->setFixedSize(QSize(58, 58));
-                labelList.at(0)->resize(QSize(58, 58));
+            ImageItem *item = slotOfIndex(m_nowIndex);
+            if (nullptr != item) {
+                m_imgListView->setSelectItem(item);
             }
 
-//            m_imgListView->show();
-            m_imgList->show();
             m_imgListView->update();
             m_imgList->update();
             m_preButton->show();
@@ -1098,17 +919,8 @@ void TTBContent::updateScreen()
             m_nextButton->show();
             m_nextButton_spc->show();
 
-
-            if (m_nowIndex == 0) {
-                m_preButton->setDisabled(true);
-            } else {
-                m_preButton->setDisabled(false);
-            }
-            if (m_nowIndex == m_allfileslist.size() - 1) {
-                m_nextButton->setDisabled(true);
-            } else {
-                m_nextButton->setDisabled(false);
-            }
+            m_preButton->setDisabled(m_nowIndex == 0);
+            m_nextButton->setDisabled(m_nowIndex == count - 1);
             m_lastIndex = m_nowIndex;
         }
     } else {
@@ -1118,13 +930,11 @@ void TTBContent::updateScreen()
         m_preButton_spc->hide();
         m_nextButton->hide();
         m_nextButton_spc->hide();
-//        m_contentWidth = TOOLBAR_JUSTONE_WIDTH;
-//        setFixedWidth(m_contentWidth);
     }
     m_windowWidth = this->window()->geometry().width();
-    if (m_ItemLoaded.size() <= 1) {
+    if (count <= 1) {
         m_contentWidth = TOOLBAR_JUSTONE_WIDTH;
-    } else if (m_ItemLoaded.size() <= 3) {
+    } else if (count <= 3) {
         m_contentWidth = TOOLBAR_MINIMUN_WIDTH;
         m_imgListView->setFixedSize(QSize(TOOLBAR_DVALUE, TOOLBAR_HEIGHT));
     } else {
@@ -1134,98 +944,133 @@ void TTBContent::updateScreen()
     setFixedWidth(m_contentWidth);
 }
 
-void TTBContent::insertImageItem(const ImageDataSt &file, bool bloadRight)
+void TTBContent::ensureSlots()
 {
-    int index = m_ItemLoaded.size();
-    TTBContentData data;
-    data.index = index;
-    data.data = file;
-    m_ItemLoaded.insert(file.dbi.filePath, data);
-    ImageItem *imageItem = new ImageItem(index, file);
-    imageItem->setFixedSize(QSize(32, 40));
-    imageItem->resize(QSize(32, 40));
-    //imageItem->installEventFilter(m_imgListView);
+    //槽位数只与可见宽度有关，与图片总数无关；选中项比普通项宽，多留一个
+    const int need = m_imgListView->width() / THUMBNAIL_WIDTH + 2 * FILMSTRIP_SLOT_MARGIN + 2;
+    if (m_slots.size() >= need) {
+        return;
+    }
+    for (ImageItem *item : m_slots) {
+        unbindSlot(item);
+    }
+    while (m_slots.size() < need) {
+        ImageItem *item = new ImageItem(-1, ImageDataSt(), m_imgList);
+        connect(item, &ImageItem::imageItemclicked, this, &TTBContent::onImageItemClicked);
+        unbindSlot(item);
+        m_slots.append(item);
+    }
+}
 
-    imageItem->setObjectName(QString("%1").arg(index));
+void TTBContent::layoutSlots()
+{
+    ensureSlots();
+    const int count = m_allfileslist.size();
+    const int slotCount = m_slots.size();
+    int first = qMax(0, -m_imgList->x() / THUMBNAIL_WIDTH - FILMSTRIP_SLOT_MARGIN);
+    first = qMax(0, qMin(first, count - slotCount));
+    //槽位按 index % 槽位数 回收，滑动一格只重新绑定一个槽位
+    for (int index = first; index < first + slotCount; ++index) {
+        ImageItem *item = m_slots.at(index % slotCount);
+        if (index < count) {
+            bindSlot(item, index);
+        } else {
+            unbindSlot(item);
+        }
+    }
+}
 
-    if (bloadRight) //右侧加载
-        m_imglayout->addWidget(imageItem);
-    else {
-        m_imglayout->insertWidget(0, imageItem);
-        QList<ImageItem *> labelList1 = m_imgList->findChildren<ImageItem *>();
-        for (auto &lable : labelList1) {
-            if (lable->index() == index) { //刚添加进入的
-                lable->setIndex(0);     //设置索引为0
-                lable->setObjectName("0");
-            } else {
-                lable->setObjectName(QString("%1").arg(lable->index() + 1));
-                if (lable->indexNow() == lable->index()) { //当前已选中
-                    lable->setIndex(lable->index() + 1);
-                    lable->setIndexNow(lable->indexNow() + 1);
-                    m_imgListView->setSelectItem(lable);
-                    m_lastIndex = lable->indexNow();
-                    m_nowIndex = lable->indexNow();
-//                    qDebug() << "name: " << lable->objectName() << "index: " << lable->index() << "indexnow: " << lable->indexNow();
-                } else {
-                    lable->setIndex(lable->index() + 1);    //索引加1
-                    lable->setIndexNow(-1);
+void TTBContent::bindSlot(ImageItem *item, int index)
+{
+    const QString &path = m_allfileslist.at(index);
+    const bool bselected = (index == m_nowIndex);
+    item->setIndex(index);
+    item->setIndexNow(m_nowIndex);
+    item->setObjectName(QString("%1").arg(index));
+    item->setFixedSize(bselected ? ITEM_SELECTED_SIZE : ITEM_NORMAL_SIZE);
+    item->move(itemX(index), bselected ? 0 : (ITEM_SELECTED_SIZE.height() - ITEM_NORMAL_SIZE.height()) / 2);
+    if (item->_path != path) {
+        item->_path = path;
+        //缩略图直接取自ImageEngineApi的共享缓存，未载入时只为可见项发起请求
+        ImageDataSt data;
+        if (ImageEngineApi::instance()->getImageData(path, data) && ImageLoadStatu_Loaded == data.loaded) {
+            item->setPic(data.imgpixmap);
+        } else {
+            item->clearPic();
+            if (!m_requestedPaths.contains(path)) {
+                m_requestedPaths.insert(path);
+                if (!ImageEngineApi::instance()->reQuestImageData(path, this)) {
+                    m_requestedPaths.remove(path);
                 }
             }
         }
-        //已加载数据index全部加1
-        for (auto &contenData : m_ItemLoaded) {
-            if (contenData.index == index)
-                contenData.index = 0;
-            else
-                contenData.index++;
-        }
     }
+    item->show();
+    item->update();
+}
 
-    connect(imageItem, &ImageItem::imageItemclicked, this, [ = ](int index, int indexNow) {
-        qDebug() << "zy------ImageItem::imageItemclicked";
-        binsertneedupdate = true;
-        m_nowIndex = index;
+void TTBContent::unbindSlot(ImageItem *item)
+{
+    item->hide();
+    item->setIndex(-1);
+    item->setObjectName("");
+    item->_path.clear();
+    item->clearPic();
+}
 
-        if (m_lastIndex > -1) {
-            QList<ImageItem *> lastlabelList = m_imgList->findChildren<ImageItem *>(QString("%1").arg(m_lastIndex));
-            if (lastlabelList.isEmpty()) {
-                return;
-            }
-            lastlabelList.at(0)->setFixedSize(QSize(32, 40));
-            lastlabelList.at(0)->resize(QSize(32, 40));
-            lastlabelList.at(0)->setIndexNow(m_nowIndex);
-        }
+ImageItem *TTBContent::slotOfIndex(int index) const
+{
+    if (index < 0 || m_slots.isEmpty()) {
+        return nullptr;
+    }
+    ImageItem *item = m_slots.at(index % m_slots.size());
+    return item->index() == index ? item : nullptr;
+}
+
+int TTBContent::itemX(int index) const
+{
+    //选中项之后的缩略图整体右移选中项多出的宽度
+    int x = index * THUMBNAIL_WIDTH;
+    if (m_nowIndex > -1 && index > m_nowIndex) {
+        x += ITEM_SELECTED_SIZE.width() - ITEM_NORMAL_SIZE.width();
+    }
+    return x;
+}
 
-        QList<ImageItem *> labelList = m_imgList->findChildren<ImageItem *>(QString("%1").arg(index));
-        if (labelList.size() > 0) {
-            ImageItem *img = labelList.at(0);
-            if (nullptr != img) {
-                labelList.at(0)->setFixedSize(QSize(58, 58));
-                labelList.at(0)->resize(QSize(58, 58));
-                img->setIndexNow(m_nowIndex);
-                m_imgListView->setSelectItem(img);
+int TTBContent::indexOfPath(const QString &path) const
+{
+    //前后翻页时目标就在当前下标附近，先就近比较，避免每次遍历整个列表
+    if (m_nowIndex > -1) {
+        const int last = qMin(m_nowIndex + 1, m_allfileslist.size() - 1);
+        for (int i = qMax(0, m_nowIndex - 1); i <= last; ++i) {
+            if (m_allfileslist.at(i) == path) {
+                return i;
             }
         }
-        m_lastIndex = m_nowIndex;
+    }
+    return m_allfileslist.indexOf(path);
+}
 
-        bfilefind = true;
-        m_currentpath = imageItem->_path;
-        qDebug() << "单击：" << "index: " << index << "indexnow: " << indexNow << "path: " << m_currentpath;
-        emit imageClicked(index, (index - indexNow));
-        emit ttbcontentClicked();
-    });
-    if (-1 == m_nowIndex && file.dbi.filePath == m_currentpath) {
-        m_nowIndex = index;
-        bfilefind = true;
-        emit feedBackCurrentIndex(m_nowIndex, m_currentpath);
-//        setCurrentItem();
-    } else {
-//        if (binsertneedupdate)
-//        updateScreen();
-        onResize();
-//        updateScreenNoAnimation();
+void TTBContent::onImageItemClicked(int index, int indexNow)
+{
+    qDebug() << "zy------ImageItem::imageItemclicked";
+    if (index < 0 || index >= m_allfileslist.size()) {
+        return;
     }
-//    onResize();
+    binsertneedupdate = true;
+    m_nowIndex = index;
+    layoutSlots();
+    ImageItem *img = slotOfIndex(index);
+    if (nullptr != img) {
+        m_imgListView->setSelectItem(img);
+    }
+    m_lastIndex = m_nowIndex;
+
+    bfilefind = true;
+    m_currentpath = m_allfileslist.at(index);
+    qDebug() << "单击：" << "index: " << index << "indexnow: " << indexNow << "path: " << m_currentpath;
+    emit imageClicked(index, (index - indexNow));
+    emit ttbcontentClicked();
 }
 
 //void TTBContent::reLoad()
@@ -1261,16 +1106,12 @@ void TTBContent::stopLoadAndClear()
 {
     clearAndStopThread();
     m_allfileslist.clear();
+    m_imgListView->setItemCount(0);
 
-    QLayoutItem *child;
-    while ((child = m_imglayout->takeAt(0)) != nullptr) {
-        m_imglayout->removeWidget(child->widget());
-        child->widget()->setParent(nullptr);
-        delete child;
-
+    for (ImageItem *item : m_slots) {
+        unbindSlot(item);
     }
-    m_filesbeleft.clear();
-    m_allNeedRequestFilesCount = 0;
+    m_requestedPaths.clear();
 }
 
 QStringList TTBContent::getAllFileList()
@@ -1303,28 +1144,10 @@ void TTBContent::checkAdaptScreenBtn()
 void TTBContent::deleteImage()
 {
     m_imgListView->stopAnimation();
-    m_ItemLoaded.remove(m_currentpath);
     if (m_allfileslist.size() == 0)
         return;
     m_allfileslist.removeAt(m_nowIndex == -1 ? 0 : m_nowIndex);
-    m_allNeedRequestFilesCount = m_allfileslist.size();
-
-    QList<ImageItem *> labelList = m_imgList->findChildren<ImageItem *>();
 
-    ImageItem *getim = nullptr;
-
-    for (auto &lable : labelList) {
-        if (lable->index() == m_nowIndex) {
-            getim = lable;
-        } else {
-            if (lable->index_1(m_nowIndex)) { //图片索引大于删除图片索引
-                m_ItemLoaded[lable->_path].index--;     //修改已加载图片索引
-                lable->setObjectName(QString("%1").arg(m_ItemLoaded[lable->_path].index));
-            }
-        }
-    }
-
-    QList<ImageItem *> labelList1 = m_imgList->findChildren<ImageItem *>();
     if (m_allfileslist.size() > 0) {
         if (m_allfileslist.size() > m_nowIndex) {
             m_lastIndex = -1;
@@ -1335,25 +1158,11 @@ void TTBContent::deleteImage()
             m_lastIndex = -1;
             m_currentpath = m_allfileslist[0];
         }
-//        m_nowIndex = - 1;
-//        m_lastIndex = -1;
-//        m_currentpath = ""/*m_allfileslist[m_nowIndex]*/;
-//        reLoad();
-//        updateScreen();
     }
-//    if (m_filelist_size < 2) {
-//        return;
-//    }
 
-    m_filelist_size = m_filelist_size - 1;
-    if (nullptr != getim) {
-        //updateScreen();
-        m_imglayout->removeWidget(getim);
-//        getim->hide();
-        delete getim;
-        getim = nullptr;
-        updateScreen();
-    }
+    m_filelist_size = m_allfileslist.size();
+    //删除后的下标整体前移，槽位按新下标重新绑定，路径未变的槽位不会重新取图
+    updateScreen();
 
     emit ttbcontentClicked();
     emit removed();     //删除数据库图片
@@ -1438,9 +1247,9 @@ void TTBContent::onAdaptScreenBtnClicked()
 void TTBContent::onclBTClicked()
 {
     if (true == m_bClBTChecked) {
-        DBManager::instance()->removeFromAlbum(COMMON_STR_FAVORITES, QStringList(m_currentpath), AlbumDBType::Favourite);
+        DBManager::instance()->removeFromAlbumAsync(COMMON_STR_FAVORITES, QStringList(m_currentpath), AlbumDBType::Favourite);
     } else {
-        DBManager::instance()->insertIntoAlbum(COMMON_STR_FAVORITES, QStringList(m_currentpath), AlbumDBType::Favourite);
+        DBManager::instance()->insertIntoAlbumAsync(COMMON_STR_FAVORITES, QStringList(m_currentpath), AlbumDBType::Favourite);
         emit dApp->signalM->insertedIntoAlbum(COMMON_STR_FAVORITES, QStringList(m_currentpath));
     }
 
@@ -1459,55 +1268,6 @@ void TTBContent::onRotateRBtnClicked()
     emit ttbcontentClicked();
 }
 
-void TTBContent::onImgListViewTestloadRight()
-{
-    if (m_rightlist.isEmpty())
-        return ;
-    qDebug() << "请求加载右边图片";
-    QStringList loadRight;
-    for (int i = 0; i < LOAD_LEFT_RIGHT; ++i) {
-        if (m_rightlist.isEmpty())
-            break;
-        ImageDataSt data;
-        if (ImageEngineApi::instance()->getImageData(m_rightlist.first(), data)) {
-            insertImageItem(data);
-            loadRight << m_rightlist.first();
-            m_rightlist.removeFirst();
-        }
-    }
-    m_allfileslist << loadRight;
-    //m_filelist_size = m_allfileslist.size();
-//        m_imgList->setFixedWidth(m_imgList->width() + 32 * loadRight.size());
-    emit sigloadRight(loadRight);
-}
-
-void TTBContent::onImgListViewTestloadLeft()
-{
-    if (m_leftlist.isEmpty())
-        return;
-    qDebug() << "请求加载左边图片";
-    QStringList loadLeft;
-    for (int i = 0; i < LOAD_LEFT_RIGHT; ++i) {
-        if (m_leftlist.isEmpty())
-            break;
-        ImageDataSt data;
-        if (ImageEngineApi::instance()->getImageData(m_leftlist.last(), data)) {
-            insertImageItem(data, false);
-            loadLeft << m_leftlist.last();
-            m_leftlist.removeLast();
-        }
-    }
-//    for (const auto &path : loadLeft)
-//        m_allfileslist.push_front(path);    //倒序放置
-    auto path = loadLeft.begin();
-    while (path != loadLeft.end()) {
-        m_allfileslist.push_front(QString::fromStdString(path->toStdString()));
-        ++path;
-    }
-    m_filelist_size = m_allfileslist.size();
-    emit sigloadLeft(loadLeft);
-}
-
 void TTBContent::onHideImageView()
 {
     m_imgList->hide();
@@ -1521,11 +1281,7 @@ void TTBContent::onSilmoved()
 void TTBContent::onNeedContinueRequest()
 {
     binsertneedupdate = false;
-    if (m_requestCount > 0) {
-        bneedloadimage = true;
-    } else {
-        requestSomeImages();
-    }
+    layoutSlots();
 }
 
 void TTBContent::onTrashBtnClicked()
@@ -1535,33 +1291,12 @@ void TTBContent::onTrashBtnClicked()
 
 void TTBContent::onNextButton()
 {
-    int viewwidth = dynamic_cast<DWidget *>(m_imgListView->getObj())->width() + dynamic_cast<DWidget *>(m_imgListView->getObj())->x();
-
-    //向右加载数据
-    if ((viewwidth - m_imgListView->width()) < 32 && viewwidth - m_imgListView->width() > -32) {
-        if (m_imgListView->m_timer->isActive()) {
-            return;
-        } else {
-            m_imgListView->m_timer->start();
-            emit m_imgListView->testloadRight();
-        }
-    }
     emit showNext();
     emit ttbcontentClicked();
 }
 
 void TTBContent::onPreButton()
 {
-    //向左加载数据
-    int posX = dynamic_cast<DWidget *>(m_imgListView->getObj())->x();
-    if (posX > -32 && posX < 32) {
-        if (m_imgListView->m_timer->isActive()) {
-            return;
-        } else {
-            m_imgListView->m_timer->start();
-            emit m_imgListView->testloadLeft();
-        }
-    }
     emit showPrevious();
     emit ttbcontentClicked();
 }
@@ -1597,6 +1332,7 @@ void TTBContent::resizeEvent(QResizeEvent *event)
         m_imgListView->setFixedSize(QSize(qMin((TOOLBAR_MINIMUN_WIDTH + THUMBNAIL_ADD_WIDTH * (m_filelist_size - 3)), qMax(m_windowWidth - RT_SPACING, TOOLBAR_MINIMUN_WIDTH)) - THUMBNAIL_VIEW_DVALUE + THUMBNAIL_LIST_ADJUST, TOOLBAR_HEIGHT));
     }
     setFixedWidth(m_contentWidth);
+    layoutSlots();
 }
 
 
@@ -1613,9 +1349,8 @@ void TTBContent::setImage(const QString &path)
         emit dApp->signalM->picNotExists(false);
     }
     m_currentpath = path;
-    QMap<QString, TTBContentData>::iterator it;
-    it = m_ItemLoaded.find(path);
-    if (it == m_ItemLoaded.end()) {
+    int index = indexOfPath(path);
+    if (index < 0) {
         bfilefind = false;
         m_nowIndex = -1;
         m_adaptImageBtn->setDisabled(true);
@@ -1625,18 +1360,16 @@ void TTBContent::setImage(const QString &path)
 //        m_trashBtn->setDisabled(true);
 //        m_imgList->setDisabled(false);
     } else {
-        TTBContentData data = it.value();
-        m_nowIndex = data.index;
-        bfilefind = true;
-//        QList<ImageItem *> labelList = m_imgList->findChildren<ImageItem *>();
-        QList<ImageItem *> labelList = m_imgList->findChildren<ImageItem *>(QString("%1").arg(m_nowIndex));
+        //首次定位到当前图片时由requestSomeImages回传下标，这里不改bfilefind
+        m_nowIndex = index;
+        setCurrentItem();
+        //旋转等操作会更新缓存中的缩略图，重新取一次
+        ImageItem *item = slotOfIndex(m_nowIndex);
         ImageDataSt gdata;
-        if (ImageEngineApi::instance()->getImageData(m_currentpath, gdata)) {
-            if (labelList.isEmpty())
-                return;
-            labelList.at(0)->setPic(gdata.imgpixmap);
+        if (nullptr != item && ImageEngineApi::instance()->getImageData(m_currentpath, gdata)
+                && ImageLoadStatu_Loaded == gdata.loaded) {
+            item->setPic(gdata.imgpixmap);
         }
-        setCurrentItem();
     }
 }
 
@@ -1696,26 +1429,21 @@ void TTBContent::updateCollectButton()
 
 void TTBContent::onResize()
 {
-    if (m_ItemLoaded.size() > 3) {
-        m_imgList->setFixedSize((m_ItemLoaded.size() + 1)*THUMBNAIL_WIDTH + THUMBNAIL_LIST_ADJUST, TOOLBAR_HEIGHT);
-        m_imgList->resize((m_ItemLoaded.size() + 1)*THUMBNAIL_WIDTH + THUMBNAIL_LIST_ADJUST, TOOLBAR_HEIGHT);
-    } else if (m_ItemLoaded.size() > 1) {
-        m_imgList->setFixedSize((m_ItemLoaded.size() + 1)*THUMBNAIL_WIDTH, TOOLBAR_HEIGHT);
-        m_imgList->resize((m_ItemLoaded.size() + 1)*THUMBNAIL_WIDTH, TOOLBAR_HEIGHT);
+    const int count = m_allfileslist.size();
+    if (count > 3) {
+        m_imgList->setFixedSize((count + 1)*THUMBNAIL_WIDTH + THUMBNAIL_LIST_ADJUST, TOOLBAR_HEIGHT);
+        m_imgList->resize((count + 1)*THUMBNAIL_WIDTH + THUMBNAIL_LIST_ADJUST, TOOLBAR_HEIGHT);
+    } else if (count > 1) {
+        m_imgList->setFixedSize((count + 1)*THUMBNAIL_WIDTH, TOOLBAR_HEIGHT);
+        m_imgList->resize((count + 1)*THUMBNAIL_WIDTH, TOOLBAR_HEIGHT);
         m_imgListView->show();
     }
     m_imgList->show();
 
-//    if(m_nowIndex==0)
-//        m_preButton->setDisabled(true);
-//    if(m_nowIndex==m_allfileslist.size())
-//        m_nextButton->setDisabled(true);
-
-
     m_windowWidth =  this->window()->geometry().width();
-    if (m_ItemLoaded.size() <= 1) {
+    if (count <= 1) {
         m_contentWidth = TOOLBAR_JUSTONE_WIDTH;
-    } else if (m_ItemLoaded.size() <= 3) {
+    } else if (count <= 3) {
         m_contentWidth = TOOLBAR_MINIMUN_WIDTH;
         m_imgListView->setFixedSize(QSize(TOOLBAR_DVALUE, TOOLBAR_HEIGHT));
     } else {
@@ -1723,7 +1451,5 @@ void TTBContent::onResize()
         m_imgListView->setFixedSize(QSize(qMin((TOOLBAR_MINIMUN_WIDTH + THUMBNAIL_ADD_WIDTH * (m_filelist_size - 3)), qMax(m_windowWidth - RT_SPACING, TOOLBAR_MINIMUN_WIDTH)) - THUMBNAIL_VIEW_DVALUE + THUMBNAIL_LIST_ADJUST, TOOLBAR_HEIGHT));
     }
     setFixedWidth(m_contentWidth);
-
-    if (!binsertneedupdate)
-        return;
+    layoutSlots();
 }
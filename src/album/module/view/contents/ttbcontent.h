@@ -40,10 +40,14 @@
 #include <DBlurEffectWidget>
 #include <DGuiApplicationHelper>
 #include <DLabel>
+#include <QSet>
 #include "imageengine/imageengineobject.h"
 
 DWIDGET_USE_NAMESPACE
 
+//胶片条中每个缩略图槽位的宽度
+const int THUMBNAIL_WIDTH = 32;
+
 class ElidedLabel;
 class QAbstractItemModel;
 //class DImageButton;
@@ -63,8 +67,9 @@ public:
     void animationStart(bool isReset, int endPos, int duration);
     void stopAnimation();
 //    bool isAnimationStart();//判断动画是否执行中
+    //设置缩略图总数，槽位回收后子控件数不再等于图片数
+    void setItemCount(int count);
 
-    QTimer *m_timer = nullptr;
     void findSelectItem();
 protected:
     bool eventFilter(QObject *obj, QEvent *e) Q_DECL_OVERRIDE;
@@ -72,9 +77,8 @@ signals:
     void mouseLeftReleased();
     void needContinueRequest();
     void silmoved();
-
-    void testloadRight();
-    void testloadLeft();
+    //缩略图列表位置变化（拖动、惯性、复位动画），用于重新绑定槽位
+    void listMoved();
 public slots:
 //    void animationTimerTimeOut();
     void animationFinished();
@@ -96,6 +100,7 @@ private:
     int m_animationTimerTOCount = 0;
     int m_preListGeometryLeft = 0;
     bool m_resetFinish = false;
+    int m_itemCount = 0;
 };
 
 class ImageItem : public QLabel
@@ -106,6 +111,8 @@ public:
     ImageItem(int index = 0, ImageDataSt data = ImageDataSt(), QWidget *parent = nullptr);
     void setIndexNow(int i);
     void setPic(QPixmap pixmap);
+    //槽位回收时清空缩略图，缩略图未载入前不显示损坏图标
+    void clearPic();
 
     QString _path;
     int index() const;
@@ -141,10 +148,6 @@ class TTBContent : public QLabel, public ImageEngineObject
 {
     Q_OBJECT
 public:
-    struct TTBContentData {
-        int index;
-        ImageDataSt data;
-    };
 //    explicit TTBContent(bool inDB, DBImgInfoList m_infos, QWidget *parent = 0);
     explicit TTBContent(bool inDB, QStringList filelist, QWidget *parent = nullptr);
     ~TTBContent() override
@@ -167,7 +170,6 @@ public:
         return false;
     }
     bool imageLoaded(QString filepath) override;
-    void insertImageItem(const ImageDataSt &file, bool bloadRight = true);
     void stopLoadAndClear();
 //    void reLoad();
     QStringList getAllFileList();
@@ -178,13 +180,6 @@ public:
     QString getIndexPath(int index);
     void requestSomeImages();
     //------------------
-    /**
-     * @brief setRightlist  设置右侧数据
-     * @param rightlist
-     */
-    void setRightlist(const QStringList &rightlist);
-
-    void setLeftlist(const QStringList &leftlist);
 
 signals:
     void ttbcontentClicked();
@@ -200,13 +195,6 @@ signals:
     void showNext();
     void feedBackCurrentIndex(int index, QString path);
     void sigRequestSomeImages();
-    /**
-     * @brief sigloadRight
-     * @param rightlist
-     */
-    void sigloadRight(QStringList rightlist);
-
-    void sigloadLeft(QStringList leftlist);
 
 public slots:
     void setCurrentDir(const QString &text);
@@ -228,8 +216,6 @@ public slots:
     void onclBTClicked();
     void onRotateLBtnClicked();
     void onRotateRBtnClicked();
-    void onImgListViewTestloadRight();
-    void onImgListViewTestloadLeft();
     void onHideImageView();
     void onSilmoved();
     void onNeedContinueRequest();
@@ -237,12 +223,25 @@ public slots:
 
 private slots:
     void onThemeChanged(ViewerThemeManager::AppTheme theme);
+    void onImageItemClicked(int index, int indexNow);
+    /**
+     * @brief layoutSlots 按列表当前位置把固定数量的槽位绑定到可见下标附近
+     */
+    void layoutSlots();
 
 protected:
     void resizeEvent(QResizeEvent *event) override;
 public:
     QString m_imageType;
 
+private:
+    void ensureSlots();
+    void bindSlot(ImageItem *item, int index);
+    void unbindSlot(ImageItem *item);
+    ImageItem *slotOfIndex(int index) const;
+    int itemX(int index) const;
+    int indexOfPath(const QString &path) const;
+
 private:
 #ifndef LITE_DIV
     PushButton *m_folderBtn;
@@ -262,7 +261,6 @@ private:
     DIconButton *m_backButton;
     ElidedLabel *m_fileNameLabel;
     DWidget *m_imgList;
-    QHBoxLayout *m_imglayout;
     MyImageListWidget *m_imgListView;
     DWidget *m_preButton_spc;
     DWidget *m_nextButton_spc;
@@ -276,18 +274,13 @@ private:
     bool badaptScreenBtnChecked = false;
     //------------------
     QStringList m_allfileslist;
-    QStringList m_filesbeleft;
     bool bneedloadimage = true;
-    bool brequestallfiles = false;
-    QMap<QString, TTBContentData> m_ItemLoaded;
-    int m_requestCount = 0;
-    int m_allNeedRequestFilesCount = 0;
     QString m_currentpath = "";
     int m_lastIndex = -1;
     bool binsertneedupdate = true;
 
-    QStringList m_rightlist;        //保存动态加载数据（右侧）
-    QStringList m_leftlist;
+    QVector<ImageItem *> m_slots;   //固定数量的缩略图槽位，下标 index 绑定到 m_slots[index % 槽位数]
+    QSet<QString> m_requestedPaths; //已请求尚未返回的缩略图
 };
 
 #endif // TTLCONTENT_H
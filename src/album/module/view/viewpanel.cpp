@@ -57,8 +57,6 @@ namespace {
 
 const int DELAY_HIDE_CURSOR_INTERVAL = 3000;
 //const QSize ICON_SIZE = QSize(48, 40);
-const int LOAD_ALL = 51;           //一次加载数量
-const int LOAD_LEFT_RIGHT = 25;     //动态加载数量
 
 }  // namespace
 
@@ -219,9 +217,6 @@ QWidget *ViewPanel::bottomTopLeftContent()
         m_ttbc->setImage("");
     }
 
-    //测试使用
-    connect(m_ttbc, &TTBContent::sigloadRight, this, &ViewPanel::onLoadRight);
-    connect(m_ttbc, &TTBContent::sigloadLeft, this, &ViewPanel::onLoadLeft);
     connect(m_ttbc, &TTBContent::ttbcontentClicked, this, &ViewPanel::onttbcontentClicked);
     connect(this, &ViewPanel::ttbcDeleteImage, m_ttbc, &TTBContent::deleteImage);
     connect(this, &ViewPanel::viewImageFrom, m_ttbc, [ = ](const QString & dir) {
@@ -383,23 +378,6 @@ void ViewPanel::onViewImageNoNeedReload(int &fileindex)
     showImage(fileindex, 0);
 }
 
-void ViewPanel::onLoadRight(QStringList rightlist)
-{
-    m_filepathlist << rightlist;
-}
-
-void ViewPanel::onLoadLeft(QStringList leftlist)
-{
-//    for (const auto &path : leftlist)
-//        m_filepathlist.push_front(path);
-    auto path = leftlist.begin();
-    while (path != leftlist.end()) {
-        m_filepathlist.push_front(QString::fromStdString(path->toStdString()));
-        ++path;
-    }
-    m_current += leftlist.size();
-}
-
 void ViewPanel::onttbcontentClicked()
 {
     if (0 != m_iSlideShowTimerId) {
@@ -560,35 +538,8 @@ void ViewPanel::onViewImage(const QStringList &vinfo)
     }
     emit dApp->signalM->gotoPanel(this);
     m_current = -1;
-    //以当前图片为中心，前后各自LOAD_ALL张  修改为动态加载--xiaolong  2020/05/22
-    QStringList rightlist, leftlist, tempalllist;
-    int currentindex = vinfo.indexOf(m_vinfo.path); //当前图片下标
-    if (vinfo.size() > LOAD_ALL) {
-        if (currentindex < LOAD_LEFT_RIGHT) {
-            tempalllist << vinfo.mid(0, currentindex);  //前50,不足所有
-            tempalllist << vinfo.mid(currentindex, LOAD_LEFT_RIGHT); //后50
-            leftlist.clear();
-            rightlist << vinfo.mid(currentindex + LOAD_LEFT_RIGHT, vinfo.size() - currentindex - LOAD_LEFT_RIGHT);
-        } else {
-            tempalllist << vinfo.mid(currentindex - LOAD_LEFT_RIGHT, LOAD_LEFT_RIGHT);    //中心前50
-            int temprightcount = vinfo.size() - currentindex;
-            if (temprightcount > LOAD_LEFT_RIGHT) {
-                tempalllist << vinfo.mid(currentindex, LOAD_LEFT_RIGHT); //中心后50
-                rightlist << vinfo.mid(currentindex + LOAD_LEFT_RIGHT, vinfo.size() - currentindex - LOAD_LEFT_RIGHT);
-            } else {
-                tempalllist << vinfo.mid(currentindex, temprightcount);//后不足50
-                rightlist.clear();
-            }
-            leftlist = vinfo.mid(0, currentindex - LOAD_LEFT_RIGHT);
-        }
-    } else {
-        tempalllist << vinfo;
-        leftlist.clear();
-        rightlist.clear();
-    }
-
-    m_filepathlist = tempalllist;
-
+    //缩略图栏按下标回收槽位，直接使用完整列表，不再分段动态加载
+    m_filepathlist = vinfo;
 
     if (vinfo.size() == 1) {
         m_imageDirIterator.reset(new QDirIterator(QFileInfo(vinfo.first()).absolutePath(),
@@ -598,11 +549,7 @@ void ViewPanel::onViewImage(const QStringList &vinfo)
     }
 
     QWidget *pttbc = bottomTopLeftContent();
-    //
-    dynamic_cast<TTBContent *>(pttbc)->setRightlist(rightlist); //左侧动态加载路径
-    dynamic_cast<TTBContent *>(pttbc)->setLeftlist(leftlist);   //右侧动态加载路径
-    emit dApp->signalM->updateBottomToolbarContent(pttbc, (tempalllist.size() > 1));
-//    emit dApp->signalM->updateBottomToolbarContent(pttbc, (vinfo.size() > 1));
+    emit dApp->signalM->updateBottomToolbarContent(pttbc, (vinfo.size() > 1));
 
     emit dynamic_cast<TTBContent *>(pttbc)->sigRequestSomeImages();
 }
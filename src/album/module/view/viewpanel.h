@@ -85,8 +85,6 @@ public slots:
     void onESCKeyActivated();
     void onImagesInserted();
     void onViewImageNoNeedReload(int &fileindex);
-    void onLoadRight(QStringList rightlist);
-    void onLoadLeft(QStringList leftlist);
     void onttbcontentClicked();
     void onRotateClockwise();
     void onRotateCounterClockwise();
@@ -26,6 +26,7 @@
 #include "widgets/printhelper.h"
 #include "mainwindow.h"
 #include "allpicview.h"
+#include "dbmanager/dbasyncmanager.h"
 #include <DMenu>
 #include <QKeySequence>
 #include <QJsonArray>
@@ -180,11 +181,9 @@ void ViewPanel::onMenuItemClicked(QAction *action)
                 emit dApp->signalM->sigAddToAlbToast(album);
                 QStringList paths;
                 paths << path1;
-                // 相册照片更新时的．更新路径相册名缓存,用于listview的setdata userrole + 2
-                ImageEngineApi::instance()->setImgPathAndAlbumNames(DBManager::instance()->getAllPathAlbumNames());
+                DBManager::instance()->insertIntoAlbumAsync(album, paths);
                 emit SignalManager::instance()->sigSyncListviewModelData(paths, album, IdAddToAlbum);
             }
-            DBManager::instance()->insertIntoAlbum(album, QStringList(path1));
         } else {
             emit dApp->signalM->viewCreateAlbum(path1, false);
         }
@@ -192,13 +191,13 @@ void ViewPanel::onMenuItemClicked(QAction *action)
     break;
     //收藏
     case IdAddToFavorites: {
-        DBManager::instance()->insertIntoAlbum(COMMON_STR_FAVORITES, QStringList(path1), AlbumDBType::Favourite);
+        DBManager::instance()->insertIntoAlbumAsync(COMMON_STR_FAVORITES, QStringList(path1), AlbumDBType::Favourite);
         emit dApp->signalM->insertedIntoAlbum(COMMON_STR_FAVORITES, QStringList(path1));
     }
     break;
     //取消收藏
     case IdRemoveFromFavorites: {
-        DBManager::instance()->removeFromAlbum(COMMON_STR_FAVORITES, QStringList(path1), AlbumDBType::Favourite);
+        DBManager::instance()->removeFromAlbumAsync(COMMON_STR_FAVORITES, QStringList(path1), AlbumDBType::Favourite);
     }
     break;
     //导出
@@ -217,7 +216,7 @@ void ViewPanel::onMenuItemClicked(QAction *action)
     }
     break;
     case IdRemoveFromAlbum:
-        DBManager::instance()->removeFromAlbum(m_vinfo.viewType, QStringList(m_currentpath));
+        DBManager::instance()->removeFromAlbumAsync(m_vinfo.viewType, QStringList(m_currentpath));
         removeCurrentImage();
         break;
     case IdShowNavigationWindow:
@@ -349,11 +348,6 @@ DMenu *ViewPanel::createAblumMenu()
 {
     DMenu *am = new DMenu(tr("Add to album"));
 
-    QStringList albums = DBManager::instance()->getAllAlbumNames();
-    albums.removeAll(COMMON_STR_FAVORITES);
-    albums.removeAll(COMMON_STR_TRASH);
-    albums.removeAll(COMMON_STR_RECENT_IMPORTED);
-
     QAction *ac1 = new QAction(am);
     ac1->setProperty("MenuID", IdAddToAlbum);
     ac1->setText(tr("New album"));
@@ -363,28 +357,32 @@ DMenu *ViewPanel::createAblumMenu()
     am->addSeparator();
 
     QStringList albumNames;
-    if (albums.count() > 0) {
-        QStandardItemModel *pTempModel = dApp->getMainWindow()->m_pAllPicView->getAllPicThumbnailListViewModel()->m_model;
-        for (int i = 0; i < pTempModel->rowCount(); i++) {
-            QModelIndex idx = pTempModel->index(i, 0);
-            QVariantList lst = idx.model()->data(idx, Qt::DisplayRole).toList();
-            if (lst.count() >= 12) {
-                if (lst.at(1).toString() == m_currentpath) {
-                    albumNames = idx.model()->data(idx, Qt::UserRole + 2).toStringList();
-                }
-            }
-        }
+    ThumbnailModel *pTempModel = dApp->getMainWindow()->m_pAllPicView->getAllPicThumbnailListViewModel()->m_model;
+    const int row = pTempModel->rowOf(m_currentpath);
+    if (row >= 0) {
+        albumNames = pTempModel->index(row, 0).data(ThumbnailModel::AlbumNamesRole).toStringList();
     }
-    for (QString album : albums) {
-        QAction *ac = new QAction(am);
-        ac->setProperty("MenuID", IdAddToAlbum);
-        ac->setText(fontMetrics().elidedText(QString(album).replace("&", "&&"), Qt::ElideMiddle, 200));
-        ac->setData(album);
-        am->addAction(ac);
-        if (albumNames.contains(album)) {
-            ac->setEnabled(false);
+    //相册名在数据库线程查询，返回后追加到子菜单；菜单已销毁则不回调
+    std::function<QStringList()> query = []() {
+        return DBManager::instance()->getAllAlbumNames();
+    };
+    std::function<void(const QStringList &)> callback = [this, am, albumNames](const QStringList & allAlbums) {
+        QStringList albums = allAlbums;
+        albums.removeAll(COMMON_STR_FAVORITES);
+        albums.removeAll(COMMON_STR_TRASH);
+        albums.removeAll(COMMON_STR_RECENT_IMPORTED);
+        for (QString album : albums) {
+            QAction *ac = new QAction(am);
+            ac->setProperty("MenuID", IdAddToAlbum);
+            ac->setText(fontMetrics().elidedText(QString(album).replace("&", "&&"), Qt::ElideMiddle, 200));
+            ac->setData(album);
+            am->addAction(ac);
+            if (albumNames.contains(album)) {
+                ac->setEnabled(false);
+            }
         }
-    }
+    };
+    DBAsyncManager::instance()->query(am, query, callback);
     return am;
 }
 #endif
@@ -436,10 +434,10 @@ void ViewPanel::keyPressEvent(QKeyEvent *e)
 {
     if (e->key() == Qt::Key_Period) {
         if (!DBManager::instance()->isImgExistInAlbum(COMMON_STR_FAVORITES, m_currentpath, AlbumDBType::Favourite)) {
-            DBManager::instance()->insertIntoAlbum(COMMON_STR_FAVORITES, QStringList(m_currentpath), AlbumDBType::Favourite);
+            DBManager::instance()->insertIntoAlbumAsync(COMMON_STR_FAVORITES, QStringList(m_currentpath), AlbumDBType::Favourite);
             emit dApp->signalM->insertedIntoAlbum(COMMON_STR_FAVORITES, QStringList(m_currentpath));
         } else {
-            DBManager::instance()->removeFromAlbum(COMMON_STR_FAVORITES, QStringList(m_currentpath), AlbumDBType::Favourite);
+            DBManager::instance()->removeFromAlbumAsync(COMMON_STR_FAVORITES, QStringList(m_currentpath), AlbumDBType::Favourite);
         }
     }
 }
@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "searchcontroller.h"
+#include "application.h"
+#include "controller/signalmanager.h"
+#include "dbmanager/dbasyncmanager.h"
+#include "utils/baseutils.h"
+
+SearchController *SearchController::m_instance = nullptr;
+
+SearchController *SearchController::instance()
+{
+    if (!m_instance) {
+        m_instance = new SearchController();
+    }
+    return m_instance;
+}
+
+SearchController::SearchController(QObject *parent)
+    : QObject(parent)
+    , m_inputTimer(new QTimer(this))
+    , m_tag(QStringLiteral("search"))
+    , m_firstPageTag(QStringLiteral("search_first"))
+{
+    m_inputTimer->setSingleShot(true);
+    m_inputTimer->setInterval(SEARCH_DEBOUNCE_INTERVAL);
+    connect(m_inputTimer, &QTimer::timeout, this, [ = ] {
+        emit inputSettled(m_inputText);
+    });
+    //图片增删后缓存的结果集失效，重新查询当前关键字
+    connect(dApp->signalM, &SignalManager::imagesInserted, this, &SearchController::onDatabaseChanged);
+    connect(dApp->signalM, &SignalManager::imagesRemoved, this, &SearchController::onDatabaseChanged);
+    connect(dApp->signalM, &SignalManager::sigUpdateImageLoader, this, &SearchController::onDatabaseChanged);
+}
+
+void SearchController::inputChanged(const QString &text)
+{
+    m_inputText = text;
+    m_inputTimer->start();
+}
+
+void SearchController::flushInput()
+{
+    m_inputTimer->stop();
+}
+
+void SearchController::search(const QString &keywords, const QString &album)
+{
+    if (keywords == m_keywords && album == m_album) {
+        if (m_finished) {
+            //结果已缓存，直接再返回一次
+            DBImgInfoList infos = m_results;
+            QMetaObject::invokeMethod(this, [ = ] {
+                emit resultsReady(infos, false);
+            }, Qt::QueuedConnection);
+        }
+        return;
+    }
+
+    if (canRefine(keywords, album)) {
+        m_keywords = keywords;
+        m_finished = false;
+        //细化只在旧结果集里过滤，首批查询不再需要
+        DBAsyncManager::instance()->cancel(m_firstPageTag);
+        const DBImgInfoList base = m_results;
+        std::function<DBImgInfoList()> query = [ = ]() {
+            return refine(base, keywords);
+        };
+        std::function<void(const DBImgInfoList &)> callback = [ = ](const DBImgInfoList & infos) {
+            setResults(infos);
+            emit resultsReady(infos, false);
+        };
+        DBAsyncManager::instance()->query(this, query, callback, m_tag);
+        return;
+    }
+
+    m_keywords = keywords;
+    m_album = album;
+    startQuery();
+}
+
+void SearchController::cancel()
+{
+    m_inputTimer->stop();
+    DBAsyncManager::instance()->cancel(m_firstPageTag);
+    DBAsyncManager::instance()->cancel(m_tag);
+    m_keywords.clear();
+    m_album.clear();
+    m_results.clear();
+    m_paths.clear();
+    m_finished = false;
+}
+
+QString SearchController::keywords() const
+{
+    return m_keywords;
+}
+
+QString SearchController::album() const
+{
+    return m_album;
+}
+
+bool SearchController::isFinished() const
+{
+    return m_finished;
+}
+
+const DBImgInfoList &SearchController::results() const
+{
+    return m_results;
+}
+
+const QStringList &SearchController::paths() const
+{
+    return m_paths;
+}
+
+DBImgInfoList SearchController::refine(const DBImgInfoList &infos, const QString &keywords)
+{
+    DBImgInfoList result;
+    for (const DBImgInfo &info : infos) {
+        //库中Time列按yyyy.MM.dd存储
+        if (likeContains(info.fileName, keywords)
+                || likeContains(info.time.toString("yyyy.MM.dd"), keywords)) {
+            result << info;
+        }
+    }
+    return result;
+}
+
+bool SearchController::likeContains(const QString &text, const QString &keywords)
+{
+    //与查库一致：%和_按普通字符匹配，只对ASCII字母忽略大小写(同sqlite的like)
+    auto fold = [](QChar c) {
+        return c.unicode() < 128 ? c.toLower() : c;
+    };
+    const int n = text.size();
+    const int m = keywords.size();
+    for (int i = 0; i + m <= n; ++i) {
+        int j = 0;
+        while (j < m && fold(text.at(i + j)) == fold(keywords.at(j))) {
+            ++j;
+        }
+        if (j == m) {
+            return true;
+        }
+    }
+    return 0 == m;
+}
+
+void SearchController::onDatabaseChanged()
+{
+    if (m_keywords.isEmpty()) {
+        return;
+    }
+    startQuery();
+}
+
+void SearchController::startQuery()
+{
+    m_finished = false;
+    const QString keywords = m_keywords;
+    const QString album = m_album;
+
+    //先取首批结果尽快显示，不足一批时即为完整结果
+    std::function<DBImgInfoList()> firstQuery = [ = ]() {
+        return queryKeywords(keywords, album, SEARCH_FIRST_PAGE);
+    };
+    std::function<void(const DBImgInfoList &)> firstCallback = [ = ](const DBImgInfoList & infos) {
+        if (m_finished) {
+            return;
+        }
+        if (infos.size() < SEARCH_FIRST_PAGE) {
+            DBAsyncManager::instance()->cancel(m_tag);
+            setResults(infos);
+            emit resultsReady(infos, false);
+        } else {
+            emit resultsReady(infos, true);
+        }
+    };
+    DBAsyncManager::instance()->query(this, firstQuery, firstCallback, m_firstPageTag);
+
+    std::function<DBImgInfoList()> query = [ = ]() {
+        return queryKeywords(keywords, album, 0);
+    };
+    std::function<void(const DBImgInfoList &)> callback = [ = ](const DBImgInfoList & infos) {
+        setResults(infos);
+        emit resultsReady(infos, false);
+    };
+    DBAsyncManager::instance()->query(this, query, callback, m_tag);
+}
+
+bool SearchController::canRefine(const QString &keywords, const QString &album) const
+{
+    if (!m_finished || m_keywords.isEmpty() || album != m_album) {
+        return false;
+    }
+    return likeContains(keywords, m_keywords);
+}
+
+void SearchController::setResults(const DBImgInfoList &infos)
+{
+    m_results = infos;
+    m_paths.clear();
+    m_paths.reserve(infos.size());
+    for (const DBImgInfo &info : infos) {
+        m_paths << info.filePath;
+    }
+    m_finished = true;
+}
+
+DBImgInfoList SearchController::queryKeywords(const QString &keywords, const QString &album, int limit)
+{
+    if (COMMON_STR_ALLPHOTOS == album
+            || COMMON_STR_TIMELINE == album
+            || COMMON_STR_RECENT_IMPORTED == album) {
+        return DBManager::instance()->getInfosForKeyword(keywords, limit);
+    } else if (COMMON_STR_TRASH == album) {
+        return DBManager::instance()->getTrashInfosForKeyword(keywords, limit);
+    }
+    return DBManager::instance()->getInfosForKeyword(album, keywords, limit);
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SEARCHCONTROLLER_H
+#define SEARCHCONTROLLER_H
+
+#include "dbmanager/dbmanager.h"
+
+#include <QObject>
+#include <QTimer>
+
+//输入停止多久后才发起搜索(ms)
+const int SEARCH_DEBOUNCE_INTERVAL = 250;
+//首批结果条数，先显示首批再替换为完整结果
+const int SEARCH_FIRST_PAGE = 200;
+
+/**
+ * @brief The SearchController class
+ * 关键字搜索的统一入口：输入去抖，查询在数据库线程执行，新查询作废旧查询。
+ * 新关键字包含上一次关键字时直接在上一次的结果集中过滤，不再查库。
+ * 结果集缓存在此，打开图片、幻灯片直接复用，不再重复查询。
+ */
+class SearchController : public QObject
+{
+    Q_OBJECT
+public:
+    static SearchController *instance();
+
+    //搜索框输入变化，去抖后发出inputSettled
+    void inputChanged(const QString &text);
+    //回车等需要立即搜索的场景，丢弃尚未触发的去抖
+    void flushInput();
+
+    //搜索album中的keywords，与当前查询相同时不重复查询
+    void search(const QString &keywords, const QString &album);
+    //作废进行中的查询并清空缓存
+    void cancel();
+
+    QString keywords() const;
+    QString album() const;
+    bool isFinished() const;
+    const DBImgInfoList &results() const;
+    const QStringList &paths() const;
+
+    //在infos中筛选匹配keywords的项，规则与数据库like一致，保持原有顺序
+    static DBImgInfoList refine(const DBImgInfoList &infos, const QString &keywords);
+    static bool likeContains(const QString &text, const QString &keywords);
+
+signals:
+    void inputSettled(const QString &text);
+    //partial为true时只是首批结果，完整结果随后到达
+    void resultsReady(const DBImgInfoList &infos, bool partial);
+
+private slots:
+    void onDatabaseChanged();
+
+private:
+    explicit SearchController(QObject *parent = nullptr);
+    void startQuery();
+    bool canRefine(const QString &keywords, const QString &album) const;
+    void setResults(const DBImgInfoList &infos);
+    static DBImgInfoList queryKeywords(const QString &keywords, const QString &album, int limit);
+
+    static SearchController *m_instance;
+    QTimer *m_inputTimer;
+    QString m_inputText;
+    QString m_keywords;
+    QString m_album;
+    QString m_tag;
+    QString m_firstPageTag;
+    DBImgInfoList m_results;
+    QStringList m_paths;
+    bool m_finished = false;
+};
+
+#endif // SEARCHCONTROLLER_H
@@ -1,6 +1,7 @@
 #include "searchview.h"
 #include <DApplicationHelper>
 #include "imageengine/imageengineapi.h"
+#include "searchcontroller.h"
 #include <QGraphicsDropShadowEffect>
 #include <QPainter>
 #include <QDebug>
@@ -137,9 +138,8 @@ void SearchView::initConnections()
     connect(dApp->signalM, &SignalManager::sigSendKeywordsIntoALLPic, this, &SearchView::improtSearchResultsIntoThumbnailView);
     connect(m_pThumbnailListView, &ThumbnailListView::openImage, this, &SearchView::onThumbnailListViewOpenImage);
     connect(m_pThumbnailListView, &ThumbnailListView::menuOpenImage, this, &SearchView::onThumbnailListViewMenuOpenImage);
-    connect(dApp->signalM, &SignalManager::sigUpdateImageLoader, this, &SearchView::updateSearchResultsIntoThumbnailView);
-    connect(dApp->signalM, &SignalManager::imagesInserted, this, &SearchView::updateSearchResultsIntoThumbnailView);
-    connect(dApp->signalM, &SignalManager::imagesRemoved, this, &SearchView::updateSearchResultsIntoThumbnailView);
+    //图片增删后由SearchController重新查询，结果同样经resultsReady返回
+    connect(SearchController::instance(), &SearchController::resultsReady, this, &SearchView::onSearchResultsReady);
     connect(DApplicationHelper::instance(), &DApplicationHelper::themeTypeChanged, this, &SearchView::changeTheme);
     connect(dApp, &Application::sigFinishLoad, this, &SearchView::onFinishLoad);
     connect(dApp->signalM, &SignalManager::sigShortcutKeyDelete, this, &SearchView::onKeyDelete);
@@ -261,20 +261,17 @@ void SearchView::initMainStackWidget()
 void SearchView::improtSearchResultsIntoThumbnailView(QString s, QString album)
 {
     m_albumName = album;
-    using namespace utils::image;
     m_keywords = s;
-    QList<ThumbnailListView::ItemInfo> thumbnaiItemList;
-    DBImgInfoList infos;
-    if (COMMON_STR_ALLPHOTOS == m_albumName
-            || COMMON_STR_TIMELINE == m_albumName
-            || COMMON_STR_RECENT_IMPORTED == m_albumName) {
-        infos = DBManager::instance()->getInfosForKeyword(s);
-    } else if (COMMON_STR_TRASH == m_albumName) {
-        infos = DBManager::instance()->getTrashInfosForKeyword(s);
-    } else {
-        infos = DBManager::instance()->getInfosForKeyword(m_albumName, s);
-    }
+    //去抖、作废旧查询、在已有结果中细化均由SearchController负责
+    SearchController::instance()->search(s, album);
+}
 
+void SearchView::onSearchResultsReady(const DBImgInfoList &infos, bool partial)
+{
+    //结果属于其它视图发起的旧搜索时不处理
+    if (m_keywords != SearchController::instance()->keywords()) {
+        return;
+    }
     if (0 < infos.length()) {
         m_pThumbnailListView->loadFilesFromLocal(infos);
         QString searchStr = tr("%1 photo(s) found");
@@ -302,30 +299,16 @@ void SearchView::improtSearchResultsIntoThumbnailView(QString s, QString album)
         m_searchPicNum = 0;
         m_stackWidget->setCurrentIndex(0);
     }
+    if (!partial) {
+        emit sigSearchFinished();
+    }
 }
 
 void SearchView::onSlideShowBtnClicked()
 {
-    DBImgInfoList imagelist;
-    if (COMMON_STR_ALLPHOTOS == m_albumName
-            || COMMON_STR_TIMELINE == m_albumName
-            || COMMON_STR_RECENT_IMPORTED == m_albumName) {
-        imagelist = DBManager::instance()->getInfosForKeyword(m_keywords);
-    } else if (COMMON_STR_TRASH == m_albumName) {
-        imagelist = DBManager::instance()->getTrashInfosForKeyword(m_keywords);
-    } else {
-        imagelist = DBManager::instance()->getInfosForKeyword(m_albumName, m_keywords);
-    }
-
-    QStringList paths;
-    for (auto image : imagelist) {
-        paths << image.filePath;
-    }
-
-    QString path = "";
+    const QStringList paths = resultPaths();
     if (paths.size() > 0) {
-        path = paths.first();
-        emit m_pThumbnailListView->menuOpenImage(path, paths, true, true);
+        emit m_pThumbnailListView->menuOpenImage(paths.first(), paths, true, true);
     }
 }
 
@@ -334,18 +317,9 @@ void SearchView::onThumbnailListViewOpenImage(int index)
     SignalManager::ViewInfo info;
     info.album = "";
     info.lastPanel = nullptr;
-    DBImgInfoList imagelist;
-    if (COMMON_STR_ALLPHOTOS == m_albumName
-            || COMMON_STR_TIMELINE == m_albumName
-            || COMMON_STR_RECENT_IMPORTED == m_albumName) {
-        imagelist = DBManager::instance()->getInfosForKeyword(m_keywords);
-    } else if (COMMON_STR_TRASH == m_albumName) {
-        imagelist = DBManager::instance()->getTrashInfosForKeyword(m_keywords);
-    } else {
-        imagelist = DBManager::instance()->getInfosForKeyword(m_albumName, m_keywords);
-    }
-    for (auto image : imagelist) {
-        info.paths << image.filePath;
+    info.paths = resultPaths();
+    if (index < 0 || index >= info.paths.size()) {
+        return;
     }
     info.path = info.paths[index];
     info.viewType = utils::common::VIEW_SEARCH_SRN;
@@ -361,6 +335,15 @@ void SearchView::onThumbnailListViewOpenImage(int index)
     }
 }
 
+QStringList SearchView::resultPaths()
+{
+    //直接使用缓存的搜索结果，不再重新查询；完整结果未到达时使用当前显示的首批结果
+    if (SearchController::instance()->isFinished()) {
+        return SearchController::instance()->paths();
+    }
+    return m_pThumbnailListView->getAllFileList();
+}
+
 void SearchView::onThumbnailListViewMenuOpenImage(QString path, QStringList paths, bool isFullScreen, bool isSlideShow)
 {
     SignalManager::ViewInfo info;
@@ -419,11 +402,6 @@ void SearchView::onFinishLoad()
     m_pThumbnailListView->update();
 }
 
-void SearchView::updateSearchResultsIntoThumbnailView()
-{
-    improtSearchResultsIntoThumbnailView(m_keywords, m_albumName);
-}
-
 void SearchView::changeTheme()
 {
 
@@ -64,12 +64,17 @@ public slots:
     void onThumbnailListViewMenuOpenImage(QString path, QStringList paths, bool isFullScreen, bool isSlideShow);
     void onFinishLoad();
 
+signals:
+    //异步搜索结果已显示
+    void sigSearchFinished();
+
 private:
     void initConnections();
     void initNoSearchResultView();
     void initSearchResultView();
     void initMainStackWidget();
-    void updateSearchResultsIntoThumbnailView();
+    void onSearchResultsReady(const DBImgInfoList &infos, bool partial);
+    QStringList resultPaths();
     void changeTheme();
     void onKeyDelete();
     void resizeEvent(QResizeEvent *e) override;
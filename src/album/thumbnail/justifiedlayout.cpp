@@ -0,0 +1,355 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "justifiedlayout.h"
+
+#include <algorithm>
+#include <limits>
+
+JustifiedLayout::JustifiedLayout()
+{
+    m_cache << Rows();
+}
+
+void JustifiedLayout::setSpacing(int spacing)
+{
+    if (spacing == m_spacing) {
+        return;
+    }
+    m_spacing = spacing;
+    resetCache();
+}
+
+int JustifiedLayout::spacing() const
+{
+    return m_spacing;
+}
+
+void JustifiedLayout::setHeaderHeight(int height)
+{
+    if (height == m_headerHeight) {
+        return;
+    }
+    m_headerHeight = height;
+    resetCache();
+}
+
+int JustifiedLayout::headerHeight() const
+{
+    return m_headerHeight;
+}
+
+bool JustifiedLayout::setGeometry(int width, int rowHeight)
+{
+    if (m_cache.first().width == width && m_cache.first().rowHeight == rowHeight) {
+        return false;
+    }
+    for (int i = 1; i < m_cache.size(); i++) {
+        if (m_cache.at(i).width == width && m_cache.at(i).rowHeight == rowHeight) {
+            m_cache.move(i, 0);
+            return true;
+        }
+    }
+    Rows rows;
+    rows.width = width;
+    rows.rowHeight = rowHeight;
+    m_cache.prepend(rows);
+    while (m_cache.size() > MAX_CACHED) {
+        m_cache.removeLast();
+    }
+    return true;
+}
+
+int JustifiedLayout::width() const
+{
+    return m_cache.first().width;
+}
+
+int JustifiedLayout::rowHeight() const
+{
+    return m_cache.first().rowHeight;
+}
+
+void JustifiedLayout::append(const QVector<float> &aspects)
+{
+    if (aspects.isEmpty()) {
+        return;
+    }
+    //原来的最后一行可能还能放下新图片，relayout会从那一行开始
+    markDirty(m_aspects.size());
+    m_aspects << aspects;
+}
+
+void JustifiedLayout::remove(int index, int count)
+{
+    if (index < 0 || count < 1 || index + count > m_aspects.size()) {
+        return;
+    }
+    markDirty(index);
+    m_aspects.remove(index, count);
+}
+
+void JustifiedLayout::setAspect(int index, float aspect)
+{
+    if (index < 0 || index >= m_aspects.size() || qFuzzyCompare(m_aspects.at(index), aspect)) {
+        return;
+    }
+    markDirty(index);
+    m_aspects[index] = aspect;
+}
+
+void JustifiedLayout::clear()
+{
+    m_aspects.clear();
+    for (Rows &rows : m_cache) {
+        rows.laidCount = 0;
+        rows.dirtyFrom = 0;
+        rows.start.clear();
+        rows.top.clear();
+        rows.height.clear();
+    }
+}
+
+int JustifiedLayout::count() const
+{
+    return m_aspects.size();
+}
+
+bool JustifiedLayout::isHeader(int index) const
+{
+    return index >= 0 && index < m_aspects.size() && m_aspects.at(index) <= 0;
+}
+
+int JustifiedLayout::rowCount() const
+{
+    return rows().start.size();
+}
+
+int JustifiedLayout::height() const
+{
+    const Rows &r = rows();
+    if (r.start.isEmpty()) {
+        return 0;
+    }
+    return r.top.last() + r.height.last();
+}
+
+int JustifiedLayout::estimatedHeight(int totalCount) const
+{
+    const Rows &r = rows();
+    if (totalCount <= m_aspects.size() || r.width < 1 || r.rowHeight < 1) {
+        return height();
+    }
+    //未加载的图片按正方形估算
+    const int capacity = qMax(1, r.width / (r.rowHeight + m_spacing));
+    int remaining = totalCount - m_aspects.size();
+    int itemHeight = (r.width - m_spacing * (capacity - 1)) / capacity;
+    int result = 0;
+    if (!r.start.isEmpty() && !isHeader(r.start.last())) {
+        itemHeight = r.height.last();
+        result = height();
+        remaining -= qMax(0, capacity - (m_aspects.size() - r.start.last()));
+        if (remaining <= 0) {
+            return result;
+        }
+        result += m_spacing;
+    } else if (!r.start.isEmpty()) {
+        result = height() + m_spacing;
+    }
+    const int extraRows = (remaining + capacity - 1) / capacity;
+    return result + extraRows * (itemHeight + m_spacing) - m_spacing;
+}
+
+int JustifiedLayout::rowOf(int index) const
+{
+    const Rows &r = rows();
+    if (index < 0 || index >= m_aspects.size()) {
+        return -1;
+    }
+    return int(std::upper_bound(r.start.constBegin(), r.start.constEnd(), index) - r.start.constBegin()) - 1;
+}
+
+int JustifiedLayout::rowAt(int y) const
+{
+    const Rows &r = rows();
+    if (r.top.isEmpty()) {
+        return -1;
+    }
+    const int row = int(std::upper_bound(r.top.constBegin(), r.top.constEnd(), y) - r.top.constBegin()) - 1;
+    return qMax(0, row);
+}
+
+int JustifiedLayout::firstInRow(int row) const
+{
+    const Rows &r = rows();
+    return (row >= 0 && row < r.start.size()) ? r.start.at(row) : -1;
+}
+
+int JustifiedLayout::rowTop(int row) const
+{
+    const Rows &r = rows();
+    return (row >= 0 && row < r.top.size()) ? r.top.at(row) : 0;
+}
+
+int JustifiedLayout::rowHeightAt(int row) const
+{
+    const Rows &r = rows();
+    return (row >= 0 && row < r.height.size()) ? r.height.at(row) : 0;
+}
+
+QSize JustifiedLayout::itemSize(int index) const
+{
+    const int row = rowOf(index);
+    if (row < 0) {
+        return QSize();
+    }
+    const int h = rows().height.at(row);
+    return QSize(itemWidth(index, h), h);
+}
+
+QRect JustifiedLayout::itemRect(int index) const
+{
+    const int row = rowOf(index);
+    if (row < 0) {
+        return QRect();
+    }
+    const Rows &r = rows();
+    const int h = r.height.at(row);
+    int x = 0;
+    for (int i = r.start.at(row); i < index; i++) {
+        x += itemWidth(i, h) + m_spacing;
+    }
+    return QRect(x, r.top.at(row), itemWidth(index, h), h);
+}
+
+int JustifiedLayout::indexAt(const QPoint &pos) const
+{
+    const Rows &r = rows();
+    if (r.start.isEmpty() || pos.x() < 0 || pos.y() < 0) {
+        return -1;
+    }
+    const int row = rowAt(pos.y());
+    if (pos.y() >= r.top.at(row) + r.height.at(row)) {
+        return -1;
+    }
+    const int h = r.height.at(row);
+    const int end = row + 1 < r.start.size() ? r.start.at(row + 1) : m_aspects.size();
+    int x = 0;
+    for (int i = r.start.at(row); i < end; i++) {
+        const int w = itemWidth(i, h);
+        if (pos.x() < x) {
+            return -1;
+        }
+        if (pos.x() < x + w) {
+            return i;
+        }
+        x += w + m_spacing;
+    }
+    return -1;
+}
+
+const JustifiedLayout::Rows &JustifiedLayout::rows() const
+{
+    Rows &current = m_cache.first();
+    if (current.laidCount != m_aspects.size() || current.dirtyFrom < m_aspects.size()) {
+        relayout(current);
+    }
+    return current;
+}
+
+void JustifiedLayout::relayout(Rows &rows) const
+{
+    const int n = m_aspects.size();
+    //从包含dirtyFrom前一张图片的行开始重排：变化的图片可能被并入上一行，
+    //删除末尾或标题后上一行也可能变成最后一行，需要按最后一行重新计算行高
+    int row = 0;
+    if (!rows.start.isEmpty() && rows.laidCount > 0) {
+        const int index = qMax(0, qMin(rows.dirtyFrom - 1, rows.laidCount - 1));
+        row = int(std::upper_bound(rows.start.constBegin(), rows.start.constEnd(), index) - rows.start.constBegin()) - 1;
+        row = qMax(0, row);
+    }
+    int i = row < rows.start.size() ? rows.start.at(row) : 0;
+    int top = row > 0 ? rows.top.at(row - 1) + rows.height.at(row - 1) + m_spacing : 0;
+    rows.start.resize(row);
+    rows.top.resize(row);
+    rows.height.resize(row);
+
+    if (rows.width > 0 && rows.rowHeight > 0) {
+        const double target = rows.rowHeight;
+        while (i < n) {
+            const int first = i;
+            if (isHeader(i)) {
+                //分组标题独占一行
+                rows.start << first;
+                rows.top << top;
+                rows.height << qMax(1, m_headerHeight);
+                top += qMax(1, m_headerHeight) + m_spacing;
+                ++i;
+                continue;
+            }
+            double sum = 0;
+            double used = 0;
+            do {
+                sum += m_aspects.at(i);
+                used += m_aspects.at(i) * target + m_spacing;
+                ++i;
+            } while (i < n && !isHeader(i) && used + m_aspects.at(i) * target + m_spacing <= rows.width);
+            const int count = i - first;
+            int h = 0;
+            if (i < n && !isHeader(i)) {
+                //满行：缩放到正好铺满宽度
+                h = int((rows.width - m_spacing * (count - 1)) / sum);
+            } else {
+                //最后一行或分组的最后一行：按平均宽高比的满行计算，与上面各行保持同样大小
+                const double mean = sum / count;
+                const int capacity = qMax(count, int(rows.width / (mean * target + m_spacing)));
+                h = int((rows.width - m_spacing * (capacity - 1)) / (capacity * mean));
+            }
+            h = qMax(1, h);
+            rows.start << first;
+            rows.top << top;
+            rows.height << h;
+            top += h + m_spacing;
+        }
+    }
+    rows.laidCount = n;
+    rows.dirtyFrom = std::numeric_limits<int>::max();
+}
+
+void JustifiedLayout::resetCache()
+{
+    //间距或标题高度变化后所有缓存的布局都失效
+    Rows current;
+    current.width = m_cache.first().width;
+    current.rowHeight = m_cache.first().rowHeight;
+    m_cache.clear();
+    m_cache << current;
+}
+
+void JustifiedLayout::markDirty(int index)
+{
+    for (Rows &rows : m_cache) {
+        rows.dirtyFrom = qMin(rows.dirtyFrom, index);
+    }
+}
+
+int JustifiedLayout::itemWidth(int index, int height) const
+{
+    if (m_aspects.at(index) <= 0) {
+        return qMax(1, m_cache.first().width);
+    }
+    return qMax(1, int(m_aspects.at(index) * height));
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef JUSTIFIEDLAYOUT_H
+#define JUSTIFIEDLAYOUT_H
+
+#include <QVector>
+#include <QList>
+#include <QRect>
+
+/**
+ * @brief The JustifiedLayout class
+ * 缩略图的两端对齐行布局：按宽高比把图片依次排入行，行满后等比缩放铺满宽度，最后一行按满行的比例显示。
+ * 每个布局只保存行首序号、行顶坐标和行高三组整数，按行号或坐标二分查找。
+ * 追加、删除或修改图片时只从受影响的行开始重排；不同宽度/行高的布局会缓存，缩放来回切换时直接复用。
+ * 宽高比不大于0的项是分组标题：独占一行、铺满宽度、高度固定，标题前未排满的行按最后一行处理。
+ */
+class JustifiedLayout
+{
+public:
+    JustifiedLayout();
+
+    void setSpacing(int spacing);
+    int spacing() const;
+    void setHeaderHeight(int height);
+    int headerHeight() const;
+    //切换可用宽度和目标行高，返回布局是否变化
+    bool setGeometry(int width, int rowHeight);
+    int width() const;
+    int rowHeight() const;
+
+    void append(const QVector<float> &aspects);
+    void remove(int index, int count);
+    void setAspect(int index, float aspect);
+    void clear();
+
+    int count() const;
+    bool isHeader(int index) const;
+    int rowCount() const;
+    int height() const;
+    //还有图片未加载时，按最后一行的尺寸估算总共totalCount张图片的高度
+    int estimatedHeight(int totalCount) const;
+
+    int rowOf(int index) const;
+    //纵坐标所在的行，落在行间距中时取上一行
+    int rowAt(int y) const;
+    int firstInRow(int row) const;
+    int rowTop(int row) const;
+    int rowHeightAt(int row) const;
+    QSize itemSize(int index) const;
+    QRect itemRect(int index) const;
+    //坐标处的图片序号，落在间隙中时返回-1
+    int indexAt(const QPoint &pos) const;
+
+private:
+    struct Rows {
+        int width = 0;
+        int rowHeight = 0;
+        int laidCount = 0;      //上次排版时的图片数
+        int dirtyFrom = 0;      //从这张图片开始需要重排
+        QVector<int> start;
+        QVector<int> top;
+        QVector<int> height;
+    };
+
+    const Rows &rows() const;
+    void relayout(Rows &rows) const;
+    void resetCache();
+    void markDirty(int index);
+    int itemWidth(int index, int height) const;
+
+    static const int MAX_CACHED = 4;
+
+    QVector<float> m_aspects;
+    int m_spacing = 0;
+    int m_headerHeight = 0;
+    //最近使用的布局在前，第一个为当前布局
+    mutable QList<Rows> m_cache;
+};
+
+#endif // JUSTIFIEDLAYOUT_H
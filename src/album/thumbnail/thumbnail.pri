@@ -1,7 +1,11 @@
 HEADERS += \
     $$PWD/thumbnaildelegate.h \
-    $$PWD/thumbnaillistview.h
+    $$PWD/justifiedlayout.h \
+    $$PWD/thumbnaillistview.h \
+    $$PWD/thumbnailmodel.h
 
 SOURCES += \
     $$PWD/thumbnaildelegate.cpp \
-    $$PWD/thumbnaillistview.cpp
+    $$PWD/justifiedlayout.cpp \
+    $$PWD/thumbnaillistview.cpp \
+    $$PWD/thumbnailmodel.cpp
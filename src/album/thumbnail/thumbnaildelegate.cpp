@@ -15,6 +15,8 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "thumbnaildelegate.h"
+#include "thumbnailmodel.h"
+#include "thumbnaillistview.h"
 #include "utils/imageutils.h"
 #include "utils/baseutils.h"
 #include "application.h"
@@ -24,7 +26,6 @@
 #include <QLineEdit>
 #include <QPainter>
 #include <QPixmapCache>
-#include <QStandardItemModel>
 #include <QThread>
 #include <QTimer>
 #include <QPainterPath>
@@ -36,6 +37,10 @@
 
 namespace {
 const QString IMAGE_DEFAULTTYPE = "All pics";
+const int HEADER_MARGIN = 10;           //分组标题左、上边距
+const int HEADER_LINE_HEIGHT = 32;      //分组标题每行文字高度
+const int HEADER_CHOSE_MARGIN = 37;     //“选择”距右边的距离
+const int PIXMAP_CACHE_LIMIT_KB = 64 * 1024;    //预先绘制的格子图按可见区域大小需要的缓存
 }
 
 const int NotSupportedOrDamagedWidth = 40;      //损坏图片宽度
@@ -46,9 +51,12 @@ ThumbnailDelegate::ThumbnailDelegate(DelegateType type, QObject *parent)
     , m_imageTypeStr(IMAGE_DEFAULTTYPE)
     , selectedPixmapLight(utils::base::renderSVG(":/resources/images/other/select_active.svg", QSize(28, 28)))
     , selectedPixmapDark(utils::base::renderSVG(":/images/logo/resources/images/other/select_active_dark.svg", QSize(28, 28)))
+    , m_favPixmap(utils::base::renderSVG(":/resources/images/other/fav_icon .svg", QSize(20, 20)))
     , m_delegatetype(type)
 {
-
+    if (QPixmapCache::cacheLimit() < PIXMAP_CACHE_LIMIT_KB) {
+        QPixmapCache::setCacheLimit(PIXMAP_CACHE_LIMIT_KB);
+    }
 }
 
 void ThumbnailDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
@@ -56,6 +64,10 @@ void ThumbnailDelegate::paint(QPainter *painter, const QStyleOptionViewItem &opt
     if (!bneedpaint) {
         return;
     }
+    if (index.data(ThumbnailModel::HeaderRole).toBool()) {
+        paintHeader(painter, option, index);
+        return;
+    }
     painter->save();
     const ItemData data = itemData(index);
     bool selected = data.isSelected;
@@ -63,34 +75,11 @@ void ThumbnailDelegate::paint(QPainter *painter, const QStyleOptionViewItem &opt
         (option.state & QStyle::State_Selected) != 0) {
         selected = true;
     }
-    painter->setRenderHints(QPainter::HighQualityAntialiasing |
-                            QPainter::SmoothPixmapTransform |
-                            QPainter::Antialiasing);
+    const bool dark = DGuiApplicationHelper::instance()->themeType() == DGuiApplicationHelper::DarkType;
+    const qreal dpr = painter->device()->devicePixelRatioF();
     QRect backgroundRect = option.rect;
-    //选中阴影框
-    if (selected) {
-        QPainterPath backgroundBp;
-        backgroundBp.addRoundedRect(backgroundRect, utils::common::SHADOW_BORDER_RADIUS, utils::common::SHADOW_BORDER_RADIUS);
-        painter->setClipPath(backgroundBp);
-
-        QBrush  shadowbrush;
-        QPixmap selectedPixmap;
-        DGuiApplicationHelper::ColorType themeType = DGuiApplicationHelper::instance()->themeType();
-        if (themeType == DGuiApplicationHelper::LightType) {
-            shadowbrush = QBrush(QColor("#DEDEDE"));
-        }
-        if (themeType == DGuiApplicationHelper::DarkType) {
-            shadowbrush = QBrush(QColor("#4F4F4F"));
-        }
-        painter->fillRect(backgroundRect, shadowbrush);
-
-        //绘制选中默认背景
-        QRect backRect(backgroundRect.x() + 8, backgroundRect.y() + 8, backgroundRect.width() - 16, backgroundRect.height() - 16);
-        QPainterPath backBp;
-        backBp.addRoundedRect(backRect, utils::common::BORDER_RADIUS, utils::common::BORDER_RADIUS);
-        painter->setClipPath(backBp);
-        painter->fillRect(backRect, shadowbrush);
-    }
+    //选中阴影框、透明图片背景和深色主题阴影都预先绘制在同一张图中
+    painter->drawPixmap(backgroundRect.topLeft(), cellDecoration(backgroundRect.size(), selected, dark, dpr));
 
     float fwidth = (backgroundRect.height()) / (data.baseHeight == 0 ? 1 : data.baseHeight) * (data.baseWidth) / (backgroundRect.width());
     float fheight = (backgroundRect.width()) / (data.baseWidth  == 0 ? 1 : data.baseWidth) * (data.baseHeight) / (backgroundRect.height());
@@ -119,88 +108,43 @@ void ThumbnailDelegate::paint(QPainter *painter, const QStyleOptionViewItem &opt
             pixmapRect.setHeight(backgroundRect.height() - 16);
         }
     }
-    //2020/6/9 DJH UI 透明图片背景
-    QBrush transparentbrush;
-    DGuiApplicationHelper::ColorType themeType1 = DGuiApplicationHelper::instance()->themeType();
-    if (themeType1 == DGuiApplicationHelper::LightType) {
-        transparentbrush = QBrush(QColor("#FFFFFF"));
-    }
-    QRect transparentRect(backgroundRect.x() + 8, backgroundRect.y() + 8, backgroundRect.width() - 16, backgroundRect.height() - 16);
-    QPainterPath transparentBp;
-    transparentBp.addRoundedRect(transparentRect, utils::common::BORDER_RADIUS, utils::common::BORDER_RADIUS);
-    painter->setClipPath(transparentBp);
-    painter->fillRect(transparentRect, transparentbrush);
-    //阴影框-深色主题
-    QPainterPath backgroundBp;
-    backgroundBp.addRoundedRect(backgroundRect, utils::common::SHADOW_BORDER_RADIUS, utils::common::SHADOW_BORDER_RADIUS);
-    painter->setClipPath(backgroundBp);
-    DGuiApplicationHelper::ColorType themeType2 = DGuiApplicationHelper::instance()->themeType();
-    if (themeType2 == DGuiApplicationHelper::DarkType) {
-        QRect tempRect(backgroundRect.x() + 8, backgroundRect.y() + 8, backgroundRect.width() - 16, backgroundRect.height() - 16);
-        painter->setRenderHint(QPainter::Antialiasing, true);
-        painter->setRenderHint(QPainter::SmoothPixmapTransform, true);
-        painter->setRenderHint(QPainter::HighQualityAntialiasing, true);
-        QColor color(00, 00, 00, 255);
-        QBrush  shadowbrush;
-        int arr[17] = {255, 200, 100, 90, 80, 70, 60, 50, 40, 30, 20, 10, 8, 6, 4, 2, 1};
-        for (int i = 0; i < 17; i++) {
-            QPainterPath path;
-            path.setFillRule(Qt::OddEvenFill);
-            path.addRoundedRect(tempRect.x() + 15 - i, tempRect.y() + 20 - i, tempRect.width() - (15 - i) * 2, tempRect.height() - (15 - i) * 2, 8, 8);
-            color.setAlpha(arr[i]);
-            painter->setPen(color);
-            painter->drawPath(path);
-            painter->fillPath(path, QBrush(color));
-        }
-    }
-
-    QPainterPath bp1;
-    bp1.addRoundedRect(pixmapRect, utils::common::BORDER_RADIUS, utils::common::BORDER_RADIUS);
-    painter->setClipPath(bp1);
 
+    //缩略图从pixmapRect左上角开始绘制的大小，超出部分被圆角裁掉
+    QSize drawSize = pixmapRect.size();
     if (fwidth > 1.5f) {
-        painter->drawPixmap(pixmapRect.x(), pixmapRect.y(), data.image.scaled((pixmapRect.height()) / (data.baseHeight) * data.baseWidth, pixmapRect.height()));
+        drawSize = QSize((pixmapRect.height()) / (data.baseHeight) * data.baseWidth, pixmapRect.height());
     } else if (fheight > 3) {
-        QPixmap temp = data.image.scaled(pixmapRect.width(), (pixmapRect.width()) / (data.baseWidth) * data.baseHeight);
-        if (temp.isNull()) {
-            painter->drawPixmap(pixmapRect.x(), pixmapRect.y(), data.image.scaled(pixmapRect.width(), pixmapRect.height()));
-        } else {
-            painter->drawPixmap(pixmapRect.x(), pixmapRect.y(), temp);
+        drawSize = QSize(pixmapRect.width(), (pixmapRect.width()) / (data.baseWidth) * data.baseHeight);
+        if (drawSize.isEmpty()) {
+            drawSize = pixmapRect.size();
+        }
+    }
+    const QPixmap cellPixmap = cellThumbnail(data.image, drawSize, pixmapRect.size(), dpr);
+    if (!cellPixmap.isNull()) {
+        painter->drawPixmap(pixmapRect.topLeft(), cellPixmap);
+    } else if (!data.bNotSupportedOrDamaged) {
+        //快速滚动时缩略图延后加载，先以主色占位
+        const quint32 color = index.data(ThumbnailModel::PreviewColorRole).toUInt();
+        if (color) {
+            painter->drawPixmap(pixmapRect.topLeft(), placeholderTile(color, pixmapRect.size(), dpr));
         }
-    } else {
-        painter->drawPixmap(pixmapRect, data.image);
     }
 
     if (COMMON_STR_FAVORITES == m_imageTypeStr) {
-        QPixmap favPixmap;
-        favPixmap = utils::base::renderSVG(":/resources/images/other/fav_icon .svg", QSize(20, 20));
         QRect favRect(pixmapRect.x() + pixmapRect.width() - 20 - 13, pixmapRect.y() + pixmapRect.height() - 20 - 10, 20, 20);
-        painter->drawPixmap(favRect, favPixmap);
+        painter->drawPixmap(favRect, m_favPixmap);
     }
 
     //绘制选中图标
     if (selected) {
-        QPixmap selectedPixmap;
-        DGuiApplicationHelper::ColorType themeType3 = DGuiApplicationHelper::instance()->themeType();
-        if (themeType3 == DGuiApplicationHelper::LightType) {
-            selectedPixmap = selectedPixmapLight;
-        }
-        if (themeType3 == DGuiApplicationHelper::DarkType) {
-            selectedPixmap = selectedPixmapDark;
-        }
 //        QRect selectedRect(backgroundRect.x() + backgroundRect.width() - 28, backgroundRect.y(), 28, 28);
         QRect selectedRect(backgroundRect.x() + backgroundRect.width() - 30, backgroundRect.y() + 4, 28, 28);
-        QPainterPath selectedBp;
-        selectedBp.addRoundedRect(selectedRect, utils::common::BORDER_RADIUS, utils::common::BORDER_RADIUS);
-        painter->setClipPath(selectedBp);
-        painter->drawPixmap(selectedRect, selectedPixmap);
+        painter->drawPixmap(selectedRect.topLeft(), selectedMark(dark, dpr));
     }
 
     //绘制剩余天数
     if (COMMON_STR_TRASH == m_imageTypeStr) {
-        QPainterPath bp;
-        bp.addRoundedRect(backgroundRect, utils::common::BORDER_RADIUS, utils::common::BORDER_RADIUS);
-        painter->setClipPath(bp);
+        painter->setRenderHint(QPainter::Antialiasing, true);
         painter->setPen(QColor(85, 85, 85, 170)); //边框颜色：灰色
         //字符串的像素宽度
         const int m_Width = painter->fontMetrics().width(data.remainDays);
@@ -236,6 +180,210 @@ void ThumbnailDelegate::paint(QPainter *painter, const QStyleOptionViewItem &opt
     painter->restore();
 }
 
+QPixmap ThumbnailDelegate::cellDecoration(const QSize &size, bool selected, bool dark, qreal dpr)
+{
+    const QString key = QStringLiteral("albumdeco_%1x%2_%3_%4_%5").arg(size.width()).arg(size.height())
+                        .arg(selected).arg(dark).arg(qRound(dpr * 100));
+    QPixmap pixmap;
+    if (QPixmapCache::find(key, &pixmap)) {
+        return pixmap;
+    }
+    QImage image(size * dpr, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(dpr);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    painter.setRenderHints(QPainter::HighQualityAntialiasing | QPainter::Antialiasing);
+    const QRect backgroundRect(QPoint(0, 0), size);
+    const QRect innerRect = backgroundRect.adjusted(8, 8, -8, -8);
+    //选中阴影框
+    if (selected) {
+        QPainterPath backgroundBp;
+        backgroundBp.addRoundedRect(backgroundRect, utils::common::SHADOW_BORDER_RADIUS, utils::common::SHADOW_BORDER_RADIUS);
+        painter.setClipPath(backgroundBp);
+        const QBrush shadowbrush(dark ? QColor("#4F4F4F") : QColor("#DEDEDE"));
+        painter.fillRect(backgroundRect, shadowbrush);
+
+        //绘制选中默认背景
+        QPainterPath backBp;
+        backBp.addRoundedRect(innerRect, utils::common::BORDER_RADIUS, utils::common::BORDER_RADIUS);
+        painter.setClipPath(backBp);
+        painter.fillRect(innerRect, shadowbrush);
+    }
+    //2020/6/9 DJH UI 透明图片背景
+    if (!dark) {
+        QPainterPath transparentBp;
+        transparentBp.addRoundedRect(innerRect, utils::common::BORDER_RADIUS, utils::common::BORDER_RADIUS);
+        painter.setClipPath(transparentBp);
+        painter.fillRect(innerRect, QColor("#FFFFFF"));
+    }
+    //阴影框-深色主题
+    if (dark) {
+        QPainterPath backgroundBp;
+        backgroundBp.addRoundedRect(backgroundRect, utils::common::SHADOW_BORDER_RADIUS, utils::common::SHADOW_BORDER_RADIUS);
+        painter.setClipPath(backgroundBp);
+        QColor color(00, 00, 00, 255);
+        int arr[17] = {255, 200, 100, 90, 80, 70, 60, 50, 40, 30, 20, 10, 8, 6, 4, 2, 1};
+        for (int i = 0; i < 17; i++) {
+            QPainterPath path;
+            path.setFillRule(Qt::OddEvenFill);
+            path.addRoundedRect(innerRect.x() + 15 - i, innerRect.y() + 20 - i, innerRect.width() - (15 - i) * 2, innerRect.height() - (15 - i) * 2, 8, 8);
+            color.setAlpha(arr[i]);
+            painter.setPen(color);
+            painter.drawPath(path);
+            painter.fillPath(path, QBrush(color));
+        }
+    }
+    painter.end();
+    pixmap = QPixmap::fromImage(image);
+    QPixmapCache::insert(key, pixmap);
+    return pixmap;
+}
+
+QPixmap ThumbnailDelegate::cellThumbnail(const QPixmap &source, const QSize &drawSize, const QSize &clipSize, qreal dpr)
+{
+    if (source.isNull() || drawSize.isEmpty() || clipSize.isEmpty()) {
+        return QPixmap();
+    }
+    //以缩略图的cacheKey为键，缩略图替换或格子大小变化后自动换用新的
+    const QString key = QStringLiteral("albumcell_%1_%2x%3_%4x%5_%6").arg(source.cacheKey())
+                        .arg(drawSize.width()).arg(drawSize.height())
+                        .arg(clipSize.width()).arg(clipSize.height()).arg(qRound(dpr * 100));
+    QPixmap pixmap;
+    if (QPixmapCache::find(key, &pixmap)) {
+        return pixmap;
+    }
+    QImage image(clipSize * dpr, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(dpr);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    painter.setRenderHints(QPainter::HighQualityAntialiasing | QPainter::SmoothPixmapTransform | QPainter::Antialiasing);
+    QPainterPath bp1;
+    bp1.addRoundedRect(QRect(QPoint(0, 0), clipSize), utils::common::BORDER_RADIUS, utils::common::BORDER_RADIUS);
+    painter.setClipPath(bp1);
+    painter.drawPixmap(QRect(QPoint(0, 0), drawSize), source);
+    painter.end();
+    pixmap = QPixmap::fromImage(image);
+    QPixmapCache::insert(key, pixmap);
+    return pixmap;
+}
+
+QPixmap ThumbnailDelegate::placeholderTile(quint32 color, const QSize &size, qreal dpr)
+{
+    if (size.isEmpty()) {
+        return QPixmap();
+    }
+    const QString key = QStringLiteral("albumplaceholder_%1_%2x%3_%4").arg(color)
+                        .arg(size.width()).arg(size.height()).arg(qRound(dpr * 100));
+    QPixmap pixmap;
+    if (QPixmapCache::find(key, &pixmap)) {
+        return pixmap;
+    }
+    QImage image(size * dpr, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(dpr);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor::fromRgb(color));
+    painter.drawRoundedRect(QRect(QPoint(0, 0), size), utils::common::BORDER_RADIUS, utils::common::BORDER_RADIUS);
+    painter.end();
+    pixmap = QPixmap::fromImage(image);
+    QPixmapCache::insert(key, pixmap);
+    return pixmap;
+}
+
+QPixmap ThumbnailDelegate::selectedMark(bool dark, qreal dpr) const
+{
+    const QString key = QStringLiteral("albumselected_%1_%2").arg(dark).arg(qRound(dpr * 100));
+    QPixmap pixmap;
+    if (QPixmapCache::find(key, &pixmap)) {
+        return pixmap;
+    }
+    const QSize size(28, 28);
+    QImage image(size * dpr, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(dpr);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    painter.setRenderHints(QPainter::HighQualityAntialiasing | QPainter::SmoothPixmapTransform | QPainter::Antialiasing);
+    QPainterPath selectedBp;
+    selectedBp.addRoundedRect(QRect(QPoint(0, 0), size), utils::common::BORDER_RADIUS, utils::common::BORDER_RADIUS);
+    painter.setClipPath(selectedBp);
+    painter.drawPixmap(QRect(QPoint(0, 0), size), dark ? selectedPixmapDark : selectedPixmapLight);
+    painter.end();
+    pixmap = QPixmap::fromImage(image);
+    QPixmapCache::insert(key, pixmap);
+    return pixmap;
+}
+
+void ThumbnailDelegate::paintHeader(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    painter->save();
+    painter->setRenderHint(QPainter::TextAntialiasing, true);
+    const QRect rect = option.rect;
+    const QString title = index.data(ThumbnailModel::NameRole).toString();
+    const QString num = QObject::tr("%1 photo(s)").arg(index.data(ThumbnailModel::SectionCountRole).toInt());
+
+    DPalette pal = DApplicationHelper::instance()->palette(option.widget);
+    QColor numColor = pal.color(DPalette::BrightText);
+    if (DGuiApplicationHelper::instance()->themeType() == DGuiApplicationHelper::LightType) {
+        numColor.setAlphaF(0.5);
+    } else {
+        numColor.setAlphaF(0.75);
+    }
+    QFont ft6 = DFontSizeManager::instance()->get(DFontSizeManager::T6);
+    ft6.setFamily("SourceHanSansSC");
+    ft6.setWeight(QFont::Medium);
+
+    if (TimeLineViewType == m_delegatetype) {
+        //时间线：日期和数量各占一行
+        QFont ft3 = DFontSizeManager::instance()->get(DFontSizeManager::T3);
+        ft3.setFamily("SourceHanSansSC");
+        ft3.setWeight(QFont::DemiBold);
+        painter->setFont(ft3);
+        painter->setPen(pal.color(DPalette::ToolTipText));
+        painter->drawText(QRect(rect.x() + HEADER_MARGIN, rect.y() + HEADER_MARGIN, rect.width() - HEADER_MARGIN, HEADER_LINE_HEIGHT),
+                          Qt::AlignLeft | Qt::AlignVCenter, title);
+        painter->setFont(ft6);
+        painter->setPen(numColor);
+        painter->drawText(QRect(rect.x() + HEADER_MARGIN, rect.y() + HEADER_MARGIN + HEADER_LINE_HEIGHT, rect.width() - HEADER_MARGIN, HEADER_LINE_HEIGHT),
+                          Qt::AlignLeft | Qt::AlignVCenter, num);
+    } else {
+        //已导入：日期和数量在同一行
+        painter->setFont(ft6);
+        painter->setPen(numColor);
+        const QRect textRect(rect.x() + HEADER_MARGIN, rect.y(), rect.width() - HEADER_MARGIN, rect.height());
+        painter->drawText(textRect, Qt::AlignLeft | Qt::AlignVCenter, title);
+        const int titleWidth = QFontMetrics(ft6).width(title) + HEADER_MARGIN * 2;
+        painter->drawText(textRect.adjusted(titleWidth, 0, 0, 0), Qt::AlignLeft | Qt::AlignVCenter, num);
+    }
+
+    painter->setFont(DFontSizeManager::instance()->get(DFontSizeManager::T5));
+    painter->setPen(pal.color(DPalette::Highlight));
+    painter->drawText(headerChoseRect(option, index), Qt::AlignCenter, headerChoseText(option, index));
+    painter->restore();
+}
+
+QString ThumbnailDelegate::headerChoseText(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    const ThumbnailListView *view = qobject_cast<const ThumbnailListView *>(option.widget);
+    if (view && view->isSectionSelected(index.row())) {
+        return QObject::tr("Unselect");
+    }
+    return QObject::tr("Select");
+}
+
+QRect ThumbnailDelegate::headerChoseRect(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    const QRect rect = option.rect;
+    const QFontMetrics fm(DFontSizeManager::instance()->get(DFontSizeManager::T5));
+    const int width = fm.width(headerChoseText(option, index)) + 4;
+    int y = rect.y() + (rect.height() - HEADER_LINE_HEIGHT) / 2;
+    if (TimeLineViewType == m_delegatetype) {
+        y = rect.y() + HEADER_MARGIN + HEADER_LINE_HEIGHT;
+    }
+    return QRect(rect.right() - HEADER_CHOSE_MARGIN - width, y, width, HEADER_LINE_HEIGHT);
+}
+
 QSize ThumbnailDelegate::sizeHint(const QStyleOptionViewItem &option,
                                   const QModelIndex &index) const
 {
@@ -250,45 +398,23 @@ QSize ThumbnailDelegate::sizeHint(const QStyleOptionViewItem &option,
 
 ThumbnailDelegate::ItemData ThumbnailDelegate::itemData(const QModelIndex &index) const
 {
-    QVariantList datas = index.model()->data(index, Qt::DisplayRole).toList();
+    //按角色逐项读取，缩略图由模型在绘制时按路径取出
     ItemData data;
-    if (datas.length() >= 1) {
-        data.name = datas[0].toString();
-    }
-    if (datas.length() >= 2) {
-        data.path =  datas[1].toString();
-    }
-    if (datas.length() >= 3) {
-        data.width = datas[2].toInt();
-    }
-    if (datas.length() >= 4) {
-        data.height = datas[3].toInt();
-    }
-    if (datas.length() >= 5) {
-        data.remainDays = datas[4].toString();
-    }
-    if (datas.length() >= 6) {
-        data.image = datas[5].value<QPixmap>();
-    }
-    if (datas.length() >= 7) {
-        data.imgWidth = datas[6].toInt();
-    }
-    if (datas.length() >= 8) {
-        data.imgHeight = datas[7].toInt();
-    }
-    if (datas.length() >= 9) {
-        data.baseWidth = datas[8].toInt();
-    }
-    if (datas.length() >= 10) {
-        data.baseHeight = datas[9].toInt();
-    }
-    if (datas.length() >= 11) {
-        data.firstorlast = datas[10].toString();
-    }
+    data.name = index.data(ThumbnailModel::NameRole).toString();
+    data.path = index.data(ThumbnailModel::PathRole).toString();
+    const QSize size = index.data(Qt::SizeHintRole).toSize();
+    data.width = size.width();
+    data.height = size.height();
+    data.remainDays = index.data(ThumbnailModel::RemainDaysRole).toString();
+    data.image = index.data(ThumbnailModel::PixmapRole).value<QPixmap>();
+    const QSize imgSize = index.data(ThumbnailModel::ImageSizeRole).toSize();
+    data.imgWidth = imgSize.width();
+    data.imgHeight = imgSize.height();
+    const QSize baseSize = index.data(ThumbnailModel::BaseSizeRole).toSize();
+    data.baseWidth = baseSize.width();
+    data.baseHeight = baseSize.height();
     data.isSelected = index.data(Qt::UserRole).toBool();
-    if (datas.length() >= 12) {
-        data.bNotSupportedOrDamaged = datas[11].toBool();
-    }
+    data.bNotSupportedOrDamaged = index.data(ThumbnailModel::DamagedRole).toBool();
     return data;
 }
 
@@ -297,6 +423,17 @@ bool ThumbnailDelegate::editorEvent(QEvent *event, QAbstractItemModel *model, co
     Q_UNUSED(model);
     if (!index.isValid())
         return false;
+    if (index.data(ThumbnailModel::HeaderRole).toBool()) {
+        //点中“选择”时返回true，视图不再按普通点击改变选中
+        if (event->type() == QEvent::MouseButtonPress) {
+            QMouseEvent *pMouseEvent = static_cast<QMouseEvent *>(event);
+            if (pMouseEvent->button() == Qt::LeftButton && headerChoseRect(option, index).contains(pMouseEvent->pos())) {
+                emit sigSectionChoseClicked(index);
+                return true;
+            }
+        }
+        return false;
+    }
     QRect rect = QRect(option.rect.x() + option.rect.width() - 20 - 13 - 2, option.rect.y() + option.rect.height() - 20 - 10 - 2, 20, 20);
     QMouseEvent *pMouseEvent = static_cast<QMouseEvent *>(event);
     if (COMMON_STR_FAVORITES == m_imageTypeStr) {
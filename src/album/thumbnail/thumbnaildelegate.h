@@ -69,10 +69,22 @@ public:
 
 signals:
     void sigCancelFavorite(const QModelIndex &index);
+    //点击分组标题上的“选择/取消选择”
+    void sigSectionChoseClicked(const QModelIndex &index);
 //    void sigPageNeedResize(const int &index) const;
 
 private:
     ItemData itemData(const QModelIndex &index) const;
+    //分组标题行直接在列表中绘制，不再为每个分组创建控件
+    void paintHeader(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const;
+    QString headerChoseText(const QStyleOptionViewItem &option, const QModelIndex &index) const;
+    QRect headerChoseRect(const QStyleOptionViewItem &option, const QModelIndex &index) const;
+    //以下绘制结果按大小、主题和缩放比缓存在QPixmapCache中，滚动时只需贴图
+    static QPixmap cellDecoration(const QSize &size, bool selected, bool dark, qreal dpr);
+    static QPixmap cellThumbnail(const QPixmap &source, const QSize &drawSize, const QSize &clipSize, qreal dpr);
+    //缩略图尚未加载时用图库中记录的主色填充的圆角块
+    static QPixmap placeholderTile(quint32 color, const QSize &size, qreal dpr);
+    QPixmap selectedMark(bool dark, qreal dpr) const;
 
 public:
     QString m_imageTypeStr;
@@ -80,6 +92,7 @@ public:
 private:
     QPixmap selectedPixmapLight;
     QPixmap selectedPixmapDark;
+    QPixmap m_favPixmap;
     QColor m_borderColor;
     QString  m_defaultThumbnail;
     bool m_itemdata = false;
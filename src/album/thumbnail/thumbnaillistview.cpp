@@ -8,6 +8,7 @@
 #include <QScrollBar>
 #include <QMutex>
 #include <QScroller>
+#include <algorithm>
 
 #include "controller/signalmanager.h"
 #include "controller/wallpapersetter.h"
@@ -17,10 +18,17 @@
 #include "utils/unionimage.h"
 #include "imageengine/imageengineapi.h"
 #include "imageengine/imageenginethread.h"
+#include "dbmanager/photocatalog.h"
+#include "dbmanager/dbasyncmanager.h"
 
 namespace {
 const int ITEM_SPACING = 4;
 const int BASE_HEIGHT = 100;
+const qreal FLING_SPEED = 2.0;          //滚动速度(像素/毫秒)超过此值视为快速滑动
+const int SCROLL_SETTLE_INTERVAL = 120; //滚动停止这么久后才请求视口内的缩略图
+const int MIN_REQUEST_BATCH = 8;        //每批请求的缩略图数量范围
+const int MAX_REQUEST_BATCH = 128;
+const int REQUEST_BATCH_TARGET = 150;   //按实测吞吐调整批量，使一批大约在这么多毫秒内完成
 
 // const QString IMAGE_DEFAULTTYPE = "All pics";
 const QString IMAGE_DEFAULTTYPE = "All Photos";
@@ -49,19 +57,20 @@ ThumbnailListView::ThumbnailListView(ThumbnailDelegate::DelegateType type, QStri
 //        m_scrollbartopdistance = 134;
 //        m_scrollbarbottomdistance = 27;
 //    }
-    m_model = new QStandardItemModel(this);
+    m_model = new ThumbnailModel(this);
     m_imageType = imgtype;
     m_iDefaultWidth = 0;
     m_iBaseHeight = BASE_HEIGHT;
+    m_requestBatch = Number_Of_Displays_Per_Time;
     m_albumMenu = nullptr;
     setResizeMode(QListView::Adjust);
     setViewMode(QListView::IconMode);
     setSpacing(ITEM_SPACING);
     setDragEnabled(false);
+    //时间线类视图由本列表直接滚动，只关闭横向滚动条
     if (COMMON_STR_VIEW_TIMELINE == m_imageType ||
             COMMON_STR_RECENT_IMPORTED == m_imageType) {
         setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-        setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     }
     //按照像素滚动，步进20
     setVerticalScrollMode(QListView::ScrollPerPixel);
@@ -83,6 +92,10 @@ ThumbnailListView::ThumbnailListView(ThumbnailDelegate::DelegateType type, QStri
     m_dt->setSingleShot(true);
     m_dt->setInterval(20);
     connect(m_dt, SIGNAL(timeout()), this, SLOT(onTimerOut()));
+    m_settleTimer = new QTimer(this);
+    m_settleTimer->setSingleShot(true);
+    m_settleTimer->setInterval(SCROLL_SETTLE_INTERVAL);
+    connect(m_settleTimer, &QTimer::timeout, this, &ThumbnailListView::onScrollSettled);
     connect(DGuiApplicationHelper::instance(), &DGuiApplicationHelper::themeTypeChanged, this, &ThumbnailListView::sltChangeDamagedPixOnThemeChanged);
     touchTapDistance = 15;
 }
@@ -119,10 +132,20 @@ void ThumbnailListView::mousePressEvent(QMouseEvent *event)
         updateEnableSelectionByMouseTimer->start();
     }
 
-    if ((QApplication::keyboardModifiers() == Qt::ShiftModifier && event->button() == Qt::LeftButton)
-            && (m_imageType == COMMON_STR_VIEW_TIMELINE || m_imageType == COMMON_STR_RECENT_IMPORTED));
-    else
+    if (m_sectioned && QApplication::keyboardModifiers() == Qt::ShiftModifier && event->button() == Qt::LeftButton) {
+        //按行号连选，跨越分组时也只是一段连续区间
+        const int row = indexAt(event->pos()).row();
+        clearSelection();
+        if (row >= 0 && m_anchorRow >= 0) {
+            selectExtent(qMin(m_anchorRow, row), qMax(m_anchorRow, row));
+        }
+    } else {
         DListView::mousePressEvent(event);
+        const QModelIndex pressIndex = indexAt(event->pos());
+        if (event->button() == Qt::LeftButton && pressIndex.isValid() && !m_model->isHeader(pressIndex.row())) {
+            m_anchorRow = pressIndex.row();
+        }
+    }
     if ((m_imageType != COMMON_STR_VIEW_TIMELINE) && (m_imageType != "All Photos") &&
             (m_imageType != COMMON_STR_TRASH) && (m_imageType != ALBUM_PATHTYPE_BY_PHONE)) {
         if (dragDropMode() != NoDragDrop) {
@@ -231,10 +254,10 @@ void ThumbnailListView::keyPressEvent(QKeyEvent *event)
             return;
         }
         if (!DBManager::instance()->isImgExistInAlbum(COMMON_STR_FAVORITES, m_dragItemPath.first(), AlbumDBType::Favourite)) {
-            DBManager::instance()->insertIntoAlbum(COMMON_STR_FAVORITES, QStringList(m_dragItemPath.first()), AlbumDBType::Favourite);
+            DBManager::instance()->insertIntoAlbumAsync(COMMON_STR_FAVORITES, QStringList(m_dragItemPath.first()), AlbumDBType::Favourite);
             emit dApp->signalM->insertedIntoAlbum(COMMON_STR_FAVORITES, QStringList(m_dragItemPath.first()));
         } else {
-            DBManager::instance()->removeFromAlbum(COMMON_STR_FAVORITES, QStringList(m_dragItemPath.first()), AlbumDBType::Favourite);
+            DBManager::instance()->removeFromAlbumAsync(COMMON_STR_FAVORITES, QStringList(m_dragItemPath.first()), AlbumDBType::Favourite);
         }
     }
 }
@@ -299,341 +322,37 @@ void ThumbnailListView::initConnections()
     connect(this, &ThumbnailListView::clicked, this, &ThumbnailListView::onClicked);
     connect(dApp->signalM, &SignalManager::sigMainwindowSliderValueChg, this, &ThumbnailListView::onPixMapScale);
     connect(m_delegate, &ThumbnailDelegate::sigCancelFavorite, this, &ThumbnailListView::onCancelFavorite);
+    connect(m_delegate, &ThumbnailDelegate::sigSectionChoseClicked, this, &ThumbnailListView::onSectionChoseClicked);
 }
 
-void ThumbnailListView::calBasePixMap(ItemInfo &info)
-{
-    int i_totalwidth = window()->width() - 30;
-    bool bcalBase = false;
-    if (info.width != 0) {
-        bcalBase = (info.height / info.width) > 3;
-    }
-    if (0 == info.height || 0 == info.width || bcalBase) {
-        info.width = m_iBaseHeight;
-        info.height = m_iBaseHeight;
-    } else {
-        info.width = info.width * m_iBaseHeight / info.height;
-        if (info.width > i_totalwidth) {
-            info.height = m_iBaseHeight / 4;
-            info.width = i_totalwidth / 4;
-        } else {
-            info.height = m_iBaseHeight;
-        }
-    }
-    info.imgHeight = info.height;
-    info.imgWidth = info.width;
-    info.imgHeight = (1 > info.imgHeight) ? 1 : info.imgHeight;
-    info.imgWidth = (1 > info.imgWidth) ? 1 : info.imgWidth;
-    info.height =
-        (m_iBaseHeight > info.height) ? m_iBaseHeight : info.height;
-    info.width = (28 > info.width) ? 28 : info.width;
-}
-
-void ThumbnailListView::calBasePixMapWandH()
+void ThumbnailListView::addThumbnailViewNew(const QList<ItemInfo> &items)
 {
-    int i_totalwidth = window()->width() - 30;
-
-    for (int i = 0; i < m_ItemList.length(); i++) {
-        if (0 == m_ItemList[i].height || 0 == m_ItemList[i].width) {
-            m_ItemList[i].width = m_iBaseHeight;
-            m_ItemList[i].height = m_iBaseHeight;
-        } else {
-            m_ItemList[i].width = m_ItemList[i].width * m_iBaseHeight / m_ItemList[i].height;
-            if (m_ItemList[i].width > i_totalwidth) {
-                m_ItemList[i].height = m_iBaseHeight / 4;
-                m_ItemList[i].width = i_totalwidth / 4;
-            } else {
-                m_ItemList[i].height = m_iBaseHeight;
-            }
-        }
-
-        m_ItemList[i].imgHeight = m_ItemList[i].height;
-        m_ItemList[i].imgWidth = m_ItemList[i].width;
-        // Prevents height or width less than 2 after scaling
-        m_ItemList[i].imgHeight = (1 > m_ItemList[i].imgHeight) ? 1 : m_ItemList[i].imgHeight;
-        m_ItemList[i].imgWidth = (1 > m_ItemList[i].imgWidth) ? 1 : m_ItemList[i].imgWidth;
-        m_ItemList[i].height =
-            (m_iBaseHeight > m_ItemList[i].height) ? m_iBaseHeight : m_ItemList[i].height;
-        m_ItemList[i].width = (28 > m_ItemList[i].width) ? 28 : m_ItemList[i].width;
-    }
-}
-
-void ThumbnailListView::calWidgetItem()
-{
-    int m_gbaseWidth = 0;
-    int i_totalwidth = width() - 30;  // same as i_totalwidth in calBasePixMapWandH()
-    QList<int> rowWidthList;
-    QList<ItemInfo> itemInfoList;
-    rowWidthList.clear();
-    itemInfoList.clear();
-    QList<QList<ItemInfo>> gridItem;
-    gridItem.clear();
-    int totlelength = m_ItemListLeft.size();
-    int corrent = 0;
-    // set rows for list
-    for (int i = 0; i < totlelength; i++) {
-        if ((m_gbaseWidth + m_ItemListLeft[corrent].width) <= i_totalwidth) {
-            m_gbaseWidth = m_gbaseWidth + m_ItemListLeft[corrent].width + ITEM_SPACING;
-            itemInfoList << m_ItemListLeft[corrent];
-            if (m_allNeedRequestFilesCount < 1 && corrent == m_ItemListLeft.size() - 1) {
-                m_gbaseWidth -= ITEM_SPACING;
-                rowWidthList << m_gbaseWidth;
-                gridItem << itemInfoList;
-                for (int j = 0; j <= corrent; j++) {
-                    m_ItemList << m_ItemListLeft.first();
-                    m_ItemListLeft.removeFirst();
-                }
-            }
-        } else if (i_totalwidth - m_gbaseWidth > 200) {
-            m_ItemListLeft[corrent].imgHeight =
-                m_ItemListLeft[corrent].imgHeight * (i_totalwidth - m_gbaseWidth) / m_ItemListLeft[corrent].imgWidth;
-            m_ItemListLeft[corrent].imgHeight = (1 > m_ItemListLeft[corrent].imgHeight) ? 1 : m_ItemListLeft[corrent].imgHeight;
-            m_ItemListLeft[corrent].imgWidth = i_totalwidth - m_gbaseWidth;
-            m_ItemListLeft[corrent].width = i_totalwidth - m_gbaseWidth;
-            m_gbaseWidth = i_totalwidth;
-            rowWidthList << m_gbaseWidth;
-            itemInfoList << m_ItemListLeft[corrent];
-            gridItem << itemInfoList;
-            for (int j = 0; j <= corrent; j++) {
-                m_ItemList << m_ItemListLeft.first();
-                m_ItemListLeft.removeFirst();
-            }
-            corrent = -1;
-            m_gbaseWidth = 0;
-            itemInfoList.clear();
-        } else {
-            m_gbaseWidth -= ITEM_SPACING;
-            rowWidthList << m_gbaseWidth;
-            m_gbaseWidth = m_ItemListLeft[corrent].width + ITEM_SPACING;
-            gridItem << itemInfoList;
-            for (int j = 0; j < corrent; j++) {
-                m_ItemList << m_ItemListLeft.first();
-                m_ItemListLeft.removeFirst();
-            }
-            itemInfoList.clear();
-            corrent = 0;
-            itemInfoList << m_ItemListLeft[corrent];
-            if (m_allNeedRequestFilesCount < 1 && corrent == m_ItemListLeft.size() - 1) {
-                m_gbaseWidth -= ITEM_SPACING;
-                rowWidthList << m_gbaseWidth;
-                gridItem << itemInfoList;
-                for (int j = 0; j <= corrent; j++) {
-                    m_ItemList << m_ItemListLeft.first();
-                    m_ItemListLeft.removeFirst();
-                }
-            }
-        }
-        corrent++;
-    }
-
-    // scaling for each row adapting list width except last one
-    totlelength = rowWidthList.size();
-    if (m_allNeedRequestFilesCount < 1)
-        totlelength -= 1;
-    for (int i = 0; i < totlelength; i++) {
-        if (rowWidthList[i] < i_totalwidth) {
-            int i_totalwidthExSpace = i_totalwidth - ITEM_SPACING * gridItem[i].length();
-            int rowWidthListExSpace = rowWidthList[i] - ITEM_SPACING * gridItem[i].length();
-            int rowWidth = 0;
-            for (int j = 0; j < gridItem[i].length(); j++) {
-                gridItem[i][j].width = gridItem[i][j].width * i_totalwidthExSpace / rowWidthListExSpace;
-                gridItem[i][j].height = gridItem[i][j].height * i_totalwidthExSpace / rowWidthListExSpace;
-                gridItem[i][j].imgWidth = gridItem[i][j].imgWidth * i_totalwidthExSpace / rowWidthListExSpace;
-                gridItem[i][j].imgHeight = gridItem[i][j].imgHeight * i_totalwidthExSpace / rowWidthListExSpace;
-                rowWidth = rowWidth + gridItem[i][j].width + ITEM_SPACING;
-            }
-            rowWidthList[i] = rowWidth - ITEM_SPACING;
-            if (rowWidthList[i] < i_totalwidth) {
-                gridItem[i][0].width = gridItem[i][0].width + i_totalwidth - rowWidthList[i];
-            }
-        }
-    }
-    addThumbnailViewNew(gridItem);
-    if (gridItem.size() > 0) {
-        bfirstload = false;
-    }
-}
-
-void ThumbnailListView::calWidgetItemWandH()
-{
-    int i_baseWidth = 0;
-    int i_totalwidth = width() - 30;  // same as i_totalwidth in calBasePixMapWandH()
-    QList<int> rowWidthList;          //一行的宽度
-    QList<ItemInfo> itemInfoList;     //一行的item项
-    QList<ItemInfo> m_ItemListAll;    //所有图片项
-    m_ItemListAll << m_ItemList << m_ItemListLeft;
-    rowWidthList.clear();
-    itemInfoList.clear();
-    m_gridItem.clear();
-    m_ItemList.clear();
-    m_ItemListLeft.clear();
-    int totlelength = m_ItemListAll.size();
-    int corrent = 0;
-    // set rows for list
-    for (int i = 0; i < totlelength; i++) {
-        if ((i_baseWidth + m_ItemListAll[corrent].width) <= i_totalwidth) {
-            i_baseWidth = i_baseWidth + m_ItemListAll[corrent].width + ITEM_SPACING;
-            itemInfoList << m_ItemListAll[corrent];
-            if (m_allNeedRequestFilesCount < 1 && corrent == m_ItemListAll.size() - 1) {
-                i_baseWidth -= ITEM_SPACING;
-                rowWidthList << i_baseWidth;
-                m_gridItem << itemInfoList;
-                for (int j = 0; j <= corrent; j++) {
-                    m_ItemList << m_ItemListAll.first();
-                    m_ItemListAll.removeFirst();
-                }
-            }
-        } else if (i_totalwidth - i_baseWidth > 200) {  //一行最后剩余宽度大于200   对当前图片进行缩放
-            m_ItemListAll[corrent].imgHeight = m_ItemListAll[corrent].imgHeight * (i_totalwidth - i_baseWidth) / m_ItemListAll[corrent].imgWidth;
-            m_ItemListAll[corrent].imgHeight = (1 > m_ItemListAll[corrent].imgHeight) ? 1 : m_ItemListAll[corrent].imgHeight;
-            m_ItemListAll[corrent].imgWidth = i_totalwidth - i_baseWidth;
-            m_ItemListAll[corrent].width = i_totalwidth - i_baseWidth;
-            i_baseWidth = i_totalwidth;
-            rowWidthList << i_baseWidth;
-            itemInfoList << m_ItemListAll[corrent];
-            m_gridItem << itemInfoList;
-            for (int j = 0; j <= corrent; j++) {
-                m_ItemList << m_ItemListAll.first();
-                m_ItemListAll.removeFirst();
-            }
-            corrent = -1;
-            i_baseWidth = 0;
-            itemInfoList.clear();
-        } else {
-            i_baseWidth -= ITEM_SPACING;
-            rowWidthList << i_baseWidth;
-            i_baseWidth = m_ItemListAll[corrent].width + ITEM_SPACING;
-            m_gridItem << itemInfoList;
-            for (int j = 0; j < corrent; j++) {
-                m_ItemList << m_ItemListAll.first();
-                m_ItemListAll.removeFirst();
-            }
-            itemInfoList.clear();
-            corrent = 0;
-            itemInfoList << m_ItemListAll[corrent];
-            if (m_allNeedRequestFilesCount < 1 && corrent == m_ItemListAll.size() - 1) {
-                i_baseWidth -= ITEM_SPACING;
-                rowWidthList << i_baseWidth;
-                m_gridItem << itemInfoList;
-                for (int j = 0; j <= corrent; j++) {
-                    m_ItemList << m_ItemListAll.first();
-                    m_ItemListAll.removeFirst();
-                }
-            }
-        }
-        corrent++;
-    }
-    m_ItemListLeft << m_ItemListAll;
-    totlelength = rowWidthList.size();
-    if (m_allNeedRequestFilesCount < 1)
-        totlelength -= 1;
-    // scaling for each row adapting list width except last one
-    for (int i = 0; i < totlelength; i++) {
-        if (i < (rowWidthList.size() - 1) && rowWidthList[i] < i_totalwidth && i < m_gridItem.size()) {
-            int i_totalwidthExSpace = i_totalwidth - ITEM_SPACING * m_gridItem[i].size();
-            int rowWidthListExSpace = rowWidthList[i] - ITEM_SPACING * m_gridItem[i].size();
-            int rowWidth = 0;
-            for (int j = 0; j < m_gridItem[i].size(); j++) {
-                m_gridItem[i][j].width = m_gridItem[i][j].width * i_totalwidthExSpace / rowWidthListExSpace;
-                m_gridItem[i][j].height = m_gridItem[i][j].height * i_totalwidthExSpace / rowWidthListExSpace;
-                m_gridItem[i][j].imgWidth = m_gridItem[i][j].imgWidth * i_totalwidthExSpace / rowWidthListExSpace;
-                m_gridItem[i][j].imgHeight = m_gridItem[i][j].imgHeight * i_totalwidthExSpace / rowWidthListExSpace;
-                rowWidth = rowWidth + m_gridItem[i][j].width + ITEM_SPACING;
-            }
-            rowWidthList[i] = rowWidth - ITEM_SPACING;
-            if (rowWidthList[i] < i_totalwidth) {
-                m_gridItem[i][0].width = m_gridItem[i][0].width + i_totalwidth - rowWidthList[i];
-            }
-        }
-    }
-    if (0 < m_gridItem.size()) {
-        m_height = 0;
-        for (int i = 0; i < rowWidthList.size(); i++) {
-            m_height = m_height + m_gridItem[i][0].height + ITEM_SPACING;
-        }
-        m_height -= ITEM_SPACING;
-    }
-}
-
-void ThumbnailListView::addThumbnailViewNew(QList<QList<ItemInfo>> gridItem)
-{
-    for (int i = 0; i < gridItem.length(); i++) {
-        for (int j = 0; j < gridItem[i].length(); j++) {
-            QStandardItem *item = new QStandardItem;
-            QString qsfirstorlast = "NotFirstOrLast";
-
-            QVariantList datas;
-            datas.append(QVariant(gridItem[i][j].name));
-            datas.append(QVariant(gridItem[i][j].path));
-            datas.append(QVariant(gridItem[i][j].width));
-            datas.append(QVariant(gridItem[i][j].height));
-            datas.append(QVariant(gridItem[i][j].remainDays));
-            datas.append(QVariant(gridItem[i][j].image));
-            datas.append(QVariant(gridItem[i][j].imgWidth));
-            datas.append(QVariant(gridItem[i][j].imgHeight));
-            datas.append(QVariant(gridItem[i][j].baseWidth));
-            datas.append(QVariant(gridItem[i][j].baseHeight));
-            datas.append(QVariant(qsfirstorlast));
-            datas.append(QVariant(gridItem[i][j].bNotSupportedOrDamaged));
-            item->setData(QVariant(datas), Qt::DisplayRole);
-            QStringList albumNames = ImageEngineApi::instance()->getImgPathAndAlbumNames().values(gridItem[i][j].path);
-            item->setData(QVariant(albumNames), Qt::UserRole + 2);
-
-            item->setData(QVariant(QSize(gridItem[i][j].width, gridItem[i][j].height)),
-                          Qt::SizeHintRole);
-            m_model->appendRow(item);
-        }
+    QVector<ThumbnailModel::Item> modelItems;
+    modelItems.reserve(items.size());
+    for (const ItemInfo &info : items) {
+        modelItems << modelItem(info);
     }
-    m_gridItem << gridItem;
+    m_model->appendItems(modelItems);
     int hightlast = m_height;
-    if (0 < m_gridItem.size()) {
-        m_height = 0;
-        int index = 0;//当前一个list所有照片数量
-        for (int i = 0; i < m_gridItem.size(); i++) {
-            for (int j = 0; j < m_gridItem[i].size(); j++) {
-                index ++;
-            }
-        }
-        int m_row = 0;//当前一个list的行数
-        if (index % rowSizeHint == 0)
-            m_row = index / rowSizeHint;
-        else
-            m_row = index / rowSizeHint + 1;
-
-        m_height = (m_gridItem[0][0].height + ITEM_SPACING) * m_row;
-        m_height -= ITEM_SPACING;
-    }
+    calListHeight();
     if (hightlast != m_height) {
         sendNeedResize();
     }
 
     if (m_selectPrePath.length() > 0) {
         this->clearSelection();
-        QModelIndex lastIndex;
-        int rowcount = m_model->rowCount();
-        for (int i = 0; i < rowcount; i++) {
-            for (int j = 0 ; j < m_model->columnCount(); j++) {
-                QVariantList datas = m_model->item(i, j)->data(Qt::DisplayRole).toList();
-                QString path;
-                if (datas.length() >= 2) {
-                    path = datas[1].toString();
-                }
-                if (m_selectPrePath == path) {
-                    if (this->objectName() == "RightTrashThumbnail" || this->objectName() == "RightFavoriteThumbnail") {
-                        if (i >= rowSizeHint) {
-                            lastIndex = m_model->item(i - rowSizeHint, j)->index();
-                        } else {
-                            lastIndex = m_model->item(i, j)->index();
-                        }
-                    } else {
-                        lastIndex = m_model->item(i, j)->index();
-                    }
-                    if (lastIndex.isValid()) {
-                        m_Row = m_model->item(i, j)->row() / m_model->rowCount();
-                        this->scrollTo(lastIndex, ScrollHint::PositionAtCenter);
-                        break;
-                    }
-                }
+        const int i = m_model->rowOf(m_selectPrePath);
+        if (i >= 0) {
+            QModelIndex lastIndex;
+            if ((this->objectName() == "RightTrashThumbnail" || this->objectName() == "RightFavoriteThumbnail")
+                    && i >= rowSizeHint) {
+                lastIndex = m_model->index(i - rowSizeHint, 0);
+            } else {
+                lastIndex = m_model->index(i, 0);
+            }
+            if (lastIndex.isValid()) {
+                m_Row = i / m_model->rowCount();
+                this->scrollTo(lastIndex, ScrollHint::PositionAtCenter);
             }
         }
     }
@@ -641,109 +360,29 @@ void ThumbnailListView::addThumbnailViewNew(QList<QList<ItemInfo>> gridItem)
 
 void ThumbnailListView::addThumbnailView()
 {
-    QModelIndexList mlist = getSelectedIndexes();
-    QMap<int, QPair<int, int>> items;
-    int key = 0;
-    for (QModelIndex i : mlist) {
-        items.insert(key, QPair<int, int>(i.row(), i.column()));
-        key++;
-    }
-    m_model->clear();
-
-    for (int i = 0; i < m_gridItem.length(); i++) {
-        for (int j = 0; j < m_gridItem[i].length(); j++) {
-            QStandardItem *item = new QStandardItem;
-            QString qsfirstorlast = "NotFirstOrLast";
-
-            QVariantList datas;
-            datas.append(QVariant(m_gridItem[i][j].name));
-            datas.append(QVariant(m_gridItem[i][j].path));
-            datas.append(QVariant(m_gridItem[i][j].width));
-            datas.append(QVariant(m_gridItem[i][j].height));
-            datas.append(QVariant(m_gridItem[i][j].remainDays));
-            datas.append(QVariant(m_gridItem[i][j].image));
-            datas.append(QVariant(m_gridItem[i][j].imgWidth));
-            datas.append(QVariant(m_gridItem[i][j].imgHeight));
-            datas.append(QVariant(m_gridItem[i][j].baseWidth));
-            datas.append(QVariant(m_gridItem[i][j].baseHeight));
-            datas.append(QVariant(qsfirstorlast));
-            datas.append(QVariant(m_gridItem[i][j].bNotSupportedOrDamaged));
-            item->setData(QVariant(datas), Qt::DisplayRole);
-            item->setData(QVariant(QSize(m_gridItem[i][j].width, m_gridItem[i][j].height)),
-                          Qt::SizeHintRole);
-            m_model->appendRow(item);
-        }
-    }
-
-//  设置更新之前的选择状态
-    for (auto it : items) {
-        if (it.first < m_model->rowCount()
-                && it.second < m_model->columnCount()) {
-            QModelIndex qindex = m_model->index(it.first, it.second);
-            selectionModel()->select(qindex, QItemSelectionModel::Select);
-        }
-    }
+    //格子大小由模型中的布局给出，这里只需同步布局尺寸
+    calgridItemsWidth();
 }
 
 void ThumbnailListView::updateThumbnailView(QString updatePath)
 {
-    int index = 0;
-    for (int i = 0; i < m_gridItem.length(); i++) {
-        for (int j = 0; j < m_gridItem[i].length(); j++) {
-            if (m_gridItem[i][j].path == updatePath) {  //需要旋转的图片
-                ImageDataSt data;
-                ImageEngineApi::instance()->getImageData(updatePath, data);
-                ItemInfo info;
-                if (data.imgpixmap.isNull()) {
-                    info.bNotSupportedOrDamaged = true;
-                    data.imgpixmap = getDamagedPixmap();
-                }
-                info.name = data.dbi.fileName;
-                info.path = data.dbi.filePath;
-                info.width = data.imgpixmap.width();
-                info.height = data.imgpixmap.height();
-                info.image = data.imgpixmap;
-                info.remainDays = data.remainDays;
-                info.baseWidth = data.imgpixmap.width();
-                info.baseHeight = data.imgpixmap.height();
-                modifyAllPic(info);
-                for (auto &item : m_ItemList) {     //替换
-                    if (item == m_gridItem[i][j])
-                        item = info;
-                }
-                QList<ItemInfo>::iterator item = m_ItemList.begin();
-                while (item != m_ItemList.end()) {
-                    if (*item == m_gridItem[i][j])
-                        *item = info;
-                    ++item;
-                }
-                m_gridItem[i][j] = info;
-                QVariantList newdatas;
-                QString qsfirstorlast = "NotFirstOrLast";
-
-                newdatas.append(QVariant(m_gridItem[i][j].name));
-                newdatas.append(QVariant(m_gridItem[i][j].path));
-                newdatas.append(QVariant(m_gridItem[i][j].width));
-                newdatas.append(QVariant(m_gridItem[i][j].height));
-                newdatas.append(QVariant(m_gridItem[i][j].remainDays));
-                newdatas.append(QVariant(m_gridItem[i][j].image));
-                newdatas.append(QVariant(m_gridItem[i][j].imgWidth));
-                newdatas.append(QVariant(m_gridItem[i][j].imgHeight));
-                newdatas.append(QVariant(m_gridItem[i][j].baseWidth));
-                newdatas.append(QVariant(m_gridItem[i][j].baseHeight));
-                newdatas.append(QVariant(qsfirstorlast));
-                newdatas.append(QVariant(m_gridItem[i][j].bNotSupportedOrDamaged));
-                m_model->item(index, 0)->setData(QVariant(newdatas), Qt::DisplayRole);
-                m_model->item(index, 0)->setData(QVariant(QSize(m_gridItem[i][j].width, m_gridItem[i][j].height)),
-                                                 Qt::SizeHintRole);
-                QStringList albumNames = ImageEngineApi::instance()->getImgPathAndAlbumNames().values(m_gridItem[i][j].path);
-                m_model->item(index, 0)->setData(QVariant(albumNames), Qt::UserRole + 2);
-            }
-            index++;
+    const int row = m_model->rowOf(updatePath);
+    if (row >= 0) {     //需要旋转的图片
+        ImageDataSt data;
+        ImageEngineApi::instance()->getImageData(updatePath, data);
+        ItemInfo info;
+        if (data.imgpixmap.isNull()) {
+            info.bNotSupportedOrDamaged = true;
+            data.imgpixmap = getDamagedPixmap();
         }
+        info.name = data.dbi.fileName;
+        info.path = data.dbi.filePath;
+        info.remainDays = data.remainDays;
+        info.baseWidth = data.imgpixmap.width();
+        info.baseHeight = data.imgpixmap.height();
+        m_model->setItem(row, modelItem(info));
     }
     //更新布局
-    calBasePixMapWidth();
     calgridItemsWidth();
     updateThumbnaillistview();
 //    addThumbnailView();
@@ -755,12 +394,110 @@ void ThumbnailListView::loadFilesFromDB(QString name, int loadCount)
     ImageEngineApi::instance()->loadImagesFromDB(m_delegatetype, this, name, loadCount);
 }
 
+void ThumbnailListView::loadSections(const QStringList &titles, const QList<DBImgInfoList> &sections, int headerHeight)
+{
+    stopLoadAndClear();
+    m_sectioned = true;
+    m_model->setHeaderHeight(headerHeight);
+    QVector<ThumbnailModel::Item> items;
+    DBImgInfoList infos;
+    for (int i = 0; i < sections.size() && i < titles.size(); i++) {
+        items << ThumbnailModel::Item::sectionHeader(titles.at(i), sections.at(i).size());
+        for (const DBImgInfo &info : sections.at(i)) {
+            ThumbnailModel::Item item;
+            item.path = info.filePath;
+            item.name = info.fileName;
+            //缩略图加载前以数据库中记录的主色占位
+            item.previewColor = info.previewColor;
+            items << item;
+            m_allfileslist << info.filePath;
+        }
+        infos << sections.at(i);
+    }
+    calgridItemsWidth();
+    m_model->appendItems(items);
+    calListHeight();
+    //登记到图片引擎后再分批请求缩略图，见imageLocalLoaded
+    ImageEngineApi::instance()->loadImagesFromLocal(infos, this);
+}
+
+bool ThumbnailListView::isSectionSelected(int headerRow) const
+{
+    if (!m_model->isHeader(headerRow)) {
+        return false;
+    }
+    const int first = headerRow + 1;
+    const int last = m_model->sectionEnd(headerRow);
+    if (last < first) {
+        return false;
+    }
+    return selectedCount(first, last) >= last - first + 1;
+}
+
+int ThumbnailListView::selectedCount(int first, int last) const
+{
+    //按选区统计落在[first, last]内的行数，不逐行查询；选区之间可能重叠，先排序合并
+    QVector<QPair<int, int>> spans;
+    for (const QItemSelectionRange &range : selectionModel()->selection()) {
+        const int top = qMax(first, range.top());
+        const int bottom = qMin(last, range.bottom());
+        if (top <= bottom) {
+            spans << qMakePair(top, bottom);
+        }
+    }
+    std::sort(spans.begin(), spans.end());
+    int selected = 0;
+    int covered = first - 1;
+    for (const QPair<int, int> &span : spans) {
+        if (span.second > covered) {
+            selected += span.second - qMax(span.first, covered + 1) + 1;
+            covered = span.second;
+        }
+    }
+    return selected;
+}
+
+void ThumbnailListView::setSectionSelected(int headerRow, bool selected)
+{
+    if (!m_model->isHeader(headerRow)) {
+        return;
+    }
+    const int last = m_model->sectionEnd(headerRow);
+    if (last <= headerRow) {
+        return;
+    }
+    const QItemSelection selection(m_model->index(headerRow + 1, 0), m_model->index(last, 0));
+    selectionModel()->select(selection, selected ? QItemSelectionModel::Select : QItemSelectionModel::Deselect);
+    viewport()->update();
+    emit sigSectionSelectionChanged();
+}
+
+int ThumbnailListView::sectionAtTop() const
+{
+    const JustifiedLayout &layout = m_model->layout();
+    //列表在布局坐标外留有一圈间距
+    const int row = layout.rowAt(verticalScrollBar()->value() - spacing());
+    if (row < 0) {
+        return -1;
+    }
+    return m_model->sectionOf(layout.firstInRow(row));
+}
+
+void ThumbnailListView::onSectionChoseClicked(const QModelIndex &index)
+{
+    const bool selected = isSectionSelected(index.row());
+    setSectionSelected(index.row(), !selected);
+    if (!selected) {
+        m_anchorRow = index.row() + 1;
+    }
+}
+
 bool ThumbnailListView::imageFromDBLoaded(QStringList &filelist)
 {
     emit sigDBImageLoaded();
     stopLoadAndClear();
     m_allfileslist << filelist;
-    m_filesbeleft << filelist;
+    queueFiles(filelist);
     m_allNeedRequestFilesCount += filelist.size();
     calgridItemsWidth();
     addThumbnailView();
@@ -791,9 +528,17 @@ void ThumbnailListView::loadFilesFromTrash(DBImgInfoList files)
 
 bool ThumbnailListView::imageLocalLoaded(QStringList &filelist)
 {
+    if (m_sectioned) {
+        //行已在loadSections中插入，这里只开始请求缩略图
+        queueFiles(filelist);
+        if (bneedloadimage) {
+            requestSomeImages();
+        }
+        return true;
+    }
     stopLoadAndClear();
     m_allfileslist << filelist;
-    m_filesbeleft << filelist;
+    queueFiles(filelist);
     m_allNeedRequestFilesCount += filelist.size();
     calgridItemsWidth();
     addThumbnailView();
@@ -804,25 +549,41 @@ bool ThumbnailListView::imageLocalLoaded(QStringList &filelist)
     return true;
 }
 
+void ThumbnailListView::queueFiles(const QStringList &files)
+{
+    m_filesbeleft << files;
+    for (const QString &path : files) {
+        m_filesbeleftSet.insert(path);
+    }
+}
+
 void ThumbnailListView::requestSomeImages()
 {
     //QMutexLocker mutex(&m_mutex);
+    if (m_flinging) {
+        //快速滑动中请求的行很快就会移出视口，等停稳后再请求
+        bneedloadimage = true;
+        return;
+    }
     bneedloadimage = false;
 
-    if (m_filesbeleft.size() < Number_Of_Displays_Per_Time) {
-        m_requestCount += m_filesbeleft.size();
-    } else {
-        m_requestCount += Number_Of_Displays_Per_Time;
-    }
-    for (int i = 0; i < Number_Of_Displays_Per_Time; i++) {
-        if (m_filesbeleft.size() <= 1) {
+    const int batch = m_requestBatch;
+    m_batchSize = qMin(m_filesbeleftSet.size(), batch);
+    m_requestCount += m_batchSize;
+    m_batchClock.start();
+    for (int i = 0; i < batch; i++) {
+        if (m_filesbeleftSet.size() <= 1) {
             brequestallfiles = true;
         }
-        if (m_filesbeleft.size() <= 0) {
+        if (m_filesbeleftSet.isEmpty()) {
+            m_filesbeleft.clear();
             return;
         }
-        QString firstfilesbeleft = m_filesbeleft.first();
-        m_filesbeleft.removeFirst();
+        //提到前面的路径在原位置上还留有一份，已请求过的跳过
+        QString firstfilesbeleft;
+        do {
+            firstfilesbeleft = m_filesbeleft.takeFirst();
+        } while (!m_filesbeleftSet.remove(firstfilesbeleft));
         bool useGlobalThreadPool = true;
         if (m_useFor == Mount) {
             useGlobalThreadPool = false;
@@ -834,7 +595,9 @@ void ThumbnailListView::requestSomeImages()
 bool ThumbnailListView::imageLoaded(QString filepath)
 {
     m_requestCount--;
-    m_allNeedRequestFilesCount--;
+    if (!m_sectioned) {
+        m_allNeedRequestFilesCount--;
+    }
     if (m_requestCount < 1) {
         if (brequestallfiles) {
             blastload = true;
@@ -855,43 +618,103 @@ bool ThumbnailListView::imageLoaded(QString filepath)
         info.path = data.dbi.filePath;
         info.width = data.imgpixmap.width();
         info.height = data.imgpixmap.height();
-        info.image = data.imgpixmap;
 //        info.bNotSupportedOrDamaged = data.imgpixmap.isNull();
         info.remainDays = data.remainDays;
         info.baseWidth = data.imgpixmap.width();
         info.baseHeight = data.imgpixmap.height();
-        insertThumbnail(info);
+        if (m_sectioned) {
+            //占位行已存在，原位更新
+            const int row = m_model->rowOf(info.path);
+            if (row >= 0) {
+                ThumbnailModel::Item item = modelItem(info);
+                item.previewColor = m_model->item(row).previewColor;
+                m_model->setItem(row, item);
+            }
+        } else {
+            insertThumbnail(info);
+        }
         reb = false;
     }
     if (m_requestCount < 1) {
+        adaptRequestBatch();
         requestSomeImages();
     }
     return reb;
 }
 
+void ThumbnailListView::adaptRequestBatch()
+{
+    if (m_batchSize <= 0 || !m_batchClock.isValid()) {
+        return;
+    }
+    const qreal perMs = qreal(m_batchSize) / qMax<qint64>(1, m_batchClock.elapsed());
+    const int wanted = qBound(MIN_REQUEST_BATCH, qRound(perMs * REQUEST_BATCH_TARGET), MAX_REQUEST_BATCH);
+    //与上一批平均，避免个别大图使批量大起大落
+    m_requestBatch = (m_requestBatch + wanted + 1) / 2;
+    m_batchSize = 0;
+}
+
+void ThumbnailListView::updateScrollSpeed(int value)
+{
+    const qint64 elapsed = m_scrollClock.isValid() ? m_scrollClock.restart() : -1;
+    if (elapsed < 0 || elapsed > SCROLL_SETTLE_INTERVAL) {
+        //停顿后重新估计
+        m_scrollSpeed = 0;
+        m_scrollClock.start();
+    } else {
+        const qreal speed = qAbs(value - m_lastScrollValue) / qMax<qreal>(1, elapsed);
+        m_scrollSpeed = (m_scrollSpeed + speed) / 2;
+    }
+    m_lastScrollValue = value;
+}
+
+void ThumbnailListView::prioritizeVisibleRows()
+{
+    const JustifiedLayout &layout = m_model->layout();
+    const int top = verticalScrollBar()->value() - spacing();
+    //视口及其下方一屏
+    const int firstRow = layout.rowAt(top);
+    const int lastRow = layout.rowAt(top + viewport()->height() * 2);
+    if (firstRow < 0 || lastRow < 0 || m_filesbeleftSet.isEmpty()) {
+        return;
+    }
+    const int end = lastRow + 1 < layout.rowCount() ? layout.firstInRow(lastRow + 1) : m_model->rowCount();
+    //按行序从上到下排在前面，只处理可见的行，不重建整个队列
+    QStringList front;
+    for (int row = layout.firstInRow(firstRow); row < end; row++) {
+        const QString path = m_model->pathAt(row);
+        if (!m_model->isHeader(row) && m_filesbeleftSet.contains(path)) {
+            front << path;
+        }
+    }
+    for (int i = front.size() - 1; i >= 0; i--) {
+        m_filesbeleft.prepend(front.at(i));
+    }
+}
+
 void ThumbnailListView::insertThumbnail(const ItemInfo &iteminfo)
 {
-    ItemInfo info = iteminfo;
-    cutPixmap(info);
-    modifyAllPic(info);
-    m_allItemLeft << info; //所有待处理的图片
+    m_allItemLeft << iteminfo; //所有待处理的图片
     calgridItems();
 }
 
 void ThumbnailListView::stopLoadAndClear(bool bClearModel)
 {
     clearAndStopThread();
-    if (bClearModel)
+    if (bClearModel) {
         m_model->clear();   //清除模型中的数据
+        m_sectioned = false;
+        m_anchorRow = -1;
+    }
     m_allfileslist.clear();
     m_filesbeleft.clear();
+    m_filesbeleftSet.clear();
     m_allNeedRequestFilesCount = 0;
     bneedloadimage = true;
     brequestallfiles = false;
-    m_ItemListLeft.clear();
     m_requestCount = 0;
-    m_ItemList.clear();
-    m_gridItem.clear();
+    m_batchSize = 0;
+    m_flinging = false;
     blastload = false;
     bfirstload = true;
 }
@@ -901,6 +724,23 @@ QStringList ThumbnailListView::getAllFileList()
     return m_allfileslist;
 }
 
+QStringList ThumbnailListView::firstScreenPaths() const
+{
+    QStringList paths;
+    const JustifiedLayout &layout = m_model->layout();
+    const int count = qMin(layout.count(), m_model->rowCount());
+    for (int i = 0; i < count; i++) {
+        if (layout.isHeader(i)) {
+            continue;
+        }
+        if (layout.rowTop(layout.rowOf(i)) >= viewport()->height()) {
+            break;
+        }
+        paths << m_model->pathAt(i);
+    }
+    return paths;
+}
+
 void ThumbnailListView::setIBaseHeight(int iBaseHeight)
 {
     m_iBaseHeight = iBaseHeight;
@@ -909,7 +749,7 @@ void ThumbnailListView::setIBaseHeight(int iBaseHeight)
 void ThumbnailListView::onShowMenu(const QPoint &pos)
 {
     //外接设备显示照片时，禁用鼠标右键菜单
-    if (!this->indexAt(pos).isValid() || ALBUM_PATHTYPE_BY_PHONE == m_imageType) {
+    if (!this->indexAt(pos).isValid() || m_model->isHeader(indexAt(pos).row()) || ALBUM_PATHTYPE_BY_PHONE == m_imageType) {
         return;
     }
     emit sigMouseRelease();
@@ -941,6 +781,10 @@ void ThumbnailListView::updateMenuContents()
         action->setVisible(true);
         action->setEnabled(true);
     }
+    // 相似照片只在单选，且菜单由本视图处理时提供
+    m_MenuActionMap.value(tr("Select similar photos"))->setVisible(1 == paths.length()
+                                                                  && COMMON_STR_VIEW_TIMELINE != m_imageType
+                                                                  && COMMON_STR_RECENT_IMPORTED != m_imageType);
     if ((1 == paths.length()) && (!QFileInfo(paths[0]).exists()) && (COMMON_STR_TRASH != m_imageType)) {
         m_MenuActionMap.value(tr("View"))->setEnabled(true);
         m_MenuActionMap.value(tr("Fullscreen"))->setEnabled(false);
@@ -1093,13 +937,13 @@ void ThumbnailListView::initMenuAction()
     m_pMenu->addSeparator();
     appendAction(IdSetAsWallpaper, tr("Set as wallpaper"), ss(SETASWALLPAPER_CONTEXT_MENU));
     appendAction(IdDisplayInFileManager, tr("Display in file manager"), ss(DISPLAYINFILEMANAGER_CONTEXT_MENU));
+    appendAction(IdSelectSimilar, tr("Select similar photos"), "");
     appendAction(IdImageInfo, tr("Photo info"), ss(ImageInfo_CONTEXT_MENU));
 }
 
 DMenu *ThumbnailListView::createAlbumMenu()
 {
     DMenu *am = new DMenu(tr("Add to album"));
-    QStringList albums = DBManager::instance()->getAllAlbumNames();
     QAction *ac1 = new QAction(am);
     ac1->setProperty("MenuID", IdAddToAlbum);
     ac1->setText(tr("New album"));
@@ -1110,13 +954,13 @@ DMenu *ThumbnailListView::createAlbumMenu()
     QStringList albumNames;
     // 单选
     if (indexList.count() == 1) {
-        albumNames = indexList.first().model()->data(indexList.first(), Qt::UserRole + 2).toStringList();
+        albumNames = indexList.first().model()->data(indexList.first(), ThumbnailModel::AlbumNamesRole).toStringList();
     }
     // 多选,以第一个作标准
     else if (indexList.count() > 1) {
-        albumNames = indexList.first().model()->data(indexList.first(), Qt::UserRole + 2).toStringList();
+        albumNames = indexList.first().model()->data(indexList.first(), ThumbnailModel::AlbumNamesRole).toStringList();
         for (int idx = 1; idx < indexList.count(); idx++) {
-            QStringList tempList = indexList.at(idx).model()->data(indexList.at(idx), Qt::UserRole + 2).toStringList();
+            QStringList tempList = indexList.at(idx).model()->data(indexList.at(idx), ThumbnailModel::AlbumNamesRole).toStringList();
             for (int i = 0; i < albumNames.count(); i++) {
                 // 不存在相册名
                 if (!tempList.contains(albumNames.at(i))) {
@@ -1126,17 +970,24 @@ DMenu *ThumbnailListView::createAlbumMenu()
             }
         }
     }
-    for (QString album : albums) {
-        QAction *ac = new QAction(am);
-        ac->setProperty("MenuID", IdAddToAlbum);
-        ac->setText(
-            fontMetrics().elidedText(QString(album).replace("&", "&&"), Qt::ElideMiddle, 200));
-        ac->setData(album);
-        am->addAction(ac);
-        if (albumNames.contains(album)) {
-            ac->setEnabled(false);
+    //相册名在数据库线程查询，返回后追加到子菜单；菜单已销毁则不回调
+    std::function<QStringList()> query = []() {
+        return DBManager::instance()->getAllAlbumNames();
+    };
+    std::function<void(const QStringList &)> callback = [this, am, albumNames](const QStringList & albums) {
+        for (QString album : albums) {
+            QAction *ac = new QAction(am);
+            ac->setProperty("MenuID", IdAddToAlbum);
+            ac->setText(
+                fontMetrics().elidedText(QString(album).replace("&", "&&"), Qt::ElideMiddle, 200));
+            ac->setData(album);
+            am->addAction(ac);
+            if (albumNames.contains(album)) {
+                ac->setEnabled(false);
+            }
         }
-    }
+    };
+    DBAsyncManager::instance()->query(am, query, callback);
     return am;
 }
 
@@ -1155,10 +1006,7 @@ QStringList ThumbnailListView::selectedPaths()
     QStringList paths;
     bool first = true;
     for (QModelIndex index : selectionModel()->selectedIndexes()) {
-        const QVariantList datas = index.model()->data(index, Qt::DisplayRole).toList();
-        if (datas.length() >= 8) {
-            paths << datas[1].toString();
-        }
+        paths << index.data(ThumbnailModel::PathRole).toString();
         if (first) {
             m_timeLineSelectPrePic = index.row() - 1;
             if (m_timeLineSelectPrePic < 0)
@@ -1214,10 +1062,8 @@ void ThumbnailListView::menuItemDeal(QStringList paths, QAction *action)
             } else {
                 emit dApp->signalM->sigAddToAlbToast(album);
             }
-            DBManager::instance()->insertIntoAlbum(album, paths);
+            DBManager::instance()->insertIntoAlbumAsync(album, paths);
             emit dApp->signalM->insertedIntoAlbum(album, paths);
-            // 相册照片更新时的．更新路径相册名缓存,用于listview的setdata userrole + 2
-            ImageEngineApi::instance()->setImgPathAndAlbumNames(DBManager::instance()->getAllPathAlbumNames());
             // 只更新部分，即将照片添加或者删除相册时
             updateModelRoleData(album, IdAddToAlbum);
 
@@ -1243,18 +1089,18 @@ void ThumbnailListView::menuItemDeal(QStringList paths, QAction *action)
     }
     break;
     case IdAddToFavorites:
-        DBManager::instance()->insertIntoAlbum(COMMON_STR_FAVORITES, paths, AlbumDBType::Favourite);
+        DBManager::instance()->insertIntoAlbumAsync(COMMON_STR_FAVORITES, paths, AlbumDBType::Favourite);
         emit dApp->signalM->insertedIntoAlbum(COMMON_STR_FAVORITES, paths);
         break;
     case IdRemoveFromFavorites:
-        DBManager::instance()->removeFromAlbum(COMMON_STR_FAVORITES, paths, AlbumDBType::Favourite);
+        DBManager::instance()->removeFromAlbumAsync(COMMON_STR_FAVORITES, paths, AlbumDBType::Favourite);
         break;
     case IdRemoveFromAlbum: {
         if (IMAGE_DEFAULTTYPE != m_imageType && COMMON_STR_VIEW_TIMELINE != m_imageType &&
                 COMMON_STR_RECENT_IMPORTED != m_imageType && COMMON_STR_TRASH != m_imageType) {
             // 只更新部分，从相册移出时
             updateModelRoleData(m_imageType, IdRemoveFromAlbum);
-            DBManager::instance()->removeFromAlbum(m_imageType, paths);
+            DBManager::instance()->removeFromAlbumAsync(m_imageType, paths);
         }
     }
     break;
@@ -1291,6 +1137,9 @@ void ThumbnailListView::menuItemDeal(QStringList paths, QAction *action)
     case IdTrashRecovery:
         emit trashRecovery();
         break;
+    case IdSelectSimilar:
+        selectSimilarPhotos(path);
+        break;
     default:
         break;
     }
@@ -1335,7 +1184,6 @@ void ThumbnailListView::onPixMapScale(int value)
         m_iBaseHeight = 80;
         break;
     }
-    calBasePixMapWidth();
     calgridItemsWidth();
     updateThumbnaillistview();      //改用新的调整位置--xioalong
 //    addThumbnailView();//耗时最长
@@ -1345,16 +1193,11 @@ void ThumbnailListView::onPixMapScale(int value)
 void ThumbnailListView::onCancelFavorite(const QModelIndex &index)
 {
     QStringList str;
-    QVariantList datas = index.model()->data(index, Qt::DisplayRole).toList();
-
-    if (datas.length() >= 2) {
-        str << datas[1].toString();
-    }
+    str << index.data(ThumbnailModel::PathRole).toString();
     //通知其它界面更新取消收藏
-    DBManager::instance()->removeFromAlbum(COMMON_STR_FAVORITES, str, AlbumDBType::Favourite);
+    DBManager::instance()->removeFromAlbumAsync(COMMON_STR_FAVORITES, str, AlbumDBType::Favourite);
     emit dApp->signalM->updateFavoriteNum();
     m_model->removeRow(index.row());
-    m_ItemList.removeAt(index.row());
     calgridItemsWidth();
     updateThumbnailView();
     sendNeedResize();
@@ -1410,41 +1253,21 @@ QPixmap ThumbnailListView::getDamagedPixmap()
 
 void ThumbnailListView::updateThumbnaillistview()
 {
-    int index = 0;
-    for (int i = 0; i < m_gridItem.length(); i++) {
-        for (int j = 0; j < m_gridItem[i].length(); j++) {
-            QString qsfirstorlast = "NotFirstOrLast";
-
-            QVariantList datas;
-            datas.append(QVariant(m_gridItem[i][j].name));
-            datas.append(QVariant(m_gridItem[i][j].path));
-            datas.append(QVariant(m_gridItem[i][j].width));
-            datas.append(QVariant(m_gridItem[i][j].height));
-            datas.append(QVariant(m_gridItem[i][j].remainDays));
-            if (m_gridItem[i][j].bNotSupportedOrDamaged) {
-                m_gridItem[i][j].image = getDamagedPixmap();
-            }
-            datas.append(QVariant(m_gridItem[i][j].image));
-            datas.append(QVariant(m_gridItem[i][j].imgWidth));
-            datas.append(QVariant(m_gridItem[i][j].imgHeight));
-            datas.append(QVariant(m_gridItem[i][j].baseWidth));
-            datas.append(QVariant(m_gridItem[i][j].baseHeight));
-            datas.append(QVariant(qsfirstorlast));
-            datas.append(QVariant(m_gridItem[i][j].bNotSupportedOrDamaged));
-
-            //更新值
-            QStandardItem *newItem = m_model->item(index);
-            if (newItem) {
-                newItem->setData(QVariant(datas), Qt::DisplayRole);
-                newItem->setData(QVariant(QSize(m_gridItem[i][j].width, m_gridItem[i][j].height)),
-                                 Qt::SizeHintRole);
-                m_model->setItem(index++, newItem);
-            }
-        }
-    }
+    calgridItemsWidth();
     this->setSpacing(ITEM_SPACING);     //重新布局
 }
 
+ThumbnailModel::Item ThumbnailListView::modelItem(const ItemInfo &info) const
+{
+    ThumbnailModel::Item item;
+    item.path = info.path;
+    item.name = info.name;
+    item.remainDays = info.remainDays;
+    item.baseSize = QSize(info.baseWidth, info.baseHeight);
+    item.damaged = info.bNotSupportedOrDamaged;
+    return item;
+}
+
 #if 1
 QModelIndexList ThumbnailListView::getSelectedIndexes()
 {
@@ -1458,26 +1281,23 @@ int ThumbnailListView::getRow(QPoint point)
 
 void ThumbnailListView::selectRear(int row)
 {
-    for (int i = row; i < m_model->rowCount(); i++) {
-        QModelIndex qindex = m_model->index(i, 0);
-        selectionModel()->select(qindex, QItemSelectionModel::Select);
-    }
+    selectExtent(row, m_model->rowCount() - 1);
 }
 
 void ThumbnailListView::selectFront(int row)
 {
-    for (int i = row; i >= 0; i--) {
-        QModelIndex qindex = m_model->index(i, 0);
-        selectionModel()->select(qindex, QItemSelectionModel::Select);
-    }
+    selectExtent(0, row);
 }
 
+//整段作为一个选区，分组标题行不可选中，会被自动跳过
 void ThumbnailListView::selectExtent(int start, int end)
 {
-    for (int i = start; i <= end; i++) {
-        QModelIndex qindex = m_model->index(i, 0);
-        selectionModel()->select(qindex, QItemSelectionModel::Select);
+    start = qMax(0, start);
+    end = qMin(end, m_model->rowCount() - 1);
+    if (start > end) {
+        return;
     }
+    selectionModel()->select(QItemSelection(m_model->index(start, 0), m_model->index(end, 0)), QItemSelectionModel::Select);
 }
 
 void ThumbnailListView::resizeHand()
@@ -1509,37 +1329,21 @@ void ThumbnailListView::onTimerOut()
 
 void ThumbnailListView::sltChangeDamagedPixOnThemeChanged()
 {
-    for (int i = 0; i < m_model->rowCount(); i++) {
-        QModelIndex idx = m_model->index(i, 0);
-        QVariantList lst = idx.model()->data(idx, Qt::DisplayRole).toList();
-        if (lst.count() >= 12) {
-            const bool &bNotSuppOrDmg = lst[11].toBool();
-            if (bNotSuppOrDmg) {
-                lst.replace(5, getDamagedPixmap());
-                m_model->item(i, 0)->setData(lst, Qt::DisplayRole);
-            }
-        }
-    }
+    m_model->refreshDamaged();
 }
 
 void ThumbnailListView::selectDuplicateForOneListView(QStringList paths, QModelIndex &firstIndex)
 {
     if (paths.count() > 0) {
         this->clearSelection();
-        for (int i = 0; i < m_model->rowCount(); i++) {
-            QModelIndex idx = m_model->index(i, 0);
-            QVariantList lst = idx.model()->data(idx, Qt::DisplayRole).toList();
-            if (lst.count() >= 12) {
-                for (int j = 0; j < paths.count(); j++) {
-                    if (lst.at(1).toString() == paths.at(j)) {
-                        // 选中
-                        selectionModel()->select(idx, QItemSelectionModel::Select);
-                        if (!firstIndex.isValid()) {
-                            firstIndex = idx;
-                        }
-                    }
-                }
-            }
+        //按路径索引取行，连续的行合并为一个区间后一次选中
+        const QItemSelection selection = m_model->selectionOf(paths);
+        if (selection.isEmpty()) {
+            return;
+        }
+        selectionModel()->select(selection, QItemSelectionModel::Select);
+        if (!firstIndex.isValid()) {
+            firstIndex = selection.first().topLeft();
         }
     }
 }
@@ -1568,60 +1372,73 @@ void ThumbnailListView::selectDuplicatePhotos(QStringList paths, bool bMultiList
     }
 }
 
+void ThumbnailListView::selectSimilarPhotos(const QString &path)
+{
+    PhotoCatalog *catalog = PhotoCatalog::instance();
+    QStringList paths = catalog->paths(catalog->similarTo(catalog->idOf(path)));
+    if (paths.isEmpty()) {
+        return;
+    }
+    paths.prepend(path);
+    selectDuplicatePhotos(paths);
+}
+
 void ThumbnailListView::updateModelRoleData(QString albumName, int actionType)
 {
     // listview存在多个，状态model不同，所以先处理已知的，再通知其他model
     // 本listview对象不再处理其他listviw对象model的同步问题！
-    if (actionType == IdRemoveFromAlbum) {
-        // remove from album
-        for (QModelIndex index : selectionModel()->selectedIndexes()) {
-            QStringList datas = index.model()->data(index, Qt::UserRole + 2).toStringList();
+    const QModelIndexList indexes = selectionModel()->selectedIndexes();
+    QVector<int> rows;
+    QStringList paths;
+    rows.reserve(indexes.size());
+    paths.reserve(indexes.size());
+    for (const QModelIndex &index : indexes) {
+        rows << index.row();
+        paths << index.data(ThumbnailModel::PathRole).toString();
+    }
+    updateAlbumNames(rows, albumName, actionType);
+    setCurrentSelectPath();
+    emit SignalManager::instance()->sigSyncListviewModelData(paths, albumName, actionType);
+}
+
+void ThumbnailListView::updateAlbumNames(const QVector<int> &rows, const QString &albumName, int actionType)
+{
+    if (actionType != IdRemoveFromAlbum && actionType != IdAddToAlbum && actionType != IdMoveToTrash) {
+        return;
+    }
+    for (int row : rows) {
+        const QModelIndex idx = m_model->index(row, 0);
+        QStringList datas;
+        if (actionType == IdRemoveFromAlbum) {
+            // remove from album
+            datas = idx.data(ThumbnailModel::AlbumNamesRole).toStringList();
             datas.removeAll(albumName);
-            QMap<int, QVariant> tempData;
-            tempData.insert(Qt::UserRole + 2, datas);
-            m_model->setItemData(index, tempData);
-        }
-    } else if (actionType == IdAddToAlbum) {
-        // add to album
-        for (QModelIndex index : selectionModel()->selectedIndexes()) {
-            QStringList datas = index.model()->data(index, Qt::UserRole + 2).toStringList();
+        } else if (actionType == IdAddToAlbum) {
+            // add to album
+            datas = idx.data(ThumbnailModel::AlbumNamesRole).toStringList();
             datas.append(albumName);
-            QMap<int, QVariant> tempData;
-            tempData.insert(Qt::UserRole + 2, datas);
-            m_model->setItemData(index, tempData);
         }
-    } else if (actionType == IdMoveToTrash) {
-        // delete photos
-        for (QModelIndex index : selectionModel()->selectedIndexes()) {
-            QStringList datas;
-            datas.clear();
-            QMap<int, QVariant> tempData;
-            tempData.insert(Qt::UserRole + 2, datas);
-            m_model->setItemData(index, tempData);
-        }
-    }
-    setCurrentSelectPath();
-    QStringList paths;
-    paths.clear();
-    for (QModelIndex index : selectionModel()->selectedIndexes()) {
-        paths.append(index.model()->data(index, Qt::DisplayRole).toList().at(1).toString());
+        // delete photos时清空
+        QMap<int, QVariant> tempData;
+        tempData.insert(ThumbnailModel::AlbumNamesRole, datas);
+        m_model->setItemData(idx, tempData);
     }
-    emit SignalManager::instance()->sigSyncListviewModelData(paths, albumName, actionType);
 }
 
 void ThumbnailListView::selectFirstPhoto()
 {
-    if (m_model->rowCount() < 1)
+    const int row = m_model->isHeader(0) ? 1 : 0;
+    if (m_model->rowCount() <= row)
         return;
-    QModelIndex idx = m_model->index(0, 0);
+    QModelIndex idx = m_model->index(row, 0);
     selectionModel()->select(idx, QItemSelectionModel::Select);
 }
 
 bool ThumbnailListView::isFirstPhotoSelected()
 {
-    QModelIndexList idx = selectionModel()->selectedIndexes();
+    const int row = m_model->isHeader(0) ? 1 : 0;
     for (QModelIndex index : selectionModel()->selectedIndexes()) {
-        if (index.row() == 0) {
+        if (index.row() == row) {
             return true;
         }
     }
@@ -1645,7 +1462,20 @@ void ThumbnailListView::slotReCalcTimelineSize()
 void ThumbnailListView::slotLoad80ThumbnailsFinish()
 {
     qDebug() << "zy------ThumbnailListView::slotLoad80ThumbnailsFinish";
-    for (auto data : ImageEngineApi::instance()->m_AllImageData) {
+    //首屏按数据库或快照中的顺序显示
+    QList<ImageDataSt> datas;
+    const QStringList &firstPagePaths = ImageEngineApi::instance()->m_firstPagePaths;
+    if (firstPagePaths.isEmpty()) {
+        datas = ImageEngineApi::instance()->m_AllImageData.values();
+    } else {
+        for (const QString &path : firstPagePaths) {
+            ImageDataSt data;
+            if (ImageEngineApi::instance()->getImageData(path, data)) {
+                datas << data;
+            }
+        }
+    }
+    for (auto data : datas) {
         ItemInfo info;
         if (data.imgpixmap.isNull()) {
             info.bNotSupportedOrDamaged = true;
@@ -1655,7 +1485,6 @@ void ThumbnailListView::slotLoad80ThumbnailsFinish()
         info.path = data.dbi.filePath;
         info.width = data.imgpixmap.width();
         info.height = data.imgpixmap.height();
-        info.image = data.imgpixmap;
 //        info.bNotSupportedOrDamaged = data.imgpixmap.isNull();
         info.remainDays = data.remainDays;
         info.baseWidth = data.imgpixmap.width();
@@ -1673,69 +1502,20 @@ void ThumbnailListView::onSyncListviewModelData(QStringList paths, QString album
     if (sender() != this) {
         // listview存在多个，状态model不同，所以先处理已知的，再通知其他model
         // 本listview对象不再处理其他listviw对象model的同步问题！
-        if (actionType == IdRemoveFromAlbum) {
-            // remove from album
-            if (paths.count() == 1 && !this->getAllPaths().contains(paths.at(0)))
-                return;
-            for (int i = 0; i < m_model->rowCount(); i++) {
-                QModelIndex idx = m_model->index(i, 0);
-                QVariantList lst = idx.model()->data(idx, Qt::DisplayRole).toList();
-                if (lst.count() >= 12) {
-                    for (int j = 0; j < paths.count(); j++) {
-                        if (lst.at(1).toString() == paths.at(j)) {
-                            QStringList datas = idx.model()->data(idx, Qt::UserRole + 2).toStringList();
-                            datas.removeAll(albumName);
-                            QMap<int, QVariant> tempData;
-                            tempData.insert(Qt::UserRole + 2, datas);
-                            m_model->setItemData(idx, tempData);
-                        }
-                    }
-                }
-            }
-        } else if (actionType == IdAddToAlbum) {
-            // add to album
-            if (paths.count() == 1 && !this->getAllPaths().contains(paths.at(0)))
-                return;
-            for (int i = 0; i < m_model->rowCount(); i++) {
-                QModelIndex idx = m_model->index(i, 0);
-                QVariantList lst = idx.model()->data(idx, Qt::DisplayRole).toList();
-                if (lst.count() >= 12) {
-                    for (int j = 0; j < paths.count(); j++) {
-                        if (lst.at(1).toString() == paths.at(j)) {
-                            QStringList datas = idx.model()->data(idx, Qt::UserRole + 2).toStringList();
-                            datas.append(albumName);
-                            QMap<int, QVariant> tempData;
-                            tempData.insert(Qt::UserRole + 2, datas);
-                            m_model->setItemData(idx, tempData);
-                        }
-                    }
-                }
-            }
-        } else if (actionType == IdMoveToTrash) {
-            // delete photos
-            if (paths.count() == 1 && !this->getAllPaths().contains(paths.at(0)))
-                return;
-            for (int i = 0; i < m_model->rowCount(); i++) {
-                QModelIndex idx = m_model->index(i, 0);
-                QVariantList lst = idx.model()->data(idx, Qt::DisplayRole).toList();
-                if (lst.count() >= 12) {
-                    for (int j = 0; j < paths.count(); j++) {
-                        if (lst.at(1).toString() == paths.at(j)) {
-                            QStringList datas;
-                            datas.clear();
-                            QMap<int, QVariant> tempData;
-                            tempData.insert(Qt::UserRole + 2, datas);
-                            m_model->setItemData(idx, tempData);
-                        }
-                    }
-                }
-            }
-        }
+        //按路径索引找到本列表中的行，不再逐行比较
+        updateAlbumNames(m_model->rowsOf(paths), albumName, actionType);
     }
 }
 
 void ThumbnailListView::onScrollbarValueChanged(int value)
 {
+    updateScrollSpeed(value);
+    if (m_sectioned) {
+        //分组视图的行已全部插入：快速滑动时只显示已有缩略图和主色占位，停稳后优先请求视口内的缩略图
+        m_flinging = m_scrollSpeed > FLING_SPEED;
+        m_settleTimer->start();
+        return;
+    }
     if (value && value >= (this->verticalScrollBar()->maximum())) {
         if (m_requestCount > 0) {
             bneedloadimage = true;
@@ -1745,6 +1525,22 @@ void ThumbnailListView::onScrollbarValueChanged(int value)
     }
 }
 
+void ThumbnailListView::onScrollSettled()
+{
+    m_flinging = false;
+    m_scrollSpeed = 0;
+    if (!m_sectioned || m_filesbeleftSet.isEmpty()) {
+        return;
+    }
+    prioritizeVisibleRows();
+    //已有请求在途时，完成后会接着请求排到前面的行
+    if (m_requestCount < 1) {
+        requestSomeImages();
+    } else {
+        bneedloadimage = true;
+    }
+}
+
 void ThumbnailListView::onScrollBarRangeChanged(int min, int max)
 {
     Q_UNUSED(max);
@@ -1757,6 +1553,9 @@ void ThumbnailListView::onScrollBarRangeChanged(int min, int max)
 
 void ThumbnailListView::onDoubleClicked(const QModelIndex &index)
 {
+    if (m_model->isHeader(index.row())) {
+        return;
+    }
     if (ALBUM_PATHTYPE_BY_PHONE != m_imageType) {
         if (m_imageType.compare(COMMON_STR_TRASH) != 0) {
             emit openImage(index.row());
@@ -1787,140 +1586,41 @@ void ThumbnailListView::sendNeedResize(/*int hight*/)
     bneedsendresize = false;
 }
 
-//调整图片尺寸
-void ThumbnailListView::modifyAllPic(ThumbnailListView::ItemInfo &info)
-{
-    int i_totalwidth = width() - 30;
-    info.width = m_iBaseHeight;
-    info.height = m_iBaseHeight;
-    if (info.width > i_totalwidth) {
-        info.height = i_totalwidth / 4;
-        info.width = i_totalwidth / 4;
-    }
-    info.imgHeight = info.height;
-    info.imgWidth = info.width;
-    info.imgHeight = (1 > info.imgHeight) ? 1 : info.imgHeight;
-    info.imgWidth = (1 > info.imgWidth) ? 1 : info.imgWidth;
-    info.height =
-        (m_iBaseHeight > info.height) ? m_iBaseHeight : info.height;
-    info.width = (28 > info.width) ? 28 : info.width;
-}
-
-//裁剪图片尺寸
-void ThumbnailListView::cutPixmap(ThumbnailListView::ItemInfo &iteminfo)
-{
-    int width = iteminfo.image.width();
-    if (width == 0)
-        width = m_iBaseHeight;
-    int height = iteminfo.image.height();
-    if (abs((width - height) * 10 / width) >= 1) {
-        QRect rect = iteminfo.image.rect();
-        int x = rect.x() + width / 2;
-        int y = rect.y() + height / 2;
-        if (width > height) {
-            x = x - height / 2;
-            y = 0;
-            iteminfo.image = iteminfo.image.copy(x, y, height, height);
-        } else {
-            y = y - width / 2;
-            x = 0;
-            iteminfo.image = iteminfo.image.copy(x, y, width, width);
-        }
-    }
-}
-
 void ThumbnailListView::calgridItems()
 {
-    int i_totalwidth = width() - 30;
-    rowSizeHint = i_totalwidth / (m_iBaseHeight + ITEM_SPACING);//计算一行能放几个
-    int currentwidth = (i_totalwidth - ITEM_SPACING * (rowSizeHint - 1)) / rowSizeHint;//一张图的宽度
-    m_onePicWidth = currentwidth;
-    if (currentwidth < 1)
+    calgridItemsWidth();
+    if (m_onePicWidth < 1)
         return;
-
-    QList<QList<ItemInfo>> gridItem;//所有
-    QList<ItemInfo> rowList;//一行
-    gridItem.clear();
-    rowList.clear();
-    int index = 0;
-    int totlelength = m_allItemLeft.size();//待处理
-    for (int i = 0; i < totlelength; i++) {
-        m_allItemLeft[i].width = currentwidth;
-        m_allItemLeft[i].height = currentwidth;
-        m_allItemLeft[i].imgHeight = currentwidth;
-        m_allItemLeft[i].imgWidth = currentwidth;
-        if (index < rowSizeHint) {
-            rowList << m_allItemLeft[i];
-            index ++;
-        } else {
-            index = 1;
-            gridItem << rowList;
-            rowList.clear();
-            rowList << m_allItemLeft[i];
-        }
-    }
-    m_allItemLeft.clear();
-    if (rowList.size() > 0) {
-        gridItem << rowList;
-        rowList.clear();
-    }
-    addThumbnailViewNew(gridItem);
-    if (gridItem.size() > 0) {
+    addThumbnailViewNew(m_allItemLeft);
+    if (!m_allItemLeft.isEmpty()) {
         bfirstload = false;
     }
+    m_allItemLeft.clear();
 }
 
-void ThumbnailListView::calBasePixMapWidth()
-{
-    int i_totalwidth = width() - 30;
-    for (int i = 0; i < m_ItemList.length(); i++) {
-        m_ItemList[i].width = m_iBaseHeight;
-        m_ItemList[i].height = m_iBaseHeight;
-        if (m_ItemList[i].width > i_totalwidth) {
-            m_ItemList[i].height = i_totalwidth / 4;
-            m_ItemList[i].width = i_totalwidth / 4;
-        }
-        m_ItemList[i].imgHeight = m_ItemList[i].height;
-        m_ItemList[i].imgWidth = m_ItemList[i].width;
-    }
-}
-
+//同步布局的宽度和行高，之前算过的布局会被复用，只有真正变化时视图才重新取格子大小
 void ThumbnailListView::calgridItemsWidth()
 {
     int i_totalwidth = width() - 30;
-    QList<ItemInfo> oneRowList;
     //计算一行的个数
     rowSizeHint = i_totalwidth / (m_iBaseHeight + ITEM_SPACING);
-    int currentwidth = (i_totalwidth - ITEM_SPACING * (rowSizeHint - 1)) / rowSizeHint;//一张图的宽度
-    m_onePicWidth = currentwidth;
-    if (currentwidth < 80)
-        currentwidth = 80;
-
-    for (int i = 0; i < m_gridItem.length(); i++) {
-        for (int j = 0 ; j < m_gridItem[i].length(); j++) {
-            m_gridItem[i][j].width = currentwidth;
-            m_gridItem[i][j].height = currentwidth;
-            m_gridItem[i][j].imgHeight = currentwidth;
-            m_gridItem[i][j].imgWidth = currentwidth;
-        }
+    if (rowSizeHint < 1) {
+        m_onePicWidth = 0;
+        return;
     }
-    if (0 < m_gridItem.size()) {
-        m_height = 0;
-        int index = 0;//当前一个list所有照片数量
-        for (int i = 0; i < m_gridItem.size(); i++) {
-            for (int j = 0; j < m_gridItem[i].size(); j++) {
-                index ++;
-            }
-        }
-        int m_row = 0;//当前一个list的行数
-        if (index % rowSizeHint == 0)
-            m_row = index / rowSizeHint;
-        else
-            m_row = index / rowSizeHint + 1;
+    m_onePicWidth = (i_totalwidth - ITEM_SPACING * (rowSizeHint - 1)) / rowSizeHint;//一张图的宽度
+    m_model->setGeometry(i_totalwidth, m_iBaseHeight, ITEM_SPACING);
+    calListHeight();
+}
 
-        m_height = (m_gridItem[0][0].height + ITEM_SPACING) * m_row;
-        m_height -= ITEM_SPACING;
+//按已加载和待加载的图片总数计算列表高度，数量来自数据库，加载过程中布局不再变化
+void ThumbnailListView::calListHeight()
+{
+    const int total = m_model->rowCount() + m_allNeedRequestFilesCount;//当前一个list所有照片数量
+    if (total < 1 || rowSizeHint < 1) {
+        return;
     }
+    m_height = m_model->layout().estimatedHeight(total);
 }
 
 void ThumbnailListView::setCurrentSelectPath()
@@ -1928,25 +1628,24 @@ void ThumbnailListView::setCurrentSelectPath()
     m_currentDeletePath.clear();
     m_selectPrePath = "";
 
-    int row;//最后选中的索引
-    for (int i = 0; i < selectionModel()->selectedIndexes().size(); i++) {
-        QModelIndex index = selectionModel()->selectedIndexes().at(i);
-        m_currentDeletePath.append(index.model()->data(index, Qt::DisplayRole).toList().at(1).toString());
-        if (i == selectionModel()->selectedIndexes().size() - 1) {
-            row = index.row();
-            while (m_currentDeletePath.contains(index.model()->data(index, Qt::DisplayRole).toList().at(1).toString())) {
-                if (row > 0) {
-                    row -= 1;
-                    QModelIndex indextemp = index.model()->index(row, 0);
-                    if (indextemp.isValid()) {
-                        m_selectPrePath = indextemp.data(Qt::DisplayRole).toList().at(1).toString();
-                    }
-                } else {
-                    break;
-                }
-                if (!m_currentDeletePath.contains(m_selectPrePath))
-                    break;
-            }
+    const QModelIndexList indexes = selectionModel()->selectedIndexes();
+    if (indexes.isEmpty()) {
+        return;
+    }
+    QSet<QString> selected;
+    for (const QModelIndex &index : indexes) {
+        const QString path = index.data(ThumbnailModel::PathRole).toString();
+        m_currentDeletePath.append(path);
+        selected.insert(path);
+    }
+    //最后选中的索引之前第一张未选中的图片
+    for (int row = indexes.last().row() - 1; row >= 0; row--) {
+        if (m_model->isHeader(row)) {
+            continue;
+        }
+        m_selectPrePath = m_model->pathAt(row);
+        if (!selected.contains(m_selectPrePath)) {
+            break;
         }
     }
 }
@@ -1987,5 +1686,7 @@ bool ThumbnailListView::isLoading()
 
 bool ThumbnailListView::isAllPicSeleted()
 {
-    return getAllPaths().count() == selectedPaths().count();
+    //标题行不可选中，按选区计数即可，不必取出全部路径
+    const int photos = m_model->rowCount() - m_model->headerRows().size();
+    return selectedCount(0, m_model->rowCount() - 1) == photos;
 }
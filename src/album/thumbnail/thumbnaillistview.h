@@ -18,6 +18,7 @@
 #define THUMBNAILLISTVIEW_H
 
 #include "thumbnaildelegate.h"
+#include "thumbnailmodel.h"
 //#include "application.h"
 #include "controller/configsetter.h"
 #include "controller/signalmanager.h"
@@ -29,6 +30,7 @@
 #include <QListWidgetItem>
 #include <QListView>
 #include <QList>
+#include <QSet>
 #include <DPushButton>
 #include <DImageButton>
 #include <DIconButton>
@@ -39,11 +41,11 @@
 #include <DLabel>
 #include <QFileInfo>
 #include <QSize>
-#include <QStandardItemModel>
 #include <QBuffer>
 #include <DMenu>
 #include <QMouseEvent>
 #include <QPointer>
+#include <QElapsedTimer>
 #include <DApplicationHelper>
 #include "imageengine/imageengineobject.h"
 #include "widgets/timelineitem.h"
@@ -82,7 +84,8 @@ public:
         IdSubMenu,
         IdSeparator,
         IdTrashRecovery,
-        IdDrawingBoard//lmh0407画板
+        IdDrawingBoard,//lmh0407画板
+        IdSelectSimilar
     };
 
     struct ItemInfo {
@@ -95,16 +98,11 @@ public:
         int imgWidth = 0;
         int imgHeight = 0;
         QString remainDays = "30天";
-        QPixmap image = QPixmap();
         bool bNotSupportedOrDamaged = false;
 
-
         friend bool operator== (const ItemInfo &left, const ItemInfo &right)
         {
-
-            if (left.image == right.image)
-                return true;
-            return false;
+            return left.path == right.path;
         }
     };
 
@@ -116,12 +114,22 @@ public:
     void loadFilesFromLocal(DBImgInfoList files, bool needcache = true, bool needcheck = true);
     void loadFilesFromTrash(DBImgInfoList files);
     void loadFilesFromDB(QString name = "", int loadCount = 0);
+    //时间线类视图：按分组一次性填入标题行和占位行，缩略图加载完成后原位更新
+    void loadSections(const QStringList &titles, const QList<DBImgInfoList> &sections, int headerHeight);
+    bool isSectionSelected(int headerRow) const;
+    //[first, last]中被选中的行数
+    int selectedCount(int first, int last) const;
+    void setSectionSelected(int headerRow, bool selected);
+    //视口顶部所在分组的标题行
+    int sectionAtTop() const;
     bool imageLocalLoaded(QStringList &filelist) override;
     bool imageFromDBLoaded(QStringList &filelist) override;
     bool imageLoaded(QString filepath) override;
     void insertThumbnail(const ItemInfo &iteminfo);
     void stopLoadAndClear(bool bClearModel = true);    //为true则清除模型中的数据
     QStringList getAllFileList();
+    //列表顶部一屏内的图片，按显示顺序，用于保存首屏快照
+    QStringList firstScreenPaths() const;
     void setIBaseHeight(int iBaseHeight);
     bool checkResizeNum();
     bool isLoading();
@@ -139,9 +147,14 @@ public:
     void selectExtent(int start, int end);
     void resizeHand();  //手动发送信号，计算大小
     void setListViewUseFor(ListViewUseFor usefor);
+    //按路径批量选中，取代原有的逐行比较
     void selectDuplicateForOneListView(QStringList paths, QModelIndex &firstIndex);
     void selectDuplicatePhotos(QStringList paths, bool bMultiListView = false);
+    //选中与path感知哈希相近的照片(连拍、近似重复)
+    void selectSimilarPhotos(const QString &path);
     void updateModelRoleData(QString albumName, int actionType);
+    //按actionType同步rows所属的相册
+    void updateAlbumNames(const QVector<int> &rows, const QString &albumName, int actionType);
     void selectFirstPhoto();
     bool isFirstPhotoSelected();
     bool isNoPhotosSelected();
@@ -171,6 +184,7 @@ signals:
 
     void sigLoad80ThumbnailsFinish();
     void sigMoveToTrash();
+    void sigSectionSelectionChanged();
 
 protected:
     void mousePressEvent(QMouseEvent *event) Q_DECL_OVERRIDE;
@@ -188,9 +202,11 @@ private slots:
     void onShowMenu(const QPoint &pos);
     void onPixMapScale(int value);
     void onCancelFavorite(const QModelIndex &index);
+    void onSectionChoseClicked(const QModelIndex &index);
     void onTimerOut();
     void resizeEventF();
     void sltChangeDamagedPixOnThemeChanged();
+    void onScrollSettled();
 
 public slots:
     void slotReCalcTimelineSize();
@@ -206,24 +222,27 @@ public:
 private:
     //------------------
     void requestSomeImages();
+    //按上一批的耗时调整下一批请求的数量
+    void adaptRequestBatch();
+    //由滚动条位置的变化估计滚动速度
+    void updateScrollSpeed(int value);
+    //把视口附近尚未请求的缩略图移到待请求队列前面
+    void prioritizeVisibleRows();
+    //加入待请求缩略图的队列
+    void queueFiles(const QStringList &files);
     //------------------
 
     void initConnections();
     //------------------
-    void calBasePixMap(ItemInfo &info);
-    void calBasePixMapWandH();
-    void calWidgetItem();
-    void calWidgetItemWandH();
-    void addThumbnailViewNew(QList<QList<ItemInfo>> gridItem);
+    void addThumbnailViewNew(const QList<ItemInfo> &items);
     void addThumbnailView();
     void sendNeedResize(/*int height*/);
 
 public:
     // zy 新算法
-    void modifyAllPic(ItemInfo &info);
-    void cutPixmap(ItemInfo &iteminfo);
+    ThumbnailModel::Item modelItem(const ItemInfo &info) const;
     void calgridItems();
-    void calBasePixMapWidth();
+    void calListHeight();
     void calgridItemsWidth();
     void setCurrentSelectPath();
 
@@ -246,14 +265,12 @@ private:
 public:
     ListViewUseFor m_useFor = Normal;
     QString m_imageType;
-    QStandardItemModel *m_model = nullptr;
+    ThumbnailModel *m_model = nullptr;
 
 private:
     int m_iDefaultWidth = 0;
     int m_iBaseHeight = 0;
 
-    QList<ItemInfo> m_ItemList;
-    QList<QList<ItemInfo>> m_gridItem;
     ThumbnailDelegate *m_delegate = nullptr;
 
     DMenu *m_pMenu = nullptr;
@@ -267,9 +284,9 @@ private:
     //------------------
     QStringList m_allfileslist;
     QStringList m_filesbeleft;
+    QSet<QString> m_filesbeleftSet;     //m_filesbeleft中尚未请求的路径
     bool bneedloadimage = true;
     bool brequestallfiles = false;
-    QList<ItemInfo> m_ItemListLeft;
     int m_requestCount = 0;
     int m_allNeedRequestFilesCount = 0;
     bool blastload = false;
@@ -278,6 +295,16 @@ private:
     int m_scrollbartopdistance = 0;
     int m_scrollbarbottomdistance = 0;
     QListWidgetItem *m_item = nullptr;
+    bool m_sectioned = false;   //模型中含分组标题，行在加载前已全部插入
+    int m_anchorRow = -1;       //shift连选的起点
+    int m_requestBatch = 0;     //每批请求的缩略图数，随解码吞吐调整
+    int m_batchSize = 0;        //在途一批的数量
+    QElapsedTimer m_batchClock;
+    QElapsedTimer m_scrollClock;
+    int m_lastScrollValue = 0;
+    qreal m_scrollSpeed = 0;    //像素/毫秒，平滑后的值
+    bool m_flinging = false;    //快速滑动中，暂停请求缩略图
+    QTimer *m_settleTimer = nullptr;
     QTimer *m_dt = nullptr;
     bool bneedsendresize = false;
     int lastresizeheight = 0;
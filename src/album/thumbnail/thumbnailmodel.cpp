@@ -0,0 +1,435 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "thumbnailmodel.h"
+#include "imageengine/imageengineapi.h"
+#include "dbmanager/dbmanager.h"
+#include "utils/imageutils.h"
+
+#include <QPixmapCache>
+#include <DApplicationHelper>
+
+#include <algorithm>
+
+DWIDGET_USE_NAMESPACE
+
+bool ThumbnailModel::Item::sameContent(const Item &other) const
+{
+    return path == other.path && qFuzzyCompare(aspect, other.aspect)
+           && baseSize == other.baseSize && damaged == other.damaged
+           && remainDays == other.remainDays && name == other.name
+           && header == other.header && sectionCount == other.sectionCount
+           && previewColor == other.previewColor;
+}
+
+ThumbnailModel::Item ThumbnailModel::Item::sectionHeader(const QString &title, int count)
+{
+    Item item;
+    item.name = title;
+    item.header = true;
+    item.sectionCount = count;
+    item.aspect = 0;
+    return item;
+}
+
+ThumbnailModel::ThumbnailModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int ThumbnailModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_items.size();
+}
+
+Qt::ItemFlags ThumbnailModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        return Qt::ItemIsDropEnabled;
+    }
+    if (isHeader(index.row())) {
+        return Qt::ItemIsEnabled;
+    }
+    return Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemIsDragEnabled | Qt::ItemIsDropEnabled;
+}
+
+QVariant ThumbnailModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_items.size()) {
+        return QVariant();
+    }
+    const Item &item = m_items.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case NameRole:
+        return item.name;
+    case PathRole:
+        return item.path;
+    case Qt::SizeHintRole:
+    case ImageSizeRole:
+        return m_layout.itemSize(index.row());
+    case BaseSizeRole:
+        return item.baseSize;
+    case RemainDaysRole:
+        return item.remainDays;
+    case DamagedRole:
+        return item.damaged;
+    case PixmapRole:
+        if (item.header) {
+            return QPixmap();
+        }
+        return thumbnail(item.path, item.damaged);
+    case HeaderRole:
+        return item.header;
+    case SectionCountRole:
+        return item.sectionCount;
+    case PreviewColorRole:
+        return item.previewColor;
+    case AlbumNamesRole:
+        if (item.header) {
+            return QStringList();
+        }
+        //查询相册缓存，只在右键菜单等需要时发生
+        if (!item.albumNamesLoaded) {
+            item.albumNames = DBManager::instance()->getAlbumNamesByPath(item.path);
+            item.albumNamesLoaded = true;
+        }
+        return item.albumNames;
+    default:
+        return QVariant();
+    }
+}
+
+bool ThumbnailModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (!index.isValid() || index.row() >= m_items.size() || AlbumNamesRole != role) {
+        return false;
+    }
+    Item &item = m_items[index.row()];
+    item.albumNames = value.toStringList();
+    item.albumNamesLoaded = true;
+    emit dataChanged(index, index, QVector<int>() << role);
+    return true;
+}
+
+bool ThumbnailModel::removeRows(int row, int count, const QModelIndex &parent)
+{
+    if (parent.isValid() || row < 0 || count < 1 || row + count > m_items.size()) {
+        return false;
+    }
+    beginRemoveRows(QModelIndex(), row, row + count - 1);
+    m_items.remove(row, count);
+    m_layout.remove(row, count);
+    rebuildHeaderRows();
+    //后面的行号都已变化，下次查找时重建
+    m_rowIndexDirty = true;
+    endRemoveRows();
+    //后面的图片可能移到上一行
+    emitGeometryChanged(row);
+    return true;
+}
+
+void ThumbnailModel::appendItems(const QVector<Item> &items)
+{
+    if (items.isEmpty()) {
+        return;
+    }
+    const int first = m_items.size();
+    QVector<float> aspects;
+    aspects.reserve(items.size());
+    for (const Item &item : items) {
+        aspects << item.aspect;
+    }
+    //原来的最后一行可能被补满，行高随之变化
+    const int lastRow = m_layout.rowOf(first - 1);
+    const int lastRowFirst = m_layout.firstInRow(lastRow);
+    beginInsertRows(QModelIndex(), first, first + items.size() - 1);
+    m_items << items;
+    m_layout.append(aspects);
+    for (int i = first; i < m_items.size(); i++) {
+        if (m_items.at(i).header) {
+            m_headerRows << i;
+        } else if (!m_rowIndexDirty && !m_rowIndex.contains(m_items.at(i).path)) {
+            m_rowIndex.insert(m_items.at(i).path, i);
+        }
+    }
+    endInsertRows();
+    if (lastRowFirst >= 0) {
+        emit dataChanged(index(lastRowFirst), index(first - 1), QVector<int>() << Qt::SizeHintRole << ImageSizeRole);
+    }
+}
+
+void ThumbnailModel::setItems(const QVector<Item> &items)
+{
+    const int common = qMin(m_items.size(), items.size());
+    //连续变化的行合并为一次dataChanged
+    int first = -1;
+    int firstResized = -1;
+    for (int i = 0; i < common; i++) {
+        if (m_items.at(i).sameContent(items.at(i))) {
+            if (first >= 0) {
+                emitChanged(first, i - 1);
+                first = -1;
+            }
+            continue;
+        }
+        //同一张图片保留已查询的相册
+        Item item = items.at(i);
+        if (item.path == m_items.at(i).path && !item.albumNamesLoaded) {
+            item.albumNamesLoaded = m_items.at(i).albumNamesLoaded;
+            item.albumNames = m_items.at(i).albumNames;
+        }
+        if (!qFuzzyCompare(item.aspect, m_items.at(i).aspect)) {
+            m_layout.setAspect(i, item.aspect);
+            if (firstResized < 0) {
+                firstResized = i;
+            }
+        }
+        m_items[i] = item;
+        m_rowIndexDirty = true;
+        if (first < 0) {
+            first = i;
+        }
+    }
+    if (first >= 0) {
+        emitChanged(first, common - 1);
+    }
+    rebuildHeaderRows();
+    if (firstResized >= 0) {
+        emitGeometryChanged(firstResized);
+    }
+    if (items.size() > common) {
+        appendItems(items.mid(common));
+    } else if (m_items.size() > common) {
+        removeRows(common, m_items.size() - common);
+    }
+}
+
+void ThumbnailModel::setItem(int row, const Item &item)
+{
+    if (row < 0 || row >= m_items.size()) {
+        return;
+    }
+    const bool resized = !qFuzzyCompare(item.aspect, m_items.at(row).aspect);
+    const bool headerChanged = item.header != m_items.at(row).header;
+    if (headerChanged || item.path != m_items.at(row).path) {
+        m_rowIndexDirty = true;
+    }
+    m_items[row] = item;
+    m_layout.setAspect(row, item.aspect);
+    if (headerChanged) {
+        rebuildHeaderRows();
+    }
+    emitChanged(row, row);
+    if (resized) {
+        emitGeometryChanged(row);
+    }
+}
+
+void ThumbnailModel::clear()
+{
+    if (m_items.isEmpty()) {
+        return;
+    }
+    beginResetModel();
+    m_items.clear();
+    m_headerRows.clear();
+    m_rowIndex.clear();
+    m_rowIndexDirty = false;
+    m_layout.clear();
+    endResetModel();
+}
+
+bool ThumbnailModel::setGeometry(int width, int rowHeight, int spacing)
+{
+    const int oldSpacing = m_layout.spacing();
+    m_layout.setSpacing(spacing);
+    if (!m_layout.setGeometry(width, rowHeight) && oldSpacing == spacing) {
+        return false;
+    }
+    emitGeometryChanged(0);
+    return true;
+}
+
+void ThumbnailModel::setHeaderHeight(int height)
+{
+    if (height == m_layout.headerHeight()) {
+        return;
+    }
+    m_layout.setHeaderHeight(height);
+    if (!m_headerRows.isEmpty()) {
+        emitGeometryChanged(m_headerRows.first());
+    }
+}
+
+const JustifiedLayout &ThumbnailModel::layout() const
+{
+    return m_layout;
+}
+
+const ThumbnailModel::Item &ThumbnailModel::item(int row) const
+{
+    return m_items.at(row);
+}
+
+QString ThumbnailModel::pathAt(int row) const
+{
+    return (row >= 0 && row < m_items.size()) ? m_items.at(row).path : QString();
+}
+
+int ThumbnailModel::rowOf(const QString &path) const
+{
+    if (path.isEmpty()) {
+        return -1;
+    }
+    ensureRowIndex();
+    return m_rowIndex.value(path, -1);
+}
+
+QVector<int> ThumbnailModel::rowsOf(const QStringList &paths) const
+{
+    ensureRowIndex();
+    QVector<int> rows;
+    rows.reserve(paths.size());
+    for (const QString &path : paths) {
+        const int row = m_rowIndex.value(path, -1);
+        if (row >= 0) {
+            rows << row;
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    return rows;
+}
+
+QItemSelection ThumbnailModel::selectionOf(const QStringList &paths) const
+{
+    const QVector<int> rows = rowsOf(paths);
+    QItemSelection selection;
+    int i = 0;
+    while (i < rows.size()) {
+        int j = i;
+        while (j + 1 < rows.size() && rows.at(j + 1) == rows.at(j) + 1) {
+            j++;
+        }
+        selection.append(QItemSelectionRange(index(rows.at(i)), index(rows.at(j))));
+        i = j + 1;
+    }
+    return selection;
+}
+
+bool ThumbnailModel::isHeader(int row) const
+{
+    return row >= 0 && row < m_items.size() && m_items.at(row).header;
+}
+
+int ThumbnailModel::sectionOf(int row) const
+{
+    if (row < 0 || row >= m_items.size()) {
+        return -1;
+    }
+    auto it = std::upper_bound(m_headerRows.constBegin(), m_headerRows.constEnd(), row);
+    return it == m_headerRows.constBegin() ? -1 : *(it - 1);
+}
+
+int ThumbnailModel::sectionEnd(int headerRow) const
+{
+    auto it = std::upper_bound(m_headerRows.constBegin(), m_headerRows.constEnd(), headerRow);
+    return it == m_headerRows.constEnd() ? m_items.size() - 1 : *it - 1;
+}
+
+const QVector<int> &ThumbnailModel::headerRows() const
+{
+    return m_headerRows;
+}
+
+void ThumbnailModel::refreshDamaged()
+{
+    for (int i = 0; i < m_items.size(); i++) {
+        if (m_items.at(i).damaged) {
+            emit dataChanged(index(i), index(i), QVector<int>() << PixmapRole);
+        }
+    }
+}
+
+void ThumbnailModel::emitChanged(int first, int last)
+{
+    emit dataChanged(index(first), index(last));
+}
+
+void ThumbnailModel::rebuildHeaderRows()
+{
+    m_headerRows.clear();
+    for (int i = 0; i < m_items.size(); i++) {
+        if (m_items.at(i).header) {
+            m_headerRows << i;
+        }
+    }
+}
+
+void ThumbnailModel::ensureRowIndex() const
+{
+    if (!m_rowIndexDirty) {
+        return;
+    }
+    m_rowIndex.clear();
+    m_rowIndex.reserve(m_items.size());
+    //倒序插入，同一路径出现多次时保留最前面的行
+    for (int i = m_items.size() - 1; i >= 0; i--) {
+        if (!m_items.at(i).header) {
+            m_rowIndex.insert(m_items.at(i).path, i);
+        }
+    }
+    m_rowIndexDirty = false;
+}
+
+void ThumbnailModel::emitGeometryChanged(int first)
+{
+    if (first < m_items.size()) {
+        emit dataChanged(index(first), index(m_items.size() - 1), QVector<int>() << Qt::SizeHintRole << ImageSizeRole);
+    }
+}
+
+QPixmap ThumbnailModel::thumbnail(const QString &path, bool damaged)
+{
+    if (damaged) {
+        return utils::image::getDamagePixmap(DApplicationHelper::instance()->themeType() == DApplicationHelper::LightType);
+    }
+    ImageDataSt data;
+    if (!ImageEngineApi::instance()->getImageData(path, data) || data.imgpixmap.isNull()) {
+        return QPixmap();
+    }
+    const QPixmap &source = data.imgpixmap;
+    const int width = source.width();
+    const int height = source.height();
+    //宽高相差不到一成时直接使用
+    if (abs((width - height) * 10 / width) < 1) {
+        return source;
+    }
+    //以缩略图的cacheKey为键，图片旋转等替换缩略图后自动失效
+    const QString key = QStringLiteral("albumthumb_%1").arg(source.cacheKey());
+    QPixmap cropped;
+    if (QPixmapCache::find(key, &cropped)) {
+        return cropped;
+    }
+    if (width > height) {
+        cropped = source.copy((width - height) / 2, 0, height, height);
+    } else {
+        cropped = source.copy(0, (height - width) / 2, width, width);
+    }
+    QPixmapCache::insert(key, cropped);
+    return cropped;
+}
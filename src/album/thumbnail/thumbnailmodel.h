@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef THUMBNAILMODEL_H
+#define THUMBNAILMODEL_H
+
+#include "justifiedlayout.h"
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QItemSelection>
+#include <QPixmap>
+#include <QSize>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief The ThumbnailModel class
+ * 缩略图列表的模型，每行只保存路径和宽高比，不持有图片。
+ * 缩略图在绘制时按路径从缩略图缓存中取出并裁剪，裁剪结果放入QPixmapCache；所属相册在首次使用时查询。
+ * 格子大小由内部的JustifiedLayout给出，缩放和调整宽度时只需切换布局，不再逐行改写数据。
+ * setItems()只对变化的行发出dataChanged，行数不变时不重置模型，选中状态得以保留。
+ * 时间线类视图在同一个模型中插入分组标题行，标题行不可选中，按行号二分查找所在分组。
+ * 路径到行号的索引随追加增量维护，删除或整体替换后在下次查找时重建。
+ */
+class ThumbnailModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    enum Roles {
+        AlbumNamesRole = Qt::UserRole + 2,  //所属相册，沿用原有的角色值
+        PathRole = Qt::UserRole + 16,
+        NameRole,
+        PixmapRole,         //裁剪后的缩略图
+        ImageSizeRole,      //图片绘制区域大小
+        BaseSizeRole,       //原始缩略图大小
+        RemainDaysRole,     //最近删除中的剩余天数
+        DamagedRole,        //不支持或已损坏
+        HeaderRole,         //是否为分组标题
+        SectionCountRole,   //分组标题下的图片数
+        PreviewColorRole,   //缩略图未加载时的占位主色，0表示没有
+    };
+
+    //行以路径而不是PhotoCatalog的id标识：最近删除和设备导入列表中的图片不在图库目录中，
+    //信号、数据库接口和缩略图缓存也都以路径为键，且id只在两次load()之间有效
+    struct Item {
+        QString path;
+        QString name;
+        QString remainDays;
+        QSize baseSize;
+        float aspect = 1.0f;    //布局使用的宽高比，缩略图裁剪为正方形时为1
+        bool damaged = false;
+        bool header = false;    //分组标题，name为标题文字
+        int sectionCount = 0;
+        quint32 previewColor = 0;   //图库中记录的缩略图主色
+        mutable bool albumNamesLoaded = false;
+        mutable QStringList albumNames;
+
+        //只比较影响显示的字段
+        bool sameContent(const Item &other) const;
+        static Item sectionHeader(const QString &title, int count);
+    };
+
+    explicit ThumbnailModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+    //设置可用宽度、目标行高和间距，布局变化时通知视图重新取格子大小
+    bool setGeometry(int width, int rowHeight, int spacing);
+    void setHeaderHeight(int height);
+    const JustifiedLayout &layout() const;
+
+    void appendItems(const QVector<Item> &items);
+    //用items替换全部行：路径相同的行只在布局变化时更新，多出或缺少的行在末尾插入或删除
+    void setItems(const QVector<Item> &items);
+    void setItem(int row, const Item &item);
+    void clear();
+
+    const Item &item(int row) const;
+    QString pathAt(int row) const;
+    int rowOf(const QString &path) const;
+    //批量查找，不在模型中的路径跳过；结果按行号升序
+    QVector<int> rowsOf(const QStringList &paths) const;
+    //paths所在行合并为连续区间的选区，用于一次性选中大量图片
+    QItemSelection selectionOf(const QStringList &paths) const;
+    bool isHeader(int row) const;
+    //row所在分组的标题行，不在任何分组中时返回-1
+    int sectionOf(int row) const;
+    //分组的最后一行
+    int sectionEnd(int headerRow) const;
+    const QVector<int> &headerRows() const;
+    //主题切换后重新取损坏图标
+    void refreshDamaged();
+
+    //按路径取正方形裁剪后的缩略图，damaged为true时返回当前主题的损坏图标
+    static QPixmap thumbnail(const QString &path, bool damaged);
+
+private:
+    void emitChanged(int first, int last);
+    void emitGeometryChanged(int first);
+    void rebuildHeaderRows();
+    void ensureRowIndex() const;
+
+    QVector<Item> m_items;
+    QVector<int> m_headerRows;      //标题行号，升序
+    mutable QHash<QString, int> m_rowIndex;     //路径到行号
+    mutable bool m_rowIndexDirty = false;
+    JustifiedLayout m_layout;
+};
+
+#endif // THUMBNAILMODEL_H
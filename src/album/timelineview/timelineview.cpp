@@ -2,6 +2,7 @@
 #include "utils/baseutils.h"
 #include "utils/imageutils.h"
 #include "imageengine/imageengineapi.h"
+#include "dbmanager/dbasyncmanager.h"
 #include "mainwindow.h"
 #include "ac-desktop-define.h"
 #include <QScrollBar>
@@ -23,18 +24,18 @@ const int VIEW_SEARCH = 2;
 const int VIEW_MAINWINDOW_TIMELINE = 1;
 const int TITLEHEIGHT = 50;
 const int TIMELINE_TITLEHEIGHT = 32;
+const int TIMELINE_HEADERHEIGHT = 87;   //日期标题行高度
+const int BOTTOM_MARGIN = 27;           //给状态栏留出的空白
 } //namespace
 
 TimeLineView::TimeLineView()
-    : m_mainListWidget(nullptr), m_mainLayout(nullptr), m_dateItem(nullptr)
+    : m_mainLayout(nullptr), m_dateItem(nullptr)
     , pSuspensionChose(nullptr)
     , allnum(0), m_pDate(nullptr), pNum_up(nullptr)
-    , pNum_dn(nullptr), m_oe(nullptr), m_oet(nullptr)
-    , m_ctrlPress(false), lastClickedIndex(0), lastRow(-1)
-    , lastChanged(false), fatherwidget(nullptr), m_pStackedWidget(nullptr)
+    , m_oe(nullptr), m_oet(nullptr)
+    , m_ctrlPress(false), fatherwidget(nullptr), m_pStackedWidget(nullptr)
     , m_pStatusBar(nullptr), pSearchView(nullptr), pImportView(nullptr), pTimeLineViewWidget(nullptr)
-    , m_pwidget(nullptr), m_index(0), m_selPicNum(0), m_spinner(nullptr)
-    , currentTimeLineLoad(0)
+    , m_timelineView(nullptr), m_pwidget(nullptr), m_index(0), m_selPicNum(0), m_spinner(nullptr)
 {
     setAcceptDrops(true);
     fatherwidget = new QWidget(this);
@@ -48,6 +49,7 @@ TimeLineView::TimeLineView()
     pTimeLineViewWidget = new QWidget();
     pImportView = new ImportView();
     pSearchView = new SearchView();
+    connect(pSearchView, &SearchView::sigSearchFinished, this, &TimeLineView::restorePicNum);
     m_pStackedWidget->addWidget(pImportView);
     m_pStackedWidget->addWidget(pTimeLineViewWidget);
     m_pStackedWidget->addWidget(pSearchView);
@@ -78,9 +80,6 @@ void TimeLineView::initConnections()
     connect(dApp->signalM, &SignalManager::imagesInserted, this, &TimeLineView::clearAndStartLayout);
     connect(dApp->signalM, &SignalManager::imagesRemoved, this, &TimeLineView::clearAndStartLayout);
     connect(dApp, &Application::sigFinishLoad, this, &TimeLineView::onFinishLoad);
-    connect(m_mainListWidget, &TimelineListWidget::sigNewTime, this, &TimeLineView::onNewTime);
-//    connect(m_mainListWidget, &TimelineListWidget::sigDelTime, this, &TimeLineView::on_DelLabel);//未使用
-    connect(m_mainListWidget, &TimelineListWidget::sigMoveTime, this, &TimeLineView::on_MoveLabel);
     connect(dApp->signalM, &SignalManager::sigUpdateImageLoader, this, &TimeLineView::updataLayout);
     connect(m_pStatusBar->m_pSlider, &DSlider::valueChanged, dApp->signalM, &SignalManager::sigMainwindowSliderValueChg);
     connect(pSearchView->m_pThumbnailListView, &ThumbnailListView::clicked, this, &TimeLineView::updatePicNum);
@@ -90,6 +89,97 @@ void TimeLineView::initConnections()
     connect(dApp->signalM, &SignalManager::sigShortcutKeyDelete, this, &TimeLineView::onKeyDelete);
     // 重复导入图片选中
     connect(dApp->signalM, &SignalManager::RepeatImportingTheSamePhotos, this, &TimeLineView::onRepeatImportingTheSamePhotos);
+
+    //悬浮标题跟随滚动位置
+    connect(m_timelineView->verticalScrollBar(), &QScrollBar::valueChanged, this, &TimeLineView::updateDateItem);
+    connect(m_timelineView, &ThumbnailListView::openImage, this, [ = ](int index) {
+        SignalManager::ViewInfo info;
+        info.album = "";
+        info.lastPanel = nullptr;
+        //与原来一样只在当天的图片中浏览
+        const QStringList paths = sectionPaths(index);
+        if (paths.size() > 1) {
+            info.paths = paths;
+        }
+        info.path = m_timelineView->m_model->pathAt(index);
+        info.viewType = utils::common::VIEW_TIMELINE_SRN;
+        info.viewMainWindowID = VIEW_MAINWINDOW_TIMELINE;
+        emit dApp->signalM->viewImage(info);
+        emit dApp->signalM->showImageView(VIEW_MAINWINDOW_TIMELINE);
+    });
+    connect(m_timelineView, &ThumbnailListView::menuOpenImage, this, [ = ](QString path, QStringList paths, bool isFullScreen, bool isSlideShow) {
+        SignalManager::ViewInfo info;
+        info.album = "";
+        info.lastPanel = nullptr;
+        const QStringList photolist = sectionPaths(m_timelineView->m_model->rowOf(path));
+        if (paths.size() > 1) {
+            info.paths = paths;
+        } else if (photolist.size() > 1) {
+            info.paths = photolist;
+        }
+        info.path = path;
+        info.fullScreen = isFullScreen;
+        info.slideShow = isSlideShow;
+        info.viewType = utils::common::VIEW_TIMELINE_SRN;
+        info.viewMainWindowID = VIEW_MAINWINDOW_TIMELINE;
+        if (info.slideShow) {
+            if (photolist.count() == 1) {
+                info.paths = paths;
+            }
+
+            QStringList pathlist;
+            pathlist.clear();
+            for (auto path : info.paths) {
+                if (QFileInfo(path).exists()) {
+                    pathlist << path;
+                }
+            }
+
+            info.paths = pathlist;
+            emit dApp->signalM->startSlideShow(info);
+            emit dApp->signalM->showSlidePanel(VIEW_MAINWINDOW_TIMELINE);
+        } else {
+            emit dApp->signalM->viewImage(info);
+            emit dApp->signalM->showImageView(VIEW_MAINWINDOW_TIMELINE);
+        }
+    });
+    connect(m_timelineView, &ThumbnailListView::sigGetSelectedPaths, this, &TimeLineView::on_GetSelectedPaths);
+    connect(m_timelineView, &ThumbnailListView::sigMousePress, this, [ = ](QMouseEvent * event) {
+        if (event->button() == Qt::LeftButton) {
+            m_ctrlPress = false;
+        }
+    });
+    connect(m_timelineView, &ThumbnailListView::sigCtrlMousePress, this, [ = ] {
+        m_ctrlPress = true;
+    });
+    //连选已在列表内按行号完成，这里只刷新计数
+    connect(m_timelineView, &ThumbnailListView::sigShiftMousePress, this, [ = ] {
+        updatePicNum();
+        updateChoseText();
+    });
+    connect(m_timelineView, &ThumbnailListView::sigSelectAll, this, [ = ] {
+        m_ctrlPress = true;
+        updatePicNum();
+        updateChoseText();
+    });
+    connect(m_timelineView, &ThumbnailListView::sigMouseRelease, this, [ = ] {
+        updatePicNum();
+        updateChoseText();
+    });
+    connect(m_timelineView, &ThumbnailListView::customContextMenuRequested, this, [ = ] {
+        updatePicNum();
+        updateChoseText();
+    });
+    connect(m_timelineView, &ThumbnailListView::sigSectionSelectionChanged, this, [ = ] {
+        m_ctrlPress = true;
+        updatePicNum();
+        updateChoseText();
+    });
+    connect(m_timelineView, &ThumbnailListView::sigMenuItemDeal, this, [ = ](QAction * action) {
+        m_timelineView->menuItemDeal(m_timelineView->selectedPaths(), action);
+    });
+    connect(m_timelineView, &ThumbnailListView::sigMoveToTrash, this, &TimeLineView::onKeyDelete);//跳转
+    connect(m_timelineView, &ThumbnailListView::sigKeyEvent, this, &TimeLineView::on_KeyEvent);
 }
 
 void TimeLineView::themeChangeSlot(DGuiApplicationHelper::ColorType themeType)
@@ -117,37 +207,13 @@ void TimeLineView::themeChangeSlot(DGuiApplicationHelper::ColorType themeType)
         pNum_up->setPalette(pal1);
     }
 
-    for (int i = 1; i < m_mainListWidget->count(); i++) {
-        TimelineItem *item = dynamic_cast<TimelineItem *>(m_mainListWidget->itemWidget(m_mainListWidget->item(i)));
-        QList<DLabel *> pLabelList = item->findChildren<DLabel *>();
-        DPalette color = DApplicationHelper::instance()->palette(pLabelList[0]);
-        color.setBrush(DPalette::Text, color.color(DPalette::ToolTipText));
-        pLabelList[0]->setForegroundRole(DPalette::Text);
-        pLabelList[0]->setPalette(color);
-
-        DPalette pal = DApplicationHelper::instance()->palette(pLabelList[1]);
-        QColor color_BT = pal.color(DPalette::BrightText);
-        DGuiApplicationHelper::ColorType themeType = DGuiApplicationHelper::instance()->themeType();
-        if (themeType == DGuiApplicationHelper::LightType) {
-            color_BT.setAlphaF(0.5);
-            pal.setBrush(DPalette::Text, color_BT);
-            pLabelList[1]->setForegroundRole(DPalette::Text);
-            pLabelList[1]->setPalette(pal);
-        } else if (themeType == DGuiApplicationHelper::DarkType) {
-            color_BT.setAlphaF(0.75);
-            pal.setBrush(DPalette::Text, color_BT);
-            pLabelList[1]->setForegroundRole(DPalette::Text);
-            pLabelList[1]->setPalette(pal);
-        }
-    }
+    //分组标题由代理按当前主题绘制，重绘即可
+    m_timelineView->viewport()->update();
 }
 
 ThumbnailListView *TimeLineView::getFirstListViewFromTimeline()
 {
-    if (m_allThumbnailListView.count() > 0)
-        return m_allThumbnailListView.at(0);
-    else
-        return nullptr;
+    return m_timelineView;
 }
 
 void TimeLineView::updataLayout(QStringList updatePathList)
@@ -156,29 +222,27 @@ void TimeLineView::updataLayout(QStringList updatePathList)
     m_spinner->stop();
     if (updatePathList.isEmpty())
         return;
-    for (ThumbnailListView *list : m_allThumbnailListView) {
-        list->updateThumbnailView(updatePathList.first());
-    }
+    m_timelineView->updateThumbnailView(updatePathList.first());
 }
 
 void TimeLineView::initTimeLineViewWidget()
 {
     m_mainLayout = new QVBoxLayout();
-    m_mainLayout->setContentsMargins(0, 0, 0, 0);
+    m_mainLayout->setContentsMargins(8, TITLEHEIGHT, 0, BOTTOM_MARGIN);
     pTimeLineViewWidget->setLayout(m_mainLayout);
     DPalette palcolor = DApplicationHelper::instance()->palette(pTimeLineViewWidget);
     palcolor.setBrush(DPalette::Window, palcolor.color(DPalette::Base));
     pTimeLineViewWidget->setPalette(palcolor);
-    m_mainListWidget = new TimelineListWidget;
-    m_mainListWidget->setFocusPolicy(Qt::NoFocus);
-    QScrollBar *pHorizontalBar = m_mainListWidget->horizontalScrollBar();
-    pHorizontalBar->setEnabled(false);
-    pHorizontalBar->setVisible(false);
-    m_mainListWidget->setVerticalScrollMode(QListWidget::ScrollPerPixel);
-    m_mainListWidget->verticalScrollBar()->setSingleStep(20);
-    m_mainLayout->addWidget(m_mainListWidget);
-    m_mainListWidget->setResizeMode(QListWidget::Adjust);
-    m_mainListWidget->setFrameShape(DTableView::NoFrame);
+    //所有日期的图片放在同一个列表中，日期标题是不可选中的整行项
+    m_timelineView = new ThumbnailListView(ThumbnailDelegate::TimeLineViewType, COMMON_STR_VIEW_TIMELINE);
+    m_timelineView->setFocusPolicy(Qt::NoFocus);
+    m_timelineView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_timelineView->setContextMenuPolicy(Qt::CustomContextMenu);
+    m_timelineView->setContentsMargins(0, 0, 0, 0);
+    m_timelineView->setFrameShape(DTableView::NoFrame);
+    m_timelineView->setVerticalScrollMode(QListView::ScrollPerPixel);
+    m_timelineView->verticalScrollBar()->setSingleStep(20);
+    m_mainLayout->addWidget(m_timelineView);
 
     //添加悬浮title
     m_dateItem = new QWidget(pTimeLineViewWidget);
@@ -253,7 +317,7 @@ void TimeLineView::initTimeLineViewWidget()
     m_dateItem->setPalette(ppal_light);
     m_dateItem->setGraphicsEffect(opacityEffect_light);
     m_dateItem->setAutoFillBackground(true);
-    m_dateItem->setFixedSize(this->width() - 10, 87);
+    m_dateItem->setFixedSize(this->width() - 10, TIMELINE_HEADERHEIGHT);
     m_dateItem->setContentsMargins(10, 0, 0, 0);
     m_dateItem->move(0, TITLEHEIGHT);
     m_dateItem->show();
@@ -262,11 +326,13 @@ void TimeLineView::initTimeLineViewWidget()
 
 void TimeLineView::updateStackedWidget()
 {
-    if (0 < DBManager::instance()->getImgsCount()) {
-        m_pStackedWidget->setCurrentIndex(VIEW_TIMELINE);
-    } else {
-        m_pStackedWidget->setCurrentIndex(VIEW_IMPORT);
-    }
+    std::function<int()> count = []() {
+        return DBManager::instance()->getImgsCount();
+    };
+    std::function<void(const int &)> callback = [this](const int &count) {
+        m_pStackedWidget->setCurrentIndex(0 < count ? VIEW_TIMELINE : VIEW_IMPORT);
+    };
+    DBAsyncManager::instance()->query(this, count, callback, "TimeLineView::updateStackedWidget");
 }
 
 int TimeLineView::getIBaseHeight()
@@ -304,38 +370,68 @@ int TimeLineView::getIBaseHeight()
 
 void TimeLineView::clearAndStop()
 {
-    for (ThumbnailListView *list : m_allThumbnailListView) {
-        list->stopLoadAndClear();
-        delete list;
-    }
-    m_mainListWidget->clear();
-    m_allThumbnailListView.clear();
-    m_allChoseButton.clear();
-    currentTimeLineLoad = 0;
-
+    m_timelineView->stopLoadAndClear();
+    m_dateItem->setVisible(false);
 }
 
 void TimeLineView::clearAndStartLayout()
 {
     m_spinner->hide();
     m_spinner->stop();
-    for (ThumbnailListView *list : m_allThumbnailListView) {
-        list->stopLoadAndClear();
-        delete list;
+    //全部时间线及其图片在数据库线程一次查出，回调中装入列表
+    std::function<DBTimelineSections()> load = []() {
+        return DBManager::instance()->getTimelineSections();
+    };
+    std::function<void(const DBTimelineSections &)> callback = [this](const DBTimelineSections &result) {
+        loadTimelineSections(result);
+    };
+    DBAsyncManager::instance()->query(this, load, callback, "TimeLineView::clearAndStartLayout");
+}
+
+void TimeLineView::loadTimelineSections(const DBTimelineSections &result)
+{
+    m_timelines.clear();
+    QStringList titles;
+    QList<DBImgInfoList> sections;
+    for (const auto &section : result) {
+        const QString &timeline = section.first;
+        m_timelines << timeline;
+        QString title;
+        QStringList datelist = timeline.split(".");
+        if (datelist.count() > 2) {
+            title = QString(QObject::tr("%1/%2/%3")).arg(datelist[0]).arg(datelist[1]).arg(datelist[2]);
+        }
+        titles << title;
+        sections << section.second;
+    }
+
+    int m_Baseheight = getIBaseHeight();
+    if (m_Baseheight == 0) {
+        return;
+    }
+    m_timelineView->setIBaseHeight(m_Baseheight);
+    m_timelineView->loadSections(titles, sections, TIMELINE_HEADERHEIGHT);
+    m_index = 0;
+    m_dateItem->setVisible(false);
+
+    if (VIEW_SEARCH != m_pStackedWidget->currentIndex()) {
+        updateStackedWidget();
+    }
+    updatePicNum();
+
+    //跳转到删除前的位置
+    if (!selectPrePaths.isEmpty()) {
+        const int row = m_timelineView->m_model->rowOf(selectPrePaths);
+        if (row >= 0) {
+            m_timelineView->scrollTo(m_timelineView->m_model->index(row, 0), QAbstractItemView::PositionAtCenter);
+        }
+        selectPrePaths = "";
     }
-    m_mainListWidget->clear();
-    m_allThumbnailListView.clear();
-    m_allChoseButton.clear();
-    currentTimeLineLoad = 0;
-    //获取所有时间线
-    m_timelines = DBManager::instance()->getAllTimelines();
-//    updataLayout();
-    addTimelineLayout();
 }
 
 void TimeLineView::onFinishLoad()
 {
-    m_mainListWidget->update();
+    m_timelineView->update();
 }
 
 void TimeLineView::onNewTime(QString date, QString num, int index)
@@ -365,506 +461,88 @@ void TimeLineView::onRepeatImportingTheSamePhotos(QStringList importPaths, QStri
     // 导入的照片重复照片提示
     if (duplicatePaths.size() > 0 && albumName.length() < 1 && dApp->getMainWindow()->getCurrentViewType() == 1) {
         QTimer::singleShot(100, this, [ = ] {
-            for (ThumbnailListView *list : m_allThumbnailListView)
-            {
-                // 注意时间线界面为多行listview处理类型
-                list->selectDuplicatePhotos(duplicatePaths, true);
-            }
+            m_timelineView->selectDuplicatePhotos(duplicatePaths);
         });
     }
 }
 
-void TimeLineView::addTimelineLayout()
+QStringList TimeLineView::sectionPaths(int row) const
 {
-    if (currentTimeLineLoad >= m_timelines.size()) {
-        updateStackedWidget();
-        return;
+    QStringList paths;
+    const int header = m_timelineView->m_model->sectionOf(row);
+    if (header < 0) {
+        return paths;
     }
-    int nowTimeLineLoad = currentTimeLineLoad;
-    //获取当前时间照片
-    DBImgInfoList ImgInfoList = DBManager::instance()->getInfosByTimeline(m_timelines.at(nowTimeLineLoad));
-
-    QListWidgetItem *item = new QListWidgetItem;
-    TimelineItem *listItem = new TimelineItem(this);
-    listItem->adjustSize();
-    QVBoxLayout *listItemlayout = new QVBoxLayout();
-    listItem->setLayout(listItemlayout);
-    listItemlayout->setMargin(0);
-    listItemlayout->setSpacing(0);
-    listItemlayout->setContentsMargins(0, 0, 0, 0);
-
-    //添加title
-    QWidget *TitleView = new QWidget;
-    QVBoxLayout *TitleViewLayout = new QVBoxLayout();
-    TitleView->setLayout(TitleViewLayout);
-    DLabel *pDate = new DLabel();
-    DFontSizeManager::instance()->bind(pDate, DFontSizeManager::T3, QFont::DemiBold);
-
-
-    pDate->setFixedHeight(TIMELINE_TITLEHEIGHT);
-    QStringList datelist = m_timelines.at(nowTimeLineLoad).split(".");
-    if (datelist.count() > 2) {
-        listItem->m_sdate = QString(QObject::tr("%1/%2/%3")).arg(datelist[0]).arg(datelist[1]).arg(datelist[2]);
+    const int last = m_timelineView->m_model->sectionEnd(header);
+    for (int i = header + 1; i <= last; i++) {
+        paths << m_timelineView->m_model->pathAt(i);
     }
-    pDate->setText(listItem->m_sdate);
-
-    DPalette color = DApplicationHelper::instance()->palette(pDate);
-    color.setBrush(DPalette::Text, color.color(DPalette::ToolTipText));
-
-    QFont ft3 = DFontSizeManager::instance()->get(DFontSizeManager::T3);
-    ft3.setFamily("SourceHanSansSC");
-    ft3.setWeight(QFont::DemiBold);
-
-    pDate->setFont(ft3);
-    pDate->setForegroundRole(DPalette::Text);
-    pDate->setPalette(color);
-
-    listItem->m_date = pDate;
-
-    pNum_dn = new DLabel();
-    listItem->m_snum = QString(QObject::tr("%1 photo(s)")).arg(ImgInfoList.size());
-    DFontSizeManager::instance()->bind(pNum_dn, DFontSizeManager::T6, QFont::Medium);
-    pNum_dn->setText(listItem->m_snum);
-
-    QFont ft6 = DFontSizeManager::instance()->get(DFontSizeManager::T6);
-    ft6.setFamily("SourceHanSansSC");
-    ft6.setWeight(QFont::Medium);
-    DPalette pal = DApplicationHelper::instance()->palette(pNum_dn);
-    QColor color_BT = pal.color(DPalette::BrightText);
-    DGuiApplicationHelper::ColorType themeType = DGuiApplicationHelper::instance()->themeType();
-    if (themeType == DGuiApplicationHelper::LightType) {
-        color_BT.setAlphaF(0.5);
-        pal.setBrush(DPalette::Text, color_BT);
-        pNum_dn->setForegroundRole(DPalette::Text);
-        pNum_dn->setPalette(pal);
-    } else if (themeType == DGuiApplicationHelper::DarkType) {
-        color_BT.setAlphaF(0.75);
-        pal.setBrush(DPalette::Text, color_BT);
-        pNum_dn->setForegroundRole(DPalette::Text);
-        pNum_dn->setPalette(pal);
-    }
-
-    pNum_dn->setFixedHeight(TIMELINE_TITLEHEIGHT);
-    pNum_dn->setFont(ft6);
+    return paths;
+}
 
-    QHBoxLayout *Layout = new QHBoxLayout();
-    DCommandLinkButton *pChose = new DCommandLinkButton(QObject::tr("Select"));
-    pChose->setFocusPolicy(Qt::NoFocus);
-    DFontSizeManager::instance()->bind(pChose, DFontSizeManager::T5);
-    m_allChoseButton << pChose;
-    pChose->setFont(DFontSizeManager::instance()->get(DFontSizeManager::T5));
-    pChose->setFixedHeight(TIMELINE_TITLEHEIGHT);
-    pChose->resize(36, 27);
-
-    pNum_dn->setLayout(Layout);
-    Layout->addStretch(1);
-    Layout->setAlignment(Qt::AlignLeft | Qt::AlignTop);
-    Layout->setContentsMargins(0, 0, 37, 0);
-    Layout->addWidget(pChose);
-
-    listItem->m_Chose = pChose;
-    listItem->m_num = pNum_dn;
-    TitleViewLayout->addWidget(pDate);
-    TitleViewLayout->addWidget(pNum_dn);
-    TitleView->setFixedHeight(87);
-    listItem->m_title = TitleView;
-
-    //添加照片
-    ThumbnailListView *pThumbnailListView = new ThumbnailListView(ThumbnailDelegate::TimeLineViewType, COMMON_STR_VIEW_TIMELINE);
-    pThumbnailListView->setFocusPolicy(Qt::NoFocus);
-    int m_Baseheight =  getIBaseHeight();
-    if (m_Baseheight == 0) {
+void TimeLineView::updateDateItem()
+{
+    ThumbnailModel *model = m_timelineView->m_model;
+    const int header = m_timelineView->sectionAtTop();
+    if (header < 0) {
+        m_dateItem->setVisible(false);
         return;
-    } else {
-        pThumbnailListView->setIBaseHeight(m_Baseheight);
-    }
-    pThumbnailListView->setFixedWidth(width() + 2);
-    connect(pThumbnailListView, &ThumbnailListView::loadEnd, this, &TimeLineView::addTimelineLayout);
-    connect(pThumbnailListView, &ThumbnailListView::needResize, this, [ = ](int h) {
-        if (!pThumbnailListView->checkResizeNum())
-            return ;
-        if (isVisible()) {
-            int mh = h;
-            if (0 == nowTimeLineLoad) {
-                mh += 50;
-            }
-            if (nowTimeLineLoad == m_timelines.size() - 1) {
-                mh += 27;
-            }
-            pThumbnailListView->setFixedHeight(mh);
-            listItem->setFixedHeight(TitleView->height() + mh);
-            item->setSizeHint(listItem->rect().size());
-        }
-    });
-
-#if 1
-    m_allThumbnailListView.append(pThumbnailListView);
-#endif
-    pThumbnailListView->setEditTriggers(QAbstractItemView::NoEditTriggers);
-    pThumbnailListView->setContextMenuPolicy(Qt::CustomContextMenu);
-    pThumbnailListView->setContentsMargins(0, 0, 0, 0);
-    pThumbnailListView->setFrameShape(DTableView::NoFrame);
-    pThumbnailListView->loadFilesFromLocal(ImgInfoList);
-    if (0 == nowTimeLineLoad) {
-        DWidget *topwidget = new DWidget;
-        topwidget->setFixedHeight(50);
-        listItemlayout->addWidget(topwidget);
     }
-    listItemlayout->addWidget(TitleView);
-    listItemlayout->addWidget(pThumbnailListView);
-    if (nowTimeLineLoad == m_timelines.size() - 1) {
-        DWidget *bottomwidget = new DWidget;
-        bottomwidget->setFixedHeight(27);
-        listItemlayout->addWidget(bottomwidget);
-    }
-    item->setFlags(Qt::NoItemFlags);
-    m_mainListWidget->addItemForWidget(item);
-    m_mainListWidget->setItemWidget(item, listItem);
-    connect(pThumbnailListView, &ThumbnailListView::openImage, this, [ = ](int index) {
-        SignalManager::ViewInfo info;
-        info.album = "";
-        info.lastPanel = nullptr;
-        if (ImgInfoList.size() <= 1) {
-            info.paths.clear();
-        } else {
-            for (auto image : ImgInfoList) {
-                info.paths << image.filePath;
-            }
-        }
-        info.path = ImgInfoList[index].filePath;
-        info.viewType = utils::common::VIEW_TIMELINE_SRN;
-        info.viewMainWindowID = VIEW_MAINWINDOW_TIMELINE;
-        emit dApp->signalM->viewImage(info);
-        emit dApp->signalM->showImageView(VIEW_MAINWINDOW_TIMELINE);
-    });
-    connect(pThumbnailListView, &ThumbnailListView::menuOpenImage, this, [ = ](QString path, QStringList paths, bool isFullScreen, bool isSlideShow) {
-        SignalManager::ViewInfo info;
-        info.album = "";
-        info.lastPanel = nullptr;
-        if (paths.size() > 1) {
-            info.paths = paths;
-        } else {
-            auto photolist = pThumbnailListView->getAllFileList();
-            if (photolist.size() > 1) {
-                for (auto image : photolist) {
-                    info.paths << image;
-                }
-            } else {
-                info.paths.clear();
-            }
-        }
-        info.path = path;
-        info.fullScreen = isFullScreen;
-        info.slideShow = isSlideShow;
-        info.viewType = utils::common::VIEW_TIMELINE_SRN;
-        info.viewMainWindowID = VIEW_MAINWINDOW_TIMELINE;
-        if (info.slideShow) {
-            if (ImgInfoList.count() == 1) {
-                info.paths = paths;
-            }
-
-            QStringList pathlist;
-            pathlist.clear();
-            for (auto path : info.paths) {
-                if (QFileInfo(path).exists()) {
-                    pathlist << path;
-                }
-            }
-
-            info.paths = pathlist;
-            emit dApp->signalM->startSlideShow(info);
-            emit dApp->signalM->showSlidePanel(VIEW_MAINWINDOW_TIMELINE);
-        } else {
-            emit dApp->signalM->viewImage(info);
-            emit dApp->signalM->showImageView(VIEW_MAINWINDOW_TIMELINE);
-        }
-    });
-    connect(pChose, &DCommandLinkButton::clicked, this, [ = ] {
-        if (QObject::tr("Select") == pChose->text())
-        {
-            pChose->setText(QObject::tr("Unselect"));
-            for (int j = 0; j < m_allChoseButton.length(); j++) {
-                if (pChose == m_allChoseButton[j])
-                    lastClickedIndex = j;
-            }
-            lastRow = 0;
-            lastChanged = true;
-            pThumbnailListView->selectAll();
-        } else
-        {
-            pChose->setText(QObject::tr("Select"));
-            pThumbnailListView->clearSelection();
-        }
-        updatePicNum();
-    });
-#if 1
-    connect(pThumbnailListView, &ThumbnailListView::sigGetSelectedPaths, this, &TimeLineView::on_GetSelectedPaths);
-
-    connect(pThumbnailListView, &ThumbnailListView::sigMousePress, this, [ = ](QMouseEvent * event) {
-        lastRow = -1;
-        if (event->button() == Qt::LeftButton) {
-            for (int j = 0; j < m_allThumbnailListView.length(); j++) {
-                if (pThumbnailListView != m_allThumbnailListView[j]) {
-                    m_allThumbnailListView[j]->clearSelection();
-                }
-            }
-            m_ctrlPress = false;
-        }
-
-        for (int j = 0; j < m_allThumbnailListView.length(); j++) {
-            if (pThumbnailListView == m_allThumbnailListView[j]) {
-                lastClickedIndex = j;
-                lastRow = pThumbnailListView->getRow(QPoint(event->x(), event->y()));
-                if (-1 != lastRow)
-                    lastChanged = true;
-            }
-        }
-    });
-
-    connect(pThumbnailListView, &ThumbnailListView::sigCtrlMousePress, this, [ = ](QMouseEvent * event) {
-        m_ctrlPress = true;
-        for (int j = 0; j < m_allThumbnailListView.length(); j++) {
-            if (pThumbnailListView == m_allThumbnailListView[j]) {
-                lastClickedIndex = j;
-                lastRow = pThumbnailListView->getRow(QPoint(event->x(), event->y()));
-                if (-1 != lastRow)
-                    lastChanged = true;
-            }
-        }
-    });
-
-    connect(pThumbnailListView, &ThumbnailListView::sigShiftMousePress, this, [ = ](QMouseEvent * event) {
-        int curClickedIndex = -1;
-        int curRow = -1;
-        for (int j = 0; j < m_allThumbnailListView.length(); j++) {
-            if (pThumbnailListView == m_allThumbnailListView[j]) {
-                curClickedIndex = j;
-                curRow = pThumbnailListView->getRow(QPoint(event->x(), event->y()));
-            }
-        }
-        if (!lastChanged && -1 != curRow) {
-            for (int j = 0; j < m_allThumbnailListView.length(); j++) {
-                m_allThumbnailListView[j]->clearSelection();
-            }
-        }
-        if (curRow == -1 || lastRow == -1) {
-            for (int j = 0; j < m_allThumbnailListView.length(); j++) {
-                m_allThumbnailListView[j]->clearSelection();
-            }
-        } else {
-            if (lastClickedIndex < curClickedIndex) {
-                m_allThumbnailListView[lastClickedIndex]->selectRear(lastRow);
-                m_allThumbnailListView[curClickedIndex]->selectFront(curRow);
-                for (int k = lastClickedIndex + 1; k < curClickedIndex; k++) {
-                    m_allThumbnailListView[k]->selectAll();
-                }
-            } else if (lastClickedIndex > curClickedIndex) {
-                m_allThumbnailListView[lastClickedIndex]->selectFront(lastRow);
-                m_allThumbnailListView[curClickedIndex]->selectRear(curRow);
-                for (int k = curClickedIndex + 1; k < lastClickedIndex; k++) {
-                    m_allThumbnailListView[k]->selectAll();
-                }
-            } else if (lastClickedIndex == curClickedIndex) {
-                if (lastRow <= curRow)
-                    pThumbnailListView->selectExtent(lastRow, curRow);
-                else
-                    pThumbnailListView->selectExtent(curRow, lastRow);
-            }
-            updatePicNum();
-            updateChoseText();
-            curRow = -1;
-            lastChanged = false;
-        }
-    });
-
-    connect(pThumbnailListView, &ThumbnailListView::sigSelectAll, this, [ = ] {
-        m_ctrlPress = true;
-        for (int j = 0; j < m_allThumbnailListView.length(); j++)
-        {
-            m_allThumbnailListView[j]->selectAll();
-        }
-        updatePicNum();
-        updateChoseText();
-        QList<DCommandLinkButton *> b = m_mainListWidget->itemWidget(m_mainListWidget->item(m_index))->findChildren<DCommandLinkButton *>();
-        pSuspensionChose->setText(b[0]->text());
-    });
-
-    connect(pThumbnailListView, &ThumbnailListView::sigMouseRelease, this, [ = ] {
-        if (!m_ctrlPress)
-        {
-            for (int j = 0; j < m_allThumbnailListView.length(); j++) {
-                if (pThumbnailListView != m_allThumbnailListView[j]) {
-                    m_allThumbnailListView[j]->clearSelection();
-                }
-            }
-        }
-
-        updatePicNum();
-        updateChoseText();
-        QList<DCommandLinkButton *> b = m_mainListWidget->itemWidget(m_mainListWidget->item(m_index))->findChildren<DCommandLinkButton *>();
-        pSuspensionChose->setText(b[0]->text());
-    });
-
-    connect(pThumbnailListView, &ThumbnailListView::customContextMenuRequested, this, [ = ] {
-        QStringList paths = pThumbnailListView->selectedPaths();
-        if (pThumbnailListView->model()->rowCount() == paths.length() && QObject::tr("Select") == pChose->text())
-        {
-            pChose->setText(QObject::tr("Unselect"));
-        }
-
-        if (pThumbnailListView->model()->rowCount() != paths.length() && QObject::tr("Unselect") == pChose->text())
-        {
-            pChose->setText(QObject::tr("Select"));
-        }
-        updatePicNum();
-    });
-    connect(pThumbnailListView, &ThumbnailListView::sigMenuItemDeal, this, [ = ](QAction * action) {
-        QStringList paths;
-        paths.clear();
-        for (int j = 0; j < m_allThumbnailListView.size(); j++) {
-            paths << m_allThumbnailListView[j]->selectedPaths();
-        }
-        pThumbnailListView->menuItemDeal(paths, action);
-    });
-
-    connect(listItem, &TimelineItem::sigMousePress, this, [ = ] {
-        for (int j = 0; j < m_allThumbnailListView.length(); j++)
-        {
-            m_allThumbnailListView[j]->clearSelection();
-        }
-        lastRow = -1;
-        updatePicNum();
-        updateChoseText();
-    });
-    connect(pThumbnailListView, &ThumbnailListView::sigMoveToTrash, this, &TimeLineView::onKeyDelete);//跳转
-#endif
-
-    connect(m_allThumbnailListView[nowTimeLineLoad], &ThumbnailListView::sigKeyEvent, this, &TimeLineView::on_KeyEvent);
-
-    if (VIEW_SEARCH == m_pStackedWidget->currentIndex()) {
-    } else {
-        updateStackedWidget();
+    //标题行本身还完整可见时不需要悬浮标题
+    const QRect headerRect = m_timelineView->visualRect(model->index(header, 0));
+    if (headerRect.top() >= 0) {
+        m_dateItem->setVisible(false);
+        return;
     }
-
-    updatePicNum();
-    currentTimeLineLoad++;
-
-    //判断跳转位置图片是否包含在当前listview
-    if (selectPrePaths.length() > 0) {
-        for (DBImgInfo &imgInfo : ImgInfoList) {
-            if (imgInfo.filePath == selectPrePaths) {
-                hasPicView = nowTimeLineLoad;
-                isFindPic = true;
-                break;
-            }
-        }
+    const QString date = model->item(header).name;
+    const QString num = QString(QObject::tr("%1 photo(s)")).arg(model->item(header).sectionCount);
+    if (header != m_index || !m_dateItem->isVisible()) {
+        onNewTime(date, num, header);
     }
-
-    if (nowTimeLineLoad == m_timelines.size() - 1 && hasPicView >= 0) {
-        int height = 0;
-        for (int i = 0; i < m_timelines.size(); i++) {
-            if (i < hasPicView) {
-                height = height + m_allThumbnailListView[i]->height() + m_allChoseButton[0]->height();
-            } else if (i == hasPicView) {
-                for (int j = 0; j < m_allThumbnailListView[i]->count(); j ++) {
-                    QModelIndex index = m_allThumbnailListView[i]->m_model->index(j, 0);
-                    QVariantList lst = index.model()->data(index, Qt::DisplayRole).toList();
-                    int rowcount = 0;
-                    int allrowcount = 0;
-                    if (lst.count() >= 12) {
-                        QString path = lst.at(1).toString();
-                        if (path == selectPrePaths) {
-                            if ((index.row() % m_allThumbnailListView[i]->rowSizeHint) == 0) {
-                                rowcount = index.row() / m_allThumbnailListView[i]->rowSizeHint;
-                            } else {
-                                rowcount = index.row() / m_allThumbnailListView[i]->rowSizeHint + 1;
-                            }
-                            if ((m_allThumbnailListView[i]->m_model->rowCount() % m_allThumbnailListView[i]->rowSizeHint) == 0) {
-                                allrowcount = m_allThumbnailListView[i]->m_model->rowCount() / m_allThumbnailListView[i]->rowSizeHint ;
-                            } else {
-                                allrowcount = m_allThumbnailListView[i]->m_model->rowCount() / m_allThumbnailListView[i]->rowSizeHint + 1;
-                            }
-                            double tempheight = rowcount / static_cast<double>(allrowcount);
-                            int thumbnailheight =  m_allThumbnailListView.at(i)->height();
-                            double finalheight = tempheight * thumbnailheight;
-                            height = height + static_cast<int>(finalheight) ;
-
-                            if (hasPicView == 0)
-                                height = height - m_allThumbnailListView[i]->m_onePicWidth;
-                            break;
-                        }
-                    }
-                }
-                break;
-            }
-        }
-//        m_mainListWidget->setCurrentRow(hasPicView);
-        m_mainListWidget->verticalScrollBar()->setValue(height);
-        hasPicView = -1;
-        selectPrePaths = "";
-        isFindPic = false;
+    //下一个日期标题顶上来时把悬浮标题推上去
+    int y = 0;
+    const int next = model->sectionEnd(header) + 1;
+    if (next < model->rowCount()) {
+        const int nextTop = m_timelineView->visualRect(model->index(next, 0)).top();
+        y = qMin(0, nextTop - m_dateItem->height());
     }
+    on_MoveLabel(y, date, num, pSuspensionChose->text());
 }
 
 void TimeLineView::on_AddLabel(QString date, QString num)
 {
-    if ((nullptr != m_dateItem) && (nullptr != m_mainListWidget)) {
+    if ((nullptr != m_dateItem) && (nullptr != m_timelineView)) {
         QList<QLabel *> labelList = m_dateItem->findChildren<QLabel *>();
         labelList[0]->setText(date);
         labelList[1]->setText(num);
         m_dateItem->setVisible(true);
         m_dateItem->move(0, TITLEHEIGHT);
+        pSuspensionChose->setText(m_timelineView->isSectionSelected(m_index) ? QObject::tr("Unselect") : QObject::tr("Select"));
     }
-#if 1
-    QList<DCommandLinkButton *> b = m_mainListWidget->itemWidget(m_mainListWidget->item(m_index))->findChildren<DCommandLinkButton *>();
-    pSuspensionChose->setText(b[0]->text());
-#endif
 }
 
 void TimeLineView::on_DCommandLinkButton()
 {
-    if (QObject::tr("Select") == pSuspensionChose->text()) {
-        pSuspensionChose->setText(QObject::tr("Unselect"));
-        QList<ThumbnailListView *> p = m_mainListWidget->itemWidget(m_mainListWidget->item(m_index))->findChildren<ThumbnailListView *>();
-        if (p.size() > 0)
-            p[0]->selectAll();
-        updatePicNum();
-        for (int i = 0; i < m_allChoseButton.length(); i++) {
-            if (m_allThumbnailListView[i] == p[0]) {
-                lastClickedIndex = i;
-                lastRow = 0;
-                lastChanged = true;
-            }
-        }
+    const bool select = QObject::tr("Select") == pSuspensionChose->text();
+    pSuspensionChose->setText(select ? QObject::tr("Unselect") : QObject::tr("Select"));
+    m_timelineView->setSectionSelected(m_index, select);
+    if (select) {
         m_ctrlPress = true;
-    } else {
-        pSuspensionChose->setText(QObject::tr("Select"));
-        QList<ThumbnailListView *> p = m_mainListWidget->itemWidget(m_mainListWidget->item(m_index))->findChildren<ThumbnailListView *>();
-        if (p.size() > 0) {
-            p[0]->clearSelection();
-            updatePicNum();
-        }
     }
-#if 1
-    QList<DCommandLinkButton *> b = m_mainListWidget->itemWidget(m_mainListWidget->item(m_index))->findChildren<DCommandLinkButton *>();
-    if (b.size() > 0)
-        b[0]->setText(pSuspensionChose->text());
-#endif
+    updatePicNum();
 }
 
 void TimeLineView::on_GetSelectedPaths(QStringList *pPaths)
 {
     pPaths->clear();
-    for (int j = 0; j < m_allThumbnailListView.size(); j++) {
-        pPaths->append(m_allThumbnailListView[j]->selectedPaths());
-    }
+    pPaths->append(m_timelineView->selectedPaths());
 }
 
 #if 1
 void TimeLineView::on_MoveLabel(int y, QString date, QString num, QString choseText)
 #endif
 {
-    if ((nullptr != m_dateItem) && (nullptr != m_mainListWidget)) {
+    if ((nullptr != m_dateItem) && (nullptr != m_timelineView)) {
         QList<QLabel *> labelList = m_dateItem->findChildren<QLabel *>();
         labelList[0]->setText(date);
         labelList[1]->setText(num);
@@ -879,18 +557,18 @@ void TimeLineView::on_KeyEvent(int key)
     qDebug() << key;
 
     if (key == Qt::Key_PageDown) {
-        QScrollBar *vb = m_mainListWidget->verticalScrollBar();
+        QScrollBar *vb = m_timelineView->verticalScrollBar();
         int posValue = vb->value();
         qDebug() << "posValue" << posValue;
 
-        posValue += m_mainListWidget->height();
+        posValue += m_timelineView->height();
         vb->setValue(posValue);
     } else if (key == Qt::Key_PageUp) {
-        QScrollBar *vb = m_mainListWidget->verticalScrollBar();
+        QScrollBar *vb = m_timelineView->verticalScrollBar();
         int posValue = vb->value();
         qDebug() << "posValue" << posValue;
 
-        posValue -= m_mainListWidget->height();
+        posValue -= m_timelineView->height();
         vb->setValue(posValue);
     }
 
@@ -900,12 +578,7 @@ void TimeLineView::resizeEvent(QResizeEvent *ev)
 {
     Q_UNUSED(ev);
     m_spinner->move(width() / 2 - 20, (height() - 50) / 2 - 20);
-    m_dateItem->setFixedSize(width() - 15, 87);
-    for (int i = 0; i < m_allThumbnailListView.length(); i++) {
-        m_allThumbnailListView[i]->setFixedWidth(width() + 2);
-        QList<DLabel *> b = m_mainListWidget->itemWidget(m_mainListWidget->item(i))->findChildren<DLabel *>();
-        b[1]->setFixedWidth(width() - 14);
-    }
+    m_dateItem->setFixedSize(width() - 15, TIMELINE_HEADERHEIGHT);
     m_pwidget->setFixedSize(this->width(), this->height() - 23);
     m_pwidget->move(0, 0);
     m_pStatusBar->setFixedWidth(this->width());
@@ -946,9 +619,7 @@ void TimeLineView::dragLeaveEvent(QDragLeaveEvent *e)
 void TimeLineView::mousePressEvent(QMouseEvent *e)
 {
     if (QApplication::keyboardModifiers() != Qt::ControlModifier && e->button() == Qt::LeftButton) {
-        for (int i = 0; i < m_allThumbnailListView.length(); i++) {
-            m_allThumbnailListView[i]->clearSelection();
-        }
+        m_timelineView->clearSelection();
         updatePicNum();
         updateChoseText();
     }
@@ -964,11 +635,7 @@ void TimeLineView::updatePicNum()
         m_selPicNum = paths.length();
         m_pStatusBar->m_pAllPicNumLabel->setText(str.arg(m_selPicNum));
     } else {
-        allnum = 0;
-
-        for (int i = 0; i < m_allThumbnailListView.size(); i++) {
-            allnum += m_allThumbnailListView[i]->selectedPaths().size();
-        }
+        allnum = m_timelineView->selectedPaths().size();
 
         if (0 == allnum) {
             restorePicNum();
@@ -981,15 +648,11 @@ void TimeLineView::updatePicNum()
 
 void TimeLineView::updateChoseText()
 {
-    for (int i = 0; i < m_allChoseButton.length(); i++) {
-        if (m_allThumbnailListView[i]->model()->rowCount() == m_allThumbnailListView[i]->selectedPaths().length() && QObject::tr("Select") == m_allChoseButton[i]->text()) {
-            m_allChoseButton[i]->setText(QObject::tr("Unselect"));
-        }
-
-        if (m_allThumbnailListView[i]->model()->rowCount() != m_allThumbnailListView[i]->selectedPaths().length() && QObject::tr("Unselect") == m_allChoseButton[i]->text()) {
-            m_allChoseButton[i]->setText(QObject::tr("Select"));
-        }
+    //列表中的选择文字在绘制时按选中状态生成，这里只同步悬浮标题
+    if (m_timelineView->m_model->isHeader(m_index)) {
+        pSuspensionChose->setText(m_timelineView->isSectionSelected(m_index) ? QObject::tr("Unselect") : QObject::tr("Select"));
     }
+    m_timelineView->viewport()->update();
 }
 
 void TimeLineView::restorePicNum()
@@ -998,8 +661,16 @@ void TimeLineView::restorePicNum()
     int selPicNum = 0;
 
     if (VIEW_TIMELINE == m_pStackedWidget->currentIndex()) {
-        selPicNum = DBManager::instance()->getImgsCount();
-
+        std::function<int()> count = []() {
+            return DBManager::instance()->getImgsCount();
+        };
+        std::function<void(const int &)> callback = [this, str](const int &count) {
+            if (VIEW_TIMELINE == m_pStackedWidget->currentIndex()) {
+                m_pStatusBar->m_pAllPicNumLabel->setText(str.arg(QString::number(count)));
+            }
+        };
+        DBAsyncManager::instance()->query(this, count, callback, "TimeLineView::restorePicNum");
+        return;
     } else if (VIEW_SEARCH == m_pStackedWidget->currentIndex()) {
         selPicNum = pSearchView->m_searchPicNum;
     }
@@ -1012,40 +683,32 @@ void TimeLineView::onKeyDelete()
     if (!isVisible()) return;
     if (VIEW_SEARCH == m_pStackedWidget->currentIndex()) return;
 
-    QStringList paths;
-    paths.clear();
-
-    bool bDeleteAll = true;
-    //获取当前所有选中的
-    for (int i = 0; i < m_allThumbnailListView.size(); i++) {
-
-        paths << m_allThumbnailListView[i]->selectedPaths();
-        QStringList currentPaths;
-        currentPaths << m_allThumbnailListView[i]->selectedPaths();
-        bDeleteAll = m_allThumbnailListView[i]->isAllPicSeleted();
-        //改为跳转到最后一张选中位置
-        if (/*first && */currentPaths.length() > 0) {
-            if (!bDeleteAll) {
-                selectPrePaths = m_allThumbnailListView[i]->m_model->index(0, 0).data().toList().at(1).toString();
-                int index = 1;
-                while (paths.contains(selectPrePaths)) {
-                    selectPrePaths = m_allThumbnailListView[i]->m_model->index(index, 0).data().toList().at(1).toString();
-                    index ++ ;
-                    if (index == m_allThumbnailListView[i]->m_model->rowCount() - 1)
-                        break;
-                }
-            } else {
-                if (i > 1) {
-                    selectPrePaths = m_allThumbnailListView[i - 1]->m_model->index(0, 0).data().toList().at(1).toString();
-                } else {
-                    selectPrePaths = "";
-                }
-            }
-        }
-    }
+    const QStringList paths = m_timelineView->selectedPaths();
     if (0 >= paths.length()) {
         return;
     }
+    const bool bDeleteAll = m_timelineView->isAllPicSeleted();
+
+    //删除后跳转到最后一张选中图片之后第一张未删除的图片，没有则取之前的
+    selectPrePaths = "";
+    if (!bDeleteAll) {
+        ThumbnailModel *model = m_timelineView->m_model;
+        const QSet<QString> deleted = paths.toSet();
+        int lastSelected = -1;
+        for (const QModelIndex &index : m_timelineView->selectionModel()->selectedIndexes()) {
+            lastSelected = qMax(lastSelected, index.row());
+        }
+        for (int row = lastSelected + 1; row < model->rowCount() && selectPrePaths.isEmpty(); row++) {
+            if (!model->isHeader(row) && !deleted.contains(model->pathAt(row))) {
+                selectPrePaths = model->pathAt(row);
+            }
+        }
+        for (int row = lastSelected - 1; row >= 0 && selectPrePaths.isEmpty(); row--) {
+            if (!model->isHeader(row) && !deleted.contains(model->pathAt(row))) {
+                selectPrePaths = model->pathAt(row);
+            }
+        }
+    }
 
     if (bDeleteAll) {
         m_pStackedWidget->setCurrentIndex(VIEW_IMPORT);
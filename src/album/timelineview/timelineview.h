@@ -84,7 +84,11 @@ private:
     void getImageInfos();
     void clearAndStop();
     void clearAndStartLayout();
-    void addTimelineLayout();
+    void loadTimelineSections(const DBTimelineSections &result);
+    //row所在日期的全部图片
+    QStringList sectionPaths(int row) const;
+    //按滚动位置更新悬浮的日期标题
+    void updateDateItem();
     void initMainStackWidget();
     void onKeyDelete();
     void dragEnterEvent(QDragEnterEvent *e) override;
@@ -105,7 +109,6 @@ public slots:
     void onRepeatImportingTheSamePhotos(QStringList importPaths, QStringList duplicatePaths, QString albumName);
 
 private:
-    TimelineListWidget *m_mainListWidget;
     QLayout *m_mainLayout;
     QList<QString> m_timelines;
     QWidget *m_dateItem;
@@ -114,15 +117,9 @@ private:
     int allnum;
     DLabel *m_pDate;
     DLabel *pNum_up;
-    DLabel *pNum_dn;
-    QList<ThumbnailListView *> m_allThumbnailListView;
-    QList<DCommandLinkButton *> m_allChoseButton;
     QGraphicsOpacityEffect *m_oe;
     QGraphicsOpacityEffect *m_oet;
     bool m_ctrlPress;
-    int lastClickedIndex;
-    int lastRow;
-    bool lastChanged;
     QWidget *fatherwidget;
 
 public:
@@ -131,14 +128,12 @@ public:
     SearchView *pSearchView;
     ImportView *pImportView;
     QWidget *pTimeLineViewWidget;
+    ThumbnailListView *m_timelineView;  //全部日期共用的列表
     QWidget *m_pwidget;
-    int m_index;
+    int m_index;                        //悬浮标题对应的标题行
     int m_selPicNum;
     DSpinner *m_spinner;
-    int currentTimeLineLoad;
     QString selectPrePaths = "";//跳转的上一图片位置
-    int hasPicView = -1;//包含跳转图片的view索引
-    bool isFindPic = false;
 };
 
 #endif // TIMELINEVIEW_H
@@ -28,6 +28,7 @@
 #include <QDesktopServices>
 #include <QDir>
 #include <QFontMetrics>
+#include <QFile>
 #include <QFileInfo>
 #include <QImage>
 #include <QMimeData>
@@ -37,6 +38,7 @@
 #include <QDebug>
 #include <QTextStream>
 #include <QtMath>
+#include <QtEndian>
 
 #include <DApplication>
 #include <DDesktopServices>
@@ -178,6 +180,124 @@ QString hash(const QString &str)
     return QString(QCryptographicHash::hash(str.toUtf8(), QCryptographicHash::Md5).toHex());
 }
 
+namespace {
+const quint64 XXH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+const quint64 XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+const quint64 XXH_PRIME64_3 = 0x165667B19E3779F9ULL;
+const quint64 XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+const quint64 XXH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+inline quint64 xxhRotl(quint64 x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+inline quint64 xxhRound(quint64 acc, quint64 input)
+{
+    acc += input * XXH_PRIME64_2;
+    acc = xxhRotl(acc, 31);
+    return acc * XXH_PRIME64_1;
+}
+
+inline quint64 xxhMergeRound(quint64 acc, quint64 val)
+{
+    acc ^= xxhRound(0, val);
+    return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+}  // namespace
+
+//XXH64，seed为0
+quint64 xxHash64(const void *data, int len)
+{
+    const uchar *p = static_cast<const uchar *>(data);
+    const uchar *end = p + len;
+    quint64 h;
+    if (len >= 32) {
+        const uchar *limit = end - 32;
+        quint64 v1 = XXH_PRIME64_1 + XXH_PRIME64_2;
+        quint64 v2 = XXH_PRIME64_2;
+        quint64 v3 = 0;
+        quint64 v4 = 0 - XXH_PRIME64_1;
+        do {
+            v1 = xxhRound(v1, qFromLittleEndian<quint64>(p));
+            v2 = xxhRound(v2, qFromLittleEndian<quint64>(p + 8));
+            v3 = xxhRound(v3, qFromLittleEndian<quint64>(p + 16));
+            v4 = xxhRound(v4, qFromLittleEndian<quint64>(p + 24));
+            p += 32;
+        } while (p <= limit);
+        h = xxhRotl(v1, 1) + xxhRotl(v2, 7) + xxhRotl(v3, 12) + xxhRotl(v4, 18);
+        h = xxhMergeRound(h, v1);
+        h = xxhMergeRound(h, v2);
+        h = xxhMergeRound(h, v3);
+        h = xxhMergeRound(h, v4);
+    } else {
+        h = XXH_PRIME64_5;
+    }
+    h += static_cast<quint64>(len);
+    while (p + 8 <= end) {
+        h ^= xxhRound(0, qFromLittleEndian<quint64>(p));
+        h = xxhRotl(h, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<quint64>(qFromLittleEndian<quint32>(p)) * XXH_PRIME64_1;
+        h = xxhRotl(h, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        p += 4;
+    }
+    while (p < end) {
+        h ^= (*p) * XXH_PRIME64_5;
+        h = xxhRotl(h, 11) * XXH_PRIME64_1;
+        ++p;
+    }
+    h ^= h >> 33;
+    h *= XXH_PRIME64_2;
+    h ^= h >> 29;
+    h *= XXH_PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+//直接对QString的UTF-16数据求值，无需转码；结果只用于本机数据库
+qint64 pathHash(const QString &path)
+{
+    return static_cast<qint64>(xxHash64(path.constData(), path.size() * static_cast<int>(sizeof(QChar))));
+}
+
+qint64 contentFingerprint(const QString &path)
+{
+    const qint64 sampleSize = 64 * 1024;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+    const qint64 size = file.size();
+    QByteArray data;
+    data.append(reinterpret_cast<const char *>(&size), sizeof(size));
+    if (size <= sampleSize * 3) {
+        data.append(file.readAll());
+    } else {
+        data.append(file.read(sampleSize));
+        file.seek((size - sampleSize) / 2);
+        data.append(file.read(sampleSize));
+        file.seek(size - sampleSize);
+        data.append(file.read(sampleSize));
+    }
+    const qint64 fingerprint = static_cast<qint64>(xxHash64(data.constData(), data.size()));
+    //0保留为"未计算"
+    return fingerprint ? fingerprint : 1;
+}
+
+QByteArray fileContentHash(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(&file);
+    return hash.result();
+}
+
 bool checkMimeData(const QMimeData *mimeData)
 {
     if (!mimeData->hasUrls()) {
@@ -220,6 +220,13 @@ void        copyImageToClipboard(const QStringList &paths);
 void        showInFileManager(const QString &path);
 int         stringHeight(const QFont &f, const QString &str);
 QString     hash(const QString &str);
+quint64     xxHash64(const void *data, int len);
+//路径的64位快速哈希，用作数据库查找键，可能冲突，需再比较路径
+qint64      pathHash(const QString &path);
+//文件内容指纹：文件大小加首、中、尾三段采样的64位哈希，读取失败返回0
+qint64      contentFingerprint(const QString &path);
+//整个文件内容的哈希，仅在指纹相同时用于确认
+QByteArray  fileContentHash(const QString &path);
 QString     SpliteText(const QString &text, const QFont &font, int nLabelSize);
 QDateTime   stringToDateTime(const QString &time);
 QString     getFileContent(const QString &file);
@@ -0,0 +1,279 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "dirsnapshot.h"
+#include "baseutils.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+
+namespace {
+
+const quint32 SNAPSHOT_MAGIC = 0x44534e50;     //"DSNP"
+const quint32 SNAPSHOT_VERSION = 1;
+
+qint64 mtimeOf(const struct stat &st)
+{
+    return static_cast<qint64>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+}  // namespace
+
+//供QVector/QHash的流操作通过ADL找到
+static QDataStream &operator<<(QDataStream &out, const DirSnapshot::FileRecord &file)
+{
+    return out << file.name << file.inode << file.size << file.mtime;
+}
+
+static QDataStream &operator>>(QDataStream &in, DirSnapshot::FileRecord &file)
+{
+    return in >> file.name >> file.inode >> file.size >> file.mtime;
+}
+
+static QDataStream &operator<<(QDataStream &out, const DirSnapshot::DirRecord &dir)
+{
+    return out << dir.mtime << dir.entryCount << dir.files << dir.subDirs;
+}
+
+static QDataStream &operator>>(QDataStream &in, DirSnapshot::DirRecord &dir)
+{
+    return in >> dir.mtime >> dir.entryCount >> dir.files >> dir.subDirs;
+}
+
+DirSnapshot::DirSnapshot(const QStringList &suffixes)
+{
+    for (const QString &suffix : suffixes) {
+        m_suffixes.insert(suffix.toLower());
+    }
+}
+
+void DirSnapshot::setRecursive(bool recursive)
+{
+    m_recursive = recursive;
+}
+
+void DirSnapshot::setSkipSymlinks(bool skip)
+{
+    m_skipSymlinks = skip;
+}
+
+void DirSnapshot::setCancelCheck(const std::function<bool()> &check)
+{
+    m_cancelCheck = check;
+}
+
+QString DirSnapshot::snapshotFile(const QString &key)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+           + "/deepin/deepin-album/snapshots/"
+           + QString::number(static_cast<quint64>(utils::base::pathHash(key)), 16) + ".snap";
+}
+
+bool DirSnapshot::load(const QString &file)
+{
+    m_dirs.clear();
+    QFile f(file);
+    if (!f.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&f);
+    quint32 magic = 0, version = 0;
+    in >> magic >> version;
+    if (magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION) {
+        return false;
+    }
+    in >> m_dirs;
+    if (in.status() != QDataStream::Ok) {
+        qDebug() << "broken dir snapshot" << file;
+        m_dirs.clear();
+        return false;
+    }
+    return true;
+}
+
+bool DirSnapshot::save(const QString &file) const
+{
+    QDir().mkpath(file.left(file.lastIndexOf('/')));
+    //先写临时文件再替换，中途退出不会留下半个快照
+    QSaveFile f(file);
+    if (!f.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream out(&f);
+    out << SNAPSHOT_MAGIC << SNAPSHOT_VERSION << m_dirs;
+    return f.commit();
+}
+
+bool DirSnapshot::isEmpty() const
+{
+    return m_dirs.isEmpty();
+}
+
+QStringList DirSnapshot::dirs() const
+{
+    return m_dirs.keys();
+}
+
+bool DirSnapshot::matchSuffix(const char *name) const
+{
+    if (m_suffixes.isEmpty()) {
+        return true;
+    }
+    const char *dot = strrchr(name, '.');
+    return dot && m_suffixes.contains(QString::fromUtf8(dot + 1).toLower());
+}
+
+bool DirSnapshot::listDir(const QString &dir, DirRecord &record) const
+{
+    DIR *d = opendir(QFile::encodeName(dir).constData());
+    if (!d) {
+        return false;
+    }
+    const int fd = dirfd(d);
+    record.files.clear();
+    record.subDirs.clear();
+    record.entryCount = 0;
+    while (struct dirent *entry = readdir(d)) {
+        //跳过.和..以及隐藏文件、隐藏目录，与QDir默认行为一致
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        ++record.entryCount;
+        unsigned char type = entry->d_type;
+        if (DT_LNK == type && m_skipSymlinks) {
+            continue;
+        }
+        if (DT_DIR == type || DT_UNKNOWN == type) {
+            struct stat st;
+            if (DT_UNKNOWN == type && 0 == fstatat(fd, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) && S_ISDIR(st.st_mode)) {
+                type = DT_DIR;
+            }
+            if (DT_DIR == type) {
+                record.subDirs << QFile::decodeName(entry->d_name);
+                continue;
+            }
+        }
+        if (!matchSuffix(entry->d_name)) {
+            continue;
+        }
+        //只有变化的目录才会走到这里，图片文件逐个stat记录inode、大小和mtime
+        struct stat st;
+        if (0 != fstatat(fd, entry->d_name, &st, 0) || !S_ISREG(st.st_mode)) {
+            continue;
+        }
+        FileRecord file;
+        file.name = QFile::decodeName(entry->d_name);
+        file.inode = st.st_ino;
+        file.size = st.st_size;
+        file.mtime = mtimeOf(st);
+        record.files << file;
+    }
+    closedir(d);
+    return true;
+}
+
+QStringList DirSnapshot::rescan(const QString &root, Changes *changes)
+{
+    QString base = root;
+    while (base.size() > 1 && base.endsWith('/')) {
+        base.chop(1);
+    }
+    //在扫描开始的同一时刻被修改的目录无法与之后的修改区分，标记为下次重新列出
+    const qint64 racyLimit = (QDateTime::currentMSecsSinceEpoch() - 2000) * 1000000;
+    QHash<QString, DirRecord> scanned;
+    QStringList files;
+    QStringList stack;
+    stack << base;
+    while (!stack.isEmpty()) {
+        if (m_cancelCheck && m_cancelCheck()) {
+            return QStringList();
+        }
+        const QString dir = stack.takeLast();
+        struct stat st;
+        if (0 != stat(QFile::encodeName(dir).constData(), &st) || !S_ISDIR(st.st_mode)) {
+            continue;
+        }
+        const qint64 mtime = mtimeOf(st);
+        const auto old = m_dirs.constFind(dir);
+        const bool known = old != m_dirs.constEnd();
+        DirRecord record;
+        if (known && old->mtime == mtime) {
+            record = old.value();
+        } else {
+            if (!listDir(dir, record)) {
+                continue;
+            }
+            record.mtime = mtime < racyLimit ? mtime : -1;
+            if (changes) {
+                QHash<QString, const FileRecord *> oldFiles;
+                if (known) {
+                    for (const FileRecord &file : old->files) {
+                        oldFiles.insert(file.name, &file);
+                    }
+                }
+                for (const FileRecord &file : record.files) {
+                    const FileRecord *prev = oldFiles.take(file.name);
+                    if (!prev) {
+                        changes->added << dir + '/' + file.name;
+                    } else if (prev->inode != file.inode || prev->size != file.size || prev->mtime != file.mtime) {
+                        changes->modified << dir + '/' + file.name;
+                    }
+                }
+                for (const FileRecord *file : oldFiles) {
+                    changes->removed << dir + '/' + file->name;
+                }
+            }
+        }
+        for (const FileRecord &file : record.files) {
+            files << dir + '/' + file.name;
+        }
+        if (m_recursive) {
+            for (const QString &sub : record.subDirs) {
+                stack << dir + '/' + sub;
+            }
+        }
+        scanned.insert(dir, record);
+    }
+
+    //root下已消失的目录，其中的文件全部视为删除
+    const QString prefix = base + '/';
+    for (auto it = m_dirs.begin(); it != m_dirs.end();) {
+        if (it.key() == base || it.key().startsWith(prefix)) {
+            if (changes && !scanned.contains(it.key())) {
+                for (const FileRecord &file : it->files) {
+                    changes->removed << it.key() + '/' + file.name;
+                }
+            }
+            it = m_dirs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = scanned.constBegin(); it != scanned.constEnd(); ++it) {
+        m_dirs.insert(it.key(), it.value());
+    }
+    return files;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DIRSNAPSHOT_H
+#define DIRSNAPSHOT_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+
+#include <functional>
+
+/**
+ * @brief The DirSnapshot class
+ * 目录快照：记录每个目录的(mtime, 条目数)和其中图片的(文件名, inode, 大小, mtime)，保存在磁盘上。
+ * 再次扫描时只对每个目录stat一次，mtime未变的目录直接使用快照，不再列目录和stat文件。
+ * 目录mtime只反映增删改名，不反映文件内容修改，modified只在目录本身变化时才会检出。
+ */
+class DirSnapshot
+{
+public:
+    struct FileRecord {
+        QString name;
+        quint64 inode = 0;
+        qint64 size = 0;
+        qint64 mtime = 0;
+    };
+    struct DirRecord {
+        qint64 mtime = -1;          //纳秒，-1表示下次必须重新列出
+        quint32 entryCount = 0;
+        QVector<FileRecord> files;
+        QStringList subDirs;
+    };
+    struct Changes {
+        QStringList added;
+        QStringList removed;
+        QStringList modified;
+    };
+
+    //suffixes为不带点的后缀，不区分大小写；为空时记录全部文件
+    explicit DirSnapshot(const QStringList &suffixes = QStringList());
+
+    void setRecursive(bool recursive);
+    //不记录符号链接(对应QDir::NoSymLinks)
+    void setSkipSymlinks(bool skip);
+    //每个目录检查一次，返回true时中止扫描，快照保持不变
+    void setCancelCheck(const std::function<bool()> &check);
+
+    bool load(const QString &file);
+    bool save(const QString &file) const;
+    bool isEmpty() const;
+    //快照中的全部目录
+    QStringList dirs() const;
+
+    //按快照增量扫描root，返回root下的全部文件，changes为相对上次快照的变化；中止时返回空
+    QStringList rescan(const QString &root, Changes *changes = nullptr);
+
+    //key(如挂载点或监控目录)对应的快照文件
+    static QString snapshotFile(const QString &key);
+
+private:
+    bool matchSuffix(const char *name) const;
+    bool listDir(const QString &dir, DirRecord &record) const;
+
+    QHash<QString, DirRecord> m_dirs;
+    QSet<QString> m_suffixes;       //小写后缀
+    bool m_recursive = true;
+    bool m_skipSymlinks = false;
+    std::function<bool()> m_cancelCheck;
+};
+
+#endif // DIRSNAPSHOT_H
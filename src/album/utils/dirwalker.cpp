@@ -0,0 +1,254 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "dirwalker.h"
+
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+namespace {
+
+//glibc未导出getdents64的结构体定义
+struct linux_dirent64 {
+    quint64 d_ino;
+    qint64 d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+const int DIRENT_BUFFER_SIZE = 64 * 1024;
+const int MAX_SUFFIX_LENGTH = 15;
+
+//各线程共享的待遍历目录队列，pending为未处理完的目录数(含正在处理的)，降到0时全部结束
+struct WalkState {
+    QMutex mutex;
+    QWaitCondition cond;
+    QVector<QByteArray> dirs;
+    int pending = 0;
+    QMutex callbackMutex;
+    bool stopped = false;
+};
+
+}  // namespace
+
+DirWalker::DirWalker(const QStringList &suffixes)
+{
+    for (const QString &suffix : suffixes) {
+        const QByteArray lower = suffix.toLower().toLatin1();
+        if (!lower.isEmpty() && lower.size() <= MAX_SUFFIX_LENGTH && !m_suffixes.contains(lower)) {
+            m_suffixes << lower;
+        }
+    }
+}
+
+void DirWalker::setFanOut(int threads)
+{
+    m_fanOut = threads;
+}
+
+void DirWalker::setSkipSymlinks(bool skip)
+{
+    m_skipSymlinks = skip;
+}
+
+void DirWalker::setRecursive(bool recursive)
+{
+    m_recursive = recursive;
+}
+
+void DirWalker::setBatchSize(int size)
+{
+    m_batchSize = qMax(1, size);
+}
+
+void DirWalker::cancel()
+{
+    m_canceled.store(1);
+}
+
+bool DirWalker::matchSuffix(const char *name, int length) const
+{
+    if (m_suffixes.isEmpty()) {
+        return true;
+    }
+    const char *dot = static_cast<const char *>(memrchr(name, '.', static_cast<size_t>(length)));
+    if (!dot) {
+        return false;
+    }
+    const int suffixLength = length - static_cast<int>(dot - name) - 1;
+    if (suffixLength <= 0 || suffixLength > MAX_SUFFIX_LENGTH) {
+        return false;
+    }
+    //在栈上转小写后逐个比较
+    char lower[MAX_SUFFIX_LENGTH];
+    for (int i = 0; i < suffixLength; i++) {
+        const char c = dot[i + 1];
+        lower[i] = (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+    }
+    for (const QByteArray &suffix : m_suffixes) {
+        if (suffix.size() == suffixLength && 0 == memcmp(suffix.constData(), lower, static_cast<size_t>(suffixLength))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DirWalker::walk(const QStringList &roots, std::function<bool(const QStringList &)> onFiles)
+{
+    m_canceled.store(0);
+    WalkState state;
+    QStringList rootFiles;
+    for (const QString &root : roots) {
+        QByteArray path = QFile::encodeName(root);
+        struct stat st;
+        if (0 != stat(path.constData(), &st)) {
+            continue;
+        }
+        if (S_ISDIR(st.st_mode)) {
+            while (path.size() > 1 && path.endsWith('/')) {
+                path.chop(1);
+            }
+            state.dirs << path;
+        } else if (S_ISREG(st.st_mode)) {
+            //直接给出的文件只按后缀过滤
+            const QByteArray name = path.mid(path.lastIndexOf('/') + 1);
+            if (matchSuffix(name.constData(), name.size())) {
+                rootFiles << root;
+            }
+        }
+    }
+    state.pending = state.dirs.size();
+    if (!rootFiles.isEmpty() && !onFiles(rootFiles)) {
+        return false;
+    }
+
+    auto flush = [&](QStringList & batch) {
+        if (batch.isEmpty()) {
+            return;
+        }
+        QMutexLocker locker(&state.callbackMutex);
+        if (!state.stopped && !m_canceled.load() && !onFiles(batch)) {
+            state.stopped = true;
+            m_canceled.store(1);
+        }
+        batch.clear();
+    };
+
+    auto worker = [&]() {
+        QByteArray buffer(DIRENT_BUFFER_SIZE, Qt::Uninitialized);
+        QStringList batch;
+        forever {
+            QByteArray dir;
+            {
+                QMutexLocker locker(&state.mutex);
+                while (state.dirs.isEmpty() && state.pending > 0 && !m_canceled.load()) {
+                    state.cond.wait(&state.mutex);
+                }
+                if (state.dirs.isEmpty() || m_canceled.load()) {
+                    break;
+                }
+                dir = state.dirs.takeLast();
+            }
+            QVector<QByteArray> subDirs;
+            const int fd = openat(AT_FDCWD, dir.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (fd >= 0) {
+                long nread;
+                while (!m_canceled.load()
+                        && (nread = syscall(SYS_getdents64, fd, buffer.data(), DIRENT_BUFFER_SIZE)) > 0) {
+                    for (long pos = 0; pos < nread;) {
+                        const linux_dirent64 *entry = reinterpret_cast<const linux_dirent64 *>(buffer.constData() + pos);
+                        pos += entry->d_reclen;
+                        const char *name = entry->d_name;
+                        //跳过.和..以及隐藏文件、隐藏目录，与QDir默认行为一致
+                        if (name[0] == '.') {
+                            continue;
+                        }
+                        const int length = static_cast<int>(strlen(name));
+                        unsigned char type = entry->d_type;
+                        //文件系统不提供d_type时才stat
+                        if (DT_UNKNOWN == type || (DT_LNK == type && !m_skipSymlinks)) {
+                            struct stat st;
+                            if (0 != fstatat(fd, name, &st, DT_LNK == type ? 0 : AT_SYMLINK_NOFOLLOW)) {
+                                continue;
+                            }
+                            if (S_ISREG(st.st_mode)) {
+                                type = DT_REG;
+                            } else if (S_ISDIR(st.st_mode) && DT_UNKNOWN == type) {
+                                type = DT_DIR;
+                            } else {
+                                continue;
+                            }
+                        }
+                        if (DT_DIR == type) {
+                            if (m_recursive) {
+                                subDirs << dir + '/' + QByteArray(name, length);
+                            }
+                        } else if (DT_REG == type && matchSuffix(name, length)) {
+                            batch << QFile::decodeName(dir + '/' + QByteArray(name, length));
+                            if (batch.size() >= m_batchSize) {
+                                flush(batch);
+                            }
+                        }
+                    }
+                }
+                close(fd);
+            }
+            QMutexLocker locker(&state.mutex);
+            state.dirs << subDirs;
+            state.pending += subDirs.size() - 1;
+            if (!subDirs.isEmpty() || 0 == state.pending) {
+                state.cond.wakeAll();
+            }
+        }
+        flush(batch);
+        QMutexLocker locker(&state.mutex);
+        state.cond.wakeAll();
+    };
+
+    if (state.pending > 0) {
+        const int fanOut = m_fanOut > 0 ? m_fanOut : QThread::idealThreadCount();
+        QThreadPool pool;
+        pool.setMaxThreadCount(fanOut);
+        for (int i = 1; i < fanOut; i++) {
+            QtConcurrent::run(&pool, worker);
+        }
+        //调用线程也参与遍历
+        worker();
+        pool.waitForDone();
+    }
+    return !m_canceled.load();
+}
+
+QStringList DirWalker::walkAll(const QStringList &roots)
+{
+    QStringList files;
+    walk(roots, [&files](const QStringList & batch) {
+        files << batch;
+        return true;
+    });
+    return files;
+}
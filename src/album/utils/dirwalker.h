@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DIRWALKER_H
+#define DIRWALKER_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QVector>
+#include <QAtomicInt>
+#include <functional>
+
+/**
+ * @brief The DirWalker class
+ * 基于openat/getdents64的目录遍历：d_type可用时不对每个文件stat，按后缀过滤时不分配内存。
+ * 子目录由多个线程并行遍历，结果分批回调给调用方；回调已串行化，调用方无需加锁。
+ * 与QDir默认行为一致，不返回隐藏文件，也不进入隐藏目录。
+ */
+class DirWalker
+{
+public:
+    //suffixes为不带点的后缀，不区分大小写；为空时返回全部文件
+    explicit DirWalker(const QStringList &suffixes = QStringList());
+
+    //并行遍历的线程数，默认为CPU核数
+    void setFanOut(int threads);
+    //是否跳过符号链接(对应QDir::NoSymLinks)，目录的符号链接始终不进入
+    void setSkipSymlinks(bool skip);
+    void setRecursive(bool recursive);
+    //每批回调的文件数
+    void setBatchSize(int size);
+
+    //遍历roots，回调返回false时停止；正常结束返回true，取消返回false
+    bool walk(const QStringList &roots, std::function<bool(const QStringList &)> onFiles);
+    //遍历并一次性返回全部文件
+    QStringList walkAll(const QStringList &roots);
+    //可在任意线程调用
+    void cancel();
+
+private:
+    bool matchSuffix(const char *name, int length) const;
+
+    QVector<QByteArray> m_suffixes;     //小写后缀
+    int m_fanOut = 0;
+    int m_batchSize = 256;
+    bool m_skipSymlinks = false;
+    bool m_recursive = true;
+    QAtomicInt m_canceled;
+};
+
+#endif // DIRWALKER_H
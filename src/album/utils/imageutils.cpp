@@ -16,6 +16,7 @@
  */
 #include "utils/baseutils.h"
 #include "utils/imageutils.h"
+#include "utils/dirwalker.h"
 //#include "utils/imageutils_libexif.h"
 #include "utils/unionimage.h"
 #include <QBuffer>
@@ -26,6 +27,7 @@
 #include <QFileInfo>
 #include <QImage>
 #include <QImageReader>
+#include <QtAlgorithms>
 #include <QtSvg>
 #include <QMimeDatabase>
 #include <QMutexLocker>
@@ -100,30 +102,22 @@ bool imageSupportRead(const QString &path)
 const QFileInfoList getImagesInfo(const QString &dir, bool recursive)
 {
     QFileInfoList infos;
-
-    if (! recursive) {
-        auto nsl = QDir(dir).entryInfoList(QDir::Files);
-        for (QFileInfo info : nsl) {
-            if (imageSupportRead(info.absoluteFilePath())) {
-                infos << info;
-            }
-        }
-        return infos;
+    DirWalker walker(imageSupportSuffixes());
+    walker.setRecursive(recursive);
+    for (const QString &path : walker.walkAll(QStringList() << dir)) {
+        infos << QFileInfo(path);
     }
-
-    QDirIterator dirIterator(dir,
-                             QDir::Files,
-                             QDirIterator::Subdirectories);
-    while (dirIterator.hasNext()) {
-        dirIterator.next();
-        if (imageSupportRead(dirIterator.fileInfo().absoluteFilePath())) {
-            infos << dirIterator.fileInfo();
-        }
-    }
-
     return infos;
 }
 
+QStringList imageSupportSuffixes()
+{
+    QStringList suffixes = UnionImage_NameSpace::unionImageSupportFormat();
+    //与imageSupportRead保持一致
+    suffixes.removeAll("X3F");
+    return suffixes;
+}
+
 QStringList supportedImageFormats()
 {
     return UnionImage_NameSpace::unionImageSupportFormat();
@@ -166,6 +160,62 @@ QPixmap getDamagePixmap(bool bLight)
     }
 }
 
+//缩放为9x8灰度图，比较每行相邻像素的明暗得到64位
+quint64 dHash(const QImage &image)
+{
+    if (image.isNull()) {
+        return 0;
+    }
+    const QImage gray = image.scaled(9, 8, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+                        .convertToFormat(QImage::Format_Grayscale8);
+    quint64 hash = 0;
+    for (int y = 0; y < 8; y++) {
+        const uchar *line = gray.constScanLine(y);
+        for (int x = 0; x < 8; x++) {
+            hash = (hash << 1) | (line[x] > line[x + 1] ? 1 : 0);
+        }
+    }
+    //0保留为"未计算"，纯色图的哈希以1代替
+    return hash ? hash : 1;
+}
+
+int hashDistance(quint64 a, quint64 b)
+{
+    return qPopulationCount(a ^ b);
+}
+
+//缩放为16x16，按每通道3位量化统计，取像素最多的一格的平均色
+quint32 dominantColor(const QImage &image)
+{
+    if (image.isNull()) {
+        return 0;
+    }
+    const QImage small = image.scaled(16, 16, Qt::IgnoreAspectRatio, Qt::FastTransformation)
+                         .convertToFormat(QImage::Format_RGB32);
+    QVector<int> counts(512, 0);
+    QVector<int> sums(512 * 3, 0);
+    int best = 0;
+    for (int y = 0; y < small.height(); y++) {
+        const QRgb *line = reinterpret_cast<const QRgb *>(small.constScanLine(y));
+        for (int x = 0; x < small.width(); x++) {
+            const int r = qRed(line[x]);
+            const int g = qGreen(line[x]);
+            const int b = qBlue(line[x]);
+            const int bin = ((r >> 5) << 6) | ((g >> 5) << 3) | (b >> 5);
+            counts[bin]++;
+            sums[bin * 3] += r;
+            sums[bin * 3 + 1] += g;
+            sums[bin * 3 + 2] += b;
+            if (counts[bin] > counts[best]) {
+                best = bin;
+            }
+        }
+    }
+    const int n = qMax(1, counts[best]);
+    //不透明，因此有效值不会为0
+    return qRgb(sums[best * 3] / n, sums[best * 3 + 1] / n, sums[best * 3 + 2] / n);
+}
+
 }  // namespace image
 
 }  //namespace utils
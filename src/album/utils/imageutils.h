@@ -38,11 +38,19 @@ enum ThumbnailType {
 const QFileInfoList                 getImagesInfo(const QString &dir,
                                                   bool recursive = true);
 bool                                imageSupportRead(const QString &path);
+//imageSupportRead认可的全部后缀，供DirWalker过滤
+QStringList                         imageSupportSuffixes();
 //bool                                imageSupportSave(const QString &path);
 QStringList                         supportedImageFormats();
 //bool                                checkFileType(const QString &path);
 
 QPixmap                             getDamagePixmap(bool bLight = true);
+//64位差值感知哈希(dHash)，由缩略图计算，0表示无效
+quint64                             dHash(const QImage &image);
+//两个感知哈希的汉明距离
+int                                 hashDistance(quint64 a, quint64 b);
+//缩略图主色(不透明ARGB)，0表示无效
+quint32                             dominantColor(const QImage &image);
 }  // namespace image
 
 }  // namespace utils
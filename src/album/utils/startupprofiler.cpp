@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "startupprofiler.h"
+
+#include <QAbstractItemView>
+#include <QCoreApplication>
+#include <QEvent>
+#include <QDebug>
+
+StartupProfiler *StartupProfiler::m_instance = nullptr;
+
+StartupProfiler *StartupProfiler::instance()
+{
+    if (!m_instance) {
+        m_instance = new StartupProfiler();
+    }
+    return m_instance;
+}
+
+StartupProfiler::StartupProfiler(QObject *parent)
+    : QObject(parent)
+{
+    //第一次调用instance()在main()开头，以此为计时起点
+    m_timer.start();
+}
+
+void StartupProfiler::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+    if (m_enabled && QCoreApplication::instance()) {
+        connect(qApp, &QCoreApplication::aboutToQuit, this, &StartupProfiler::report, Qt::UniqueConnection);
+    }
+}
+
+bool StartupProfiler::isEnabled() const
+{
+    return m_enabled;
+}
+
+void StartupProfiler::mark(const QString &phase)
+{
+    if (!m_enabled) {
+        return;
+    }
+    qint64 ms = m_timer.elapsed();
+    m_phases.append(qMakePair(phase, ms));
+    qInfo().noquote() << QString("startup-profile: %1: %2 ms").arg(phase).arg(ms);
+}
+
+void StartupProfiler::watchFirstFrame(QWidget *window)
+{
+    if (!m_enabled || !window || m_firstFrameMs >= 0) {
+        return;
+    }
+    m_window = window;
+    window->installEventFilter(this);
+}
+
+void StartupProfiler::watchFirstGrid(QAbstractItemView *view)
+{
+    if (!m_enabled || !view || m_firstGridMs >= 0) {
+        return;
+    }
+    m_gridView = view;
+    view->viewport()->installEventFilter(this);
+}
+
+bool StartupProfiler::eventFilter(QObject *obj, QEvent *e)
+{
+    if (e->type() == QEvent::Paint) {
+        if (m_window && obj == m_window) {
+            m_window->removeEventFilter(this);
+            m_firstFrameMs = m_timer.elapsed();
+            mark("first frame");
+        } else if (m_gridView && obj == m_gridView->viewport()) {
+            //空列表的绘制不算首屏网格
+            if (m_gridView->model() && m_gridView->model()->rowCount() > 0) {
+                m_gridView->viewport()->removeEventFilter(this);
+                m_firstGridMs = m_timer.elapsed();
+                mark("first thumbnail grid");
+                report();
+            }
+        }
+    }
+    return QObject::eventFilter(obj, e);
+}
+
+void StartupProfiler::report()
+{
+    if (!m_enabled || m_reported) {
+        return;
+    }
+    m_reported = true;
+    auto text = [](qint64 ms) {
+        return ms < 0 ? QString("n/a") : QString("%1 ms").arg(ms);
+    };
+    qInfo().noquote() << QString("startup-profile: time to first frame %1, time to first thumbnail grid %2")
+                      .arg(text(m_firstFrameMs)).arg(text(m_firstGridMs));
+}
+
+qint64 StartupProfiler::firstFrameMs() const
+{
+    return m_firstFrameMs;
+}
+
+qint64 StartupProfiler::firstGridMs() const
+{
+    return m_firstGridMs;
+}
+
+QVector<QPair<QString, qint64>> StartupProfiler::phases() const
+{
+    return m_phases;
+}
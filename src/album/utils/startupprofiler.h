@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2016 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QVector>
+#include <QPair>
+
+class QWidget;
+class QAbstractItemView;
+
+/**
+ * @brief The StartupProfiler class
+ * 启动耗时统计，由--startup-profile开启，未开启时所有接口直接返回。
+ * 时间以进入main()为起点，记录各启动阶段、首帧绘制和首屏缩略图网格绘制的耗时。
+ */
+class StartupProfiler : public QObject
+{
+    Q_OBJECT
+public:
+    static StartupProfiler *instance();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    //记录一个阶段完成的时间点
+    void mark(const QString &phase);
+    //窗口第一次绘制时记录首帧时间
+    void watchFirstFrame(QWidget *window);
+    //缩略图列表有数据后第一次绘制时记录首屏网格时间，并输出汇总
+    void watchFirstGrid(QAbstractItemView *view);
+    //输出汇总，只输出一次；没有照片时在退出时输出
+    void report();
+
+    qint64 firstFrameMs() const;
+    qint64 firstGridMs() const;
+    QVector<QPair<QString, qint64>> phases() const;
+
+protected:
+    bool eventFilter(QObject *obj, QEvent *e) override;
+
+private:
+    explicit StartupProfiler(QObject *parent = nullptr);
+
+    static StartupProfiler *m_instance;
+    QElapsedTimer m_timer;
+    bool m_enabled = false;
+    bool m_reported = false;
+    qint64 m_firstFrameMs = -1;
+    qint64 m_firstGridMs = -1;
+    QPointer<QWidget> m_window;
+    QPointer<QAbstractItemView> m_gridView;
+    QVector<QPair<QString, qint64>> m_phases;
+};
+
+#endif // STARTUPPROFILER_H
@@ -1,13 +1,19 @@
 HEADERS += \
     $$PWD/baseutils.h \
+    $$PWD/dirsnapshot.h \
+    $$PWD/dirwalker.h \
     $$PWD/imageutils.h \
 #    $$PWD/shortcut.h \
     $$PWD/imageutils_libexif.h \
     $$PWD/snifferimageformat.h \
+    $$PWD/startupprofiler.h \
     $$PWD/unionimage.h
 
 SOURCES += \
     $$PWD/imageutils.cpp \
     $$PWD/baseutils.cpp \
+    $$PWD/dirsnapshot.cpp \
+    $$PWD/dirwalker.cpp \
 #    $$PWD/shortcut.cpp \
-    $$PWD/snifferimageformat.cpp
+    $$PWD/snifferimageformat.cpp \
+    $$PWD/startupprofiler.cpp
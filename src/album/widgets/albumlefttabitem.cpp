@@ -244,7 +244,7 @@ void AlbumLeftTabItem::onCheckNameValid()
         m_nameLabel->setVisible(true);
         m_pLineEdit->setVisible(false);
 
-        DBManager::instance()->insertIntoAlbum(newNameStr, QStringList(" "));
+        DBManager::instance()->insertIntoAlbumAsync(newNameStr, QStringList(" "));
 
         m_albumNameStr = newNameStr;
         emit dApp->signalM->sigUpdataAlbumRightTitle(m_albumNameStr);
@@ -18,6 +18,7 @@
 #include "controller/signalmanager.h"
 #include "utils/imageutils.h"
 #include "imageengineapi.h"
+#include "dbmanager/photocatalog.h"
 #include "utils/unionimage.h"
 #include "widgets/formlabel.h"
 
@@ -257,6 +258,11 @@ void ImgInfoDialog::updateBaseInfo(const QMap<QString, QString> &infos)
                 ImageDataSt st;
                 ImageEngineApi::instance()->getImageData(m_path, st);
                 value = st.dbi.albumSize;
+                //图库中的图片尺寸记录在目录中
+                const QSize size = PhotoCatalog::instance()->size(PhotoCatalog::instance()->idOf(m_path));
+                if (value.isEmpty() && !size.isEmpty()) {
+                    value = QString::number(size.width()) + "x" + QString::number(size.height());
+                }
                 if (value.isEmpty()) {
                     QImage tImg;
                     QString errMsg;
@@ -18,7 +18,7 @@ void StatusBar::initUI()
     setFixedHeight(27);
 
 //    QString str = QObject::tr("%1 photo(s)");
-    m_allPicNum = DBManager::instance()->getImgsCount();
+    //图片数由各视图异步统计后写入标签，这里不再同步查询数据库
 
     m_pAllPicNumLabel = new DLabel();
     AC_SET_OBJECT_NAME(m_pAllPicNumLabel, All_Pic_Count);
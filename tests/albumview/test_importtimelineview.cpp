@@ -107,8 +107,8 @@ TEST(ImportTimeLineView, thumbnaillistViewSlot_test)
     QTest::qWait(1000);
 
     ImportTimeLineView *impTimeline = w->m_pAlbumview->m_pImpTimeLineView;
-    if (impTimeline->m_allThumbnailListView.count() > 0) {
-        ThumbnailListView *tempThumbnailListView =  impTimeline->m_allThumbnailListView.first();
+    if (impTimeline->getFirstListView()->count() > 0) {
+        ThumbnailListView *tempThumbnailListView =  impTimeline->getFirstListView();
         ViewPanel *viewPanel = nullptr;
         QList<QWidget *> widgets = w->findChildren<QWidget *>();
         foreach (auto widget, widgets) {
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+
+#include <QSignalSpy>
+#include <QTest>
+
+#define private public
+#define protected public
+
+#include "application.h"
+#include "searchcontroller.h"
+#include "../test_qtestDefine.h"
+
+TEST(SearchController, likeContains)
+{
+    TEST_CASE_NAME("likeContains")
+    EXPECT_TRUE(SearchController::likeContains("IMG_2020.JPG", "img"));
+    EXPECT_TRUE(SearchController::likeContains("IMG_2020.JPG", ""));
+    EXPECT_TRUE(SearchController::likeContains("2020.05.22", "05.2"));
+    EXPECT_FALSE(SearchController::likeContains("IMG_2020.JPG", "png"));
+    //%和_按普通字符匹配，与查库时一致
+    EXPECT_FALSE(SearchController::likeContains("IMGX2020.JPG", "img_2"));
+    EXPECT_TRUE(SearchController::likeContains("IMG_2020.JPG", "img_2"));
+    EXPECT_TRUE(SearchController::likeContains("50%.jpg", "0%"));
+    //与sqlite一致，非ASCII字母区分大小写
+    EXPECT_FALSE(SearchController::likeContains("Ärger.jpg", "ä"));
+    EXPECT_TRUE(SearchController::likeContains("Ärger.jpg", "Är"));
+}
+
+TEST(SearchController, refine)
+{
+    TEST_CASE_NAME("refine")
+    DBImgInfoList infos;
+    for (int i = 0; i < 100; i++) {
+        DBImgInfo info;
+        info.fileName = QString("photo_%1.jpg").arg(i);
+        info.filePath = "/tmp/" + info.fileName;
+        info.time = QDateTime(QDate(2020, 1 + i % 12, 1));
+        infos << info;
+    }
+    //photo_1, photo_10..19
+    DBImgInfoList result = SearchController::refine(infos, "photo_1");
+    EXPECT_EQ(result.size(), 11);
+    EXPECT_EQ(result.first().fileName, QString("photo_1.jpg"));
+    EXPECT_EQ(result.last().fileName, QString("photo_19.jpg"));
+    //按Time列格式匹配
+    result = SearchController::refine(infos, "2020.12");
+    EXPECT_EQ(result.size(), 8);
+
+    SearchController *c = SearchController::instance();
+    c->cancel();
+    c->m_album = COMMON_STR_ALLPHOTOS;
+    c->m_keywords = "photo";
+    c->setResults(infos);
+    EXPECT_EQ(c->paths().size(), infos.size());
+    EXPECT_TRUE(c->canRefine("photo_1", COMMON_STR_ALLPHOTOS));
+    EXPECT_TRUE(c->canRefine("PHOTO_1", COMMON_STR_ALLPHOTOS));
+    EXPECT_TRUE(c->canRefine("photo%1", COMMON_STR_ALLPHOTOS));
+    EXPECT_FALSE(c->canRefine("hoto", COMMON_STR_ALLPHOTOS));
+    EXPECT_FALSE(c->canRefine("photo_1", COMMON_STR_TRASH));
+
+    //扩展关键字时在缓存中过滤，不查库
+    QSignalSpy spy(c, &SearchController::resultsReady);
+    c->search("photo_1", COMMON_STR_ALLPHOTOS);
+    EXPECT_TRUE(spy.wait(2000));
+    EXPECT_FALSE(spy.last().at(1).toBool());
+    EXPECT_TRUE(c->isFinished());
+    EXPECT_EQ(c->paths().size(), 11);
+    c->cancel();
+    EXPECT_TRUE(c->paths().isEmpty());
+}
+
+TEST(SearchController, debounce)
+{
+    TEST_CASE_NAME("debounce")
+    SearchController *c = SearchController::instance();
+    QSignalSpy spy(c, &SearchController::inputSettled);
+    c->inputChanged("a");
+    c->inputChanged("ab");
+    c->inputChanged("abc");
+    QTest::qWait(SEARCH_DEBOUNCE_INTERVAL * 3);
+    ASSERT_EQ(spy.count(), 1);
+    EXPECT_EQ(spy.first().at(0).toString(), QString("abc"));
+
+    //立即搜索时丢弃尚未触发的去抖
+    c->inputChanged("abcd");
+    c->flushInput();
+    QTest::qWait(SEARCH_DEBOUNCE_INTERVAL * 2);
+    EXPECT_EQ(spy.count(), 1);
+    c->cancel();
+}
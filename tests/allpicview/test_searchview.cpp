@@ -26,6 +26,8 @@ TEST(searchview, test_ini)
     event.simulate(w->getButG()->button(0));
     event.clear();
 
+    //搜索界面在第一次搜索时才创建
+    w->createSearchView();
     ASSERT_TRUE(w->m_pSearchView);
 }
 
@@ -51,6 +53,7 @@ TEST(searchview, search)
     TEST_CASE_NAME("search")
     MainWindow *w = dApp->getMainWindow();
     w->showEvent(nullptr);
+    w->createSearchView();
     SearchView *s = w->m_pSearchView;
     s->onSlideShowBtnClicked();
 }
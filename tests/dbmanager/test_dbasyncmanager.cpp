@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include "dbmanager/dbasyncmanager.h"
+#include "../test_qtestDefine.h"
+#include <QAtomicInt>
+#include <QSemaphore>
+
+namespace {
+//等待数据库线程上此前提交的请求全部执行完，并处理已投递的回调
+void drainDBThread()
+{
+    std::function<void()> noop = []() {};
+    DBAsyncManager::instance()->future(noop).waitForFinished();
+    QTest::qWait(50);
+}
+}
+
+TEST(DBAsyncManager, supersede)
+{
+    TEST_CASE_NAME("supersede")
+    QObject receiver;
+    QSemaphore gate;
+    std::function<void()> block = [&gate]() {
+        gate.acquire();
+    };
+    DBAsyncManager::instance()->future(block);
+
+    // 同tag的新请求到来后，排队中的旧请求不再执行
+    QAtomicInt oldRan(0);
+    int oldCalled = 0;
+    int newResult = 0;
+    std::function<int()> oldQuery = [&oldRan]() {
+        oldRan.ref();
+        return 1;
+    };
+    std::function<void(const int &)> oldCallback = [&oldCalled](const int &) {
+        oldCalled++;
+    };
+    std::function<int()> newQuery = []() {
+        return 2;
+    };
+    std::function<void(const int &)> newCallback = [&newResult](const int &result) {
+        newResult = result;
+    };
+    DBAsyncManager::instance()->query(&receiver, oldQuery, oldCallback, "test_supersede");
+    DBAsyncManager::instance()->query(&receiver, newQuery, newCallback, "test_supersede");
+    gate.release();
+    drainDBThread();
+    EXPECT_EQ(oldRan.load(), 0);
+    EXPECT_EQ(oldCalled, 0);
+    EXPECT_EQ(newResult, 2);
+
+    // 不带tag的请求互不影响
+    int untagged = 0;
+    std::function<void(const int &)> count = [&untagged](const int &) {
+        untagged++;
+    };
+    DBAsyncManager::instance()->query(&receiver, newQuery, count);
+    DBAsyncManager::instance()->query(&receiver, newQuery, count);
+    drainDBThread();
+    EXPECT_EQ(untagged, 2);
+}
+
+TEST(DBAsyncManager, cancelWhileRunning)
+{
+    TEST_CASE_NAME("cancelWhileRunning")
+    QObject receiver;
+    QSemaphore started;
+    QSemaphore gate;
+    QAtomicInt ran(0);
+    int called = 0;
+    std::function<int()> query = [&]() {
+        started.release();
+        gate.acquire();
+        ran.ref();
+        return 1;
+    };
+    std::function<void(const int &)> callback = [&called](const int &) {
+        called++;
+    };
+    DBAsyncManager::instance()->query(&receiver, query, callback, "test_running");
+    // 执行过程中作废：查询照常完成，但执行后的检查阻止投递回调
+    started.acquire();
+    DBAsyncManager::instance()->cancel("test_running");
+    gate.release();
+    drainDBThread();
+    EXPECT_EQ(ran.load(), 1);
+    EXPECT_EQ(called, 0);
+}
+
+TEST(DBAsyncManager, cancelBeforeCallback)
+{
+    TEST_CASE_NAME("cancelBeforeCallback")
+    QObject receiver;
+    int called = 0;
+    std::function<int()> query = []() {
+        return 1;
+    };
+    std::function<void(const int &)> callback = [&called](const int &) {
+        called++;
+    };
+
+    // 回调已投递但尚未在GUI线程执行时作废，回调内的检查将其丢弃
+    DBAsyncManager::instance()->query(&receiver, query, callback, "test_callback");
+    std::function<void()> noop = []() {};
+    DBAsyncManager::instance()->future(noop).waitForFinished();
+    DBAsyncManager::instance()->cancel("test_callback");
+    QTest::qWait(50);
+    EXPECT_EQ(called, 0);
+
+    // 对照：不作废时回调照常执行
+    DBAsyncManager::instance()->query(&receiver, query, callback, "test_callback");
+    drainDBThread();
+    EXPECT_EQ(called, 1);
+}
+
+TEST(DBAsyncManager, receiverDestroyed)
+{
+    TEST_CASE_NAME("receiverDestroyed")
+    int called = 0;
+    QObject *receiver = new QObject;
+    std::function<int()> query = []() {
+        return 1;
+    };
+    std::function<void(const int &)> callback = [&called](const int &) {
+        called++;
+    };
+    DBAsyncManager::instance()->query(receiver, query, callback);
+    delete receiver;
+    drainDBThread();
+    EXPECT_EQ(called, 0);
+}
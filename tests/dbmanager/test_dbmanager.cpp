@@ -3,10 +3,20 @@
 
 #include "application.h"
 #include "dbmanager.h"
+#include "dbasyncmanager.h"
 #include "DBandImgOperate.h"
+#include "photocatalog.h"
+#include "similarindex.h"
+#include "imageengine/imageenginethread.h"
+#include "imageengine/imageengineapi.h"
+#include "controller/signalmanager.h"
 #include "utils/baseutils.h"
 #include "utils/imageutils.h"
 #include "../test_qtestDefine.h"
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QtConcurrent>
 #include "ac-desktop-define.h"
 #include "mainwindow.h"
 
@@ -92,3 +102,562 @@ TEST(DBandImgOperate, DBImgOper)
     db->loadOneThumbnail(pic);
     db->getAllInfos();
 }
+
+TEST(AlbumCache, db12)
+{
+    TEST_CASE_NAME("db12")
+    QStringList paths;
+    paths << testPath_Pictures + "/a.jpg" << testPath_Pictures + "/aa.jpg";
+    DBManager::instance()->insertImgInfos(DBImgInfoList() << getDBInfo(paths.first()) << getDBInfo(paths.last()));
+    DBManager::instance()->removeAlbum("cacheAlbum");
+    //库中没有的图片不写入相册，也不进缓存
+    const QString notImported = testPath_Pictures + "/notImported.jpg";
+    DBManager::instance()->insertIntoAlbum("cacheAlbum", QStringList(paths) << notImported);
+    EXPECT_EQ(DBManager::instance()->getImgsCountByAlbum("cacheAlbum"), 2);
+    EXPECT_TRUE(DBManager::instance()->isImgExistInAlbum("cacheAlbum", paths.first()));
+    EXPECT_TRUE(DBManager::instance()->getAlbumNamesByPath(paths.first()).contains("cacheAlbum"));
+    EXPECT_FALSE(DBManager::instance()->isImgExistInAlbum("cacheAlbum", notImported));
+    EXPECT_TRUE(DBManager::instance()->getAlbumNamesByPath(notImported).isEmpty());
+
+    DBManager::instance()->removeFromAlbum("cacheAlbum", QStringList(paths.first()));
+    EXPECT_EQ(DBManager::instance()->getImgsCountByAlbum("cacheAlbum"), 1);
+    EXPECT_FALSE(DBManager::instance()->isImgExistInAlbum("cacheAlbum", paths.first()));
+
+    DBManager::instance()->renameAlbum("cacheAlbum", "newCacheAlbum");
+    EXPECT_EQ(DBManager::instance()->getImgsCountByAlbum("cacheAlbum"), 0);
+    EXPECT_TRUE(DBManager::instance()->getAlbumNamesByPath(paths.last()).contains("newCacheAlbum"));
+
+    DBManager::instance()->removeAlbum("newCacheAlbum");
+    EXPECT_EQ(DBManager::instance()->getImgsCountByAlbum("newCacheAlbum"), 0);
+    EXPECT_TRUE(DBManager::instance()->getAlbumNamesByPath(paths.last()).isEmpty());
+}
+
+TEST(ImageMetas, db13)
+{
+    TEST_CASE_NAME("db13")
+    QString pic = testPath_Pictures + "/39elz3.jpg";
+    DBImgInfo info = getDBInfo(pic);
+    EXPECT_GT(info.width, 0);
+    EXPECT_GT(info.height, 0);
+    EXPECT_GT(info.fileSize, 0);
+    EXPECT_EQ(info.displaySize(), QSize(info.width, info.height));
+
+    DBManager::instance()->insertImgInfos(DBImgInfoList() << info);
+    DBImgInfo stored = DBManager::instance()->getInfoByPath(pic);
+    EXPECT_EQ(stored.width, info.width);
+    EXPECT_EQ(stored.height, info.height);
+    EXPECT_EQ(stored.orientation, info.orientation);
+    EXPECT_EQ(stored.fileSize, info.fileSize);
+    EXPECT_EQ(stored.mtime, info.mtime);
+}
+
+TEST(PhotoCatalog, db14)
+{
+    TEST_CASE_NAME("db14")
+    PhotoCatalog *catalog = PhotoCatalog::instance();
+    catalog->load();
+    EXPECT_TRUE(catalog->isLoaded());
+    EXPECT_EQ(catalog->count(), DBManager::instance()->getImgsCount());
+
+    QString pic = testPath_Pictures + "/39elz3.jpg";
+    DBManager::instance()->insertImgInfos(DBImgInfoList() << getDBInfo(pic));
+    PhotoId id = catalog->idOf(pic);
+    EXPECT_TRUE(catalog->isValid(id));
+    EXPECT_EQ(catalog->path(id), pic);
+    EXPECT_EQ(catalog->fileName(id), QString("39elz3.jpg"));
+    EXPECT_EQ(catalog->info(id).filePath, pic);
+    //图片信息对话框从目录取尺寸
+    EXPECT_FALSE(catalog->size(id).isEmpty());
+    EXPECT_TRUE(catalog->idsByTime().contains(id));
+
+    DBManager::instance()->removeImgInfosNoSignal(QStringList(pic));
+    EXPECT_FALSE(catalog->isValid(id));
+    EXPECT_EQ(catalog->idOf(pic), INVALID_PHOTO_ID);
+}
+
+namespace {
+//生成旧版(TEXT PathHash)或新版(INTEGER ImageId)结构的测试库，返回(库文件大小, 相册联合查询耗时ms)
+QPair<qint64, qint64> benchSchema(bool intKeys, const QStringList &paths)
+{
+    const QString name = intKeys ? "bench_int" : "bench_text";
+    QString file = QDir::tempPath() + QDir::separator() + name + ".db";
+    QFile::remove(file);
+    qint64 joinMs = 0;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", name);
+        db.setDatabaseName(file);
+        db.open();
+        QSqlQuery query(db);
+        if (intKeys) {
+            query.exec("CREATE TABLE ImageTable3 (ImageId INTEGER primary key, PathKey INTEGER, FilePath TEXT)");
+            query.exec("CREATE INDEX ImagePathKeyIndex ON ImageTable3 (PathKey)");
+            query.exec("CREATE TABLE AlbumTable3 (AlbumId INTEGER primary key, AlbumName TEXT, ImageId INTEGER)");
+            query.exec("CREATE INDEX AlbumImageIdIndex ON AlbumTable3 (ImageId)");
+        } else {
+            query.exec("CREATE TABLE ImageTable3 (PathHash TEXT primary key, FilePath TEXT)");
+            query.exec("CREATE TABLE AlbumTable3 (AlbumId INTEGER primary key, AlbumName TEXT, PathHash TEXT)");
+            // 两种结构索引对等：图片表按键查找、相册表按引用列联合
+            query.exec("CREATE INDEX AlbumPathHashIndex ON AlbumTable3 (PathHash)");
+        }
+        query.exec("BEGIN");
+        QSqlQuery image(db), album(db);
+        if (intKeys) {
+            image.prepare("INSERT INTO ImageTable3 (ImageId, PathKey, FilePath) VALUES (?, ?, ?)");
+            album.prepare("INSERT INTO AlbumTable3 (AlbumName, ImageId) VALUES ('bench', ?)");
+        } else {
+            image.prepare("INSERT INTO ImageTable3 (PathHash, FilePath) VALUES (?, ?)");
+            album.prepare("INSERT INTO AlbumTable3 (AlbumName, PathHash) VALUES ('bench', ?)");
+        }
+        for (int i = 0; i < paths.size(); ++i) {
+            if (intKeys) {
+                image.addBindValue(i + 1);
+                image.addBindValue(utils::base::pathHash(paths[i]));
+            } else {
+                image.addBindValue(utils::base::hash(paths[i]));
+            }
+            image.addBindValue(paths[i]);
+            image.exec();
+            if (i % 4 == 0) {
+                album.addBindValue(intKeys ? QVariant(i + 1) : QVariant(utils::base::hash(paths[i])));
+                album.exec();
+            }
+        }
+        query.exec("COMMIT");
+        query.exec("VACUUM");
+        QElapsedTimer timer;
+        timer.start();
+        query.exec(intKeys ? "SELECT i.FilePath FROM AlbumTable3 AS a INNER JOIN ImageTable3 AS i ON i.ImageId = a.ImageId"
+                   : "SELECT i.FilePath FROM AlbumTable3 AS a INNER JOIN ImageTable3 AS i ON i.PathHash = a.PathHash");
+        while (query.next()) {}
+        joinMs = timer.elapsed();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+    qint64 size = QFileInfo(file).size();
+    QFile::remove(file);
+    return qMakePair(size, joinMs);
+}
+}
+
+TEST(PathKeyBench, db15)
+{
+    TEST_CASE_NAME("db15")
+    QStringList paths;
+    for (int i = 0; i < 100000; ++i) {
+        paths << QString("/home/user/Pictures/%1/IMG_%2.jpg").arg(i / 500).arg(i, 6, 10, QChar('0'));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    for (const QString &path : paths) {
+        utils::base::hash(path);
+    }
+    qint64 md5Ms = timer.restart();
+    QSet<qint64> keys;
+    for (const QString &path : paths) {
+        keys.insert(utils::base::pathHash(path));
+    }
+    qint64 xxhMs = timer.elapsed();
+    EXPECT_EQ(keys.size(), paths.size());
+    qDebug() << "hash 100k paths: md5" << md5Ms << "ms, xxh64" << xxhMs << "ms";
+
+    auto textKey = benchSchema(false, paths);
+    auto intKey = benchSchema(true, paths);
+    qDebug() << "TEXT PathHash keys: db" << textKey.first << "bytes, join" << textKey.second << "ms";
+    qDebug() << "INTEGER ImageId keys: db" << intKey.first << "bytes, join" << intKey.second << "ms";
+    EXPECT_LT(intKey.first, textKey.first);
+}
+
+TEST(ImportDedupBench, db16)
+{
+    TEST_CASE_NAME("db16")
+    // 20万张的图库中导入5万张，其中一半已存在；使用独立实例，不污染全局图库
+    PhotoCatalog catalog;
+    catalog.load();
+    DBImgInfoList library;
+    QStringList libraryPaths;
+    for (int i = 0; i < 200000; ++i) {
+        DBImgInfo info;
+        info.filePath = QString("/tmp/dedupbench/library/%1/IMG_%2.jpg").arg(i / 500).arg(i, 6, 10, QChar('0'));
+        info.fileName = info.filePath.mid(info.filePath.lastIndexOf('/') + 1);
+        library << info;
+        libraryPaths << info.filePath;
+    }
+    catalog.insertInfos(library);
+    QStringList importPaths;
+    for (int i = 0; i < 50000; ++i) {
+        importPaths << (i % 2 ? libraryPaths.at(i * 4)
+                        : QString("/tmp/dedupbench/import/IMG_%1.jpg").arg(i, 6, 10, QChar('0')));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const QVector<bool> imported = catalog.contains(importPaths);
+    qint64 hashMs = timer.restart();
+    EXPECT_EQ(imported.count(true), 25000);
+
+    // 旧实现为QStringList::contains，只抽样1000个并按比例推算
+    int listHits = 0;
+    for (int i = 0; i < 1000; ++i) {
+        listHits += libraryPaths.contains(importPaths.at(i)) ? 1 : 0;
+    }
+    qint64 listMs = timer.elapsed() * (importPaths.size() / 1000);
+    EXPECT_EQ(listHits, 500);
+    // 耗时只记录不断言，避免负载较高的构建机上偶发失败
+    qDebug() << "dedup 50k into 200k: hash index" << hashMs << "ms, QStringList (extrapolated)" << listMs << "ms";
+}
+
+TEST(ContentFingerprint, db17)
+{
+    TEST_CASE_NAME("db17")
+    QString tempDir = QDir::tempPath() + "/albumfingerprint";
+    QDir().mkpath(tempDir);
+    QByteArray content(512 * 1024, 'a');
+    for (int i = 0; i < content.size(); i += 7) {
+        content[i] = static_cast<char>(i % 251);
+    }
+    auto writeFile = [](const QString & path, const QByteArray & data) {
+        QFile file(path);
+        file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+        file.write(data);
+    };
+    writeFile(tempDir + "/a.jpg", content);
+    writeFile(tempDir + "/b.jpg", content);
+    // 改动采样范围之外的一个字节：指纹相同，整体哈希不同
+    QByteArray changed = content;
+    changed[100 * 1024] = 'z';
+    writeFile(tempDir + "/c.jpg", changed);
+
+    qint64 fa = utils::base::contentFingerprint(tempDir + "/a.jpg");
+    EXPECT_NE(fa, 0);
+    EXPECT_EQ(fa, utils::base::contentFingerprint(tempDir + "/b.jpg"));
+    EXPECT_EQ(fa, utils::base::contentFingerprint(tempDir + "/c.jpg"));
+    EXPECT_EQ(utils::base::fileContentHash(tempDir + "/a.jpg"), utils::base::fileContentHash(tempDir + "/b.jpg"));
+    EXPECT_NE(utils::base::fileContentHash(tempDir + "/a.jpg"), utils::base::fileContentHash(tempDir + "/c.jpg"));
+    EXPECT_EQ(utils::base::contentFingerprint(tempDir + "/missing.jpg"), 0);
+
+    PhotoCatalog *catalog = PhotoCatalog::instance();
+    if (!catalog->isLoaded()) {
+        catalog->load();
+    }
+    DBImgInfo info;
+    info.filePath = tempDir + "/a.jpg";
+    info.fileName = "a.jpg";
+    info.fingerprint = fa;
+    catalog->insertInfos(DBImgInfoList() << info);
+    QVector<PhotoId> ids = catalog->idsByFingerprint(fa);
+    EXPECT_EQ(ids.size(), 1);
+    EXPECT_EQ(catalog->path(ids.first()), info.filePath);
+    catalog->removePaths(QSet<QString>() << info.filePath);
+    EXPECT_TRUE(catalog->idsByFingerprint(fa).isEmpty());
+    QDir(tempDir).removeRecursively();
+}
+
+TEST(SimilarIndex, db18)
+{
+    TEST_CASE_NAME("db18")
+    QImage image(200, 150, QImage::Format_RGB32);
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x) {
+            image.setPixel(x, y, qRgb(x, y, (x * y) % 256));
+        }
+    }
+    quint64 hash = utils::image::dHash(image);
+    EXPECT_NE(hash, 0u);
+    // 轻微缩放后哈希应非常接近
+    quint64 scaledHash = utils::image::dHash(image.scaled(120, 90));
+    EXPECT_LE(utils::image::hashDistance(hash, scaledHash), SimilarIndex::MAX_DISTANCE);
+    EXPECT_EQ(utils::image::dHash(QImage()), 0u);
+
+    // 20万个随机哈希，每100个中插入一组3张的近似图片
+    qsrand(7);
+    QVector<quint64> hashes;
+    for (int i = 0; i < 200000; ++i) {
+        quint64 h = (static_cast<quint64>(qrand()) << 48) ^ (static_cast<quint64>(qrand()) << 32)
+                    ^ (static_cast<quint64>(qrand()) << 16) ^ static_cast<quint64>(qrand());
+        if (i % 100 == 2) {
+            h = hashes[i - 1] ^ 0x3;
+        } else if (i % 100 == 3) {
+            h = hashes[i - 2] ^ (Q_UINT64_C(1) << 40);
+        }
+        hashes << h;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    SimilarIndex index;
+    index.build(hashes);
+    qint64 buildMs = timer.restart();
+    QVector<int> similar = index.find(hashes[101]);
+    EXPECT_TRUE(similar.contains(101));
+    EXPECT_TRUE(similar.contains(102));
+    EXPECT_TRUE(similar.contains(103));
+    EXPECT_EQ(similar.first(), 101);
+    timer.restart();
+    QVector<QVector<int>> groups = index.groups();
+    qint64 groupMs = timer.elapsed();
+    // 耗时只记录不断言
+    qDebug() << "similar index 200k: build" << buildMs << "ms, group" << groupMs << "ms," << groups.size() << "groups";
+    EXPECT_GE(groups.size(), 2000);
+}
+
+TEST(PreviewColor, db19)
+{
+    TEST_CASE_NAME("db19")
+    // 大半为蓝色、少量红色的图片，主色应为蓝色
+    QImage image(160, 120, QImage::Format_RGB32);
+    image.fill(qRgb(20, 40, 200));
+    for (int y = 0; y < 30; ++y) {
+        for (int x = 0; x < image.width(); ++x) {
+            image.setPixel(x, y, qRgb(230, 10, 10));
+        }
+    }
+    const quint32 color = utils::image::dominantColor(image);
+    EXPECT_NE(color, 0u);
+    EXPECT_LT(qRed(color), 64);
+    EXPECT_GT(qBlue(color), 160);
+    EXPECT_EQ(utils::image::dominantColor(QImage()), 0u);
+    // 纯黑图片的主色也不能与"未计算"混淆
+    QImage black(32, 32, QImage::Format_RGB32);
+    black.fill(Qt::black);
+    EXPECT_NE(utils::image::dominantColor(black), 0u);
+
+    PhotoCatalog *catalog = PhotoCatalog::instance();
+    if (!catalog->isLoaded()) {
+        catalog->load();
+    }
+    DBImgInfo info;
+    info.filePath = "/tmp/album_preview_color/a.jpg";
+    info.fileName = "a.jpg";
+    catalog->insertInfos(DBImgInfoList() << info);
+    const QString missing = "/tmp/album_preview_color/missing.jpg";
+    EXPECT_EQ(catalog->previewColors(QStringList() << info.filePath << missing), QVector<quint32>() << 0 << 0);
+    // 回填主色后可批量取出，未带主色的更新不覆盖已有值
+    info.previewColor = color;
+    catalog->updateMetas(DBImgInfoList() << info);
+    EXPECT_EQ(catalog->previewColors(QStringList() << info.filePath << missing), QVector<quint32>() << color << 0);
+    info.previewColor = 0;
+    catalog->insertInfos(DBImgInfoList() << info);
+    EXPECT_EQ(catalog->previewColors(QStringList() << info.filePath).first(), color);
+    catalog->removePaths(QSet<QString>() << info.filePath);
+}
+
+namespace {
+DBImgInfoList fakeInfos(const QString &dir, int count)
+{
+    DBImgInfoList infos;
+    for (int i = 0; i < count; ++i) {
+        DBImgInfo info;
+        info.filePath = QString("%1/IMG_%2.jpg").arg(dir).arg(i);
+        info.fileName = QString("IMG_%1.jpg").arg(i);
+        info.time = QDateTime::currentDateTime();
+        info.changeTime = info.time;
+        info.importTime = info.time;
+        infos << info;
+    }
+    return infos;
+}
+}
+
+TEST(RemoveInTransaction, db20)
+{
+    TEST_CASE_NAME("db20")
+    const DBImgInfoList infos = fakeInfos("/tmp/album_remove_test", 5);
+    QStringList paths;
+    for (const DBImgInfo &info : infos) {
+        paths << info.filePath;
+    }
+    DBManager::instance()->insertImgInfos(infos);
+    DBManager::instance()->insertIntoAlbum("removeTestAlbum", paths.mid(0, 3));
+    EXPECT_EQ(DBManager::instance()->getInfosByPaths(paths).size(), 5);
+    EXPECT_EQ(DBManager::instance()->getImgsCountByAlbum("removeTestAlbum"), 3);
+
+    int removedCount = 0;
+    int removedInfos = 0;
+    QObject context;
+    QObject::connect(dApp->signalM, &SignalManager::imagesRemoved, &context, [&]() {
+        removedCount++;
+    });
+    QObject::connect(dApp->signalM, &SignalManager::imagesRemovedPar, &context, [&](const DBImgInfoList & removed) {
+        removedInfos += removed.size();
+    });
+
+    // 多次失效删除合并到数据库线程上的一个事务，图片与相册行一起删除，只通知一次
+    for (const QString &path : paths) {
+        ImageEngineApi::instance()->removeImage(path);
+    }
+    for (int i = 0; i < 100 && removedCount == 0; ++i) {
+        QTest::qWait(50);
+    }
+    QTest::qWait(300);
+    EXPECT_EQ(removedCount, 1);
+    EXPECT_EQ(removedInfos, 5);
+    EXPECT_TRUE(DBManager::instance()->getInfosByPaths(paths).isEmpty());
+    EXPECT_EQ(DBManager::instance()->getImgsCountByAlbum("removeTestAlbum"), 0);
+    EXPECT_FALSE(PhotoCatalog::instance()->contains(paths).contains(true));
+
+    // 同步接口同样只发送一次
+    removedCount = 0;
+    DBManager::instance()->insertImgInfos(infos);
+    DBManager::instance()->removeImgInfos(paths);
+    EXPECT_EQ(removedCount, 1);
+    EXPECT_TRUE(DBManager::instance()->getInfosByPaths(paths).isEmpty());
+    DBManager::instance()->removeAlbum("removeTestAlbum");
+}
+
+TEST(CatalogLoadRace, db21)
+{
+    TEST_CASE_NAME("db21")
+    // load()在锁外读取数据库期间到来的增删不能丢失
+    PhotoCatalog catalog;
+    const DBImgInfoList removed = fakeInfos("/tmp/catalog_load_race/removed", 100);
+    QSet<QString> removedPaths;
+    for (const DBImgInfo &info : removed) {
+        removedPaths << info.filePath;
+    }
+    catalog.load();
+    catalog.insertInfos(removed);
+
+    QFuture<void> loading = QtConcurrent::run(&catalog, &PhotoCatalog::load);
+    DBImgInfoList inserted;
+    int batch = 0;
+    do {
+        const DBImgInfoList infos = fakeInfos(QString("/tmp/catalog_load_race/%1").arg(batch++), 50);
+        catalog.insertInfos(infos);
+        inserted << infos;
+    } while (!loading.isFinished() && batch < 2000);
+    catalog.removePaths(removedPaths);
+    loading.waitForFinished();
+
+    QStringList insertedPaths;
+    for (const DBImgInfo &info : inserted) {
+        insertedPaths << info.filePath;
+    }
+    EXPECT_TRUE(catalog.isLoaded());
+    EXPECT_FALSE(catalog.contains(insertedPaths).contains(false));
+    EXPECT_FALSE(catalog.contains(removedPaths.toList()).contains(true));
+
+    // 重放记录在快照装入后清空，再次加载时不会带回已提交之外的数据
+    catalog.load();
+    EXPECT_FALSE(catalog.contains(insertedPaths).contains(true));
+}
+
+TEST(InsertNoSignal, db22)
+{
+    TEST_CASE_NAME("db22")
+    const DBImgInfoList infos = fakeInfos("/tmp/album_insert_nosignal", 3);
+    QStringList paths;
+    for (const DBImgInfo &info : infos) {
+        paths << info.filePath;
+    }
+    int insertedCount = 0;
+    QObject context;
+    QObject::connect(dApp->signalM, &SignalManager::imagesInserted, &context, [&]() {
+        insertedCount++;
+    });
+
+    // 导入时先静默写入图片和相册行，由调用方合并通知
+    EXPECT_TRUE(DBManager::instance()->insertImgInfosNoSignal(infos));
+    DBManager::instance()->insertIntoAlbumNoSignal("insertNoSignalAlbum", paths);
+    EXPECT_EQ(insertedCount, 0);
+    EXPECT_EQ(DBManager::instance()->getInfosByPaths(paths).size(), 3);
+    EXPECT_EQ(DBManager::instance()->getImgsCountByAlbum("insertNoSignalAlbum"), 3);
+    EXPECT_FALSE(DBManager::instance()->insertImgInfosNoSignal(DBImgInfoList()));
+
+    DBManager::instance()->insertImgInfos(infos);
+    EXPECT_EQ(insertedCount, 1);
+
+    DBManager::instance()->removeImgInfos(paths);
+    DBManager::instance()->removeAlbum("insertNoSignalAlbum");
+}
+
+TEST(TimelineSections, db23)
+{
+    TEST_CASE_NAME("db23")
+    // 3天各2张，一次查询按日期倒序分组
+    DBImgInfoList infos = fakeInfos("/tmp/album_timeline_sections", 6);
+    QStringList paths;
+    for (int i = 0; i < infos.size(); ++i) {
+        infos[i].time = QDateTime(QDate(1971, 1, 1 + i / 2), QTime(12, 0));
+        paths << infos.at(i).filePath;
+    }
+    DBManager::instance()->insertImgInfos(infos);
+
+    const DBTimelineSections sections = DBManager::instance()->getTimelineSections();
+    QStringList timelines;
+    for (const auto &section : sections) {
+        timelines << section.first;
+    }
+    const QStringList expected = QStringList() << "1971.01.03" << "1971.01.02" << "1971.01.01";
+    for (int i = 0; i < expected.size(); ++i) {
+        const int at = timelines.indexOf(expected.at(i));
+        ASSERT_GE(at, 0);
+        EXPECT_EQ(sections.at(at).second.size(), 2);
+        // 与逐个时间线查询的结果一致
+        EXPECT_EQ(sections.at(at).second.size(), DBManager::instance()->getInfosByTimeline(expected.at(i)).size());
+        if (i > 0) {
+            EXPECT_GT(timelines.indexOf(expected.at(i)), timelines.indexOf(expected.at(i - 1)));
+        }
+    }
+    EXPECT_EQ(timelines.size(), timelines.toSet().size());
+    EXPECT_EQ(timelines, DBManager::instance()->getAllTimelines());
+    EXPECT_FALSE(DBManager::instance()->getImportTimelineSections().isEmpty());
+
+    DBManager::instance()->removeImgInfos(paths);
+}
+
+TEST(KeywordBinding, db24)
+{
+    TEST_CASE_NAME("db24")
+    // 关键字含引号和通配符时按普通字符匹配，不破坏SQL
+    DBImgInfoList infos = fakeInfos("/tmp/album_keyword_binding", 2);
+    infos[0].fileName = "it's_50%.jpg";
+    infos[0].filePath = "/tmp/album_keyword_binding/it's_50%.jpg";
+    infos[1].fileName = "its0500x.jpg";
+    infos[1].filePath = "/tmp/album_keyword_binding/its0500x.jpg";
+    const QStringList paths = QStringList() << infos[0].filePath << infos[1].filePath;
+    DBManager::instance()->insertImgInfos(infos);
+    DBManager::instance()->insertIntoAlbum("keywordBindingAlbum", paths);
+
+    DBImgInfoList found = DBManager::instance()->getInfosForKeyword("it's_50%");
+    ASSERT_EQ(found.size(), 1);
+    EXPECT_EQ(found.first().filePath, infos[0].filePath);
+    found = DBManager::instance()->getInfosForKeyword("keywordBindingAlbum", "s_5");
+    ASSERT_EQ(found.size(), 1);
+    EXPECT_EQ(found.first().filePath, infos[0].filePath);
+    EXPECT_TRUE(DBManager::instance()->getInfosForKeyword("' OR '1'='1").isEmpty());
+    EXPECT_TRUE(DBManager::instance()->getTrashInfosForKeyword("' OR '1'='1").isEmpty());
+
+    DBManager::instance()->removeImgInfos(paths);
+    DBManager::instance()->removeAlbum("keywordBindingAlbum");
+}
+
+TEST(AlbumAsyncRollback, db25)
+{
+    TEST_CASE_NAME("db25")
+    DBImgInfoList infos = fakeInfos("/tmp/album_async_rollback", 1);
+    DBManager::instance()->insertImgInfos(infos);
+    const QString imported = infos.first().filePath;
+    const QString notImported = "/tmp/album_async_rollback/notImported.jpg";
+    DBManager::instance()->removeAlbum("asyncAlbum");
+    DBManager::instance()->removeAlbum("asyncEmptyAlbum");
+    EXPECT_FALSE(DBManager::instance()->isAlbumExistInDB("asyncAlbum"));
+
+    // 缓存立即可见，写库完成后撤销库中没有的图片
+    DBManager::instance()->insertIntoAlbumAsync("asyncAlbum", QStringList() << imported << notImported);
+    EXPECT_TRUE(DBManager::instance()->isImgExistInAlbum("asyncAlbum", notImported));
+    std::function<bool()> barrier = []() {
+        return true;
+    };
+    DBAsyncManager::instance()->future(barrier).waitForFinished();
+    EXPECT_TRUE(DBManager::instance()->isImgExistInAlbum("asyncAlbum", imported));
+    EXPECT_FALSE(DBManager::instance()->isImgExistInAlbum("asyncAlbum", notImported));
+    EXPECT_TRUE(DBManager::instance()->getAlbumNamesByPath(notImported).isEmpty());
+
+    // 一张都没写入的新相册从缓存中去掉
+    DBManager::instance()->insertIntoAlbumAsync("asyncEmptyAlbum", QStringList(notImported));
+    DBAsyncManager::instance()->future(barrier).waitForFinished();
+    EXPECT_FALSE(DBManager::instance()->isAlbumExistInDB("asyncEmptyAlbum"));
+
+    DBManager::instance()->removeAlbum("asyncAlbum");
+    DBManager::instance()->removeImgInfosNoSignal(QStringList(imported));
+}
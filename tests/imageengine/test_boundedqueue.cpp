@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include "imageengine/boundedqueue.h"
+#include "../test_qtestDefine.h"
+#include <QtConcurrent>
+
+TEST(BoundedQueue, ie1)
+{
+    TEST_CASE_NAME("ie1")
+    BoundedQueue<int> queue(4);
+    // 生产者在队列满时阻塞，消费者按顺序取完后退出
+    QFuture<void> producer = QtConcurrent::run([&queue]() {
+        for (int i = 0; i < 100; i++) {
+            queue.push(i);
+        }
+        queue.close();
+    });
+    int item = -1;
+    int expected = 0;
+    while (queue.pop(item)) {
+        EXPECT_EQ(item, expected++);
+    }
+    producer.waitForFinished();
+    EXPECT_EQ(expected, 100);
+    EXPECT_FALSE(queue.push(100));
+}
+
+TEST(BoundedQueue, ie2)
+{
+    TEST_CASE_NAME("ie2")
+    BoundedQueue<int> queue(2);
+    queue.push(1);
+    queue.push(2);
+    // 队列满时取消应唤醒阻塞的生产者
+    QFuture<bool> producer = QtConcurrent::run([&queue]() {
+        return queue.push(3);
+    });
+    queue.abort();
+    EXPECT_FALSE(producer.result());
+    QList<int> items;
+    EXPECT_FALSE(queue.popBatch(items, 10, 10));
+    EXPECT_TRUE(items.isEmpty());
+}
+
+TEST(BoundedQueue, ie3)
+{
+    TEST_CASE_NAME("ie3")
+    BoundedQueue<int> queue(8);
+    QList<int> items;
+    // 超时返回true但没有数据
+    EXPECT_TRUE(queue.popBatch(items, 4, 10));
+    EXPECT_TRUE(items.isEmpty());
+    for (int i = 0; i < 6; i++) {
+        queue.push(i);
+    }
+    EXPECT_TRUE(queue.popBatch(items, 4, 10));
+    EXPECT_EQ(items.size(), 4);
+    queue.close();
+    items.clear();
+    EXPECT_TRUE(queue.popBatch(items, 4, 10));
+    EXPECT_EQ(items.size(), 2);
+    items.clear();
+    EXPECT_FALSE(queue.popBatch(items, 4, 10));
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include "imageengine/copyengine.h"
+#include "../test_qtestDefine.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+
+namespace {
+
+QByteArray makeData(int size, char seed)
+{
+    QByteArray data(size, Qt::Uninitialized);
+    for (int i = 0; i < size; ++i) {
+        data[i] = static_cast<char>(seed + i * 31);
+    }
+    return data;
+}
+
+void writeFile(const QString &path, const QByteArray &data)
+{
+    QFile f(path);
+    f.open(QIODevice::WriteOnly);
+    f.write(data);
+}
+
+}  // namespace
+
+TEST(CopyEngine, ie6)
+{
+    TEST_CASE_NAME("ie6")
+    const QString root = QDir::tempPath() + "/albumcopy1";
+    QDir(root).removeRecursively();
+    QDir().mkpath(root + "/src/a");
+    QDir().mkpath(root + "/src/b");
+    const QString journal = root + "/import.journal";
+    //不同目录下的同名文件
+    const QByteArray dataA = makeData(3 * 1024 * 1024 + 7, 'a');
+    const QByteArray dataB = makeData(1000, 'b');
+    writeFile(root + "/src/a/IMG_1.jpg", dataA);
+    writeFile(root + "/src/b/IMG_1.jpg", dataB);
+    writeFile(root + "/src/b/empty.png", QByteArray());
+
+    QStringList targets;
+    QMutex mutex;
+    {
+        CopyEngine engine(root + "/dst", journal);
+        const bool finished = engine.run(QStringList() << root + "/src/a/IMG_1.jpg" << root + "/src/b/IMG_1.jpg"
+                                         << root + "/src/b/empty.png" << root + "/src/none.jpg",
+        [&](const CopyEngine::Item & item) {
+            if (item.ok) {
+                QMutexLocker locker(&mutex);
+                targets << item.target;
+            }
+            return true;
+        });
+        EXPECT_TRUE(finished);
+        EXPECT_EQ(engine.filesCopied(), 3);
+        EXPECT_EQ(engine.bytesCopied(), dataA.size() + dataB.size());
+    }
+    ASSERT_EQ(targets.size(), 3);
+    EXPECT_EQ(targets.toSet().size(), 3);
+    for (const QString &target : targets) {
+        QFile f(target);
+        f.open(QIODevice::ReadOnly);
+        const QByteArray data = f.readAll();
+        EXPECT_TRUE(data == dataA || data == dataB || data.isEmpty());
+    }
+    //没有留下临时文件
+    EXPECT_EQ(QDir(root + "/dst").entryList(QDir::Files | QDir::Hidden).size(), 3);
+
+    //未调用finish()相当于中断，再次导入时使用已拷贝的文件
+    {
+        CopyEngine engine(root + "/dst", journal);
+        const CopyEngine::Item item = engine.copyOne(root + "/src/a/IMG_1.jpg");
+        EXPECT_TRUE(item.ok);
+        EXPECT_TRUE(item.resumed);
+        EXPECT_TRUE(targets.contains(item.target));
+        EXPECT_EQ(engine.filesCopied(), 0);
+        engine.finish();
+    }
+    EXPECT_FALSE(QFileInfo::exists(journal));
+    {
+        CopyEngine engine(root + "/dst", journal);
+        const CopyEngine::Item item = engine.copyOne(root + "/src/a/IMG_1.jpg");
+        EXPECT_TRUE(item.ok);
+        EXPECT_FALSE(item.resumed);
+        engine.finish();
+    }
+
+    QDir(root).removeRecursively();
+}
+
+//与逐个QFile::copy比较：200个2MB文件
+TEST(CopyEngine, ie7)
+{
+    TEST_CASE_NAME("ie7")
+    const QString root = QDir::tempPath() + "/albumcopy2";
+    QDir(root).removeRecursively();
+    QDir().mkpath(root + "/src");
+    QDir().mkpath(root + "/qfile");
+    const QByteArray data = makeData(2 * 1024 * 1024, 'x');
+    QStringList sources;
+    for (int i = 0; i < 200; ++i) {
+        sources << QString("%1/src/IMG_%2.jpg").arg(root).arg(i);
+        writeFile(sources.last(), data);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    for (const QString &source : sources) {
+        QFile::copy(source, root + "/qfile/" + QFileInfo(source).fileName());
+    }
+    const qint64 qfileMs = timer.elapsed();
+
+    timer.restart();
+    CopyEngine engine(root + "/dst", root + "/import.journal");
+    EXPECT_TRUE(engine.run(sources, nullptr));
+    const qint64 engineMs = timer.elapsed();
+    engine.finish();
+    qDebug() << "copy QFile::copy" << qfileMs << "ms, CopyEngine" << engineMs << "ms,"
+             << engine.mbPerSecond() << "MB/s," << engine.filesPerSecond() << "files/s";
+
+    EXPECT_EQ(engine.filesCopied(), sources.size());
+    EXPECT_EQ(engine.bytesCopied(), static_cast<qint64>(data.size()) * sources.size());
+
+    QDir(root).removeRecursively();
+}
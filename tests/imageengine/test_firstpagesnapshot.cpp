@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include "imageengine/firstpagesnapshot.h"
+#include "../test_qtestDefine.h"
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+namespace {
+
+DBImgInfo makeInfo(const QString &name)
+{
+    DBImgInfo info;
+    info.filePath = "/tmp/firstpage/" + name;
+    info.fileName = name;
+    info.time = QDateTime(QDate(2020, 12, 1), QTime(8, 30));
+    return info;
+}
+
+QImage makeImage(int width, int height, QColor color)
+{
+    QImage image(width, height, QImage::Format_RGB32);
+    image.fill(color);
+    return image;
+}
+
+}  // namespace
+
+TEST(FirstPageSnapshot, saveAndLoad)
+{
+    TEST_CASE_NAME("saveAndLoad")
+    QTemporaryDir dir;
+    const QString file = dir.path() + "/first/page.snap";
+
+    FirstPageSnapshot snapshot;
+    snapshot.setGeometry(QSize(1300, 848), 4);
+    snapshot.append(makeInfo("a.jpg"), makeImage(300, 200, Qt::red));
+    snapshot.append(makeInfo("b.jpg"), makeImage(200, 400, Qt::green));
+    snapshot.append(makeInfo("damaged.jpg"), QImage());
+    //宽图会换行
+    for (int i = 0; i < 20; i++) {
+        snapshot.append(makeInfo(QString("c%1.jpg").arg(i)), makeImage(800, 400, Qt::blue));
+    }
+    //短边缩到200
+    ASSERT_EQ(QSize(300, 200), snapshot.thumbnail(0).size());
+    ASSERT_EQ(QSize(200, 400), snapshot.thumbnail(1).size());
+    ASSERT_EQ(QSize(400, 200), snapshot.thumbnail(3).size());
+    ASSERT_TRUE(snapshot.save(file));
+
+    FirstPageSnapshot loaded;
+    ASSERT_TRUE(loaded.load(file));
+    ASSERT_EQ(23, loaded.count());
+    ASSERT_TRUE(loaded.matches(QSize(1300, 848), 4));
+    ASSERT_FALSE(loaded.matches(QSize(1300, 848), 5));
+    ASSERT_EQ(QString("/tmp/firstpage/b.jpg"), loaded.info(1).filePath);
+    ASSERT_EQ(QString("c19.jpg"), loaded.info(22).fileName);
+    ASSERT_EQ(makeInfo("a.jpg").time, loaded.info(0).time);
+    ASSERT_EQ(QSize(300, 200), loaded.thumbnail(0).size());
+    ASSERT_EQ(QSize(200, 400), loaded.thumbnail(1).size());
+    ASSERT_TRUE(loaded.thumbnail(2).isNull());
+    ASSERT_EQ(QSize(400, 200), loaded.thumbnail(22).size());
+    //JPEG有损，只比较大致颜色
+    QColor c = loaded.thumbnail(1).pixelColor(100, 200);
+    ASSERT_GT(c.green(), 200);
+    ASSERT_LT(c.red(), 50);
+}
+
+TEST(FirstPageSnapshot, broken)
+{
+    TEST_CASE_NAME("broken")
+    QTemporaryDir dir;
+    const QString file = dir.path() + "/page.snap";
+    FirstPageSnapshot snapshot;
+    ASSERT_FALSE(snapshot.load(file));
+
+    QFile f(file);
+    f.open(QIODevice::WriteOnly);
+    f.write("not a snapshot");
+    f.close();
+    ASSERT_FALSE(snapshot.load(file));
+    ASSERT_TRUE(snapshot.isEmpty());
+}
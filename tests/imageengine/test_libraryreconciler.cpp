@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+
+#include <QTest>
+
+#define private public
+#define protected public
+
+#include "application.h"
+#include "controller/signalmanager.h"
+#include "dbmanager/dbmanager.h"
+#include "imageengine/libraryreconciler.h"
+#include "../test_qtestDefine.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+
+TEST(LibraryReconciler, ie4)
+{
+    TEST_CASE_NAME("ie4")
+    const QString dir = QDir::tempPath() + "/albumreconcile";
+    QDir().mkpath(dir);
+    QFile f(dir + "/a.jpg");
+    f.open(QIODevice::WriteOnly);
+    f.close();
+
+    EXPECT_TRUE(LibraryReconciler::fileExists(dir + "/a.jpg"));
+    EXPECT_TRUE(LibraryReconciler::fileExists(dir));
+    EXPECT_FALSE(LibraryReconciler::fileExists(dir + "/b.jpg"));
+    //上级是普通文件(ENOTDIR)同样视为丢失
+    EXPECT_FALSE(LibraryReconciler::fileExists(dir + "/a.jpg/c.jpg"));
+
+    QDir(dir).removeRecursively();
+}
+
+//与QFileInfo::exists比较单线程核对开销
+TEST(LibraryReconciler, ie5)
+{
+    TEST_CASE_NAME("ie5")
+    const QString dir = QDir::tempPath() + "/albumreconcile2";
+    QDir().mkpath(dir);
+    QStringList paths;
+    for (int i = 0; i < 20000; ++i) {
+        paths << QString("%1/IMG_%2.jpg").arg(dir).arg(i);
+        if (i % 2 == 0) {
+            QFile f(paths.last());
+            f.open(QIODevice::WriteOnly);
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    int statxCount = 0;
+    for (const QString &path : paths) {
+        statxCount += LibraryReconciler::fileExists(path) ? 1 : 0;
+    }
+    const qint64 statxMs = timer.elapsed();
+    timer.restart();
+    int infoCount = 0;
+    for (const QString &path : paths) {
+        infoCount += QFileInfo(path).exists() ? 1 : 0;
+    }
+    const qint64 infoMs = timer.elapsed();
+    qDebug() << "reconcile statx" << statxMs << "ms, QFileInfo" << infoMs << "ms";
+
+    EXPECT_EQ(statxCount, 10000);
+    EXPECT_EQ(statxCount, infoCount);
+
+    QDir(dir).removeRecursively();
+}
+
+TEST(LibraryReconciler, ie8)
+{
+    TEST_CASE_NAME("ie8")
+    LibraryReconciler reconciler;
+    //不启动核对线程，直接检查取批顺序
+    reconciler.m_workers = 1000;
+    QStringList paths;
+    for (int i = 0; i < 300; ++i) {
+        paths << QString("/tmp/albumreconcile3/IMG_%1.jpg").arg(i);
+    }
+    reconciler.reconcile(paths);
+    reconciler.prioritize(paths.at(150));
+    reconciler.prioritize(paths.at(290));
+    //不在队列中的路径不处理
+    reconciler.prioritize("/tmp/albumreconcile3/unknown.jpg");
+
+    // 可见项排在最前，后加入的先核对，之后按加入顺序
+    QStringList batch;
+    ASSERT_TRUE(reconciler.takeBatch(batch));
+    ASSERT_GE(batch.size(), 3);
+    EXPECT_EQ(batch.at(0), paths.at(290));
+    EXPECT_EQ(batch.at(1), paths.at(150));
+    EXPECT_EQ(batch.at(2), paths.at(0));
+    EXPECT_FALSE(batch.contains("/tmp/albumreconcile3/unknown.jpg"));
+
+    // 优先核对过的路径不再出现
+    QStringList all = batch;
+    batch.clear();
+    while (reconciler.takeBatch(batch)) {
+        all << batch;
+        batch.clear();
+    }
+    EXPECT_EQ(all.size(), paths.size());
+    EXPECT_EQ(all.count(paths.at(150)), 1);
+    EXPECT_EQ(all.count(paths.at(290)), 1);
+    reconciler.m_workers = 0;
+}
+
+TEST(LibraryReconciler, ie9)
+{
+    TEST_CASE_NAME("ie9")
+    const QString dir = QDir::tempPath() + "/albumreconcile4";
+    QDir(dir).removeRecursively();
+    QDir().mkpath(dir);
+    DBImgInfoList infos;
+    QStringList present;
+    QStringList missing;
+    for (int i = 0; i < 1200; ++i) {
+        DBImgInfo info;
+        info.filePath = QString("%1/IMG_%2.jpg").arg(dir).arg(i);
+        info.fileName = QString("IMG_%1.jpg").arg(i);
+        info.time = QDateTime::currentDateTime();
+        info.changeTime = info.time;
+        info.importTime = info.time;
+        infos << info;
+        if (i % 6 == 0) {
+            QFile f(info.filePath);
+            f.open(QIODevice::WriteOnly);
+            present << info.filePath;
+        } else {
+            missing << info.filePath;
+        }
+    }
+    DBManager::instance()->insertImgInfos(infos);
+
+    int removals = 0;
+    QObject context;
+    QObject::connect(dApp->signalM, &SignalManager::imagesRemoved, &context, [&removals]() {
+        ++removals;
+    });
+    LibraryReconciler reconciler;
+    QStringList paths;
+    for (const DBImgInfo &info : infos) {
+        paths << info.filePath;
+    }
+    reconciler.reconcile(paths);
+    reconciler.m_pool.waitForDone();
+    QTest::qWait(100);
+
+    // 丢失的文件从数据库删除，存在的保留
+    EXPECT_TRUE(DBManager::instance()->getInfosByPaths(missing).isEmpty());
+    EXPECT_EQ(DBManager::instance()->getInfosByPaths(present).size(), present.size());
+    // 分批删除，不是每个文件一次
+    EXPECT_GE(removals, 1);
+    EXPECT_LT(removals, 10);
+    // 已核对存在的路径不再重复核对
+    EXPECT_TRUE(reconciler.m_verified.contains(present.first()));
+
+    DBManager::instance()->removeImgInfosNoSignal(present);
+    QDir(dir).removeRecursively();
+}
@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+
+#include <QElapsedTimer>
+
+#define private public
+#define protected public
+
+#include "application.h"
+#include "ttbcontent.h"
+#include "../../test_qtestDefine.h"
+
+TEST(TTBContent, recycledSlots)
+{
+    TEST_CASE_NAME("recycledSlots")
+    QWidget parent;
+    QStringList paths;
+    for (int i = 0; i < 50000; i++) {
+        paths << QString("/tmp/ttbcontent_%1.jpg").arg(i);
+    }
+    QElapsedTimer timer;
+    timer.start();
+    TTBContent *ttbc = new TTBContent(false, paths, &parent);
+    ttbc->setImage(paths.at(25000));
+    ttbc->requestSomeImages();
+    qDebug() << "open filmstrip:" << timer.elapsed() << "ms";
+
+    //槽位数只与可见宽度有关
+    int slotCount = ttbc->m_imgList->findChildren<ImageItem *>().size();
+    EXPECT_EQ(slotCount, ttbc->m_slots.size());
+    EXPECT_LT(slotCount, 200);
+    EXPECT_EQ(ttbc->m_nowIndex, 25000);
+    EXPECT_NE(ttbc->slotOfIndex(25000), nullptr);
+
+    //模拟拖动到列表两端，槽位重新绑定而不是新建
+    ttbc->m_imgList->move(0, 0);
+    ttbc->layoutSlots();
+    EXPECT_NE(ttbc->slotOfIndex(0), nullptr);
+    EXPECT_EQ(ttbc->slotOfIndex(0)->_path, paths.first());
+    ttbc->m_imgList->move(-(paths.size() * THUMBNAIL_WIDTH), 0);
+    ttbc->layoutSlots();
+    EXPECT_NE(ttbc->slotOfIndex(paths.size() - 1), nullptr);
+    EXPECT_EQ(ttbc->m_imgList->findChildren<ImageItem *>().size(), slotCount);
+
+    //下一张走就近查找
+    ttbc->setImage(paths.at(25001));
+    EXPECT_EQ(ttbc->m_nowIndex, 25001);
+    ttbc->deleteImage();
+    EXPECT_EQ(ttbc->itemLoadedSize(), paths.size() - 1);
+    EXPECT_EQ(ttbc->getIndexPath(25001), paths.at(25002));
+    EXPECT_EQ(ttbc->m_imgList->findChildren<ImageItem *>().size(), slotCount);
+}
@@ -0,0 +1,232 @@
+#include <gtest/gtest.h>
+
+#include "fileinotify.h"
+#include "application.h"
+#include "controller/signalmanager.h"
+#include "utils/dirsnapshot.h"
+#include "test_qtestDefine.h"
+#include <QDir>
+#include <QFile>
+#include <sys/inotify.h>
+
+namespace {
+
+//直接向事件处理注入构造的inotify事件，并读取内部状态
+class InotifyProbe : public FileInotify
+{
+public:
+    void inject(uint32_t mask, const QString &dir, const QString &name = QString())
+    {
+        const QByteArray encoded = QFile::encodeName(name);
+        QByteArray buf(static_cast<int>(sizeof(inotify_event)) + encoded.size() + 1, '\0');
+        inotify_event *event = reinterpret_cast<inotify_event *>(buf.data());
+        QMutexLocker locker(&m_mutex);
+        event->wd = dir.isEmpty() ? -1 : watchedDirId.value(dir, -1);
+        event->mask = mask;
+        event->len = name.isEmpty() ? 0 : static_cast<uint32_t>(encoded.size() + 1);
+        memcpy(event->name, encoded.constData(), static_cast<size_t>(encoded.size()));
+        handleEventLocked(event);
+    }
+    bool isKnown(const QString &path)
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_allPic.contains(path);
+    }
+    QStringList pending()
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_newFile;
+    }
+    bool isWatching(const QString &dir)
+    {
+        QMutexLocker locker(&m_mutex);
+        return watchedDirId.contains(dir);
+    }
+};
+
+void touch(const QString &path)
+{
+    QFile f(path);
+    f.open(QIODevice::WriteOnly);
+}
+
+//空的监控目录，快照一并清理
+QString makeRoot(const QString &name)
+{
+    const QString root = QDir::tempPath() + "/" + name;
+    QDir(root).removeRecursively();
+    QFile::remove(DirSnapshot::snapshotFile(root + "/"));
+    QDir().mkpath(root);
+    return root;
+}
+
+void removeRoot(const QString &root)
+{
+    QDir(root).removeRecursively();
+    QFile::remove(DirSnapshot::snapshotFile(root + "/"));
+}
+
+}  // namespace
+
+TEST(FileInotify, inotify1)
+{
+    TEST_CASE_NAME("inotify1")
+    const QString root = makeRoot("albuminotify1");
+    InotifyProbe probe;
+    probe.addWather(root);
+    ASSERT_TRUE(probe.isWatching(root));
+
+    // IN_CREATE时文件可能还没写完，只在IN_CLOSE_WRITE时加入
+    probe.inject(IN_CREATE, root, "a.jpg");
+    EXPECT_FALSE(probe.isKnown(root + "/a.jpg"));
+    probe.inject(IN_CLOSE_WRITE, root, "a.jpg");
+    EXPECT_TRUE(probe.isKnown(root + "/a.jpg"));
+    EXPECT_TRUE(probe.pending().contains(root + "/a.jpg"));
+
+    // 移走后从已知列表和待发送列表中去掉
+    probe.inject(IN_MOVED_FROM, root, "a.jpg");
+    EXPECT_FALSE(probe.isKnown(root + "/a.jpg"));
+    EXPECT_FALSE(probe.pending().contains(root + "/a.jpg"));
+    probe.inject(IN_MOVED_TO, root, "b.jpg");
+    EXPECT_TRUE(probe.isKnown(root + "/b.jpg"));
+    probe.inject(IN_DELETE, root, "b.jpg");
+    EXPECT_FALSE(probe.isKnown(root + "/b.jpg"));
+
+    // 不支持的格式和隐藏文件不处理
+    probe.inject(IN_CLOSE_WRITE, root, "note.txt");
+    probe.inject(IN_CLOSE_WRITE, root, ".hidden.jpg");
+    EXPECT_FALSE(probe.isKnown(root + "/note.txt"));
+    EXPECT_FALSE(probe.isKnown(root + "/.hidden.jpg"));
+    removeRoot(root);
+}
+
+TEST(FileInotify, inotify2)
+{
+    TEST_CASE_NAME("inotify2")
+    const QString root = makeRoot("albuminotify2");
+    const QString outside = makeRoot("albuminotify2_outside");
+    InotifyProbe probe;
+    probe.addWather(root);
+
+    // 新建的多层目录：监控每一层并收集已写入的照片
+    QDir().mkpath(root + "/new/deep");
+    touch(root + "/new/deep/1.jpg");
+    probe.inject(IN_CREATE | IN_ISDIR, root, "new");
+    EXPECT_TRUE(probe.isWatching(root + "/new"));
+    EXPECT_TRUE(probe.isWatching(root + "/new/deep"));
+    EXPECT_TRUE(probe.isKnown(root + "/new/deep/1.jpg"));
+
+    // 从监控范围外移入的目录树
+    QDir().mkpath(outside + "/x/y");
+    touch(outside + "/x/2.png");
+    touch(outside + "/x/y/3.jpg");
+    ASSERT_TRUE(QDir().rename(outside + "/x", root + "/moved"));
+    // 等监控线程处理完真实事件，之后注入的事件不会与之交错
+    QTest::qWait(200);
+    probe.inject(IN_MOVED_TO | IN_ISDIR, root, "moved");
+    EXPECT_TRUE(probe.isWatching(root + "/moved/y"));
+    EXPECT_TRUE(probe.isKnown(root + "/moved/2.png"));
+    EXPECT_TRUE(probe.isKnown(root + "/moved/y/3.jpg"));
+
+    // 移出监控范围的目录不再监控，其中的照片一并去掉
+    probe.inject(IN_MOVED_FROM | IN_ISDIR, root, "moved");
+    EXPECT_FALSE(probe.isWatching(root + "/moved/y"));
+    EXPECT_FALSE(probe.isKnown(root + "/moved/y/3.jpg"));
+    removeRoot(outside);
+    removeRoot(root);
+}
+
+TEST(FileInotify, inotify3)
+{
+    TEST_CASE_NAME("inotify3")
+    const QString root = makeRoot("albuminotify3");
+    touch(root + "/keep.jpg");
+    InotifyProbe probe;
+    probe.addWather(root);
+    EXPECT_TRUE(probe.isKnown(root + "/keep.jpg"));
+
+    // 删除事件丢失的照片，以及没有收到事件的新目录
+    probe.inject(IN_CLOSE_WRITE, root, "ghost.jpg");
+    EXPECT_TRUE(probe.isKnown(root + "/ghost.jpg"));
+    QDir().mkpath(root + "/late");
+    touch(root + "/late/late.jpg");
+
+    // 队列溢出后按磁盘现状重扫：去掉已不存在的，补上新增的
+    probe.inject(IN_Q_OVERFLOW, QString());
+    EXPECT_FALSE(probe.isKnown(root + "/ghost.jpg"));
+    EXPECT_FALSE(probe.pending().contains(root + "/ghost.jpg"));
+    EXPECT_TRUE(probe.isKnown(root + "/keep.jpg"));
+    EXPECT_TRUE(probe.isWatching(root + "/late"));
+    EXPECT_TRUE(probe.isKnown(root + "/late/late.jpg"));
+    removeRoot(root);
+}
+
+TEST(FileInotify, inotify4)
+{
+    TEST_CASE_NAME("inotify4")
+    const QString root = makeRoot("albuminotify4");
+    InotifyProbe probe;
+    probe.addWather(root);
+    QList<QStringList> batches;
+    QObject context;
+    QObject::connect(dApp->signalM, &SignalManager::sigMonitorChanged, &context, [&batches](QStringList files) {
+        batches << files;
+    });
+
+    // 事件仍在持续时不发送，停歇后合并为一批
+    for (int i = 0; i < 3; ++i) {
+        probe.inject(IN_CLOSE_WRITE, root, QString("burst%1.jpg").arg(i));
+    }
+    probe.onNeedSendPictures();
+    EXPECT_TRUE(batches.isEmpty());
+    for (int i = 0; i < 100 && batches.isEmpty(); ++i) {
+        QTest::qWait(50);
+    }
+    ASSERT_EQ(batches.size(), 1);
+    EXPECT_EQ(batches.first().size(), 3);
+    EXPECT_TRUE(probe.pending().isEmpty());
+
+    // 攒够一批立即发送，不等停歇
+    batches.clear();
+    for (int i = 0; i < 500; ++i) {
+        probe.inject(IN_CLOSE_WRITE, root, QString("many%1.jpg").arg(i));
+    }
+    probe.onNeedSendPictures();
+    ASSERT_EQ(batches.size(), 1);
+    EXPECT_EQ(batches.first().size(), 500);
+    removeRoot(root);
+}
+
+TEST(FileInotify, inotify5)
+{
+    TEST_CASE_NAME("inotify5")
+    const QString root = makeRoot("albuminotify5");
+    const QString snapshotFile = DirSnapshot::snapshotFile(root + "/");
+    touch(root + "/offline.jpg");
+
+    // 检出的照片还没发送就退出：不保存快照，下次启动仍能检出
+    {
+        InotifyProbe probe;
+        probe.addWather(root);
+        EXPECT_TRUE(probe.pending().contains(root + "/offline.jpg"));
+        EXPECT_FALSE(QFile::exists(snapshotFile));
+    }
+    InotifyProbe probe;
+    probe.addWather(root);
+    EXPECT_TRUE(probe.pending().contains(root + "/offline.jpg"));
+
+    // 发送导入之后才保存快照
+    QList<QStringList> batches;
+    QObject context;
+    QObject::connect(dApp->signalM, &SignalManager::sigMonitorChanged, &context, [&batches](QStringList files) {
+        batches << files;
+    });
+    for (int i = 0; i < 100 && batches.isEmpty(); ++i) {
+        QTest::qWait(50);
+        probe.onNeedSendPictures();
+    }
+    ASSERT_EQ(batches.size(), 1);
+    EXPECT_TRUE(batches.first().contains(root + "/offline.jpg"));
+    EXPECT_TRUE(QFile::exists(snapshotFile));
+    removeRoot(root);
+}
@@ -711,7 +711,7 @@ TEST(MainWindow, timelineview)
         //选中第一张
         e.addMouseMove(pr, 20);
         e.addMouseDClick(Qt::MouseButton::LeftButton, Qt::NoModifier, pr, 50);
-        e.simulate(timelineview->m_allThumbnailListView[0]->viewport());
+        e.simulate(timelineview->m_timelineView->viewport());
         e.clear();
         QTest::qWait(300);
 
@@ -721,11 +721,11 @@ TEST(MainWindow, timelineview)
         QTest::qWait(300);
 
         e.addMouseClick(Qt::MouseButton::LeftButton);
-        e.simulate(timelineview->m_allThumbnailListView[0]->viewport());
+        e.simulate(timelineview->m_timelineView->viewport());
         e.clear();
         QTest::qWait(300);
 
-        qApp->sendEvent(timelineview->m_allThumbnailListView[0]->viewport(), &menuEvent);
+        qApp->sendEvent(timelineview->m_timelineView->viewport(), &menuEvent);
         QTest::qWait(300);
         //查看
         DMenu *menuWidget = static_cast<DMenu *>(qApp->activePopupWidget());
@@ -739,7 +739,7 @@ TEST(MainWindow, timelineview)
         e.clear();
         QTest::qWait(300);
         //全屏
-        qApp->sendEvent(timelineview->m_allThumbnailListView[0]->viewport(), &menuEvent);
+        qApp->sendEvent(timelineview->m_timelineView->viewport(), &menuEvent);
         QTest::qWait(300);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
@@ -754,7 +754,7 @@ TEST(MainWindow, timelineview)
         //TODO:打印
 
         //幻灯片
-        qApp->sendEvent(timelineview->m_allThumbnailListView[0]->viewport(), &menuEvent);
+        qApp->sendEvent(timelineview->m_timelineView->viewport(), &menuEvent);
         QTest::qWait(300);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
@@ -769,7 +769,7 @@ TEST(MainWindow, timelineview)
         e.clear();
         QTest::qWait(300);
         //复制7
-        qApp->sendEvent(timelineview->m_allThumbnailListView[0]->viewport(), &menuEvent);
+        qApp->sendEvent(timelineview->m_timelineView->viewport(), &menuEvent);
         QTest::qWait(300);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
@@ -784,7 +784,7 @@ TEST(MainWindow, timelineview)
         QTest::qWait(300);
         //TODO:删除
         //收藏9
-        qApp->sendEvent(timelineview->m_allThumbnailListView[0]->viewport(), &menuEvent);
+        qApp->sendEvent(timelineview->m_timelineView->viewport(), &menuEvent);
         QTest::qWait(300);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
@@ -800,7 +800,7 @@ TEST(MainWindow, timelineview)
         e.clear();
         QTest::qWait(100);
         //顺时针10
-        qApp->sendEvent(timelineview->m_allThumbnailListView[0]->viewport(), &menuEvent);
+        qApp->sendEvent(timelineview->m_timelineView->viewport(), &menuEvent);
         QTest::qWait(300);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
@@ -818,11 +818,11 @@ TEST(MainWindow, timelineview)
         QTest::qWait(1500);
         e.addMouseMove(pr, 20);
         e.addMouseClick(Qt::MouseButton::LeftButton);
-        e.simulate(timelineview->m_allThumbnailListView[0]->viewport());
+        e.simulate(timelineview->m_timelineView->viewport());
         e.clear();
         QTest::qWait(300);
         //逆时针11
-        qApp->sendEvent(timelineview->m_allThumbnailListView[0]->viewport(), &menuEvent);;
+        qApp->sendEvent(timelineview->m_timelineView->viewport(), &menuEvent);;
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
@@ -841,11 +841,11 @@ TEST(MainWindow, timelineview)
 
         e.addMouseMove(pr, 20);
         e.addMouseClick(Qt::MouseButton::LeftButton);
-        e.simulate(timelineview->m_allThumbnailListView[0]->viewport());
+        e.simulate(timelineview->m_timelineView->viewport());
         e.clear();
         QTest::qWait(300);
         //设为壁纸12
-        qApp->sendEvent(timelineview->m_allThumbnailListView[0]->viewport(), &menuEvent);
+        qApp->sendEvent(timelineview->m_timelineView->viewport(), &menuEvent);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
@@ -863,7 +863,7 @@ TEST(MainWindow, timelineview)
         e.clear();
         QTest::qWait(100);
         //文管显示13
-        qApp->sendEvent(timelineview->m_allThumbnailListView[0]->viewport(), &menuEvent);
+        qApp->sendEvent(timelineview->m_timelineView->viewport(), &menuEvent);
         QTest::qWait(300);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
@@ -886,11 +886,11 @@ TEST(MainWindow, timelineview)
         QTest::qWait(300);
         e.addMouseMove(pr, 20);
         e.addMouseClick(Qt::MouseButton::LeftButton);
-        e.simulate(timelineview->m_allThumbnailListView[0]->viewport());
+        e.simulate(timelineview->m_timelineView->viewport());
         e.clear();
         QTest::qWait(300);
         //照片信息14
-        qApp->sendEvent(timelineview->m_allThumbnailListView[0]->viewport(), &menuEvent);
+        qApp->sendEvent(timelineview->m_timelineView->viewport(), &menuEvent);
         QTest::qWait(300);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
@@ -911,21 +911,17 @@ TEST(MainWindow, timelineview)
         e.clear();
         QTest::qWait(500);
 
-        QList<DCommandLinkButton *> btns = timelineview->m_allChoseButton;
+        //选中全部
+        timelineview->m_timelineView->selectAll();
+        QTest::qWait(200);
         QTestEventList e1;
-        e1.addMouseClick(Qt::MouseButton::LeftButton);
-        for (int i = 0; i < btns.size(); i++) { //选中全部
-            e1.simulate(btns.at(i));
-            QTest::qWait(200);
-        }
-        e1.clear();
 
-        qApp->sendEvent(timelineview->m_allThumbnailListView[0]->viewport(), &menuEvent);
+        qApp->sendEvent(timelineview->m_timelineView->viewport(), &menuEvent);
         QTest::qWait(300);
         DMenu *menuWidget3 = static_cast<DMenu *>(qApp->activePopupWidget());
 
         //幻灯片
-        qApp->sendEvent(timelineview->m_allThumbnailListView[0]->viewport(), &menuEvent);
+        qApp->sendEvent(timelineview->m_timelineView->viewport(), &menuEvent);
         QTest::qWait(300);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
@@ -952,7 +948,7 @@ TEST(MainWindow, timelineview)
         e.simulate(imageview->viewport());
         e.clear();
         //导出-d
-//        qApp->sendEvent(timelineview->m_allThumbnailListView[0]->viewport(), &menuEvent2);
+//        qApp->sendEvent(timelineview->m_timelineView->viewport(), &menuEvent2);
 //        QTest::qWait(300);
 //        e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
 //        e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
@@ -964,12 +960,12 @@ TEST(MainWindow, timelineview)
 //        QTest::qWait(500);
 
         e1.addMouseMove(pr);
-        e1.simulate(timelineview->m_allThumbnailListView[0]->viewport());
+        e1.simulate(timelineview->m_timelineView->viewport());
         e1.clear();
         QTest::qWait(300);
 
         //复制
-        qApp->sendEvent(timelineview->m_allThumbnailListView[0]->viewport(), &menuEvent);
+        qApp->sendEvent(timelineview->m_timelineView->viewport(), &menuEvent);
         QTest::qWait(300);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
         e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
@@ -981,7 +977,7 @@ TEST(MainWindow, timelineview)
         e.clear();
         QTest::qWait(500);
         //删除-d
-//        qApp->sendEvent(timelineview->m_allThumbnailListView[0]->viewport(), &menuEvent2);
+//        qApp->sendEvent(timelineview->m_timelineView->viewport(), &menuEvent2);
 //        QTest::qWait(300);
 //        e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
 //        e.addKeyClick(Qt::Key_Tab, Qt::NoModifier, 50);
@@ -1336,14 +1332,9 @@ TEST(MainWindow, AlbumView)
 
     //删除-d
 
-    QList<DCommandLinkButton *> btns = albumview->m_pImpTimeLineView->m_allChoseButton;
-    QTestEventList e1;
-    e1.addMouseClick(Qt::MouseButton::LeftButton);
-    for (int i = 0; i < btns.size(); i++) { //选中全部
-        e1.simulate(btns.at(i));
-        QTest::qWait(200);
-    }
-    e1.clear();
+    //选中全部
+    albumview->m_pImpTimeLineView->m_timelineView->selectAll();
+    QTest::qWait(200);
 
     //重新选中，拖拽
     e.addMouseClick(Qt::MouseButton::LeftButton, Qt::NoModifier, p1, 50);
@@ -2002,10 +1993,7 @@ TEST(MainWindow, callFuncitons_test)
     TEST_CASE_NAME("callFuncitons_test")
 
     ViewPanel viewPanel;
-    QStringList strList;
-    strList << "0" << "1";
 
-    viewPanel.onLoadLeft(strList);
     viewPanel.onttbcontentClicked();
     viewPanel.onRemoved();
     viewPanel.onViewBClicked();
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+
+#include "justifiedlayout.h"
+#include "../test_qtestDefine.h"
+
+namespace {
+
+//增量重排的结果应与按同样数据重新排版完全一致
+void expectSameAsFresh(const JustifiedLayout &layout, const QVector<float> &aspects)
+{
+    JustifiedLayout fresh;
+    fresh.setSpacing(layout.spacing());
+    fresh.setHeaderHeight(layout.headerHeight());
+    fresh.setGeometry(layout.width(), layout.rowHeight());
+    fresh.append(aspects);
+    ASSERT_EQ(fresh.rowCount(), layout.rowCount());
+    for (int row = 0; row < fresh.rowCount(); row++) {
+        EXPECT_EQ(fresh.firstInRow(row), layout.firstInRow(row)) << "row" << row;
+        EXPECT_EQ(fresh.rowTop(row), layout.rowTop(row)) << "row" << row;
+        EXPECT_EQ(fresh.rowHeightAt(row), layout.rowHeightAt(row)) << "row" << row;
+    }
+    EXPECT_EQ(fresh.height(), layout.height());
+}
+
+}  // namespace
+
+TEST(JustifiedLayout, layout1)
+{
+    TEST_CASE_NAME("layout1")
+    JustifiedLayout layout;
+    layout.setSpacing(10);
+    layout.setGeometry(1100, 100);
+    layout.append(QVector<float>(25, 1.0f));
+
+    //正方形图片与原来的网格一致：一行10个，(1100 - 9 * 10) / 10 = 101
+    EXPECT_EQ(3, layout.rowCount());
+    EXPECT_EQ(QRect(0, 0, 101, 101), layout.itemRect(0));
+    EXPECT_EQ(QRect(111, 111, 101, 101), layout.itemRect(11));
+    EXPECT_EQ(QSize(101, 101), layout.itemSize(24));
+    EXPECT_EQ(2, layout.rowOf(24));
+    EXPECT_EQ(323, layout.height());
+    EXPECT_EQ(11, layout.indexAt(QPoint(150, 150)));
+    EXPECT_EQ(-1, layout.indexAt(QPoint(105, 50)));
+    EXPECT_EQ(-1, layout.indexAt(QPoint(50, 2000)));
+    //第三行还能再放5个
+    EXPECT_EQ(323, layout.estimatedHeight(30));
+    EXPECT_EQ(434, layout.estimatedHeight(31));
+
+    //追加后补满最后一行
+    layout.append(QVector<float>(5, 1.0f));
+    EXPECT_EQ(3, layout.rowCount());
+    layout.append(QVector<float>(1, 1.0f));
+    EXPECT_EQ(4, layout.rowCount());
+    EXPECT_EQ(30, layout.firstInRow(3));
+
+    //删除后后面的图片前移
+    layout.remove(0, 10);
+    EXPECT_EQ(3, layout.rowCount());
+    EXPECT_EQ(20, layout.firstInRow(2));
+}
+
+TEST(JustifiedLayout, layout2)
+{
+    TEST_CASE_NAME("layout2")
+    JustifiedLayout layout;
+    layout.setSpacing(0);
+    layout.setGeometry(300, 100);
+    //宽图与方图混排，满行缩放到正好铺满宽度
+    layout.append(QVector<float>() << 2.0f << 1.0f << 1.0f << 1.0f);
+    EXPECT_EQ(2, layout.rowCount());
+    EXPECT_EQ(QSize(200, 100), layout.itemSize(0));
+    EXPECT_EQ(QRect(200, 0, 100, 100), layout.itemRect(1));
+    EXPECT_EQ(100, layout.rowTop(1));
+
+    //切换尺寸后再切回来，结果不变
+    layout.setGeometry(600, 100);
+    EXPECT_EQ(1, layout.rowCount());
+    EXPECT_EQ(120, layout.rowHeightAt(0));
+    layout.setAspect(0, 1.0f);
+    layout.setGeometry(300, 100);
+    EXPECT_EQ(2, layout.rowCount());
+    EXPECT_EQ(QSize(100, 100), layout.itemSize(0));
+    EXPECT_EQ(3, layout.firstInRow(1));
+}
+
+TEST(JustifiedLayout, header)
+{
+    TEST_CASE_NAME("header")
+    JustifiedLayout layout;
+    layout.setSpacing(0);
+    layout.setHeaderHeight(40);
+    layout.setGeometry(300, 100);
+    //标题、4张图、标题、1张图
+    layout.append(QVector<float>() << 0.0f << 1.0f << 1.0f << 1.0f << 1.0f << 0.0f << 1.0f);
+    EXPECT_TRUE(layout.isHeader(0));
+    EXPECT_FALSE(layout.isHeader(1));
+    EXPECT_EQ(5, layout.rowCount());
+    EXPECT_EQ(QSize(300, 40), layout.itemSize(0));
+    EXPECT_EQ(QRect(0, 40, 100, 100), layout.itemRect(1));
+
+    //标题前未排满的行与满行同样大小
+    EXPECT_EQ(4, layout.firstInRow(2));
+    EXPECT_EQ(100, layout.rowHeightAt(2));
+    EXPECT_EQ(240, layout.rowTop(3));
+    EXPECT_EQ(380, layout.height());
+
+    EXPECT_EQ(0, layout.rowAt(-5));
+    EXPECT_EQ(0, layout.rowAt(39));
+    EXPECT_EQ(1, layout.rowAt(40));
+    EXPECT_EQ(3, layout.rowAt(250));
+    EXPECT_EQ(5, layout.indexAt(QPoint(10, 250)));
+
+    //标题高度变化后重新排列
+    layout.setHeaderHeight(20);
+    EXPECT_EQ(20, layout.rowTop(1));
+    EXPECT_EQ(340, layout.height());
+}
+
+TEST(JustifiedLayout, incremental)
+{
+    TEST_CASE_NAME("incremental")
+    //宽300、无间距、行高100：[1, 1]之后放不下1.5，1.5另起一行
+    QVector<float> aspects = QVector<float>() << 1.0f << 1.0f << 1.5f << 1.0f << 1.0f;
+    JustifiedLayout layout;
+    layout.setSpacing(0);
+    layout.setHeaderHeight(40);
+    layout.setGeometry(300, 100);
+    layout.append(aspects);
+    EXPECT_EQ(2, layout.firstInRow(1));
+    expectSameAsFresh(layout, aspects);
+
+    //行首图片变窄后并入上一行
+    layout.setAspect(2, 1.0f);
+    aspects[2] = 1.0f;
+    EXPECT_EQ(3, layout.firstInRow(1));
+    expectSameAsFresh(layout, aspects);
+
+    //删除行首图片，后面的窄图并入上一行
+    layout.setAspect(2, 1.5f);
+    aspects[2] = 1.5f;
+    layout.setAspect(3, 0.5f);
+    aspects[3] = 0.5f;
+    expectSameAsFresh(layout, aspects);
+    layout.remove(2, 1);
+    aspects.remove(2, 1);
+    EXPECT_EQ(3, layout.firstInRow(1));
+    expectSameAsFresh(layout, aspects);
+
+    //删除末尾后，原来的满行变为最后一行，按最后一行的比例显示
+    aspects = QVector<float>() << 1.0f << 1.0f << 1.5f;
+    layout.clear();
+    layout.append(aspects);
+    EXPECT_EQ(150, layout.rowHeightAt(0));
+    layout.remove(2, 1);
+    aspects.remove(2, 1);
+    EXPECT_EQ(1, layout.rowCount());
+    EXPECT_EQ(100, layout.rowHeightAt(0));
+    expectSameAsFresh(layout, aspects);
+
+    //删除分组标题，前后两组的图片合并排列
+    aspects = QVector<float>() << 0.0f << 1.0f << 1.0f << 0.0f << 1.0f << 1.0f;
+    layout.clear();
+    layout.append(aspects);
+    EXPECT_EQ(4, layout.rowCount());
+    layout.remove(3, 1);
+    aspects.remove(3, 1);
+    EXPECT_EQ(3, layout.rowCount());
+    EXPECT_EQ(4, layout.firstInRow(2));
+    expectSameAsFresh(layout, aspects);
+
+    //在缓存的其他尺寸下修改，切回时同样从受影响的行重排
+    layout.setGeometry(500, 100);
+    layout.setAspect(1, 2.0f);
+    aspects[1] = 2.0f;
+    layout.setGeometry(300, 100);
+    expectSameAsFresh(layout, aspects);
+}
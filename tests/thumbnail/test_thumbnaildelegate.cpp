@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QPainter>
+#include <QPixmap>
+#include <QStandardItemModel>
+#include <QDebug>
+
+#include "thumbnaildelegate.h"
+#include "thumbnailmodel.h"
+#include "../test_qtestDefine.h"
+
+namespace {
+const int CELL = 120;
+const int COLUMNS = 10;
+const int ROWS = 6;
+
+//按列表滚动的方式绘制一屏格子，返回耗时(微秒)
+qint64 paintFrame(ThumbnailDelegate &delegate, QStandardItemModel &model, QImage &frame, int firstRow)
+{
+    QElapsedTimer timer;
+    timer.start();
+    frame.fill(Qt::transparent);
+    QPainter painter(&frame);
+    QStyleOptionViewItem option;
+    for (int r = 0; r < ROWS; r++) {
+        for (int c = 0; c < COLUMNS; c++) {
+            const int row = (firstRow + r) * COLUMNS + c;
+            if (row >= model.rowCount()) {
+                break;
+            }
+            option.rect = QRect(c * CELL, r * CELL, CELL, CELL);
+            option.state = (row % 7 == 0) ? QStyle::State_Selected : QStyle::State_None;
+            delegate.paint(&painter, option, model.index(row, 0));
+        }
+    }
+    painter.end();
+    return timer.nsecsElapsed() / 1000;
+}
+}
+
+TEST(ThumbnailDelegate, scrollBenchmark)
+{
+    TEST_CASE_NAME("scrollBenchmark")
+    QStandardItemModel model;
+    QList<QPixmap> sources;
+    for (int i = 0; i < 4; i++) {
+        QPixmap pixmap(300, 200);
+        pixmap.fill(QColor::fromHsv(i * 60, 200, 200));
+        sources << pixmap;
+    }
+    for (int i = 0; i < 600; i++) {
+        QStandardItem *item = new QStandardItem;
+        item->setData(QSize(CELL, CELL), Qt::SizeHintRole);
+        item->setData(QVariant::fromValue(sources.at(i % sources.size())), ThumbnailModel::PixmapRole);
+        item->setData(QSize(300, 200), ThumbnailModel::BaseSizeRole);
+        item->setData(QSize(CELL - 16, CELL - 16), ThumbnailModel::ImageSizeRole);
+        item->setData(QString("/tmp/delegate/%1.jpg").arg(i), ThumbnailModel::PathRole);
+        model.appendRow(item);
+    }
+
+    ThumbnailDelegate delegate(ThumbnailDelegate::AllPicViewType);
+    QImage frame(COLUMNS * CELL, ROWS * CELL, QImage::Format_ARGB32_Premultiplied);
+
+    //第一帧需要生成缓存，之后逐行滚动只是贴图
+    const qint64 cold = paintFrame(delegate, model, frame, 0);
+    qint64 total = 0;
+    qint64 worst = 0;
+    const int frames = 200;
+    for (int i = 0; i < frames; i++) {
+        const qint64 cost = paintFrame(delegate, model, frame, i % (600 / COLUMNS - ROWS));
+        total += cost;
+        worst = qMax(worst, cost);
+    }
+    qDebug() << "thumbnail delegate frame time(us): cold" << cold << "avg" << total / frames << "max" << worst;
+
+    //缩略图已绘制到格子中
+    const QColor center = frame.pixelColor(CELL / 2, CELL / 2);
+    EXPECT_EQ(255, center.alpha());
+    EXPECT_EQ(sources.at(0).toImage().pixelColor(150, 100).rgb(), center.rgb());
+}
@@ -2,6 +2,7 @@
 #include <gmock/gmock-matchers.h>
 
 #include <QTestEventList>
+#include <QElapsedTimer>
 #include <QString>
 
 #define private public
@@ -111,3 +112,107 @@ TEST(ThumbnailListView, createNewAlbumFromDialog1)
     QTest::qWait(200);
     emit dApp->signalM->sigCreateNewAlbumFromDialog("test-album1");
 }
+
+TEST(ThumbnailListView, scrollLoading)
+{
+    TEST_CASE_NAME("scrollLoading")
+    ThumbnailListView view(ThumbnailDelegate::TimeLineViewType);
+    view.resize(800, 600);
+    view.m_model->setGeometry(800, 100, 4);
+    QVector<ThumbnailModel::Item> items;
+    QStringList reversed;
+    items << ThumbnailModel::Item::sectionHeader("2020/1/1", 300);
+    for (int i = 0; i < 300; i++) {
+        ThumbnailModel::Item item;
+        item.path = QString("/tmp/scroll/%1.jpg").arg(i);
+        item.previewColor = qRgb(i % 256, 0, 0);
+        items << item;
+        reversed.prepend(item.path);
+    }
+    view.queueFiles(reversed);
+    view.m_model->appendItems(items);
+    view.m_sectioned = true;
+    EXPECT_EQ(qRgb(5, 0, 0), view.m_model->index(6, 0).data(ThumbnailModel::PreviewColorRole).toUInt());
+
+    //一帧内滚过几千像素视为快速滑动，不发出请求
+    view.onScrollbarValueChanged(0);
+    view.onScrollbarValueChanged(5000);
+    EXPECT_TRUE(view.m_flinging);
+    view.requestSomeImages();
+    EXPECT_EQ(0, view.m_requestCount);
+    EXPECT_TRUE(view.bneedloadimage);
+
+    //停稳后视口内的行排到队列前面
+    view.m_requestCount = 1;
+    view.verticalScrollBar()->blockSignals(true);
+    view.verticalScrollBar()->setValue(0);
+    view.verticalScrollBar()->blockSignals(false);
+    view.onScrollSettled();
+    view.m_settleTimer->stop();
+    EXPECT_FALSE(view.m_flinging);
+    EXPECT_EQ(QString("/tmp/scroll/0.jpg"), view.m_filesbeleft.first());
+    EXPECT_EQ(QString("/tmp/scroll/1.jpg"), view.m_filesbeleft.at(1));
+    EXPECT_GT(view.m_filesbeleft.indexOf("/tmp/scroll/299.jpg"), view.m_filesbeleft.indexOf("/tmp/scroll/1.jpg"));
+    EXPECT_EQ(300, view.m_filesbeleftSet.size());
+    view.m_requestCount = 0;
+
+    //解码快时批量变大，慢时变小，始终在范围内
+    const int initial = view.m_requestBatch;
+    view.m_batchSize = initial;
+    view.m_batchClock.start();
+    view.adaptRequestBatch();
+    EXPECT_GT(view.m_requestBatch, initial);
+    const int fast = view.m_requestBatch;
+    view.m_batchSize = 8;
+    view.m_batchClock.start();
+    QTest::qWait(400);
+    view.adaptRequestBatch();
+    EXPECT_LT(view.m_requestBatch, fast);
+    EXPECT_GE(view.m_requestBatch, 8);
+    EXPECT_EQ(0, view.m_batchSize);
+    view.m_filesbeleft.clear();
+    view.m_filesbeleftSet.clear();
+}
+
+TEST(ThumbnailListView, selectionBenchmark)
+{
+    TEST_CASE_NAME("selectionBenchmark")
+    ThumbnailListView view(ThumbnailDelegate::AllPicViewType);
+    view.m_model->setGeometry(800, 100, 4);
+    const int total = 100000;
+    QVector<ThumbnailModel::Item> items;
+    items.reserve(total);
+    for (int i = 0; i < total; i++) {
+        ThumbnailModel::Item item;
+        item.path = QString("/tmp/bench/%1.jpg").arg(i);
+        items << item;
+    }
+    view.m_model->appendItems(items);
+    //每20张取一张作为重复导入的图片
+    QStringList duplicates;
+    for (int i = 0; i < total; i += 20) {
+        duplicates << items.at(i).path;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QModelIndex firstIndex;
+    view.selectDuplicateForOneListView(duplicates, firstIndex);
+    const qint64 duplicateMs = timer.restart();
+    EXPECT_EQ(0, firstIndex.row());
+    EXPECT_EQ(duplicates.size(), view.selectedCount(0, total - 1));
+    EXPECT_FALSE(view.isAllPicSeleted());
+
+    timer.restart();
+    view.selectAll();
+    EXPECT_TRUE(view.isAllPicSeleted());
+    const qint64 selectAllMs = timer.restart();
+
+    //其他列表同步相册变化
+    view.onSyncListviewModelData(duplicates, "bench", ThumbnailListView::IdAddToAlbum);
+    const qint64 syncMs = timer.elapsed();
+    EXPECT_TRUE(view.m_model->index(20, 0).data(ThumbnailModel::AlbumNamesRole).toStringList().contains("bench"));
+    // 耗时只记录不断言
+    qDebug() << "selection 100k rows: duplicates" << duplicates.size() << duplicateMs << "ms, select all"
+             << selectAllMs << "ms, sync" << syncMs << "ms";
+}
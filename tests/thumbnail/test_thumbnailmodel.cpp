@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+
+#include <QSignalSpy>
+#include <QString>
+
+#include "thumbnailmodel.h"
+#include "../test_qtestDefine.h"
+
+namespace {
+QVector<ThumbnailModel::Item> makeItems(int count, float aspect)
+{
+    QVector<ThumbnailModel::Item> items;
+    for (int i = 0; i < count; i++) {
+        ThumbnailModel::Item item;
+        item.path = QString("/tmp/model/%1.jpg").arg(i);
+        item.name = QString("%1.jpg").arg(i);
+        item.baseSize = QSize(100, 100);
+        item.aspect = aspect;
+        items << item;
+    }
+    return items;
+}
+}
+
+TEST(ThumbnailModel, model1)
+{
+    TEST_CASE_NAME("model1")
+    ThumbnailModel model;
+    //一行放10个101x101的格子
+    model.setGeometry(1100, 100, 10);
+    QSignalSpy inserted(&model, &ThumbnailModel::rowsInserted);
+    model.appendItems(makeItems(10000, 1));
+    EXPECT_EQ(1, inserted.count());
+    EXPECT_EQ(10000, model.rowCount());
+    EXPECT_EQ(QString("/tmp/model/42.jpg"), model.index(42, 0).data(ThumbnailModel::PathRole).toString());
+    EXPECT_EQ(QSize(101, 101), model.index(42, 0).data(Qt::SizeHintRole).toSize());
+    EXPECT_EQ(42, model.rowOf("/tmp/model/42.jpg"));
+    EXPECT_EQ(-1, model.rowOf("/tmp/model/none.jpg"));
+
+    model.setData(model.index(3, 0), QStringList() << "album", ThumbnailModel::AlbumNamesRole);
+    EXPECT_EQ(QStringList() << "album", model.index(3, 0).data(ThumbnailModel::AlbumNamesRole).toStringList());
+}
+
+TEST(ThumbnailModel, model2)
+{
+    TEST_CASE_NAME("model2")
+    ThumbnailModel model;
+    model.setGeometry(1100, 100, 10);
+    model.appendItems(makeItems(100, 1));
+    QSignalSpy changed(&model, &ThumbnailModel::dataChanged);
+    QSignalSpy reset(&model, &ThumbnailModel::modelReset);
+    QSignalSpy removed(&model, &ThumbnailModel::rowsRemoved);
+
+    //相同数据不产生任何通知
+    model.setItems(makeItems(100, 1));
+    EXPECT_EQ(0, changed.count());
+
+    //只有第10~19行变化，合并为一次dataChanged
+    QVector<ThumbnailModel::Item> items = makeItems(100, 1);
+    for (int i = 10; i < 20; i++) {
+        items[i].damaged = true;
+    }
+    model.setItems(items);
+    ASSERT_EQ(1, changed.count());
+    EXPECT_EQ(10, changed.at(0).at(0).toModelIndex().row());
+    EXPECT_EQ(19, changed.at(0).at(1).toModelIndex().row());
+
+    //缩放时只通知格子大小变化，切回原来的尺寸直接复用缓存的布局
+    changed.clear();
+    EXPECT_TRUE(model.setGeometry(1100, 50, 10));
+    EXPECT_EQ(1, changed.count());
+    EXPECT_FALSE(model.setGeometry(1100, 50, 10));
+    EXPECT_TRUE(model.setGeometry(1100, 100, 10));
+    EXPECT_EQ(QSize(101, 101), model.index(15, 0).data(Qt::SizeHintRole).toSize());
+
+    //行数减少时只删除末尾
+    model.setItems(items.mid(0, 90));
+    EXPECT_EQ(1, removed.count());
+    EXPECT_EQ(90, model.rowCount());
+    EXPECT_EQ(0, reset.count());
+
+    model.removeRows(0, 1);
+    EXPECT_EQ(QString("/tmp/model/1.jpg"), model.pathAt(0));
+}
+
+TEST(ThumbnailModel, section)
+{
+    TEST_CASE_NAME("section")
+    ThumbnailModel model;
+    model.setGeometry(1100, 100, 10);
+    model.setHeaderHeight(40);
+    QVector<ThumbnailModel::Item> items;
+    items << ThumbnailModel::Item::sectionHeader("2020/1/2", 4) << makeItems(4, 1)
+          << ThumbnailModel::Item::sectionHeader("2020/1/1", 1) << makeItems(1, 1);
+    model.appendItems(items);
+    EXPECT_EQ(QVector<int>() << 0 << 5, model.headerRows());
+    EXPECT_TRUE(model.isHeader(5));
+    EXPECT_EQ(0, model.sectionOf(3));
+    EXPECT_EQ(5, model.sectionOf(6));
+    EXPECT_EQ(4, model.sectionEnd(0));
+    EXPECT_EQ(6, model.sectionEnd(5));
+
+    //标题行不可选中，不参与按路径查找
+    EXPECT_EQ(Qt::ItemIsEnabled, model.flags(model.index(0, 0)));
+    EXPECT_TRUE(model.flags(model.index(1, 0)) & Qt::ItemIsSelectable);
+    EXPECT_TRUE(model.index(0, 0).data(ThumbnailModel::HeaderRole).toBool());
+    EXPECT_EQ(4, model.index(0, 0).data(ThumbnailModel::SectionCountRole).toInt());
+    EXPECT_EQ(-1, model.rowOf(""));
+
+    //删除后标题位置随之前移
+    model.removeRows(1, 1);
+    EXPECT_EQ(QVector<int>() << 0 << 4, model.headerRows());
+    EXPECT_EQ(4, model.sectionOf(5));
+}
+
+TEST(ThumbnailModel, rowIndex)
+{
+    TEST_CASE_NAME("rowIndex")
+    ThumbnailModel model;
+    model.setGeometry(1100, 100, 10);
+    QVector<ThumbnailModel::Item> items;
+    items << ThumbnailModel::Item::sectionHeader("2020/1/2", 10) << makeItems(10, 1);
+    model.appendItems(items);
+    EXPECT_EQ(1, model.rowOf("/tmp/model/0.jpg"));
+    EXPECT_EQ(10, model.rowOf("/tmp/model/9.jpg"));
+    EXPECT_EQ(-1, model.rowOf("2020/1/2"));
+
+    //连续的行合并为一个区间，结果按行号升序且去重
+    QStringList paths;
+    paths << "/tmp/model/5.jpg" << "/tmp/model/1.jpg" << "/tmp/model/2.jpg" << "/tmp/model/3.jpg"
+          << "/tmp/model/2.jpg" << "/tmp/missing.jpg";
+    EXPECT_EQ(QVector<int>() << 2 << 3 << 4 << 6, model.rowsOf(paths));
+    const QItemSelection selection = model.selectionOf(paths);
+    ASSERT_EQ(2, selection.size());
+    EXPECT_EQ(2, selection.at(0).top());
+    EXPECT_EQ(4, selection.at(0).bottom());
+    EXPECT_EQ(6, selection.at(1).top());
+    EXPECT_TRUE(model.selectionOf(QStringList() << "/tmp/missing.jpg").isEmpty());
+
+    //删除和替换后索引随之更新
+    model.removeRows(1, 2);
+    EXPECT_EQ(-1, model.rowOf("/tmp/model/0.jpg"));
+    EXPECT_EQ(1, model.rowOf("/tmp/model/2.jpg"));
+    ThumbnailModel::Item item = model.item(1);
+    item.path = "/tmp/model/renamed.jpg";
+    model.setItem(1, item);
+    EXPECT_EQ(-1, model.rowOf("/tmp/model/2.jpg"));
+    EXPECT_EQ(1, model.rowOf("/tmp/model/renamed.jpg"));
+    model.setItems(makeItems(3, 1));
+    EXPECT_EQ(2, model.rowOf("/tmp/model/2.jpg"));
+    EXPECT_EQ(-1, model.rowOf("/tmp/model/renamed.jpg"));
+    model.clear();
+    EXPECT_EQ(-1, model.rowOf("/tmp/model/2.jpg"));
+}
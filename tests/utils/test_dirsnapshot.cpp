@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include "utils/dirsnapshot.h"
+#include "../test_qtestDefine.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSet>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+void touch(const QString &path, const QByteArray &data = QByteArray())
+{
+    QFile f(path);
+    f.open(QIODevice::WriteOnly);
+    f.write(data);
+}
+
+//把目录mtime调到一小时前，避开快照对刚修改目录的重扫保护
+void ageDir(const QString &dir)
+{
+    struct timespec times[2];
+    clock_gettime(CLOCK_REALTIME, &times[0]);
+    times[0].tv_sec -= 3600;
+    times[1] = times[0];
+    utimensat(AT_FDCWD, QFile::encodeName(dir).constData(), times, 0);
+}
+
+QSet<QString> toSet(const QStringList &list)
+{
+    return list.toSet();
+}
+
+}  // namespace
+
+TEST(DirSnapshot, snapshot1)
+{
+    TEST_CASE_NAME("snapshot1")
+    const QString root = QDir::tempPath() + "/albumsnapshot1";
+    const QString file = root + ".snap";
+    QDir(root).removeRecursively();
+    QFile::remove(file);
+    QDir().mkpath(root + "/a/b");
+    touch(root + "/1.jpg");
+    touch(root + "/note.txt");
+    touch(root + "/a/2.PNG");
+    touch(root + "/a/b/3.jpg");
+    ageDir(root + "/a/b");
+    ageDir(root + "/a");
+    ageDir(root);
+
+    DirSnapshot first(QStringList() << "jpg" << "png");
+    EXPECT_FALSE(first.load(file));
+    DirSnapshot::Changes changes;
+    QStringList files = first.rescan(root, &changes);
+    EXPECT_EQ(toSet(files), toSet(QStringList() << root + "/1.jpg" << root + "/a/2.PNG" << root + "/a/b/3.jpg"));
+    EXPECT_EQ(changes.added.size(), 3);
+    EXPECT_TRUE(first.save(file));
+
+    //子目录变化：新增、删除、替换文件
+    touch(root + "/a/b/4.jpg");
+    QFile::remove(root + "/a/2.PNG");
+    QFile::remove(root + "/a/b/3.jpg");
+    touch(root + "/a/b/3.jpg", "changed");
+
+    DirSnapshot second(QStringList() << "jpg" << "png");
+    EXPECT_TRUE(second.load(file));
+    changes = DirSnapshot::Changes();
+    files = second.rescan(root, &changes);
+    EXPECT_EQ(toSet(files), toSet(QStringList() << root + "/1.jpg" << root + "/a/b/3.jpg" << root + "/a/b/4.jpg"));
+    EXPECT_EQ(changes.added, QStringList() << root + "/a/b/4.jpg");
+    EXPECT_EQ(changes.removed, QStringList() << root + "/a/2.PNG");
+    EXPECT_EQ(changes.modified, QStringList() << root + "/a/b/3.jpg");
+
+    //整个子目录被删除
+    QDir(root + "/a").removeRecursively();
+    changes = DirSnapshot::Changes();
+    files = second.rescan(root, &changes);
+    EXPECT_EQ(files, QStringList() << root + "/1.jpg");
+    EXPECT_EQ(toSet(changes.removed), toSet(QStringList() << root + "/a/b/3.jpg" << root + "/a/b/4.jpg"));
+
+    QDir(root).removeRecursively();
+    QFile::remove(file);
+}
+
+//mtime未变的目录不再列出：在目录中悄悄加入文件并恢复原mtime，增量扫描不应看到它
+TEST(DirSnapshot, snapshot2)
+{
+    TEST_CASE_NAME("snapshot2")
+    const QString root = QDir::tempPath() + "/albumsnapshot2";
+    QDir(root).removeRecursively();
+    const int dirs = 20;
+    const int filesPerDir = 50;
+    for (int d = 0; d < dirs; ++d) {
+        const QString dir = QString("%1/DCIM%2/%3").arg(root).arg(d / 10).arg(d);
+        QDir().mkpath(dir);
+        for (int f = 0; f < filesPerDir; ++f) {
+            touch(QString("%1/IMG_%2.jpg").arg(dir).arg(f));
+        }
+        ageDir(dir);
+    }
+    for (int g = 0; g < dirs / 10; ++g) {
+        ageDir(QString("%1/DCIM%2").arg(root).arg(g));
+    }
+    ageDir(root);
+
+    DirSnapshot snapshot(QStringList() << "jpg");
+    QElapsedTimer timer;
+    timer.start();
+    const int full = snapshot.rescan(root).size();
+    const qint64 fullMs = timer.elapsed();
+    EXPECT_EQ(full, dirs * filesPerDir);
+
+    //改动一个目录；另一个目录加入文件后恢复mtime，模拟未变化的目录
+    const QString changedDir = root + "/DCIM0/0";
+    touch(changedDir + "/IMG_new.jpg");
+    const QString untouchedDir = root + "/DCIM1/15";
+    struct stat st;
+    ASSERT_EQ(stat(QFile::encodeName(untouchedDir).constData(), &st), 0);
+    touch(untouchedDir + "/IMG_hidden.jpg");
+    struct timespec times[2] = {st.st_atim, st.st_mtim};
+    utimensat(AT_FDCWD, QFile::encodeName(untouchedDir).constData(), times, 0);
+
+    DirSnapshot::Changes changes;
+    timer.restart();
+    const QStringList incremental = snapshot.rescan(root, &changes);
+    const qint64 incrementalMs = timer.elapsed();
+    // 耗时只记录不断言
+    qDebug() << "snapshot full" << fullMs << "ms, incremental" << incrementalMs << "ms";
+
+    EXPECT_EQ(incremental.size(), full + 1);
+    EXPECT_EQ(changes.added, QStringList() << changedDir + "/IMG_new.jpg");
+    EXPECT_FALSE(incremental.contains(untouchedDir + "/IMG_hidden.jpg"));
+
+    QDir(root).removeRecursively();
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include "utils/dirwalker.h"
+#include "../test_qtestDefine.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QSet>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+//生成 dirs 个目录(两层)，每个目录 filesPerDir 个文件，三分之一为非图片
+int makeTree(const QString &root, int dirs, int filesPerDir)
+{
+    int images = 0;
+    for (int d = 0; d < dirs; ++d) {
+        const QString dir = QString("%1/DCIM%2/%3").arg(root).arg(d / 50).arg(d);
+        QDir().mkpath(dir);
+        for (int f = 0; f < filesPerDir; ++f) {
+            const char *suffix = (f % 3 == 0) ? "txt" : (f % 3 == 1 ? "JPG" : "png");
+            const QByteArray path = QFile::encodeName(QString("%1/IMG_%2.%3").arg(dir).arg(f).arg(suffix));
+            const int fd = ::open(path.constData(), O_CREAT | O_WRONLY, 0644);
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            images += (f % 3 == 0) ? 0 : 1;
+        }
+    }
+    return images;
+}
+
+}  // namespace
+
+TEST(DirWalker, walker1)
+{
+    TEST_CASE_NAME("walker1")
+    const QString root = QDir::tempPath() + "/albumwalker1";
+    QDir(root).removeRecursively();
+    const int images = makeTree(root, 20, 30);
+    // 隐藏文件和隐藏目录不返回
+    QDir().mkpath(root + "/.hidden");
+    QFile(root + "/.hidden/a.jpg").open(QIODevice::WriteOnly);
+    QFile(root + "/.b.jpg").open(QIODevice::WriteOnly);
+
+    DirWalker walker(QStringList() << "jpg" << "PNG");
+    walker.setFanOut(4);
+    QStringList files = walker.walkAll(QStringList() << root);
+    EXPECT_EQ(files.size(), images);
+    EXPECT_EQ(files.toSet().size(), images);
+
+    walker.setRecursive(false);
+    EXPECT_TRUE(walker.walkAll(QStringList() << root).isEmpty());
+
+    // 回调返回false时停止
+    DirWalker stopper(QStringList() << "jpg");
+    stopper.setBatchSize(5);
+    int batches = 0;
+    EXPECT_FALSE(stopper.walk(QStringList() << root, [&batches](const QStringList &) {
+        return ++batches < 2;
+    }));
+    EXPECT_EQ(batches, 2);
+    QDir(root).removeRecursively();
+}
+
+TEST(DirWalkerBench, walker2)
+{
+    TEST_CASE_NAME("walker2")
+    // 100个目录 x 60个文件，与QDirIterator结果一致，耗时只记录不断言
+    const QString root = QDir::tempPath() + "/albumwalker2";
+    QDir(root).removeRecursively();
+    const int images = makeTree(root, 100, 60);
+
+    QStringList filters;
+    filters << "*.jpg" << "*.JPG" << "*.png" << "*.PNG";
+    QElapsedTimer timer;
+    timer.start();
+    QDirIterator it(root, filters, QDir::Files | QDir::NoSymLinks, QDirIterator::Subdirectories);
+    int iteratorCount = 0;
+    while (it.hasNext()) {
+        it.next();
+        it.fileInfo().filePath();
+        ++iteratorCount;
+    }
+    qint64 iteratorMs = timer.restart();
+
+    DirWalker walker(QStringList() << "jpg" << "png");
+    walker.setSkipSymlinks(true);
+    int walkerCount = 0;
+    walker.walk(QStringList() << root, [&walkerCount](const QStringList & files) {
+        walkerCount += files.size();
+        return true;
+    });
+    qint64 walkerMs = timer.elapsed();
+    qDebug() << "walk 6k files: QDirIterator" << iteratorMs << "ms, DirWalker" << walkerMs << "ms";
+    EXPECT_EQ(iteratorCount, images);
+    EXPECT_EQ(walkerCount, images);
+    QDir(root).removeRecursively();
+}
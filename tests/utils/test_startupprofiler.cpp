@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#define private public
+#include "utils/startupprofiler.h"
+#include "../test_qtestDefine.h"
+#include <QListView>
+#include <QStringListModel>
+#include <QTest>
+
+TEST(StartupProfiler, disabled)
+{
+    TEST_CASE_NAME("disabled")
+    StartupProfiler *p = StartupProfiler::instance();
+    p->setEnabled(false);
+    int count = p->phases().size();
+    p->mark("nothing");
+    QWidget w;
+    p->watchFirstFrame(&w);
+    w.show();
+    QTest::qWait(100);
+    ASSERT_EQ(count, p->phases().size());
+    ASSERT_EQ(-1, p->firstFrameMs());
+}
+
+TEST(StartupProfiler, firstFrameAndGrid)
+{
+    TEST_CASE_NAME("firstFrameAndGrid")
+    StartupProfiler *p = StartupProfiler::instance();
+    p->setEnabled(true);
+    p->m_reported = false;
+    p->mark("phase");
+    ASSERT_EQ(QString("phase"), p->phases().last().first);
+
+    QWidget w;
+    p->watchFirstFrame(&w);
+    w.show();
+    QTest::qWait(200);
+    ASSERT_GE(p->firstFrameMs(), 0);
+
+    //空列表绘制不计入首屏网格
+    QStringListModel model;
+    QListView view;
+    p->watchFirstGrid(&view);
+    view.setModel(&model);
+    view.show();
+    QTest::qWait(200);
+    ASSERT_EQ(-1, p->firstGridMs());
+
+    model.setStringList(QStringList() << "a" << "b");
+    view.viewport()->update();
+    QTest::qWait(200);
+    ASSERT_GE(p->firstGridMs(), p->firstFrameMs());
+    ASSERT_TRUE(p->m_reported);
+    p->setEnabled(false);
+}